@@ -0,0 +1,485 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the function templates async_read, async_write and async_flush,
+// which perform i/o on file descriptors and on chains ending in file
+// descriptors without blocking the calling thread, using a reactor to wait
+// until the descriptor is ready.
+//
+// The operations rely on the library's conventions for non-blocking i/o: a
+// read which returns 0 and a write which returns a short count would block.
+// file_descriptor follows them when its handle -- e.g., a pipe or socket --
+// is in non-blocking mode, and the stream buffers of a chain and filters
+// such as symmetric_filter pass them on, so that the compression filters
+// work unchanged in asynchronous chains.
+//
+// The first argument of each operation is a reactor; the second is either
+// a file_descriptor, file_descriptor_source or file_descriptor_sink, or a
+// filtering_streambuf or filtering_wstreambuf whose final link is one of
+// these. For other devices, the handle to wait on may be passed explicitly
+// as the third argument. The last argument is a completion handler, which
+// is invoked from reactor::run() as
+//
+//      handler(const boost::system::error_code& ec, std::streamsize n)
+//
+// async_read completes as soon as at least one character has been read;
+// n is the number of characters read, or -1 at end-of-stream. async_write
+// completes once all n characters have been accepted, and async_flush --
+// which applies to filtering streambufs -- once the buffers of the chain
+// have been written through to the device; n is then 0. If the compiler
+// supports C++20 coroutines, the overloads which omit the handler return an
+// awaitable, whose co_await expression yields n or throws system_error.
+//
+// Closing a chain may write further data, such as a compressor's trailer,
+// and does so synchronously; close an output chain only after async_flush
+// has completed, when the device can accept the remaining data.
+
+#ifndef BOOST_IOSTREAMS_ASYNC_HPP_INCLUDED
+#define BOOST_IOSTREAMS_ASYNC_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <exception>
+#include <boost/config.hpp>                       // BOOST_DEDUCED_TYPENAME.
+#include <boost/iostreams/detail/config/coroutine.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/error_code.hpp>
+#include <boost/iostreams/filtering_streambuf.hpp>
+#include <boost/iostreams/flush.hpp>
+#include <boost/iostreams/reactor.hpp>
+#include <boost/iostreams/traits.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/system/system_error.hpp>
+#include <boost/throw_exception.hpp>
+#ifdef BOOST_IOSTREAMS_HAS_COROUTINES
+# include <coroutine>
+#endif
+
+// Must come last.
+#include <boost/iostreams/detail/config/disable_warnings.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace detail {
+
+//------------------Non-blocking primitives-----------------------------------//
+
+// Each of the following returns the number of characters transferred,
+// 0 if the operation would block or -1 at end-of-stream.
+
+template<typename T>
+std::streamsize async_read_some
+    ( T& t, typename char_type_of<T>::type* s, std::streamsize n,
+      boost::system::error_code& ec )
+{ return iostreams::read(t, s, n, ec); }
+
+template<typename T>
+std::streamsize async_write_some
+    ( T& t, const typename char_type_of<T>::type* s, std::streamsize n,
+      boost::system::error_code& ec )
+{ return iostreams::write(t, s, n, ec); }
+
+// Returns true if there is no buffered output left to write.
+template<typename T>
+bool async_flush_some(T& t, boost::system::error_code& ec)
+{
+    try {
+        iostreams::flush(t);
+    } catch (const std::exception&) {
+        detail::set_error_code(ec);
+    }
+    return true;
+}
+
+// A filtering streambuf returns 0 from sgetn() both at end-of-stream and
+// when the device would block; the first link of its chain records which.
+template<typename Streambuf>
+std::streamsize async_chain_read_some
+    ( Streambuf& buf, typename Streambuf::char_type* s, std::streamsize n,
+      boost::system::error_code& ec )
+{
+    try {
+        std::streamsize amt = buf.sgetn(s, n);
+        return amt != 0 ?
+            amt :
+            buf.filters().front().true_eof() ?
+                -1 :
+                0;
+    } catch (const std::exception&) {
+        detail::set_error_code(ec);
+        return -1;
+    }
+}
+
+template<typename Streambuf>
+std::streamsize async_chain_write_some
+    ( Streambuf& buf, const typename Streambuf::char_type* s,
+      std::streamsize n, boost::system::error_code& ec )
+{
+    try {
+        return buf.sputn(s, n);
+    } catch (const std::exception&) {
+        detail::set_error_code(ec);
+        return 0;
+    }
+}
+
+template<typename Streambuf>
+bool async_chain_flush_some(Streambuf& buf, boost::system::error_code& ec)
+{
+    if (buf.BOOST_IOSTREAMS_PUBSYNC() == -1) {
+        ec = errors::bad_write;
+        return true;
+    }
+    return !buf.output_pending();
+}
+
+#define BOOST_IOSTREAMS_ASYNC_CHAIN_OPERATIONS(streambuf_) \
+    template< typename Mode, typename Ch, typename Tr, \
+              typename Alloc, typename Access > \
+    std::streamsize async_read_some \
+        ( streambuf_<Mode, Ch, Tr, Alloc, Access>& buf, Ch* s, \
+          std::streamsize n, boost::system::error_code& ec ) \
+    { return async_chain_read_some(buf, s, n, ec); } \
+    template< typename Mode, typename Ch, typename Tr, \
+              typename Alloc, typename Access > \
+    std::streamsize async_write_some \
+        ( streambuf_<Mode, Ch, Tr, Alloc, Access>& buf, const Ch* s, \
+          std::streamsize n, boost::system::error_code& ec ) \
+    { return async_chain_write_some(buf, s, n, ec); } \
+    template< typename Mode, typename Ch, typename Tr, \
+              typename Alloc, typename Access > \
+    bool async_flush_some \
+        ( streambuf_<Mode, Ch, Tr, Alloc, Access>& buf, \
+          boost::system::error_code& ec ) \
+    { return async_chain_flush_some(buf, ec); } \
+    template< typename Mode, typename Ch, typename Tr, \
+              typename Alloc, typename Access > \
+    reactor::handle_type async_handle \
+        (streambuf_<Mode, Ch, Tr, Alloc, Access>& buf) \
+    { return async_chain_handle(buf); } \
+    /**/
+
+//------------------Definition of async_handle--------------------------------//
+
+// Returns the handle of the file descriptor to wait on
+
+inline reactor::handle_type async_handle(file_descriptor& t)
+{ return t.handle(); }
+
+inline reactor::handle_type async_handle(file_descriptor_source& t)
+{ return t.handle(); }
+
+inline reactor::handle_type async_handle(file_descriptor_sink& t)
+{ return t.handle(); }
+
+template<typename Streambuf>
+reactor::handle_type async_chain_handle(Streambuf& buf)
+{
+    int n = static_cast<int>(buf.size()) - 1;
+    if (n >= 0) {
+        if (file_descriptor* fd = buf.template component<file_descriptor>(n))
+            return fd->handle();
+        if ( file_descriptor_source* fd =
+                 buf.template component<file_descriptor_source>(n) )
+        {
+            return fd->handle();
+        }
+        if ( file_descriptor_sink* fd =
+                 buf.template component<file_descriptor_sink>(n) )
+        {
+            return fd->handle();
+        }
+    }
+    return file_descriptor().handle(); // Invalid handle; waiting fails.
+}
+
+BOOST_IOSTREAMS_ASYNC_CHAIN_OPERATIONS(filtering_streambuf)
+BOOST_IOSTREAMS_ASYNC_CHAIN_OPERATIONS(filtering_wstreambuf)
+#undef BOOST_IOSTREAMS_ASYNC_CHAIN_OPERATIONS
+
+//------------------Definition of asynchronous operations---------------------//
+
+template<typename T, typename Handler>
+class async_read_op {
+public:
+    typedef typename char_type_of<T>::type char_type;
+    async_read_op( reactor& r, T& t, reactor::handle_type h,
+                   char_type* s, std::streamsize n, Handler handler )
+        : reactor_(&r), t_(&t), handle_(h), s_(s), n_(n), handler_(handler)
+        { }
+    void operator()(const boost::system::error_code& e)
+    {
+        if (e) {
+            handler_(e, 0);
+            return;
+        }
+        boost::system::error_code ec;
+        std::streamsize amt = n_ != 0 ? async_read_some(*t_, s_, n_, ec) : 0;
+        if (ec)
+            handler_(ec, 0);
+        else if (amt == 0 && n_ != 0)
+            reactor_->async_wait(handle_, reactor::wait_read, *this);
+        else
+            handler_(ec, amt);
+    }
+private:
+    reactor*              reactor_;
+    T*                    t_;
+    reactor::handle_type  handle_;
+    char_type*            s_;
+    std::streamsize       n_;
+    Handler               handler_;
+};
+
+template<typename T, typename Handler>
+class async_write_op {
+public:
+    typedef typename char_type_of<T>::type char_type;
+    async_write_op( reactor& r, T& t, reactor::handle_type h,
+                    const char_type* s, std::streamsize n, Handler handler )
+        : reactor_(&r), t_(&t), handle_(h), s_(s), n_(n), total_(0),
+          handler_(handler)
+        { }
+    void operator()(const boost::system::error_code& e)
+    {
+        if (e) {
+            handler_(e, total_);
+            return;
+        }
+        boost::system::error_code ec;
+        while (total_ < n_) {
+            std::streamsize amt =
+                async_write_some(*t_, s_ + total_, n_ - total_, ec);
+            total_ += amt;
+            if (ec)
+                break;
+            if (amt == 0) {
+                reactor_->async_wait(handle_, reactor::wait_write, *this);
+                return;
+            }
+        }
+        handler_(ec, total_);
+    }
+private:
+    reactor*              reactor_;
+    T*                    t_;
+    reactor::handle_type  handle_;
+    const char_type*      s_;
+    std::streamsize       n_;
+    std::streamsize       total_;
+    Handler               handler_;
+};
+
+template<typename T, typename Handler>
+class async_flush_op {
+public:
+    async_flush_op( reactor& r, T& t, reactor::handle_type h,
+                    Handler handler )
+        : reactor_(&r), t_(&t), handle_(h), handler_(handler)
+        { }
+    void operator()(const boost::system::error_code& e)
+    {
+        if (e) {
+            handler_(e, 0);
+            return;
+        }
+        boost::system::error_code ec;
+        if (async_flush_some(*t_, ec) || ec)
+            handler_(ec, 0);
+        else
+            reactor_->async_wait(handle_, reactor::wait_write, *this);
+    }
+private:
+    reactor*              reactor_;
+    T*                    t_;
+    reactor::handle_type  handle_;
+    Handler               handler_;
+};
+
+} // End namespace detail.
+
+//------------------Definition of async_read----------------------------------//
+
+template<typename T, typename Handler>
+void async_read( reactor& r, T& t, reactor::handle_type h,
+                 typename char_type_of<T>::type* s, std::streamsize n,
+                 Handler handler )
+{ r.post(detail::async_read_op<T, Handler>(r, t, h, s, n, handler)); }
+
+template<typename T, typename Handler>
+void async_read( reactor& r, T& t, typename char_type_of<T>::type* s,
+                 std::streamsize n, Handler handler )
+{ iostreams::async_read(r, t, detail::async_handle(t), s, n, handler); }
+
+//------------------Definition of async_write---------------------------------//
+
+template<typename T, typename Handler>
+void async_write( reactor& r, T& t, reactor::handle_type h,
+                  const typename char_type_of<T>::type* s, std::streamsize n,
+                  Handler handler )
+{ r.post(detail::async_write_op<T, Handler>(r, t, h, s, n, handler)); }
+
+template<typename T, typename Handler>
+void async_write( reactor& r, T& t, const typename char_type_of<T>::type* s,
+                  std::streamsize n, Handler handler )
+{ iostreams::async_write(r, t, detail::async_handle(t), s, n, handler); }
+
+//------------------Definition of async_flush---------------------------------//
+
+template<typename T, typename Handler>
+void async_flush(reactor& r, T& t, reactor::handle_type h, Handler handler)
+{ r.post(detail::async_flush_op<T, Handler>(r, t, h, handler)); }
+
+template<typename T, typename Handler>
+void async_flush(reactor& r, T& t, Handler handler)
+{ iostreams::async_flush(r, t, detail::async_handle(t), handler); }
+
+//------------------Definition of awaitable operations------------------------//
+
+#ifdef BOOST_IOSTREAMS_HAS_COROUTINES
+
+namespace detail {
+
+// Base class of the awaitables returned by async_read, async_write and
+// async_flush; Derived::start(handler) initiates the operation
+template<typename Derived>
+class async_awaiter {
+public:
+    async_awaiter() : result_(0) { }
+    bool await_ready() const { return false; }
+    void await_suspend(std::coroutine_handle<> h)
+    { static_cast<Derived*>(this)->start(resumer(this, h)); }
+    std::streamsize await_resume()
+    {
+        if (ec_)
+            boost::throw_exception(boost::system::system_error(ec_));
+        return result_;
+    }
+protected:
+    struct resumer {
+        resumer(async_awaiter* self, std::coroutine_handle<> h)
+            : self_(self), h_(h)
+            { }
+        void operator()( const boost::system::error_code& ec,
+                         std::streamsize n ) const
+        {
+            self_->ec_ = ec;
+            self_->result_ = n;
+            h_.resume();
+        }
+        async_awaiter*           self_;
+        std::coroutine_handle<>  h_;
+    };
+private:
+    boost::system::error_code  ec_;
+    std::streamsize            result_;
+};
+
+template<typename T>
+class async_read_awaiter
+    : public async_awaiter< async_read_awaiter<T> >
+{
+public:
+    typedef typename char_type_of<T>::type char_type;
+    async_read_awaiter( reactor& r, T& t, reactor::handle_type h,
+                        char_type* s, std::streamsize n )
+        : reactor_(&r), t_(&t), handle_(h), s_(s), n_(n)
+        { }
+    template<typename Handler>
+    void start(Handler handler)
+    { iostreams::async_read(*reactor_, *t_, handle_, s_, n_, handler); }
+private:
+    reactor*              reactor_;
+    T*                    t_;
+    reactor::handle_type  handle_;
+    char_type*            s_;
+    std::streamsize       n_;
+};
+
+template<typename T>
+class async_write_awaiter
+    : public async_awaiter< async_write_awaiter<T> >
+{
+public:
+    typedef typename char_type_of<T>::type char_type;
+    async_write_awaiter( reactor& r, T& t, reactor::handle_type h,
+                         const char_type* s, std::streamsize n )
+        : reactor_(&r), t_(&t), handle_(h), s_(s), n_(n)
+        { }
+    template<typename Handler>
+    void start(Handler handler)
+    { iostreams::async_write(*reactor_, *t_, handle_, s_, n_, handler); }
+private:
+    reactor*              reactor_;
+    T*                    t_;
+    reactor::handle_type  handle_;
+    const char_type*      s_;
+    std::streamsize       n_;
+};
+
+template<typename T>
+class async_flush_awaiter
+    : public async_awaiter< async_flush_awaiter<T> >
+{
+public:
+    async_flush_awaiter(reactor& r, T& t, reactor::handle_type h)
+        : reactor_(&r), t_(&t), handle_(h)
+        { }
+    template<typename Handler>
+    void start(Handler handler)
+    { iostreams::async_flush(*reactor_, *t_, handle_, handler); }
+private:
+    reactor*              reactor_;
+    T*                    t_;
+    reactor::handle_type  handle_;
+};
+
+} // End namespace detail.
+
+template<typename T>
+detail::async_read_awaiter<T>
+async_read( reactor& r, T& t, reactor::handle_type h,
+            typename char_type_of<T>::type* s, std::streamsize n )
+{ return detail::async_read_awaiter<T>(r, t, h, s, n); }
+
+template<typename T>
+detail::async_read_awaiter<T>
+async_read( reactor& r, T& t, typename char_type_of<T>::type* s,
+            std::streamsize n )
+{ return detail::async_read_awaiter<T>(r, t, detail::async_handle(t), s, n); }
+
+template<typename T>
+detail::async_write_awaiter<T>
+async_write( reactor& r, T& t, reactor::handle_type h,
+             const typename char_type_of<T>::type* s, std::streamsize n )
+{ return detail::async_write_awaiter<T>(r, t, h, s, n); }
+
+template<typename T>
+detail::async_write_awaiter<T>
+async_write( reactor& r, T& t, const typename char_type_of<T>::type* s,
+             std::streamsize n )
+{ return detail::async_write_awaiter<T>(r, t, detail::async_handle(t), s, n); }
+
+template<typename T>
+detail::async_flush_awaiter<T>
+async_flush(reactor& r, T& t, reactor::handle_type h)
+{ return detail::async_flush_awaiter<T>(r, t, h); }
+
+template<typename T>
+detail::async_flush_awaiter<T> async_flush(reactor& r, T& t)
+{ return detail::async_flush_awaiter<T>(r, t, detail::async_handle(t)); }
+
+#endif // #ifdef BOOST_IOSTREAMS_HAS_COROUTINES
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/iostreams/detail/config/enable_warnings.hpp>
+
+#endif // #ifndef BOOST_IOSTREAMS_ASYNC_HPP_INCLUDED
@@ -61,6 +61,8 @@ struct localizable_tag : virtual any_tag { };
 struct optimally_buffered_tag : virtual any_tag { };
 struct direct_tag : virtual any_tag { };          // Devices.
 struct multichar_tag : virtual any_tag { };       // Filters.
+struct error_code_tag : virtual any_tag { };      // Devices and filters.
+struct segmented_tag : virtual any_tag { };       // Sources.
 
 struct source_tag : device_tag, input { };
 struct sink_tag : device_tag, output { };
@@ -30,6 +30,7 @@
 #include <boost/iostreams/detail/streambuf.hpp> // pubsync.
 #include <boost/iostreams/detail/wrap_unwrap.hpp>
 #include <boost/iostreams/device/null.hpp>
+#include <boost/iostreams/memory_budget.hpp>
 #include <boost/iostreams/positioning.hpp>
 #include <boost/iostreams/traits.hpp>           // is_filter.
 #include <boost/iostreams/stream_buffer.hpp>
@@ -165,6 +166,16 @@ public:
     void set_pback_size(std::streamsize n) 
         { pimpl_->pback_size_ = n; }
 
+    //----------Memory accounting---------------------------------------------//
+
+    // Sets the budget which is current while links are added to this chain,
+    // so that allocations made by an Alloc of type budget_allocator are 
+    // charged to it. Does not affect links already added. Pass a null pointer
+    // to stop installing a budget.
+    void set_budget(memory_budget* budget) 
+        { pimpl_->budget_ = budget; }
+    memory_budget* budget() const { return pimpl_->budget_; }
+
     //----------Device interface----------------------------------------------//
 
     std::streamsize read(char_type* s, std::streamsize n);
@@ -228,6 +239,11 @@ public:
     void set_auto_close(bool close);
     bool sync() { return front().BOOST_IOSTREAMS_PUBSYNC() != -1; }
     bool strict_sync();
+
+    // Returns true if characters written to this chain are held in the
+    // buffers of its links because a filter or device would block; call
+    // sync() to pass them on.
+    bool output_pending() const;
 private:
     template<typename T>
     void push_impl(const T& t, std::streamsize buffer_size = -1, 
@@ -253,8 +269,16 @@ private:
             pback_size != -1 ?
                 pback_size :
                 pimpl_->pback_size_;
+        memory_budget::scope budget_scope(pimpl_->budget_);
         std::auto_ptr<streambuf_t>
             buf(new streambuf_t(t, buffer_size, pback_size));
+        if ( pimpl_->budget_ && 
+             pimpl_->budget_->policy() == memory_budget::fail_push &&
+             pimpl_->budget_->exceeded() )
+        {
+            buf->set_auto_close(false);
+            boost::throw_exception(memory_budget_exceeded());
+        }
         list().push_back(buf.get());
         buf.release();
         if (is_device<component_type>::value) {
@@ -309,7 +333,8 @@ private:
 
     struct chain_impl {
         chain_impl()
-            : client_(0), device_buffer_size_(default_device_buffer_size),
+            : client_(0), budget_(0),
+              device_buffer_size_(default_device_buffer_size),
               filter_buffer_size_(default_filter_buffer_size),
               pback_size_(default_pback_buffer_size),
               flags_(f_auto_close)
@@ -372,6 +397,7 @@ private:
             }
         list_type        links_;
         client_type*     client_;
+        memory_budget*   budget_;
         std::streamsize  device_buffer_size_,
                          filter_buffer_size_,
                          pback_size_;
@@ -480,11 +506,16 @@ public:
     bool auto_close() const { return chain_->auto_close(); }
     void set_auto_close(bool close) { chain_->set_auto_close(close); }
     bool strict_sync() { return chain_->strict_sync(); }
+    bool output_pending() const { return chain_->output_pending(); }
     void set_device_buffer_size(std::streamsize n)
         { chain_->set_device_buffer_size(n); }
     void set_filter_buffer_size(std::streamsize n)
         { chain_->set_filter_buffer_size(n); }
     void set_pback_size(std::streamsize n) { chain_->set_pback_size(n); }
+    void set_budget(memory_budget* budget)
+        { chain_->set_budget(budget); }
+    memory_budget* budget() const 
+        { return chain_->budget(); }
     BOOST_IOSTREAMS_DEFINE_PUSH(push, mode, char_type, push_impl)
     void pop() { chain_->pop(); }
     bool empty() const { return chain_->empty(); }
@@ -574,6 +605,21 @@ bool chain_base<Self, Ch, Tr, Alloc, Mode>::strict_sync()
     return result;
 }
 
+template<typename Self, typename Ch, typename Tr, typename Alloc, typename Mode>
+bool chain_base<Self, Ch, Tr, Alloc, Mode>::output_pending() const
+{
+    typedef typename list_type::const_iterator iterator;
+    for ( iterator first = list().begin(),
+                   last = list().end();
+          first != last;
+          ++first )
+    {
+        if ((*first)->output_pending())
+            return true;
+    }
+    return false;
+}
+
 template<typename Self, typename Ch, typename Tr, typename Alloc, typename Mode>
 void chain_base<Self, Ch, Tr, Alloc, Mode>::pop()
 {
@@ -0,0 +1,196 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definition of the class template chain_prototype, which
+// records a sequence of filters once and creates filtering streams consisting
+// of copies of those filters followed by a given device. A stream is returned
+// to the prototype when the last shared_ptr referring to it is destroyed; its
+// device is then popped, which closes the filters, and the stream is reused
+// by a later call to open(), so that the stream buffers, their buffers and
+// the filters themselves, together with any state they keep across close(),
+// such as an initialized z_stream, are allocated only once. Since copies of
+// the filters based on symmetric_filter, such as gzip_decompressor, share
+// their state, such filters are obtained from a factory when several
+// instances may be in use at a time:
+//
+//     gzip_decompressor make_gzip() { return gzip_decompressor(); }
+//
+//     chain_prototype<filtering_istream> proto;
+//     proto.push_factory(&make_gzip);
+//     proto.push(grep_filter(boost::regex("^ERROR")));
+//     ...
+//     chain_prototype<filtering_istream>::stream_ptr
+//         in = proto.open(array_source(data, size));
+//     std::getline(*in, line);
+
+#ifndef BOOST_IOSTREAMS_CHAIN_PROTOTYPE_HPP_INCLUDED
+#define BOOST_IOSTREAMS_CHAIN_PROTOTYPE_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <cstddef>                          // size_t.
+#include <memory>                           // auto_ptr.
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/iostreams/detail/ios.hpp>   // streamsize.
+#include <boost/iostreams/traits.hpp>       // is_filter, is_streambuf.
+#include <boost/mpl/bool.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/utility/result_of.hpp>
+
+namespace boost { namespace iostreams {
+
+//
+// Template name: chain_prototype.
+// Description: Creates instances of a filtering stream or filtering stream
+//      buffer consisting of a sequence of filters followed by a device,
+//      recycling instances which are no longer in use. Each new instance
+//      contains copies of the filters passed to push() and filters obtained
+//      from the factories passed to push_factory(). Copies of a prototype
+//      share filters and recycled instances. A prototype and the instances
+//      it creates must not be used concurrently from different threads.
+// Template parameters:
+//      Stream - A specialization of filtering_stream or filtering_streambuf.
+//
+template<typename Stream>
+class chain_prototype {
+public:
+    typedef Stream                    stream_type;
+    typedef shared_ptr<stream_type>   stream_ptr;
+
+    chain_prototype() : pimpl_(new impl) { }
+
+    // Appends a filter to the sequence; instances already created are not
+    // affected.
+    template<typename T>
+    void push( const T& t, std::streamsize buffer_size = -1,
+               std::streamsize pback_size = -1 )
+    {
+        BOOST_STATIC_ASSERT(is_filter<T>::value);
+        pimpl_->clear();
+        pimpl_->links_.push_back(
+            boost::bind( &chain_prototype::push_link<T>, _1, t,
+                         buffer_size, pback_size )
+        );
+    }
+
+    // Appends a filter obtained by calling the given function object, with
+    // no arguments, for each new instance.
+    template<typename Factory>
+    void push_factory( const Factory& make, std::streamsize buffer_size = -1,
+                       std::streamsize pback_size = -1 )
+    {
+        typedef typename result_of<Factory ()>::type filter_type;
+        BOOST_STATIC_ASSERT(is_filter<filter_type>::value);
+        pimpl_->clear();
+        pimpl_->links_.push_back(
+            boost::bind( &chain_prototype::make_link<Factory>, _1, make,
+                         buffer_size, pback_size )
+        );
+    }
+
+    // Returns an instance consisting of the filters followed by the given
+    // device, reusing an idle instance if there is one.
+    template<typename Device>
+    stream_ptr open( const Device& dev, std::streamsize buffer_size = -1,
+                     std::streamsize pback_size = -1 )
+    {
+        std::auto_ptr<stream_type> s(pimpl_->acquire());
+        s->push(dev, buffer_size, pback_size);
+        return stream_ptr(s.release(), recycler(pimpl_));
+    }
+
+    // Returns the number of filters.
+    std::size_t size() const { return pimpl_->links_.size(); }
+
+    // Returns the number of idle instances.
+    std::size_t idle() const { return pimpl_->idle_.size(); }
+
+    // Destroys the idle instances.
+    void clear() { pimpl_->clear(); }
+private:
+    template<typename T>
+    static void push_link( stream_type& s, const T& t,
+                           std::streamsize buffer_size,
+                           std::streamsize pback_size )
+    { s.push(t, buffer_size, pback_size); }
+
+    template<typename Factory>
+    static void make_link( stream_type& s, const Factory& make,
+                           std::streamsize buffer_size,
+                           std::streamsize pback_size )
+    { s.push(make(), buffer_size, pback_size); }
+
+    struct impl : private noncopyable {
+        ~impl() { clear(); }
+
+        // Returns an idle instance, or a new instance containing the filters
+        stream_type* acquire()
+        {
+            if (!idle_.empty()) {
+                stream_type* s = idle_.back();
+                idle_.pop_back();
+                return s;
+            }
+            std::auto_ptr<stream_type> s(new stream_type);
+            for (std::size_t z = 0, n = links_.size(); z < n; ++z)
+                links_[z](*s);
+            return s.release();
+        }
+
+        // Pops the device of the given instance, closing its filters, and
+        // makes the instance available for reuse, provided that it still
+        // contains exactly the filters of the prototype
+        void recycle(stream_type* s)
+        {
+            std::auto_ptr<stream_type> ptr(s);
+            try {
+                if ( !s->is_complete() || !s->auto_close() ||
+                     s->size() != links_.size() + 1 )
+                {
+                    return;
+                }
+                s->pop();
+                clear_state(*s, is_streambuf<stream_type>());
+                idle_.push_back(s);
+                ptr.release();
+            } catch (...) { }
+        }
+
+        void clear()
+        {
+            for (std::size_t z = 0, n = idle_.size(); z < n; ++z)
+                delete idle_[z];
+            idle_.clear();
+        }
+
+        // Resets the state flags of a stream
+        static void clear_state(stream_type& s, mpl::false_) { s.clear(); }
+        static void clear_state(stream_type&, mpl::true_) { }
+
+        std::vector< function<void (stream_type&)> >  links_;
+        std::vector<stream_type*>                      idle_;
+    };
+
+    // Deleter which returns an instance to its prototype
+    struct recycler {
+        explicit recycler(const shared_ptr<impl>& pimpl) : pimpl_(pimpl) { }
+        void operator()(stream_type* s) const { pimpl_->recycle(s); }
+        shared_ptr<impl> pimpl_;
+    };
+
+    shared_ptr<impl> pimpl_;
+};
+
+} } // End namespaces iostreams, boost.
+
+#endif // #ifndef BOOST_IOSTREAMS_CHAIN_PROTOTYPE_HPP_INCLUDED
@@ -23,6 +23,7 @@
 #include <boost/iostreams/detail/enable_if_stream.hpp>
 #include <boost/iostreams/detail/execute.hpp>
 #include <boost/iostreams/detail/functional.hpp>
+#include <boost/iostreams/error_code.hpp>
 #include <boost/iostreams/operations.hpp>
 #include <boost/iostreams/traits.hpp>      // mode_of, is_direct.
 #include <boost/mpl/if.hpp>
@@ -84,7 +85,8 @@ public:
           closable_tag,
           flushable_tag,
           localizable_tag,
-          optimally_buffered_tag
+          optimally_buffered_tag,
+          error_code_tag
         { };
     composite_device(const Filter& flt, param_type dev);
     std::streamsize read(char_type* s, std::streamsize n);
@@ -95,6 +97,22 @@ public:
 
     void close();
     void close(BOOST_IOS::openmode which);
+
+    // Non-throwing versions of the above; see <boost/iostreams/error_code.hpp>
+    std::streamsize read( char_type* s, std::streamsize n, 
+                          boost::system::error_code& ec )
+    { return iostreams::read(filter_, device_, s, n, ec); }
+    std::streamsize write( const char_type* s, std::streamsize n, 
+                           boost::system::error_code& ec )
+    { return iostreams::write(filter_, device_, s, n, ec); }
+    std::streampos seek( stream_offset off, BOOST_IOS::seekdir way,
+                         BOOST_IOS::openmode which, 
+                         boost::system::error_code& ec );
+    std::streampos seek( stream_offset off, BOOST_IOS::seekdir way,
+                         boost::system::error_code& ec )
+    { return seek(off, way, BOOST_IOS::in | BOOST_IOS::out, ec); }
+    void close(boost::system::error_code& ec);
+    void close(BOOST_IOS::openmode which, boost::system::error_code& ec);
     bool flush();
     std::streamsize optimal_buffer_size() const;
 
@@ -472,6 +490,69 @@ void composite_device<Filter, Device, Mode>::close(BOOST_IOS::openmode which)
     }
 }
 
+template<typename Filter, typename Device, typename Mode>
+std::streampos composite_device<Filter, Device, Mode>::seek
+    ( stream_offset off, BOOST_IOS::seekdir way, BOOST_IOS::openmode which,
+      boost::system::error_code& ec )
+{ 
+    ec.clear();
+    try {
+        return iostreams::seek(filter_, device_, off, way, which); 
+    } catch (const std::exception&) {
+        detail::set_error_code(ec);
+        return offset_to_position(-1);
+    }
+}
+
+template<typename Filter, typename Device, typename Mode>
+void composite_device<Filter, Device, Mode>::close
+    (boost::system::error_code& ec)
+{
+    BOOST_STATIC_ASSERT((!is_convertible<Mode, two_sequence>::value));
+
+    // Close input sequences in reverse order and output sequences 
+    // in forward order, recording the first error
+    boost::system::error_code next;
+    ec.clear();
+    if (!is_convertible<filter_mode, dual_use>::value) {
+        iostreams::close(device_, BOOST_IOS::in, ec);
+        iostreams::close(filter_, device_, BOOST_IOS::in, next);
+        detail::keep_first_error(ec, next);
+        iostreams::close(filter_, device_, BOOST_IOS::out, next);
+        detail::keep_first_error(ec, next);
+        iostreams::close(device_, BOOST_IOS::out, next);
+        detail::keep_first_error(ec, next);
+    } else if (is_convertible<device_mode, input>::value) {
+        iostreams::close(device_, BOOST_IOS::in, ec);
+        iostreams::close(filter_, device_, BOOST_IOS::in, next);
+        detail::keep_first_error(ec, next);
+    } else {
+        iostreams::close(filter_, device_, BOOST_IOS::out, ec);
+        iostreams::close(device_, BOOST_IOS::out, next);
+        detail::keep_first_error(ec, next);
+    }
+}
+
+template<typename Filter, typename Device, typename Mode>
+void composite_device<Filter, Device, Mode>::close
+    (BOOST_IOS::openmode which, boost::system::error_code& ec)
+{
+    BOOST_STATIC_ASSERT((is_convertible<Mode, two_sequence>::value));
+
+    boost::system::error_code next;
+    ec.clear();
+    if (which == BOOST_IOS::in) {
+        iostreams::close(device_, BOOST_IOS::in, ec);
+        iostreams::close(filter_, device_, BOOST_IOS::in, next);
+        detail::keep_first_error(ec, next);
+    }
+    if (which == BOOST_IOS::out) {
+        iostreams::close(filter_, device_, BOOST_IOS::out, ec);
+        iostreams::close(device_, BOOST_IOS::out, next);
+        detail::keep_first_error(ec, next);
+    }
+}
+
 template<typename Filter, typename Device, typename Mode>
 bool composite_device<Filter, Device, Mode>::flush()
 {
@@ -7,7 +7,8 @@
 
 // Contains: The function template copy, which reads data from a Source 
 // and writes it to a Sink until the end of the sequence is reached, returning 
-// the number of characters transfered.
+// the number of characters transfered. Overloads taking an error_code report
+// errors without throwing; see <boost/iostreams/error_code.hpp>.
 
 // The implementation is complicated by the need to handle smart adapters
 // and direct devices.
@@ -30,14 +31,17 @@
 #include <boost/iostreams/detail/adapter/non_blocking_adapter.hpp>        
 #include <boost/iostreams/detail/buffer.hpp>
 #include <boost/iostreams/detail/enable_if_stream.hpp>  
+#include <boost/iostreams/detail/error.hpp>
 #include <boost/iostreams/detail/execute.hpp>
 #include <boost/iostreams/detail/functional.hpp>
 #include <boost/iostreams/detail/ios.hpp>   // failure, streamsize.                   
 #include <boost/iostreams/detail/resolve.hpp>                   
 #include <boost/iostreams/detail/wrap_unwrap.hpp>
+#include <boost/iostreams/error_code.hpp>
 #include <boost/iostreams/operations.hpp>  // read, write, close.
 #include <boost/iostreams/pipeline.hpp>
 #include <boost/static_assert.hpp>  
+#include <boost/throw_exception.hpp>
 #include <boost/type_traits/is_same.hpp> 
 
 namespace boost { namespace iostreams {
@@ -49,10 +53,11 @@ namespace detail {
     // models Direct (see 
     // http://www.boost.org/libs/iostreams/doc/index.html?path=4.1.1.4)
 
-// Copy from a direct source to a direct sink
+// Copy from a direct source to a direct sink, a block at a time; the sink
+// must be large enough to hold the source's contents
 template<typename Source, typename Sink>
 std::streamsize copy_impl( Source& src, Sink& snk, 
-                           std::streamsize /* buffer_size */,
+                           std::streamsize buffer_size,
                            mpl::true_, mpl::true_ )
 {   
     using namespace std;
@@ -60,11 +65,14 @@ std::streamsize copy_impl( Source& src, Sink& snk,
     typedef std::pair<char_type*, char_type*>    pair_type;
     pair_type p1 = iostreams::input_sequence(src);
     pair_type p2 = iostreams::output_sequence(snk);
-    std::streamsize total = 
-        static_cast<std::streamsize>(
-            (std::min)(p1.second - p1.first, p2.second - p2.first)
-        );
-    std::copy(p1.first, p1.first + total, p2.first);
+    std::streamsize size = static_cast<std::streamsize>(p1.second - p1.first);
+    if (size > p2.second - p2.first)
+        boost::throw_exception(write_area_exhausted());
+    std::streamsize total, amt;
+    for (total = 0; total < size; total += amt) {
+        amt = (std::min)(buffer_size, size - total);
+        std::copy(p1.first + total, p1.first + total + amt, p2.first + total);
+    }
     return total;
 }
 
@@ -89,7 +97,9 @@ std::streamsize copy_impl( Source& src, Sink& snk,
     return total;
 }
 
-// Copy from an indirect source to a direct sink
+// Copy from an indirect source to a direct sink, reading directly into the
+// sink's output sequence; the sink must be large enough to hold the source's
+// contents
 template<typename Source, typename Sink>
 std::streamsize copy_impl( Source& src, Sink& snk, 
                            std::streamsize buffer_size,
@@ -97,22 +107,24 @@ std::streamsize copy_impl( Source& src, Sink& snk,
 {
     typedef typename char_type_of<Source>::type  char_type;
     typedef std::pair<char_type*, char_type*>    pair_type;
-    detail::basic_buffer<char_type>  buf(buffer_size);
-    pair_type                        p = snk.output_sequence();
-    std::streamsize                  total = 0;
-    std::ptrdiff_t                   capacity = p.second - p.first;
+    pair_type        p = iostreams::output_sequence(snk);
+    std::streamsize  capacity =
+        static_cast<std::streamsize>(p.second - p.first);
+    std::streamsize  total = 0;
     while (true) {
-        std::streamsize amt = 
-            iostreams::read(
-                src, 
-                buf.data(),
-                buffer_size < capacity - total ?
-                    buffer_size :
-                    static_cast<std::streamsize>(capacity - total)
-            );
+        std::streamsize amt;
+        if (total == capacity) {
+            char_type c;
+            if ((amt = iostreams::read(src, &c, 1)) == -1)
+                break;
+            if (amt != 0)
+                boost::throw_exception(write_area_exhausted());
+            continue;
+        }
+        amt = iostreams::read( src, p.first + total,
+                               (std::min)(buffer_size, capacity - total) );
         if (amt == -1)
             break;
-        std::copy(buf.data(), buf.data() + amt, p.first + total);
         total += amt;
     }
     return total;
@@ -145,7 +157,7 @@ std::streamsize copy_impl( Source& src, Sink& snk,
     // overload of copy_impl(), below
 
 // Function object that delegates to one of the above four 
-// overloads of compl_impl()
+// overloads of compl_impl(), or to a segmented source
 template<typename Source, typename Sink>
 class copy_operation {
 public:
@@ -153,12 +165,18 @@ public:
     copy_operation(Source& src, Sink& snk, std::streamsize buffer_size)
         : src_(src), snk_(snk), buffer_size_(buffer_size)
         { }
-    std::streamsize operator()() 
+    std::streamsize operator()() { return apply(is_segmented<Source>()); }
+private:
+
+    // A segmented source writes its segments to the sink itself (see
+    // <boost/iostreams/device/segmented_buffer.hpp>)
+    std::streamsize apply(mpl::true_)
+    { return detail::unwrap(src_).write_segments(snk_); }
+    std::streamsize apply(mpl::false_)
     {
         return copy_impl( src_, snk_, buffer_size_, 
                           is_direct<Source>(), is_direct<Sink>() );
     }
-private:
     copy_operation& operator=(const copy_operation&);
     Source&          src_;
     Sink&            snk_;
@@ -183,6 +201,121 @@ std::streamsize copy_impl(Source src, Sink snk, std::streamsize buffer_size)
            );
 }
 
+    // The following overloads of copy_impl() report errors through an 
+    // error_code instead of throwing
+
+// Copy from a direct source to a direct sink
+template<typename Source, typename Sink>
+std::streamsize copy_impl( Source& src, Sink& snk, 
+                           std::streamsize buffer_size,
+                           boost::system::error_code& ec,
+                           mpl::true_, mpl::true_ )
+{   
+    typedef typename char_type_of<Source>::type  char_type;
+    typedef std::pair<char_type*, char_type*>    pair_type;
+    pair_type p1 = iostreams::input_sequence(src);
+    pair_type p2 = iostreams::output_sequence(snk);
+    if (p1.second - p1.first > p2.second - p2.first) {
+        ec = errors::make_error_code(errors::bad_write);
+        return 0;
+    }
+    return copy_impl(src, snk, buffer_size, mpl::true_(), mpl::true_());
+}
+
+// Copy from a direct source to an indirect sink
+template<typename Source, typename Sink>
+std::streamsize copy_impl( Source& src, Sink& snk, 
+                           std::streamsize /* buffer_size */,
+                           boost::system::error_code& ec,
+                           mpl::true_, mpl::false_ )
+{
+    typedef typename char_type_of<Source>::type  char_type;
+    typedef std::pair<char_type*, char_type*>    pair_type;
+    pair_type p = iostreams::input_sequence(src);
+    std::streamsize size, total;
+    for ( total = 0, size = static_cast<std::streamsize>(p.second - p.first);
+          total < size && !ec; )
+    {
+        total += iostreams::write(snk, p.first + total, size - total, ec); 
+    }
+    return total;
+}
+
+// Copy from an indirect source to a direct sink
+template<typename Source, typename Sink>
+std::streamsize copy_impl( Source& src, Sink& snk, 
+                           std::streamsize buffer_size,
+                           boost::system::error_code& ec,
+                           mpl::false_, mpl::true_ )
+{
+    typedef typename char_type_of<Source>::type  char_type;
+    typedef std::pair<char_type*, char_type*>    pair_type;
+    pair_type        p = iostreams::output_sequence(snk);
+    std::streamsize  capacity =
+        static_cast<std::streamsize>(p.second - p.first);
+    std::streamsize  total = 0;
+    while (!ec) {
+        std::streamsize amt;
+        if (total == capacity) {
+            char_type c;
+            if ((amt = iostreams::read(src, &c, 1, ec)) == -1)
+                break;
+            if (amt != 0)
+                ec = errors::make_error_code(errors::bad_write);
+            continue;
+        }
+        amt = iostreams::read( src, p.first + total,
+                               (std::min)(buffer_size, capacity - total), ec );
+        if (amt == -1)
+            break;
+        total += amt;
+    }
+    return total;
+}
+
+// Copy from an indirect source to an indirect sink
+template<typename Source, typename Sink>
+std::streamsize copy_impl( Source& src, Sink& snk, 
+                           std::streamsize buffer_size,
+                           boost::system::error_code& ec,
+                           mpl::false_, mpl::false_ )
+{ 
+    typedef typename char_type_of<Source>::type char_type;
+    detail::basic_buffer<char_type>  buf(buffer_size);
+    std::streamsize                  total = 0;
+    std::streamsize                  amt;
+    while ((amt = iostreams::read(src, buf.data(), buffer_size, ec)) != -1) {
+        for (std::streamsize off = 0; off < amt && !ec; )
+            off += iostreams::write(snk, buf.data() + off, amt - off, ec);
+        if (ec)
+            break;
+        total += amt;
+    }
+    return total;
+}
+
+// Overload of copy_impl() taking an error_code. Closes both devices, even if 
+// an error occurs, and stores the first error encountered in ec.
+template<typename Source, typename Sink>
+std::streamsize copy_impl( Source src, Sink snk, std::streamsize buffer_size,
+                           boost::system::error_code& ec )
+{
+    using namespace std;
+    typedef typename char_type_of<Source>::type  src_char;
+    typedef typename char_type_of<Sink>::type    snk_char;
+    BOOST_STATIC_ASSERT((is_same<src_char, snk_char>::value));
+    ec.clear();
+    std::streamsize total = 
+        copy_impl( src, snk, buffer_size, ec, 
+                   is_direct<Source>(), is_direct<Sink>() );
+    boost::system::error_code close_ec;
+    iostreams::close(src, BOOST_IOS::in | BOOST_IOS::out, close_ec);
+    detail::keep_first_error(ec, close_ec);
+    iostreams::close(snk, BOOST_IOS::in | BOOST_IOS::out, close_ec);
+    detail::keep_first_error(ec, close_ec);
+    return total;
+}
+
 } // End namespace detail.
                     
 //------------------Definition of copy----------------------------------------//
@@ -247,6 +380,69 @@ copy( Source& src, Sink& snk,
 
 #endif // #if !BOOST_WORKAROUND(BOOST_MSVC, <= 1300) //-----------------------//
 
+//------------------Definition of copy with error_code------------------------//
+
+// Overload of copy() for the case where neither the source nor the sink is
+// a standard stream or stream buffer
+template<typename Source, typename Sink>
+std::streamsize
+copy( const Source& src, const Sink& snk, boost::system::error_code& ec,
+      std::streamsize buffer_size = default_device_buffer_size
+      BOOST_IOSTREAMS_DISABLE_IF_STREAM(Source)
+      BOOST_IOSTREAMS_DISABLE_IF_STREAM(Sink) )
+{ 
+    typedef typename char_type_of<Source>::type char_type;
+    return detail::copy_impl( detail::resolve<input, char_type>(src), 
+                              detail::resolve<output, char_type>(snk), 
+                              buffer_size, ec ); 
+}
+
+#if !BOOST_WORKAROUND(BOOST_MSVC, <= 1300) //---------------------------------//
+
+// Overload of copy() for the case where the source, but not the sink, is
+// a standard stream or stream buffer
+template<typename Source, typename Sink>
+std::streamsize
+copy( Source& src, const Sink& snk, boost::system::error_code& ec,
+      std::streamsize buffer_size = default_device_buffer_size
+      BOOST_IOSTREAMS_ENABLE_IF_STREAM(Source)
+      BOOST_IOSTREAMS_DISABLE_IF_STREAM(Sink) ) 
+{ 
+    typedef typename char_type_of<Source>::type char_type;
+    return detail::copy_impl( detail::wrap(src), 
+                              detail::resolve<output, char_type>(snk), 
+                              buffer_size, ec );
+}
+
+// Overload of copy() for the case where the sink, but not the source, is
+// a standard stream or stream buffer
+template<typename Source, typename Sink>
+std::streamsize
+copy( const Source& src, Sink& snk, boost::system::error_code& ec,
+      std::streamsize buffer_size = default_device_buffer_size
+      BOOST_IOSTREAMS_DISABLE_IF_STREAM(Source)
+      BOOST_IOSTREAMS_ENABLE_IF_STREAM(Sink) ) 
+{ 
+    typedef typename char_type_of<Source>::type char_type;
+    return detail::copy_impl( detail::resolve<input, char_type>(src), 
+                              detail::wrap(snk), buffer_size, ec );
+}
+
+// Overload of copy() for the case where both the source and the sink are
+// standard streams or stream buffers
+template<typename Source, typename Sink>
+std::streamsize
+copy( Source& src, Sink& snk, boost::system::error_code& ec,
+      std::streamsize buffer_size = default_device_buffer_size
+      BOOST_IOSTREAMS_ENABLE_IF_STREAM(Source)
+      BOOST_IOSTREAMS_ENABLE_IF_STREAM(Sink) ) 
+{ 
+    return detail::copy_impl( detail::wrap(src), detail::wrap(snk), 
+                              buffer_size, ec );
+}
+
+#endif // #if !BOOST_WORKAROUND(BOOST_MSVC, <= 1300) //-----------------------//
+
 } } // End namespaces iostreams, boost.
 
 #endif // #ifndef BOOST_IOSTREAMS_COPY_HPP_INCLUDED
@@ -25,6 +25,24 @@
 
 namespace boost { namespace iostreams { namespace detail {
 
+//----------------Buffer sizing-----------------------------------------------//
+
+// Returns the number of characters which should be allocated with the given
+// allocator when a buffer of n characters has been requested. Allocators which
+// charge a memory budget, such as budget_allocator, provide an overload which
+// may return a smaller value, but never less than min.
+template<typename Alloc>
+inline std::streamsize budgeted_buffer_size
+    (const Alloc&, std::streamsize n, std::streamsize /* min */)
+{ return n; }
+
+// Dispatches to the appropriate overload of budgeted_buffer_size(); overloads
+// for particular allocators are found by argument dependent lookup.
+template<typename Alloc>
+inline std::streamsize adjust_buffer_size
+    (const Alloc& alloc, std::streamsize n, std::streamsize min)
+{ return budgeted_buffer_size(alloc, n, min); }
+
 //----------------Buffers-----------------------------------------------------//
 
 //
@@ -57,6 +75,7 @@ private:
     // Disallow copying and assignment.
     basic_buffer(const basic_buffer&);
     basic_buffer& operator=(const basic_buffer&);
+    allocator_type   alloc_;
     Ch*              buf_;
     std::streamsize  size_;
 };
@@ -142,7 +161,7 @@ basic_buffer<Ch, Alloc>::basic_buffer() : buf_(0), size_(0) { }
 
 template<typename Ch, typename Alloc>
 basic_buffer<Ch, Alloc>::basic_buffer(int buffer_size)
-    : buf_(static_cast<Ch*>(allocator_type().allocate(buffer_size, 0))), 
+    : buf_(static_cast<Ch*>(alloc_.allocate(buffer_size, 0))), 
       size_(buffer_size) // Cast for SunPro 5.3.
     { }
 
@@ -150,7 +169,7 @@ template<typename Ch, typename Alloc>
 inline basic_buffer<Ch, Alloc>::~basic_buffer()
 {
     if (buf_) {
-        allocator_type().deallocate(buf_,
+        alloc_.deallocate(buf_,
             static_cast<BOOST_DEDUCED_TYPENAME Alloc::size_type>(size_));
     }
 }
@@ -160,14 +179,14 @@ inline void basic_buffer<Ch, Alloc>::resize(int buffer_size)
 {
     if (size_ != buffer_size) {
         basic_buffer<Ch, Alloc> temp(buffer_size);
-        std::swap(size_, temp.size_);
-        std::swap(buf_, temp.buf_);
+        swap(temp);
     }
 }
 
 template<typename Ch, typename Alloc>
 void basic_buffer<Ch, Alloc>::swap(basic_buffer& rhs) 
 { 
+    std::swap(alloc_, rhs.alloc_); 
     std::swap(buf_, rhs.buf_); 
     std::swap(size_, rhs.size_); 
 }
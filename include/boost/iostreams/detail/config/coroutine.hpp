@@ -0,0 +1,25 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Defines the macro BOOST_IOSTREAMS_HAS_COROUTINES if the compiler supports
+// C++20 coroutines, unless BOOST_IOSTREAMS_NO_COROUTINES is defined.
+
+#ifndef BOOST_IOSTREAMS_DETAIL_CONFIG_COROUTINE_HPP_INCLUDED
+#define BOOST_IOSTREAMS_DETAIL_CONFIG_COROUTINE_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#if !defined(BOOST_IOSTREAMS_HAS_COROUTINES) && \
+    !defined(BOOST_IOSTREAMS_NO_COROUTINES) && \
+    defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L) \
+    /**/
+# define BOOST_IOSTREAMS_HAS_COROUTINES
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_DETAIL_CONFIG_COROUTINE_HPP_INCLUDED
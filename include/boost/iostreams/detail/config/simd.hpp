@@ -0,0 +1,27 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Defines the macro BOOST_IOSTREAMS_HAS_SSE2 if the library may use SSE2
+// instructions without checking for them at run time, i.e., on x86-64 and
+// when compiling for x86 processors which support them. Defining
+// BOOST_IOSTREAMS_NO_SIMD disables the use of vector instructions.
+
+#ifndef BOOST_IOSTREAMS_DETAIL_CONFIG_SIMD_HPP_INCLUDED
+#define BOOST_IOSTREAMS_DETAIL_CONFIG_SIMD_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#if !defined(BOOST_IOSTREAMS_NO_SIMD)
+# if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define BOOST_IOSTREAMS_HAS_SSE2
+# endif
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_DETAIL_CONFIG_SIMD_HPP_INCLUDED
@@ -0,0 +1,33 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Defines the macro BOOST_IOSTREAMS_THREAD_LOCAL, which expands to a storage
+// class specifier for variables of POD type having one instance per thread.
+
+#ifndef BOOST_IOSTREAMS_DETAIL_CONFIG_THREAD_LOCAL_HPP_INCLUDED
+#define BOOST_IOSTREAMS_DETAIL_CONFIG_THREAD_LOCAL_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <boost/config.hpp> // BOOST_NO_CXX11_THREAD_LOCAL.
+
+#if !defined(BOOST_IOSTREAMS_THREAD_LOCAL)
+# if !defined(BOOST_NO_CXX11_THREAD_LOCAL)
+#  define BOOST_IOSTREAMS_THREAD_LOCAL thread_local
+# elif defined(BOOST_MSVC) || defined(__BORLANDC__)
+#  define BOOST_IOSTREAMS_THREAD_LOCAL __declspec(thread)
+# elif defined(__GNUC__) || defined(__SUNPRO_CC) || defined(__IBMCPP__)
+#  define BOOST_IOSTREAMS_THREAD_LOCAL __thread
+# else
+#  define BOOST_IOSTREAMS_THREAD_LOCAL
+#  define BOOST_IOSTREAMS_NO_THREAD_LOCAL
+# endif
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_DETAIL_CONFIG_THREAD_LOCAL_HPP_INCLUDED
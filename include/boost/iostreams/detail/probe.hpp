@@ -0,0 +1,63 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Defines the macros BOOST_IOSTREAMS_PROBE0, ..., BOOST_IOSTREAMS_PROBE5,
+// which mark static tracepoints in the provider "boost_iostreams".
+//
+// If BOOST_IOSTREAMS_ENABLE_USDT is defined, the macros expand to the USDT
+// probes of <sys/sdt.h>, each of which compiles to a single nop plus an ELF
+// note describing the location of its arguments; tools such as bpftrace,
+// perf and SystemTap can then attach to a running process, e.g.,
+//
+//      bpftrace -e 'usdt:./app:boost_iostreams:underflow_done
+//                   { @bytes[str(arg1)] = hist(arg2); }'
+//
+// Otherwise the macros expand to nothing and their arguments are not
+// evaluated. Probe arguments must be integers or pointers; by convention the
+// first argument identifies the component (the address of the streambuf,
+// filter or device) and, where available, the second is the name of its
+// type as returned by std::type_info::name(). Probes come in pairs named
+// <function>_start and <function>_done, so that latencies can be measured.
+
+#ifndef BOOST_IOSTREAMS_DETAIL_PROBE_HPP_INCLUDED
+#define BOOST_IOSTREAMS_DETAIL_PROBE_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#if defined(BOOST_IOSTREAMS_ENABLE_USDT)
+# include <typeinfo>  // Probe arguments often use typeid.
+# include <sys/sdt.h>
+# define BOOST_IOSTREAMS_PROBE0(name) \
+    DTRACE_PROBE(boost_iostreams, name) \
+    /**/
+# define BOOST_IOSTREAMS_PROBE1(name, a1) \
+    DTRACE_PROBE1(boost_iostreams, name, a1) \
+    /**/
+# define BOOST_IOSTREAMS_PROBE2(name, a1, a2) \
+    DTRACE_PROBE2(boost_iostreams, name, a1, a2) \
+    /**/
+# define BOOST_IOSTREAMS_PROBE3(name, a1, a2, a3) \
+    DTRACE_PROBE3(boost_iostreams, name, a1, a2, a3) \
+    /**/
+# define BOOST_IOSTREAMS_PROBE4(name, a1, a2, a3, a4) \
+    DTRACE_PROBE4(boost_iostreams, name, a1, a2, a3, a4) \
+    /**/
+# define BOOST_IOSTREAMS_PROBE5(name, a1, a2, a3, a4, a5) \
+    DTRACE_PROBE5(boost_iostreams, name, a1, a2, a3, a4, a5) \
+    /**/
+#else
+# define BOOST_IOSTREAMS_PROBE0(name) ((void) 0)
+# define BOOST_IOSTREAMS_PROBE1(name, a1) ((void) 0)
+# define BOOST_IOSTREAMS_PROBE2(name, a1, a2) ((void) 0)
+# define BOOST_IOSTREAMS_PROBE3(name, a1, a2, a3) ((void) 0)
+# define BOOST_IOSTREAMS_PROBE4(name, a1, a2, a3, a4) ((void) 0)
+# define BOOST_IOSTREAMS_PROBE5(name, a1, a2, a3, a4, a5) ((void) 0)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_DETAIL_PROBE_HPP_INCLUDED
@@ -28,6 +28,7 @@
 #include <boost/iostreams/detail/functional.hpp>
 #include <boost/iostreams/detail/ios.hpp>
 #include <boost/iostreams/detail/optional.hpp>
+#include <boost/iostreams/detail/probe.hpp>
 #include <boost/iostreams/detail/push.hpp>
 #include <boost/iostreams/detail/streambuf/linked_streambuf.hpp>
 #include <boost/iostreams/operations.hpp>
@@ -96,6 +97,7 @@ protected:
     // Declared in linked_streambuf.
     void set_next(streambuf_type* next);
     void close_impl(BOOST_IOS::openmode m);
+    bool output_pending() const { return pptr() != pbase(); }
     const std::type_info& component_type() const { return typeid(T); }
     void* component_impl() { return component(); }
 private:
@@ -166,6 +168,18 @@ void indirect_streambuf<T, Tr, Alloc, Mode>::open
         pback_size :
         default_pback_buffer_size;
 
+    // Shrink buffers to fit within the memory budget, if any.
+    if (buffer_size > 1) {
+        std::streamsize pback = 
+            can_read() ? (std::max)(std::streamsize(2), pback_size) : 0;
+        std::streamsize count = 
+            can_read() && can_write() && !shared_buffer() ? 2 : 1;
+        std::streamsize size =
+            adjust_buffer_size( Alloc(), count * buffer_size + pback, 
+                                count + pback );
+        buffer_size = (size - pback) / count;
+    }
+
     // Construct input buffer.
     if (can_read()) {
         pback_size_ = (std::max)(std::streamsize(2), pback_size); // STLPort needs 2.
@@ -254,8 +268,12 @@ indirect_streambuf<T, Tr, Alloc, Mode>::underflow()
           buf.data() + pback_size_ );
 
     // Read from source.
+    BOOST_IOSTREAMS_PROBE3(
+        underflow_start, this, typeid(T).name(), buf.size() - pback_size_
+    );
     std::streamsize chars =
         obj().read(buf.data() + pback_size_, buf.size() - pback_size_, next_);
+    BOOST_IOSTREAMS_PROBE3(underflow_done, this, typeid(T).name(), chars);
     if (chars == -1) {
         this->set_true_eof(true);
         chars = 0;
@@ -300,7 +318,10 @@ indirect_streambuf<T, Tr, Alloc, Mode>::overflow(int_type c)
             pbump(1);
         } else {
             char_type d = traits_type::to_char_type(c);
-            if (obj().write(&d, 1, next_) != 1)
+            BOOST_IOSTREAMS_PROBE3(overflow_start, this, typeid(T).name(), 1);
+            std::streamsize amt = obj().write(&d, 1, next_);
+            BOOST_IOSTREAMS_PROBE3(overflow_done, this, typeid(T).name(), amt);
+            if (amt != 1)
                 return traits_type::eof();
         }
     }
@@ -358,7 +379,16 @@ indirect_streambuf<T, Tr, Alloc, Mode>::seek_impl
         off -= static_cast<off_type>(egptr() - gptr());
     setg(0, 0, 0);
     setp(0, 0);
-    return obj().seek(off, way, which, next_);
+    BOOST_IOSTREAMS_PROBE4(
+        seek_start, this, typeid(T).name(), 
+        static_cast<long long>(off), static_cast<int>(way)
+    );
+    pos_type result = obj().seek(off, way, which, next_);
+    BOOST_IOSTREAMS_PROBE3(
+        seek_done, this, typeid(T).name(), 
+        static_cast<long long>(position_to_offset(result))
+    );
+    return result;
 }
 
 template<typename T, typename Tr, typename Alloc, typename Mode>
@@ -391,7 +421,10 @@ void indirect_streambuf<T, Tr, Alloc, Mode>::sync_impl()
 {
     std::streamsize avail, amt;
     if ((avail = static_cast<std::streamsize>(pptr() - pbase())) > 0) {
-        if ((amt = obj().write(pbase(), avail, next())) == avail)
+        BOOST_IOSTREAMS_PROBE3(sync_start, this, typeid(T).name(), avail);
+        amt = obj().write(pbase(), avail, next());
+        BOOST_IOSTREAMS_PROBE3(sync_done, this, typeid(T).name(), amt);
+        if (amt == avail)
             setp(out().begin(), out().end());
         else {
             const char_type* ptr = pptr();
@@ -91,6 +91,10 @@ protected:
     virtual bool auto_close() const = 0;
     virtual void set_auto_close(bool) = 0;
     virtual bool strict_sync() = 0;
+
+    // Returns true if characters written to this stream buffer have not yet
+    // been passed on to its component, e.g., because a device would block.
+    virtual bool output_pending() const { return false; }
     virtual const std::type_info& component_type() const = 0;
     virtual void* component_impl() = 0;
 #ifndef BOOST_NO_MEMBER_TEMPLATE_FRIENDS
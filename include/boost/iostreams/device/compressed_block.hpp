@@ -0,0 +1,691 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definition of the class template
+// basic_compressed_block_device, which provides random read and write access
+// to data stored in a seekable Device as a sequence of independently
+// compressed blocks of a fixed size, together with the typedef
+// compressed_block_device, which uses zlib and a file_descriptor:
+//
+//     compressed_block_device dev(
+//         file_descriptor("state.cbd", BOOST_IOS::in | BOOST_IOS::out)
+//     );
+//     stream<compressed_block_device> io(dev);
+//     io.seekp(offset);
+//     io.write(record, record_size);
+//
+// Decompressed blocks are kept in a cache. A block which has been modified
+// is compressed when it is evicted from the cache or when the device is
+// flushed, and is appended to the used portion of the container, leaving its
+// previous version as garbage; when the garbage exceeds a given fraction of
+// the container, flush() moves the blocks in use to the start of the
+// container. The container remains valid if writing is interrupted, except
+// while it is being compacted; it does not shrink, but the space freed by
+// compaction is reused.
+//
+// The container consists of the following, where all integers are unsigned
+// and stored in little-endian order:
+//
+//     A header consisting of the characters "BIOCBD01" followed by the
+//         block size, the number of uncompressed characters, the offset of
+//         the block table, the number of characters in use and the number of
+//         those which are garbage, as 64-bit integers.
+//     The compressed blocks, and possibly garbage, in any order.
+//     The block table, containing for each block its offset, as a 64-bit
+//         integer, followed by its compressed and uncompressed sizes, as
+//         32-bit integers. A block whose uncompressed size is zero is not
+//         stored, and consists of null characters; the last block may be
+//         shorter than the block size.
+
+#ifndef BOOST_IOSTREAMS_COMPRESSED_BLOCK_HPP_INCLUDED
+#define BOOST_IOSTREAMS_COMPRESSED_BLOCK_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <algorithm>                            // min, sort.
+#include <cstddef>                              // size_t.
+#include <cstring>                              // memcmp, memcpy.
+#include <list>
+#include <map>
+#include <vector>
+#include <boost/config.hpp>                     // PREVENT_MACRO_SUBSTITUTION.
+#include <boost/cstdint.hpp>                    // uint32_t, uint64_t.
+#include <boost/function.hpp>
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/ios.hpp>       // failure, streamsize.
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/filter/blocked.hpp>   // block_codec.
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/flush.hpp>
+#include <boost/iostreams/positioning.hpp>
+#include <boost/iostreams/seek.hpp>
+#include <boost/iostreams/write.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/throw_exception.hpp>
+
+// Must come last.
+#ifdef BOOST_MSVC
+# pragma warning(push)
+# pragma warning(disable:4251 4231 4660)
+#endif
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace compressed_block {
+
+                    // Status codes
+
+const int okay            = 0;
+const int bad_header      = 1;
+const int bad_table       = 2;
+const int bad_block       = 3;
+const int unexpected_eof  = 4;
+
+                    // Default values
+
+const std::size_t default_block_size = 64 * 1024;
+const std::size_t default_cache_size = 64;
+
+} // End namespace compressed_block.
+
+//
+// Class name: compressed_block_params.
+// Description: Encapsulates the parameters of a compressed block device.
+//      block_size - The number of uncompressed characters in each block;
+//          ignored unless the container is empty.
+//      cache_size - The maximum number of decompressed blocks retained.
+//      compaction_threshold - The fraction of the container which may be
+//          garbage before flush() compacts it.
+//
+struct compressed_block_params {
+
+    // Non-explicit constructor.
+    compressed_block_params
+        ( std::size_t block_size = compressed_block::default_block_size,
+          std::size_t cache_size = compressed_block::default_cache_size,
+          double compaction_threshold = 0.5 )
+        : block_size(block_size), cache_size(cache_size),
+          compaction_threshold(compaction_threshold)
+        { }
+    std::size_t  block_size;
+    std::size_t  cache_size;
+    double       compaction_threshold;
+};
+
+//
+// Class name: compressed_block_error.
+// Description: Subclass of std::ios::failure thrown to indicate a malformed
+//      container; the status code is one of the constants in namespace
+//      compressed_block. Errors reported by a codec are propagated unchanged.
+//
+class BOOST_IOSTREAMS_DECL compressed_block_error
+    : public BOOST_IOSTREAMS_FAILURE
+{
+public:
+    explicit compressed_block_error(int error);
+    int error() const { return error_; }
+    static void check BOOST_PREVENT_MACRO_SUBSTITUTION(int error);
+private:
+    int error_;
+};
+
+namespace detail {
+
+const std::size_t compressed_block_header_size = 48;
+const std::size_t compressed_block_entry_size = 16;
+const char compressed_block_magic[] = "BIOCBD01";
+
+} // End namespace detail.
+
+//
+// Template name: basic_compressed_block_device.
+// Description: Model of SeekableDevice providing random read and write
+//      access to the uncompressed contents of a container stored in the
+//      given seekable Device, which is initialized if it is empty. Blocks
+//      are compressed using copies of Compressor and decompressed using
+//      copies of Decompressor, which must be models of OutputFilter and are
+//      obtained from the given factories. Writing beyond the end extends
+//      the contents with null characters. Copies of a device share the
+//      container and the cache but have their own positions, and may be
+//      used concurrently from different threads; blocks missing from the
+//      cache are decompressed concurrently.
+//
+template< typename Compressor,
+          typename Decompressor,
+          typename Device = file_descriptor >
+class basic_compressed_block_device {
+public:
+    typedef char char_type;
+    struct category
+        : seekable_device_tag,
+          closable_tag,
+          flushable_tag
+        { };
+    typedef boost::function<Compressor ()>    compressor_factory;
+    typedef boost::function<Decompressor ()>  decompressor_factory;
+
+    explicit basic_compressed_block_device
+        ( const Device& dev,
+          const compressed_block_params& p = compressed_block_params(),
+          const compressor_factory& compress =
+              &detail::construct_codec<Compressor>,
+          const decompressor_factory& decompress =
+              &detail::construct_codec<Decompressor> )
+        : pimpl_(new impl(dev, p, compress, decompress)), pos_(0)
+        { }
+
+    std::streamsize read(char* s, std::streamsize n)
+    { return pimpl_->read(pos_, s, n); }
+
+    std::streamsize write(const char* s, std::streamsize n)
+    { return pimpl_->write(pos_, s, n); }
+
+    std::streampos seek(stream_offset off, BOOST_IOS::seekdir way);
+
+    // Writes the modified blocks and the block table to the container,
+    // compacting it if necessary.
+    bool flush()
+    {
+        pimpl_->flush(false);
+        return true;
+    }
+
+    void close() { pimpl_->flush(false); }
+
+    // Writes the modified blocks and moves the blocks in use to the start
+    // of the container.
+    void compact() { pimpl_->flush(true); }
+
+    // Returns the number of uncompressed characters.
+    stream_offset size() const;
+
+    // Returns the number of characters in each block.
+    std::size_t block_size() const { return pimpl_->block_size_; }
+
+    // Returns the number of characters of the container in use, including
+    // garbage.
+    stream_offset used() const;
+
+    // Returns the number of characters of the container which are garbage.
+    stream_offset garbage() const;
+private:
+    typedef boost::uint64_t uint64;
+    struct entry {
+        entry() : offset(0), csize(0), usize(0) { }
+        uint64           offset;
+        boost::uint32_t  csize;  // Compressed size.
+        boost::uint32_t  usize;  // Uncompressed size; zero if not stored.
+    };
+    struct cached_block {
+        std::vector<char>                 data;
+        std::list<std::size_t>::iterator  lru;
+        bool                              dirty;
+    };
+    typedef std::map<std::size_t, cached_block> cache_type;
+    typedef boost::mutex::scoped_lock           lock_type;
+    struct impl {
+        impl( const Device& dev, const compressed_block_params& p,
+              const compressor_factory& compress,
+              const decompressor_factory& decompress );
+        ~impl() { try { flush(false); } catch (...) { } }
+        std::streamsize read(uint64& pos, char* s, std::streamsize n);
+        std::streamsize write(uint64& pos, const char* s, std::streamsize n);
+        void flush(bool force);
+
+        // Returns the given block, decompressing it if necessary; the lock
+        // is released while the block is decompressed.
+        cached_block& load(lock_type& lock, std::size_t z);
+        void insert(std::size_t z, std::vector<char>& data);
+        void write_back(std::size_t z, cached_block& b);
+        void compact();
+        void write_table();
+        void read_at(uint64 off, char* s, std::size_t n);
+        void write_at(uint64 off, const char* s, std::size_t n);
+
+        Device                             dev_;
+        detail::block_codec<Compressor>    compress_;
+        detail::block_codec<Decompressor>  decompress_;
+        std::size_t                        block_size_;
+        std::size_t                        cache_size_;
+        double                             threshold_;
+        boost::mutex                       mtx_;
+        std::vector<entry>                 table_;
+        uint64                             size_;    // Uncompressed size.
+        uint64                             table_offset_;
+        uint64                             table_size_;
+        uint64                             used_;
+        uint64                             garbage_;
+        unsigned long                      generation_;
+        bool                               modified_; // Header out of date.
+        cache_type                         cache_;
+        std::list<std::size_t>             lru_;     // Most recent first.
+        std::vector<char>                  in_, out_;
+    };
+    shared_ptr<impl>  pimpl_;
+    uint64            pos_;
+};
+
+//
+// Typedef name: compressed_block_device.
+// Description: A basic_compressed_block_device which stores its container
+//      in a file_descriptor and compresses blocks with zlib.
+//
+typedef basic_compressed_block_device<zlib_compressor, zlib_decompressor>
+        compressed_block_device;
+
+//------------------Implementation of basic_compressed_block_device-----------//
+
+template<typename Compressor, typename Decompressor, typename Device>
+std::streampos
+basic_compressed_block_device<Compressor, Decompressor, Device>::seek
+    (stream_offset off, BOOST_IOS::seekdir way)
+{
+    stream_offset next;
+    if (way == BOOST_IOS::beg)
+        next = off;
+    else if (way == BOOST_IOS::cur)
+        next = static_cast<stream_offset>(pos_) + off;
+    else
+        next = size() + off;
+    if (next < 0)
+        boost::throw_exception(BOOST_IOSTREAMS_FAILURE("bad seek"));
+    pos_ = static_cast<uint64>(next);
+    return offset_to_position(next);
+}
+
+template<typename Compressor, typename Decompressor, typename Device>
+stream_offset
+basic_compressed_block_device<Compressor, Decompressor, Device>::size() const
+{
+    lock_type lock(pimpl_->mtx_);
+    return static_cast<stream_offset>(pimpl_->size_);
+}
+
+template<typename Compressor, typename Decompressor, typename Device>
+stream_offset
+basic_compressed_block_device<Compressor, Decompressor, Device>::used() const
+{
+    lock_type lock(pimpl_->mtx_);
+    return static_cast<stream_offset>(pimpl_->used_);
+}
+
+template<typename Compressor, typename Decompressor, typename Device>
+stream_offset
+basic_compressed_block_device<
+    Compressor, Decompressor, Device
+>::garbage() const
+{
+    lock_type lock(pimpl_->mtx_);
+    return static_cast<stream_offset>(pimpl_->garbage_);
+}
+
+//------------------Implementation of impl------------------------------------//
+
+template<typename Compressor, typename Decompressor, typename Device>
+basic_compressed_block_device<Compressor, Decompressor, Device>::impl::impl
+    ( const Device& dev, const compressed_block_params& p,
+      const compressor_factory& compress,
+      const decompressor_factory& decompress )
+    : dev_(dev), compress_(compress), decompress_(decompress),
+      block_size_(p.block_size), cache_size_((std::max)(p.cache_size,
+                                                        std::size_t(1))),
+      threshold_(p.compaction_threshold), size_(0), table_offset_(0),
+      table_size_(0), used_(detail::compressed_block_header_size),
+      garbage_(0), generation_(0), modified_(false)
+{
+    const std::size_t header = detail::compressed_block_header_size,
+                      entry_size = detail::compressed_block_entry_size;
+    uint64 total = position_to_offset(
+        iostreams::seek(dev_, 0, BOOST_IOS::end, BOOST_IOS::in)
+    );
+    if (total == 0) {
+
+        // Initialize an empty container
+        if (block_size_ == 0 || block_size_ > blocked::max_block_size)
+            block_size_ = blocked::max_block_size;
+        modified_ = true;
+        flush(false);
+        return;
+    }
+    char buf[header];
+    if (total < header)
+        boost::throw_exception(
+            compressed_block_error(compressed_block::bad_header)
+        );
+    read_at(0, buf, header);
+    uint64 block_size = detail::blocked_load(buf + 8, 8);
+    size_ = detail::blocked_load(buf + 16, 8);
+    table_offset_ = detail::blocked_load(buf + 24, 8);
+    used_ = detail::blocked_load(buf + 32, 8);
+    garbage_ = detail::blocked_load(buf + 40, 8);
+    if ( std::memcmp(buf, detail::compressed_block_magic, 8) != 0 ||
+         block_size == 0 || block_size > blocked::max_block_size ||
+         used_ < header || used_ > total || garbage_ > used_ - header )
+    {
+        boost::throw_exception(
+            compressed_block_error(compressed_block::bad_header)
+        );
+    }
+    block_size_ = static_cast<std::size_t>(block_size);
+
+    // Read the table, checking that each block lies within the portion of
+    // the container in use
+    uint64 count = (size_ + block_size - 1) / block_size;
+    table_size_ = count * entry_size;
+    if ( count > (used_ - header) / entry_size ||
+         (count != 0 && (table_offset_ < header ||
+                         table_offset_ > used_ - table_size_)) )
+    {
+        boost::throw_exception(
+            compressed_block_error(compressed_block::bad_table)
+        );
+    }
+    std::vector<char> table(static_cast<std::size_t>(table_size_));
+    if (!table.empty())
+        read_at(table_offset_, &table[0], table.size());
+    table_.resize(static_cast<std::size_t>(count));
+    for (std::size_t z = 0; z < table_.size(); ++z) {
+        const char*  p = &table[z * entry_size];
+        entry&       e = table_[z];
+        e.offset = detail::blocked_load(p, 8);
+        e.csize = static_cast<boost::uint32_t>(detail::blocked_load(p + 8, 4));
+        e.usize =
+            static_cast<boost::uint32_t>(detail::blocked_load(p + 12, 4));
+        uint64 max = (std::min)(uint64(block_size_), size_ - z * block_size);
+        if ( e.usize > max ||
+             ( e.usize != 0 &&
+               (e.offset < header || e.offset > used_ ||
+                e.csize > used_ - e.offset) ) )
+        {
+            boost::throw_exception(
+                compressed_block_error(compressed_block::bad_table)
+            );
+        }
+    }
+}
+
+template<typename Compressor, typename Decompressor, typename Device>
+std::streamsize
+basic_compressed_block_device<Compressor, Decompressor, Device>::impl::read
+    (uint64& pos, char* s, std::streamsize n)
+{
+    lock_type lock(mtx_);
+    if (pos >= size_)
+        return -1;
+    if (static_cast<uint64>(n) > size_ - pos)
+        n = static_cast<std::streamsize>(size_ - pos);
+    std::streamsize result = 0;
+    while (result < n) {
+        std::size_t    z = static_cast<std::size_t>(pos / block_size_);
+        std::size_t    off = static_cast<std::size_t>(pos % block_size_);
+        std::size_t    amt =
+            (std::min)( block_size_ - off,
+                        static_cast<std::size_t>(n - result) );
+        cached_block&  b = load(lock, z);
+        std::memcpy(s + result, &b.data[off], amt);
+        pos += amt;
+        result += static_cast<std::streamsize>(amt);
+    }
+    return result;
+}
+
+template<typename Compressor, typename Decompressor, typename Device>
+std::streamsize
+basic_compressed_block_device<Compressor, Decompressor, Device>::impl::write
+    (uint64& pos, const char* s, std::streamsize n)
+{
+    lock_type lock(mtx_);
+    std::streamsize result = 0;
+    while (result < n) {
+        std::size_t    z = static_cast<std::size_t>(pos / block_size_);
+        std::size_t    off = static_cast<std::size_t>(pos % block_size_);
+        std::size_t    amt =
+            (std::min)( block_size_ - off,
+                        static_cast<std::size_t>(n - result) );
+        cached_block&  b = load(lock, z);
+        std::memcpy(&b.data[off], s + result, amt);
+        b.dirty = true;
+        pos += amt;
+        result += static_cast<std::streamsize>(amt);
+        if (pos > size_) {
+            size_ = pos;
+            table_.resize(static_cast<std::size_t>(
+                (size_ + block_size_ - 1) / block_size_
+            ));
+            modified_ = true;
+        }
+    }
+    return result;
+}
+
+template<typename Compressor, typename Decompressor, typename Device>
+void basic_compressed_block_device<
+    Compressor, Decompressor, Device
+>::impl::flush(bool force)
+{
+    lock_type lock(mtx_);
+    for (typename cache_type::iterator it = cache_.begin();
+         it != cache_.end(); ++it )
+    {
+        if (it->second.dirty)
+            write_back(it->first, it->second);
+    }
+    if (!modified_ && !force)
+        return;
+
+    // The previous table becomes garbage once the header refers to its
+    // replacement
+    if (table_offset_ != 0) {
+        garbage_ += table_size_;
+        table_offset_ = 0;
+    }
+    uint64 data = used_ - detail::compressed_block_header_size;
+    if ( force ||
+         (garbage_ != 0 && garbage_ > threshold_ * static_cast<double>(data)) )
+    {
+        compact();
+    }
+    write_table();
+}
+
+template<typename Compressor, typename Decompressor, typename Device>
+typename basic_compressed_block_device<
+    Compressor, Decompressor, Device
+>::cached_block&
+basic_compressed_block_device<Compressor, Decompressor, Device>::impl::load
+    (lock_type& lock, std::size_t z)
+{
+    for (;;) {
+        typename cache_type::iterator it = cache_.find(z);
+        if (it != cache_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            return it->second;
+        }
+        entry e = z < table_.size() ? table_[z] : entry();
+        std::vector<char> block;
+        if (e.usize != 0) {
+
+            // Read the compressed block and decompress it without holding
+            // the lock, discarding the result if the block is loaded or
+            // rewritten in the meantime
+            unsigned long      generation = generation_;
+            std::vector<char>  in(e.csize);
+            if (!in.empty())
+                read_at(e.offset, &in[0], in.size());
+            lock.unlock();
+            try {
+                decompress_(in, block);
+            } catch (...) {
+                lock.lock();
+                throw;
+            }
+            lock.lock();
+            if (block.size() != e.usize)
+                boost::throw_exception(
+                    compressed_block_error(compressed_block::bad_block)
+                );
+            if (cache_.find(z) != cache_.end() || generation != generation_)
+                continue;
+        }
+        block.resize(block_size_);
+        insert(z, block);
+        return cache_[z];
+    }
+}
+
+template<typename Compressor, typename Decompressor, typename Device>
+void basic_compressed_block_device<Compressor, Decompressor, Device>::impl::
+    insert(std::size_t z, std::vector<char>& data)
+{
+    if (cache_.size() >= cache_size_) {
+        typename cache_type::iterator it = cache_.find(lru_.back());
+        if (it->second.dirty)
+            write_back(it->first, it->second);
+        cache_.erase(it);
+        lru_.pop_back();
+    }
+    lru_.push_front(z);
+    cached_block& b = cache_[z];
+    b.data.swap(data);
+    b.lru = lru_.begin();
+    b.dirty = false;
+}
+
+template<typename Compressor, typename Decompressor, typename Device>
+void basic_compressed_block_device<Compressor, Decompressor, Device>::impl::
+    write_back(std::size_t z, cached_block& b)
+{
+    // Blocks consisting of null characters are not stored
+    std::size_t usize = static_cast<std::size_t>(
+        (std::min)(uint64(block_size_), size_ - uint64(z) * block_size_)
+    );
+    std::size_t nonzero = usize;
+    while (nonzero != 0 && b.data[nonzero - 1] == 0)
+        --nonzero;
+    entry e;
+    if (nonzero != 0) {
+        in_.assign(b.data.begin(), b.data.begin() + usize);
+        compress_(in_, out_);
+        if (out_.size() > 0xffffffffu)
+            boost::throw_exception(
+                compressed_block_error(compressed_block::bad_block)
+            );
+        if (!out_.empty())
+            write_at(used_, &out_[0], out_.size());
+        e.offset = used_;
+        e.csize = static_cast<boost::uint32_t>(out_.size());
+        e.usize = static_cast<boost::uint32_t>(usize);
+        used_ += out_.size();
+    }
+    entry& old = table_[z];
+    if (old.usize != 0)
+        garbage_ += old.csize;
+    old = e;
+    b.dirty = false;
+    modified_ = true;
+    ++generation_;
+}
+
+template<typename Compressor, typename Decompressor, typename Device>
+void basic_compressed_block_device<
+    Compressor, Decompressor, Device
+>::impl::compact()
+{
+    // Moving the blocks in order of increasing offset ensures that no block
+    // is overwritten before it has been moved
+    std::vector< std::pair<uint64, std::size_t> > order;
+    for (std::size_t z = 0; z < table_.size(); ++z)
+        if (table_[z].usize != 0)
+            order.push_back(std::make_pair(table_[z].offset, z));
+    std::sort(order.begin(), order.end());
+    uint64 next = detail::compressed_block_header_size;
+    for (std::size_t z = 0; z < order.size(); ++z) {
+        entry& e = table_[order[z].second];
+        if (e.offset != next && e.csize != 0) {
+            in_.resize(e.csize);
+            read_at(e.offset, &in_[0], in_.size());
+            write_at(next, &in_[0], in_.size());
+        }
+        e.offset = next;
+        next += e.csize;
+    }
+    used_ = next;
+    garbage_ = 0;
+}
+
+template<typename Compressor, typename Decompressor, typename Device>
+void basic_compressed_block_device<
+    Compressor, Decompressor, Device
+>::impl::write_table()
+{
+    const std::size_t header = detail::compressed_block_header_size,
+                      entry_size = detail::compressed_block_entry_size;
+    if (!table_.empty()) {
+        out_.resize(table_.size() * entry_size);
+        for (std::size_t z = 0; z < table_.size(); ++z) {
+            char* p = &out_[z * entry_size];
+            detail::blocked_store(p, table_[z].offset, 8);
+            detail::blocked_store(p + 8, table_[z].csize, 4);
+            detail::blocked_store(p + 12, table_[z].usize, 4);
+        }
+        write_at(used_, &out_[0], out_.size());
+        table_offset_ = used_;
+        table_size_ = out_.size();
+        used_ += table_size_;
+    }
+    char buf[header];
+    std::memcpy(buf, detail::compressed_block_magic, 8);
+    detail::blocked_store(buf + 8, block_size_, 8);
+    detail::blocked_store(buf + 16, size_, 8);
+    detail::blocked_store(buf + 24, table_offset_, 8);
+    detail::blocked_store(buf + 32, used_, 8);
+    detail::blocked_store(buf + 40, garbage_, 8);
+    write_at(0, buf, header);
+    iostreams::flush(dev_);
+    modified_ = false;
+}
+
+template<typename Compressor, typename Decompressor, typename Device>
+void basic_compressed_block_device<Compressor, Decompressor, Device>::impl::
+    read_at(uint64 off, char* s, std::size_t n)
+{
+    iostreams::seek( dev_, static_cast<stream_offset>(off),
+                     BOOST_IOS::beg, BOOST_IOS::in );
+    if (detail::blocked_read(dev_, s, n) != n)
+        boost::throw_exception(
+            compressed_block_error(compressed_block::unexpected_eof)
+        );
+}
+
+template<typename Compressor, typename Decompressor, typename Device>
+void basic_compressed_block_device<Compressor, Decompressor, Device>::impl::
+    write_at(uint64 off, const char* s, std::size_t n)
+{
+    iostreams::seek( dev_, static_cast<stream_offset>(off),
+                     BOOST_IOS::beg, BOOST_IOS::out );
+    while (n != 0) {
+        std::streamsize amt =
+            iostreams::write(dev_, s, static_cast<std::streamsize>(n));
+        s += amt;
+        n -= static_cast<std::size_t>(amt);
+    }
+}
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+#ifdef BOOST_MSVC
+# pragma warning(pop)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_COMPRESSED_BLOCK_HPP_INCLUDED
@@ -0,0 +1,224 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definition of the class concat_source, which presents a
+// sequence of files or Sources as a single stream. The parts are opened,
+// read and, optionally, decompressed by a background thread, which stays a
+// bounded number of characters ahead of the reader, so that opening a part
+// and waiting for its first characters overlaps with the processing of the
+// preceding parts:
+//
+//     std::vector<std::string> shards = ...;
+//     filtering_istream in(concat_source(shards, concat::automatic));
+//
+// The library must be built with zlib support.
+
+#ifndef BOOST_IOSTREAMS_CONCAT_HPP_INCLUDED
+#define BOOST_IOSTREAMS_CONCAT_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <cstddef>                            // size_t.
+#include <string>
+#include <utility>                            // pair.
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/iostreams/categories.hpp>     // source_tag, closable_tag.
+#include <boost/iostreams/close.hpp>
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/ios.hpp>     // streamsize.
+#include <boost/iostreams/input_sequence.hpp>
+#include <boost/iostreams/read.hpp>
+#include <boost/iostreams/traits.hpp>         // is_direct.
+#include <boost/mpl/if.hpp>
+#include <boost/shared_ptr.hpp>
+
+// Must come last.
+#ifdef BOOST_MSVC
+# pragma warning(push)
+# pragma warning(disable:4251 4231 4660)
+#endif
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace concat {
+
+                    // Compression formats
+
+const int none        = 0;
+const int gzip        = 1;
+const int zlib        = 2;
+const int automatic   = 3;   // gzip if the part begins with the gzip magic
+                             // number, and none otherwise.
+
+                    // Default values
+
+const std::size_t default_chunk_size  = 64 * 1024;
+const std::size_t default_read_ahead  = 4 * 1024 * 1024;
+
+} // End namespace concat.
+
+//
+// Class name: concat_params.
+// Description: Encapsulates the parameters of a concat_source.
+//      compression - The format of each part, from namespace concat.
+//      chunk_size - The number of characters read from a part at a time.
+//      read_ahead - The number of characters which may be read ahead of the
+//          reader, after which the background thread waits.
+//      separator - Characters inserted between consecutive parts.
+//
+struct concat_params {
+
+    // Non-explicit constructor.
+    concat_params( int compression = concat::none,
+                   std::size_t chunk_size = concat::default_chunk_size,
+                   std::size_t read_ahead = concat::default_read_ahead,
+                   const std::string& separator = std::string() )
+        : compression(compression), chunk_size(chunk_size),
+          read_ahead(read_ahead), separator(separator)
+        { }
+    int          compression;
+    std::size_t  chunk_size;
+    std::size_t  read_ahead;
+    std::string  separator;
+};
+
+namespace detail {
+
+class concat_source_impl;
+
+// Type-erased Source from which a part is read.
+class BOOST_IOSTREAMS_DECL concat_reader {
+public:
+    virtual ~concat_reader();
+    virtual std::streamsize read(char* s, std::streamsize n) = 0;
+    virtual void close() = 0;
+};
+
+template<typename Source>
+class concat_indirect_reader : public concat_reader {
+public:
+    explicit concat_indirect_reader(const Source& src) : src_(src) { }
+    std::streamsize read(char* s, std::streamsize n)
+    { return iostreams::read(src_, s, n); }
+    void close() { iostreams::close(src_, BOOST_IOS::in); }
+private:
+    Source src_;
+};
+
+template<typename Source>
+class concat_direct_reader : public concat_reader {
+public:
+    explicit concat_direct_reader(const Source& src) : src_(src)
+    {
+        std::pair<char*, char*> seq = iostreams::input_sequence(src_);
+        next_ = seq.first;
+        end_ = seq.second;
+    }
+    std::streamsize read(char* s, std::streamsize n)
+    {
+        if (next_ == end_)
+            return -1;
+        if (n > end_ - next_)
+            n = static_cast<std::streamsize>(end_ - next_);
+        std::char_traits<char>::copy(s, next_, static_cast<std::size_t>(n));
+        next_ += n;
+        return n;
+    }
+    void close() { iostreams::close(src_, BOOST_IOS::in); }
+private:
+    Source       src_;
+    const char*  next_;
+    const char*  end_;
+};
+
+template<typename Source>
+struct concat_reader_type
+    : mpl::if_<
+          is_direct<Source>,
+          concat_direct_reader<Source>,
+          concat_indirect_reader<Source>
+      >
+    { };
+
+} // End namespace detail.
+
+//
+// Class name: concat_part.
+// Description: Filled in by the generator of a concat_source with the next
+//      part to be read, which may be a file or any Source, and its name.
+//
+class BOOST_IOSTREAMS_DECL concat_part {
+public:
+    // Opens the file with the given pathname.
+    void open(const std::string& path);
+
+    // Reads from a copy of the given Source.
+    template<typename Source>
+    void open(const Source& src, const std::string& name = std::string())
+    {
+        typedef typename detail::concat_reader_type<Source>::type reader;
+        reader_.reset(new reader(src));
+        name_ = name;
+    }
+private:
+    friend class detail::concat_source_impl;
+    shared_ptr<detail::concat_reader>  reader_;
+    std::string                        name_;
+};
+
+//
+// Class name: concat_source.
+// Description: Model of Source which reads the concatenation of a sequence
+//      of parts, each read on a background thread. Exceptions thrown while
+//      opening or reading a part are rethrown by read() once the
+//      characters preceding the failure have been consumed. Copies of a
+//      concat_source share their position.
+//
+class BOOST_IOSTREAMS_DECL concat_source {
+public:
+    typedef char char_type;
+    struct category : source_tag, closable_tag { };
+
+    // Type of the function object invoked on the background thread to
+    // obtain each part in turn; it returns false if there are no more.
+    typedef boost::function<bool (concat_part&)> generator;
+
+    // Reads the files with the given pathnames.
+    explicit concat_source( const std::vector<std::string>& paths,
+                            const concat_params& p = concat_params() );
+
+    // Reads the parts returned by gen.
+    explicit concat_source( const generator& gen,
+                            const concat_params& p = concat_params() );
+
+    std::streamsize read(char* s, std::streamsize n);
+
+    // Stops the background thread; further reads return EOF.
+    void close();
+
+    // Returns the index and name of the part from which the last characters
+    // were read, or of the first part if none have been read; the name is
+    // empty if the part has not yet been opened.
+    std::size_t part() const;
+    std::string part_name() const;
+private:
+    shared_ptr<detail::concat_source_impl> pimpl_;
+};
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+#ifdef BOOST_MSVC
+# pragma warning(pop)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_CONCAT_HPP_INCLUDED
@@ -26,6 +26,7 @@
 #include <boost/iostreams/detail/path.hpp>
 #include <boost/iostreams/positioning.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/system/error_code.hpp>
 
 // Must come last.
 #include <boost/config/abi_prefix.hpp>
@@ -51,7 +52,8 @@ public:
     typedef char                 char_type;
     struct category
         : seekable_device_tag,
-          closable_tag
+          closable_tag,
+          error_code_tag
         { };
 
     // Default constructor
@@ -127,9 +129,21 @@ public:
 
     bool is_open() const;
     void close();
+
+    // If the handle is in non-blocking mode, read() returns 0 and write()
+    // returns a short count, rather than failing, when the call would block
     std::streamsize read(char_type* s, std::streamsize n);
     std::streamsize write(const char_type* s, std::streamsize n);
     std::streampos seek(stream_offset off, BOOST_IOS::seekdir way);
+
+    // Non-throwing versions of the above; see <boost/iostreams/error_code.hpp>
+    void close(boost::system::error_code& ec);
+    std::streamsize read( char_type* s, std::streamsize n,
+                          boost::system::error_code& ec );
+    std::streamsize write( const char_type* s, std::streamsize n,
+                           boost::system::error_code& ec );
+    std::streampos seek( stream_offset off, BOOST_IOS::seekdir way,
+                         boost::system::error_code& ec );
     handle_type handle() const;
 private:
     void init();
@@ -154,7 +168,8 @@ public:
     struct category
       : input_seekable,
         device_tag,
-        closable_tag
+        closable_tag,
+        error_code_tag
       { };
     using file_descriptor::is_open;
     using file_descriptor::close;
@@ -236,7 +251,8 @@ public:
     struct category
       : output_seekable,
         device_tag,
-        closable_tag
+        closable_tag,
+        error_code_tag
       { };
     using file_descriptor::is_open;
     using file_descriptor::close;
@@ -0,0 +1,124 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definition of the class pipe_sink, which writes to the write
+// end of a pipe. On Linux, characters are collected in page-aligned buffers
+// which are handed to the kernel with vmsplice(2) instead of being copied
+// into the pipe; a buffer is reused once the reader has consumed the pages
+// it contains. The capacity of the pipe may be enlarged with F_SETPIPE_SZ:
+//
+//     filtering_ostream out(pipe_sink(STDOUT_FILENO, never_close_handle,
+//                                     pipe_params(1024 * 1024)));
+//
+// Elsewhere, or if the descriptor does not refer to a pipe, pipe_sink
+// behaves like file_descriptor_sink.
+
+#ifndef BOOST_IOSTREAMS_PIPE_SINK_HPP_INCLUDED
+#define BOOST_IOSTREAMS_PIPE_SINK_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <cstddef>                            // size_t.
+#include <boost/iostreams/categories.hpp>     // tags.
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/ios.hpp>     // streamsize.
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/shared_ptr.hpp>
+
+// Must come last.
+#ifdef BOOST_MSVC
+# pragma warning(push)
+# pragma warning(disable:4251 4231 4660)
+#endif
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace pipes {
+
+const std::size_t default_buffer_size = 64 * 1024;
+
+} // End namespace pipes.
+
+//
+// Class name: pipe_params.
+// Description: Encapsulates the parameters of a pipe_sink.
+//      pipe_size - If non-zero, the capacity to which the pipe is enlarged;
+//          the pipe is never made smaller.
+//      zero_copy - true if characters should be passed to the kernel with
+//          vmsplice(2) where possible.
+//      buffer_size - The size of each buffer, rounded up to a whole number
+//          of pages.
+//
+struct pipe_params {
+
+    // Non-explicit constructor.
+    pipe_params( std::size_t pipe_size = 0, bool zero_copy = true,
+                 std::size_t buffer_size = pipes::default_buffer_size )
+        : pipe_size(pipe_size), zero_copy(zero_copy),
+          buffer_size(buffer_size)
+        { }
+    std::size_t  pipe_size;
+    bool         zero_copy;
+    std::size_t  buffer_size;
+};
+
+namespace detail { class pipe_sink_impl; }
+
+//
+// Class name: pipe_sink.
+// Description: Model of Sink which writes to a pipe, using vmsplice(2) with
+//      SPLICE_F_GIFT where supported. The descriptor must be in blocking
+//      mode. Characters are buffered until a buffer is full, flush() is
+//      called or the sink is closed. Copies of a pipe_sink share their
+//      buffers.
+//
+class BOOST_IOSTREAMS_DECL pipe_sink {
+public:
+    typedef file_descriptor_sink::handle_type handle_type;
+    typedef char                              char_type;
+    struct category : sink_tag, closable_tag, flushable_tag { };
+
+    pipe_sink( handle_type fd, file_descriptor_flags f,
+               const pipe_params& p = pipe_params() );
+    explicit pipe_sink( const file_descriptor_sink& fd,
+                        const pipe_params& p = pipe_params() );
+
+    std::streamsize write(const char* s, std::streamsize n);
+
+    // Writes buffered characters to the pipe.
+    bool flush();
+
+    // Flushes the sink and closes the descriptor, as specified by the
+    // file_descriptor_flags passed to the constructor.
+    void close();
+
+    // Returns the capacity of the pipe, or 0 if the descriptor is not a
+    // pipe or the capacity cannot be determined.
+    std::size_t pipe_size() const;
+
+    // Changes the capacity of the pipe, returning the new capacity, which
+    // may be larger than requested.
+    std::size_t set_pipe_size(std::size_t size);
+
+    // Returns true if characters are currently passed with vmsplice(2).
+    bool zero_copy() const;
+private:
+    shared_ptr<detail::pipe_sink_impl> pimpl_;
+};
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+#ifdef BOOST_MSVC
+# pragma warning(pop)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_PIPE_SINK_HPP_INCLUDED
@@ -0,0 +1,342 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definition of the class segmented_buffer, which stores a
+// sequence of characters as a list of segments referring to reference-counted
+// or borrowed storage, together with the devices segmented_source and
+// segmented_sink. Characters are copied only when appended without an owner;
+// appending a buffer, splitting a buffer and copying a buffer share the
+// segments. When copy() is called with a segmented_source, each segment is
+// written to the sink directly; with a file_descriptor_sink, the segments are
+// written with writev(2), and with a segmented_sink they are shared:
+//
+//     segmented_buffer msg;
+//     msg.append_borrowed(header, header_size);
+//     msg.append(payload);
+//     boost::iostreams::copy(segmented_source(msg), file_descriptor_sink(fd));
+
+#ifndef BOOST_IOSTREAMS_SEGMENTED_BUFFER_HPP_INCLUDED
+#define BOOST_IOSTREAMS_SEGMENTED_BUFFER_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <algorithm>                          // min, max.
+#include <cstddef>                            // size_t.
+#include <cstring>                            // memcpy.
+#include <deque>
+#include <vector>
+#include <boost/iostreams/categories.hpp>     // tags.
+#include <boost/iostreams/detail/adapter/non_blocking_adapter.hpp>
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/ios.hpp>     // streamsize.
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/write.hpp>
+#include <boost/shared_ptr.hpp>
+
+// Must come last.
+#ifdef BOOST_MSVC
+# pragma warning(push)
+# pragma warning(disable:4251 4231 4660)
+#endif
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace segmented {
+
+const std::size_t default_segment_size = 4096;
+
+} // End namespace segmented.
+
+namespace detail {
+
+// Storage allocated by a segmented_buffer for the characters appended to it.
+// Characters may be added to the unused portion by any buffer whose last
+// segment ends at the first unused character.
+struct segment_storage {
+    explicit segment_storage(std::size_t capacity)
+        : data(capacity), used(0)
+        { }
+    std::vector<char>  data;
+    std::size_t        used;
+};
+
+} // End namespace detail.
+
+//
+// Class name: segmented_buffer.
+// Description: A sequence of characters stored as a list of segments, each
+//      of which refers to characters kept alive by a reference-counted
+//      owner, or borrowed from the caller. Characters are never modified
+//      once appended, so copies of a buffer, and the buffers produced by
+//      split(), share segments. A buffer and its copies must not be used
+//      concurrently from different threads.
+//      segment_size - The minimum size of the storage allocated for
+//          characters appended by copying.
+//
+class segmented_buffer {
+public:
+    typedef char char_type;
+
+    //
+    // Class name: segment.
+    // Description: A contiguous range of characters in a segmented_buffer.
+    //
+    class segment {
+    public:
+        segment() : data_(0), size_(0), storage_(0) { }
+        const char* data() const { return data_; }
+        std::size_t size() const { return size_; }
+    private:
+        friend class segmented_buffer;
+        segment( const char* data, std::size_t size,
+                 const shared_ptr<void>& owner,
+                 detail::segment_storage* storage = 0 )
+            : owner_(owner), data_(data), size_(size), storage_(storage)
+            { }
+        shared_ptr<void>          owner_;   // Empty if borrowed.
+        const char*               data_;
+        std::size_t               size_;
+        detail::segment_storage*  storage_; // Non-null if owned by buffer.
+    };
+    typedef std::deque<segment>::const_iterator const_iterator;
+
+    explicit segmented_buffer
+        (std::size_t segment_size = segmented::default_segment_size)
+        : size_(0), segment_size_((std::max)(segment_size, std::size_t(1)))
+        { }
+
+    // Appends a copy of the given characters, using the unused storage of
+    // the last segment if possible.
+    void append(const char* s, std::size_t n);
+
+    // Appends the given characters without copying them; they are kept
+    // alive by owner.
+    void append(const char* s, std::size_t n, const shared_ptr<void>& owner)
+    {
+        if (n != 0) {
+            segments_.push_back(segment(s, n, owner));
+            size_ += n;
+        }
+    }
+
+    // Appends the given characters without copying them; they must remain
+    // valid while any buffer refers to them.
+    void append_borrowed(const char* s, std::size_t n)
+    { append(s, n, shared_ptr<void>()); }
+
+    // Appends the segments of the given buffer.
+    void append(const segmented_buffer& buf)
+    {
+        segments_.insert(segments_.end(), buf.segments_.begin(),
+                         buf.segments_.end());
+        size_ += buf.size_;
+    }
+
+    // Removes and returns the first n characters, or all the characters if
+    // fewer than n are stored; at most one segment is divided.
+    segmented_buffer split(std::size_t n);
+
+    // Removes the first n characters, or all the characters if fewer than n
+    // are stored.
+    void consume(std::size_t n);
+
+    void clear()
+    {
+        segments_.clear();
+        size_ = 0;
+    }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    std::size_t segment_count() const { return segments_.size(); }
+    const_iterator begin() const { return segments_.begin(); }
+    const_iterator end() const { return segments_.end(); }
+private:
+    std::deque<segment>  segments_;
+    std::size_t          size_;
+    std::size_t          segment_size_;
+};
+
+//
+// Class name: segmented_sink.
+// Description: Model of Sink which appends copies of the characters written
+//      to it to a segmented_buffer. When it is the sink passed to copy()
+//      together with a segmented_source, the segments are shared instead.
+//
+class segmented_sink {
+public:
+    typedef char       char_type;
+    typedef sink_tag   category;
+    segmented_sink(segmented_buffer& buf) : buf_(&buf) { }
+    std::streamsize write(const char* s, std::streamsize n)
+    {
+        buf_->append(s, static_cast<std::size_t>(n));
+        return n;
+    }
+    segmented_buffer& buffer() const { return *buf_; }
+private:
+    segmented_buffer* buf_;
+};
+
+//------------------Definition of write_segments------------------------------//
+
+// Writes the contents of the given buffer to the given sink, a segment at a
+// time, returning the number of characters written.
+template<typename Sink>
+std::streamsize write_segments(Sink& snk, const segmented_buffer& buf)
+{
+    non_blocking_adapter<Sink> nb(snk);
+    for ( segmented_buffer::const_iterator it = buf.begin(), end = buf.end();
+          it != end; ++it )
+    {
+        iostreams::write( nb, it->data(),
+                          static_cast<std::streamsize>(it->size()) );
+    }
+    return static_cast<std::streamsize>(buf.size());
+}
+
+// Appends the segments of the given buffer to the sink's buffer.
+inline std::streamsize
+write_segments(segmented_sink& snk, const segmented_buffer& buf)
+{
+    snk.buffer().append(buf);
+    return static_cast<std::streamsize>(buf.size());
+}
+
+// Writes the contents of the given buffer to the given descriptor with as
+// few calls to writev(2) as possible; elsewhere, the segments are written
+// one at a time.
+BOOST_IOSTREAMS_DECL std::streamsize
+write_segments(file_descriptor_sink& snk, const segmented_buffer& buf);
+
+//
+// Class name: segmented_source.
+// Description: Model of Source which reads the contents of a
+//      segmented_buffer, sharing its segments. When passed to copy(), the
+//      remaining segments are written to the sink with write_segments().
+//
+class segmented_source {
+public:
+    typedef char char_type;
+    struct category : source_tag, segmented_tag { };
+    segmented_source(const segmented_buffer& buf) : buf_(buf) { }
+    std::streamsize read(char* s, std::streamsize n)
+    {
+        if (buf_.empty())
+            return -1;
+        std::streamsize result = 0;
+        segmented_buffer::const_iterator it = buf_.begin();
+        while (result < n && it != buf_.end()) {
+            std::size_t amt =
+                (std::min)( it->size(),
+                            static_cast<std::size_t>(n - result) );
+            std::memcpy(s + result, it->data(), amt);
+            result += static_cast<std::streamsize>(amt);
+            ++it;
+        }
+        buf_.consume(static_cast<std::size_t>(result));
+        return result;
+    }
+
+    // Writes the remaining characters to the given sink.
+    template<typename Sink>
+    std::streamsize write_segments(Sink& snk)
+    {
+        std::streamsize result = iostreams::write_segments(snk, buf_);
+        buf_.clear();
+        return result;
+    }
+    const segmented_buffer& buffer() const { return buf_; }
+private:
+    segmented_buffer buf_;
+};
+
+//------------------Implementation of segmented_buffer------------------------//
+
+inline void segmented_buffer::append(const char* s, std::size_t n)
+{
+    if (n == 0)
+        return;
+    if (!segments_.empty()) {
+        segment&                  last = segments_.back();
+        detail::segment_storage*  storage = last.storage_;
+        if ( storage != 0 &&
+             last.data_ + last.size_ == &storage->data[0] + storage->used )
+        {
+            std::size_t amt =
+                (std::min)(n, storage->data.size() - storage->used);
+            std::memcpy(&storage->data[0] + storage->used, s, amt);
+            storage->used += amt;
+            last.size_ += amt;
+            size_ += amt;
+            s += amt;
+            n -= amt;
+            if (n == 0)
+                return;
+        }
+    }
+    shared_ptr<detail::segment_storage>
+        storage(new detail::segment_storage((std::max)(n, segment_size_)));
+    std::memcpy(&storage->data[0], s, n);
+    storage->used = n;
+    segments_.push_back(segment(&storage->data[0], n, storage, storage.get()));
+    size_ += n;
+}
+
+inline segmented_buffer segmented_buffer::split(std::size_t n)
+{
+    segmented_buffer result(segment_size_);
+    while (n != 0 && !segments_.empty()) {
+        segment& first = segments_.front();
+        if (first.size_ <= n) {
+            n -= first.size_;
+            size_ -= first.size_;
+            result.size_ += first.size_;
+            result.segments_.push_back(first);
+            segments_.pop_front();
+        } else {
+            segment prefix = first;
+            prefix.size_ = n;
+            result.segments_.push_back(prefix);
+            result.size_ += n;
+            first.data_ += n;
+            first.size_ -= n;
+            size_ -= n;
+            n = 0;
+        }
+    }
+    return result;
+}
+
+inline void segmented_buffer::consume(std::size_t n)
+{
+    while (n != 0 && !segments_.empty()) {
+        segment& first = segments_.front();
+        if (first.size_ <= n) {
+            n -= first.size_;
+            size_ -= first.size_;
+            segments_.pop_front();
+        } else {
+            first.data_ += n;
+            first.size_ -= n;
+            size_ -= n;
+            n = 0;
+        }
+    }
+}
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+#ifdef BOOST_MSVC
+# pragma warning(pop)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_SEGMENTED_BUFFER_HPP_INCLUDED
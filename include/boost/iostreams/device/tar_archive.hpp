@@ -0,0 +1,632 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definitions of the class tar_index, which records the
+// position and size of each member of a tar archive, and of the class
+// templates basic_tar_archive and basic_tar_gz_archive, which read the
+// members of an uncompressed or gzip-compressed archive stored in a seekable
+// Source. The index is built by reading the archive once, or loaded from a
+// copy saved earlier:
+//
+//     tar_archive tar(mapped_file_source("bundle.tar"));
+//     tar_archive::member_source m = tar.open("data/table.csv");
+//     std::pair<const char*, const char*> chars = m.input_sequence();
+//
+// The members of an uncompressed archive are restrictions of the Source,
+// so that members of a memory-mapped archive are read without copying. While
+// the index of a compressed archive is built, checkpoints are recorded at
+// regular intervals of the uncompressed data; a member is read by resuming
+// decompression at the last checkpoint preceding it. The formats ustar, pax
+// and GNU are supported, including long names; sparse files are not.
+
+#ifndef BOOST_IOSTREAMS_TAR_ARCHIVE_HPP_INCLUDED
+#define BOOST_IOSTREAMS_TAR_ARCHIVE_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <algorithm>                            // min, upper_bound.
+#include <cstddef>                              // size_t.
+#include <ctime>                                // time_t.
+#include <string>
+#include <vector>
+#include <boost/config.hpp>  // BOOST_PREVENT_MACRO_SUBSTITUTION.
+#include <boost/iostreams/categories.hpp>       // source_tag.
+#include <boost/iostreams/detail/adapter/direct_adapter.hpp>
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/ios.hpp>       // failure, streamsize.
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/input_sequence.hpp>
+#include <boost/iostreams/positioning.hpp>      // stream_offset.
+#include <boost/iostreams/read.hpp>
+#include <boost/iostreams/restrict.hpp>
+#include <boost/iostreams/seek.hpp>
+#include <boost/iostreams/traits.hpp>           // is_direct.
+#include <boost/iostreams/write.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/mpl/if.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/throw_exception.hpp>
+
+// Must come last.
+#ifdef BOOST_MSVC
+# pragma warning(push)
+# pragma warning(disable:4251 4231 4660)
+#endif
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace tar {
+
+                    // Status codes
+
+BOOST_IOSTREAMS_DECL extern const int okay;
+BOOST_IOSTREAMS_DECL extern const int bad_header;
+BOOST_IOSTREAMS_DECL extern const int bad_checksum;
+BOOST_IOSTREAMS_DECL extern const int unexpected_eof;
+BOOST_IOSTREAMS_DECL extern const int member_not_found;
+BOOST_IOSTREAMS_DECL extern const int bad_index;
+
+                    // Member types
+
+const char regular        = '0';
+const char hard_link      = '1';
+const char symbolic_link  = '2';
+const char character      = '3';
+const char block          = '4';
+const char directory      = '5';
+const char fifo           = '6';
+const char contiguous     = '7';
+
+                    // Default values
+
+const std::streamsize default_checkpoint_spacing = 4 * 1024 * 1024;
+
+} // End namespace tar.
+
+//
+// Class name: tar_error.
+// Description: Subclass of std::ios::failure thrown to indicate that an
+//      archive or an index is invalid, or that a member does not exist; the
+//      status code is one of the constants in namespace tar.
+//
+class BOOST_IOSTREAMS_DECL tar_error : public BOOST_IOSTREAMS_FAILURE {
+public:
+    explicit tar_error(int error);
+    int error() const { return error_; }
+    static void check BOOST_PREVENT_MACRO_SUBSTITUTION(int error);
+private:
+    int error_;
+};
+
+//
+// Class name: tar_entry.
+// Description: Description of an archive member. Offsets are positions
+//      within the uncompressed archive; header_offset is the position of the
+//      first header describing the member, including any long name or pax
+//      header, and data_offset is the position of its contents.
+//
+struct tar_entry {
+    tar_entry()
+        : type(tar::regular), mode(0), mtime(0), header_offset(0),
+          data_offset(0), size(0)
+        { }
+    bool is_directory() const
+    {
+        return type == tar::directory ||
+               (!name.empty() && name[name.size() - 1] == '/');
+    }
+    bool is_regular() const
+    {
+        return type == tar::regular || type == '\0' ||
+               type == tar::contiguous;
+    }
+    std::string    name;
+    std::string    link_name;
+    char           type;
+    unsigned       mode;
+    std::time_t    mtime;
+    stream_offset  header_offset;
+    stream_offset  data_offset;
+    stream_offset  size;
+};
+
+namespace detail {
+
+//
+// Class name: tar_reader.
+// Description: Sequential view of the characters of an uncompressed
+//      archive, used by tar_index to erase the type of the Source from
+//      which it is built. read() returns fewer than n characters only at the
+//      end of the archive; skip() discards n characters, returning false if
+//      the end of the archive is reached first.
+//
+class BOOST_IOSTREAMS_DECL tar_reader {
+public:
+    virtual ~tar_reader();
+    virtual std::size_t read(char* s, std::size_t n) = 0;
+    virtual bool skip(stream_offset n) = 0;
+};
+
+} // End namespace detail.
+
+//
+// Class name: tar_index.
+// Description: The members of an archive, in the order in which they
+//      appear, together with the checkpoints from which a compressed archive
+//      may be decompressed. An index may be saved to a Sink and loaded from
+//      a Source, so that an archive need be read only once.
+//
+class BOOST_IOSTREAMS_DECL tar_index {
+public:
+    typedef std::vector<tar_entry>::size_type       size_type;
+    typedef std::vector<tar_entry>::const_iterator  const_iterator;
+
+    size_type size() const { return entries_.size(); }
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+    const tar_entry& operator[](size_type n) const { return entries_[n]; }
+
+    // Returns the last entry with the given name, or a null pointer.
+    const tar_entry* find(const std::string& name) const;
+
+    // Returns the checkpoints, in order of increasing uncompressed offset;
+    // empty for an uncompressed archive.
+    const std::vector<zlib_checkpoint>& checkpoints() const
+    { return checkpoints_; }
+
+    // Returns the last checkpoint at or before the given uncompressed
+    // offset, or a null pointer.
+    const zlib_checkpoint* checkpoint(stream_offset off) const;
+
+    // Writes the index to the given Sink.
+    template<typename Sink>
+    void save(Sink& snk) const { save(snk, is_direct<Sink>()); }
+
+    // Replaces the index with one read from the given Source.
+    template<typename Source>
+    void load(Source& src) { load(src, is_direct<Source>()); }
+
+    // Replaces the index with the members read from the given archive;
+    // for use by basic_tar_archive and basic_tar_gz_archive.
+    void build(detail::tar_reader& in);
+    void add_checkpoint(const zlib_checkpoint& cp);
+private:
+    template<typename Sink>
+    void save(Sink& snk, mpl::true_) const
+    {
+        detail::direct_adapter<Sink> out(snk);
+        save(out, mpl::false_());
+    }
+    template<typename Sink>
+    void save(Sink& snk, mpl::false_) const
+    {
+        std::string      data = serialize();
+        const char*      s = data.data();
+        std::streamsize  n = static_cast<std::streamsize>(data.size());
+        while (n != 0) {
+            std::streamsize amt = iostreams::write(snk, s, n);
+            s += amt;
+            n -= amt;
+        }
+    }
+    template<typename Source>
+    void load(Source& src, mpl::true_)
+    {
+        detail::direct_adapter<Source> in(src);
+        load(in, mpl::false_());
+    }
+    template<typename Source>
+    void load(Source& src, mpl::false_)
+    {
+        std::string      data;
+        char             buf[4096];
+        std::streamsize  amt;
+        while ((amt = iostreams::read(src, buf, sizeof(buf))) != -1)
+            data.append(buf, static_cast<std::size_t>(amt));
+        deserialize(data);
+    }
+    std::string serialize() const;
+    void deserialize(const std::string& data);
+    void sort();
+    std::vector<tar_entry>        entries_;
+    std::vector<std::size_t>      sorted_;  // Indices of entries, by name.
+    std::vector<zlib_checkpoint>  checkpoints_;
+};
+
+namespace detail {
+
+template<typename Device>
+class tar_direct_reader : public tar_reader {
+public:
+    explicit tar_direct_reader(const Device& dev) : dev_(dev), pos_(0)
+    {
+        std::pair<char*, char*> seq = iostreams::input_sequence(dev_);
+        begin_ = seq.first;
+        size_ = static_cast<stream_offset>(seq.second - seq.first);
+    }
+    std::size_t read(char* s, std::size_t n)
+    {
+        if (static_cast<stream_offset>(n) > size_ - pos_)
+            n = static_cast<std::size_t>(size_ - pos_);
+        std::char_traits<char>::copy(s, begin_ + pos_, n);
+        pos_ += n;
+        return n;
+    }
+    bool skip(stream_offset n)
+    {
+        if (n > size_ - pos_) {
+            pos_ = size_;
+            return false;
+        }
+        pos_ += n;
+        return true;
+    }
+private:
+    Device         dev_;
+    const char*    begin_;
+    stream_offset  size_;
+    stream_offset  pos_;
+};
+
+template<typename Device>
+class tar_indirect_reader : public tar_reader {
+public:
+    explicit tar_indirect_reader(Device& dev) : dev_(dev), pos_(0)
+    {
+        size_ = position_to_offset(
+            iostreams::seek(dev_, 0, BOOST_IOS::end, BOOST_IOS::in)
+        );
+        iostreams::seek(dev_, 0, BOOST_IOS::beg, BOOST_IOS::in);
+    }
+    std::size_t read(char* s, std::size_t n)
+    {
+        std::size_t result = 0;
+        while (result < n) {
+            std::streamsize amt =
+                iostreams::read( dev_, s + result,
+                                 static_cast<std::streamsize>(n - result) );
+            if (amt == -1)
+                break;
+            result += static_cast<std::size_t>(amt);
+        }
+        pos_ += static_cast<stream_offset>(result);
+        return result;
+    }
+    bool skip(stream_offset n)
+    {
+        bool result = n <= size_ - pos_;
+        if (!result)
+            n = size_ - pos_;
+        iostreams::seek(dev_, n, BOOST_IOS::cur, BOOST_IOS::in);
+        pos_ += n;
+        return result;
+    }
+private:
+    Device&        dev_;
+    stream_offset  size_;
+    stream_offset  pos_;
+};
+
+// Reads a gzip-compressed archive from the start of the given Source,
+// recording checkpoints in the given index.
+template<typename Source>
+class tar_gz_reader : public tar_reader {
+public:
+    tar_gz_reader( Source& src, tar_index& index,
+                   std::streamsize spacing )
+        : src_(src), index_(index)
+        { gzip_.enable_checkpoints(spacing); }
+    std::size_t read(char* s, std::size_t n)
+    {
+        std::size_t result = 0;
+        while (result < n) {
+            std::streamsize amt =
+                gzip_.read( src_, s + result,
+                            static_cast<std::streamsize>(n - result) );
+            if (amt == -1)
+                break;
+            result += static_cast<std::size_t>(amt);
+            if (gzip_.has_checkpoint())
+                index_.add_checkpoint(gzip_.checkpoint());
+        }
+        return result;
+    }
+    bool skip(stream_offset n)
+    {
+        char buf[4096];
+        while (n != 0) {
+            std::size_t amt = static_cast<std::size_t>(
+                (std::min)(n, static_cast<stream_offset>(sizeof(buf)))
+            );
+            if (read(buf, amt) != amt)
+                return false;
+            n -= static_cast<stream_offset>(amt);
+        }
+        return true;
+    }
+private:
+    Source&            src_;
+    tar_index&         index_;
+    gzip_decompressor  gzip_;
+};
+
+// Returns a copy of the given Device positioned at the start of the archive,
+// since restriction skips relative to the current position of a copy which
+// may share its position with the Device.
+template<typename Device>
+Device tar_rewind(const Device& dev, mpl::true_) { return dev; }
+
+template<typename Device>
+Device tar_rewind(const Device& dev, mpl::false_)
+{
+    Device result(dev);
+    iostreams::seek(result, 0, BOOST_IOS::beg, BOOST_IOS::in);
+    return result;
+}
+
+template<typename Device>
+Device tar_rewind(const Device& dev)
+{ return tar_rewind(dev, is_direct<Device>()); }
+
+template<typename Device>
+struct tar_indirect_type
+    : mpl::if_<
+          is_direct<Device>,
+          direct_adapter<Device>,
+          Device
+      >
+    { };
+
+} // End namespace detail.
+
+//
+// Template name: tar_member_source.
+// Description: Restriction of a copy of the Source of an uncompressed
+//      archive to the contents of a member. Closing a tar_member_source does
+//      not close the Source, whose copies may share the underlying file or
+//      mapping with the archive.
+// Template parameters:
+//      Device - A model of Source which is seekable or Direct.
+//
+template<typename Device>
+class tar_member_source : public restriction<Device> {
+public:
+    struct category
+        : mode_of<Device>::type,
+          device_tag,
+          mpl::if_<
+              is_direct<Device>,
+              direct_tag,
+              optimally_buffered_tag
+          >::type
+        { };
+    tar_member_source(const Device& dev, const tar_entry& e)
+        : restriction<Device>(dev, e.data_offset, e.size)
+        { }
+};
+
+//
+// Template name: basic_tar_archive.
+// Description: Provides access to the members of an uncompressed archive
+//      stored in a copy of the given seekable Source. Members are read
+//      through restrictions of copies of the Source; if the copies of the
+//      Source share a position, as do those of file_descriptor_source, only
+//      one member may be read at a time.
+// Template parameters:
+//      Device - A model of Source which is seekable or Direct.
+//
+template<typename Device>
+class basic_tar_archive {
+public:
+    typedef tar_member_source<Device>     member_source;
+    typedef tar_index::size_type          size_type;
+    typedef tar_index::const_iterator     const_iterator;
+
+    // Builds the index by reading the headers of the archive.
+    explicit basic_tar_archive(const Device& dev)
+        : dev_(dev), index_(new tar_index)
+        { build(is_direct<Device>()); }
+
+    // Uses an index previously built for the same archive.
+    basic_tar_archive(const Device& dev, const tar_index& index)
+        : dev_(dev), index_(new tar_index(index))
+        { }
+
+    const tar_index& index() const { return *index_; }
+    size_type size() const { return index_->size(); }
+    const_iterator begin() const { return index_->begin(); }
+    const_iterator end() const { return index_->end(); }
+    const tar_entry& operator[](size_type n) const { return (*index_)[n]; }
+    const tar_entry* find(const std::string& name) const
+    { return index_->find(name); }
+
+    member_source open(const tar_entry& e) const
+    { return member_source(detail::tar_rewind(dev_), e); }
+
+    member_source open(const std::string& name) const
+    {
+        const tar_entry* e = find(name);
+        if (!e)
+            boost::throw_exception(tar_error(tar::member_not_found));
+        return open(*e);
+    }
+private:
+    void build(mpl::true_)
+    {
+        detail::tar_direct_reader<Device> in(dev_);
+        index_->build(in);
+    }
+    void build(mpl::false_)
+    {
+        Device dev(dev_);
+        detail::tar_indirect_reader<Device> in(dev);
+        index_->build(in);
+    }
+    Device                 dev_;
+    shared_ptr<tar_index>  index_;
+};
+
+//
+// Typedef name: tar_archive.
+// Description: A basic_tar_archive which reads a memory-mapped file.
+//
+typedef basic_tar_archive<mapped_file_source> tar_archive;
+
+//
+// Template name: tar_gz_member_source.
+// Description: Model of Source which reads the contents of a member of a
+//      gzip-compressed archive, decompressing from the last checkpoint
+//      preceding the member. Copies of a tar_gz_member_source share their
+//      position.
+//
+template<typename Device>
+class tar_gz_member_source {
+public:
+    typedef char        char_type;
+    typedef source_tag  category;
+    tar_gz_member_source( const Device& dev, const tar_index& index,
+                          const tar_entry& e )
+        : pimpl_(new impl(dev, index, e))
+        { }
+    std::streamsize read(char* s, std::streamsize n)
+    { return pimpl_->read(s, n); }
+    const tar_entry& entry() const { return pimpl_->entry_; }
+private:
+    typedef typename
+            detail::tar_indirect_type< restriction<Device> >::type
+            device_type;
+    struct impl {
+        impl(const Device& dev, const tar_index& index, const tar_entry& e)
+            : src_(restriction<Device>( detail::tar_rewind(dev),
+                                        start(index, e) )),
+              entry_(e),
+              skip_(e.data_offset), left_(e.size)
+        {
+            if (const zlib_checkpoint* cp = index.checkpoint(e.data_offset)) {
+                gzip_.restore(*cp);
+                skip_ -= cp->uncompressed_offset;
+            }
+        }
+        static stream_offset start(const tar_index& index, const tar_entry& e)
+        {
+            const zlib_checkpoint* cp = index.checkpoint(e.data_offset);
+            return cp ? cp->compressed_offset : 0;
+        }
+        std::streamsize read(char* s, std::streamsize n)
+        {
+            if (n == 0)
+                return 0;
+            while (skip_ != 0) {
+                std::streamsize amt =
+                    gzip_.read( src_, s,
+                                static_cast<std::streamsize>(
+                                    (std::min)(skip_, stream_offset(n))
+                                ) );
+                if (amt == -1)
+                    boost::throw_exception(tar_error(tar::unexpected_eof));
+                skip_ -= amt;
+            }
+            if (left_ == 0)
+                return -1;
+            std::streamsize result =
+                gzip_.read( src_, s,
+                            static_cast<std::streamsize>(
+                                (std::min)(left_, stream_offset(n))
+                            ) );
+            if (result == -1)
+                boost::throw_exception(tar_error(tar::unexpected_eof));
+            left_ -= result;
+            return result;
+        }
+        device_type        src_;
+        gzip_decompressor  gzip_;
+        tar_entry          entry_;
+        stream_offset      skip_;  // Characters preceding the member.
+        stream_offset      left_;  // Characters of the member not yet read.
+    };
+    shared_ptr<impl> pimpl_;
+};
+
+//
+// Template name: basic_tar_gz_archive.
+// Description: Provides access to the members of a gzip-compressed archive
+//      stored in a copy of the given seekable Source. Building the index
+//      decompresses the archive once, recording a checkpoint after every
+//      spacing characters of uncompressed data; each checkpoint holds 32K
+//      of uncompressed data, and reading a member decompresses up to
+//      spacing characters preceding it. If the copies of the Source share a
+//      position, only one member may be read at a time.
+// Template parameters:
+//      Device - A model of Source which is seekable or Direct.
+//
+template<typename Device>
+class basic_tar_gz_archive {
+public:
+    typedef tar_gz_member_source<Device>  member_source;
+    typedef tar_index::size_type          size_type;
+    typedef tar_index::const_iterator     const_iterator;
+
+    // Builds the index by decompressing the archive.
+    explicit basic_tar_gz_archive
+        ( const Device& dev,
+          std::streamsize spacing = tar::default_checkpoint_spacing )
+        : dev_(dev), index_(new tar_index)
+    {
+        typename detail::tar_indirect_type<Device>::type src(dev_);
+        detail::tar_gz_reader<
+            typename detail::tar_indirect_type<Device>::type
+        > in(src, *index_, spacing);
+        index_->build(in);
+    }
+
+    // Uses an index previously built for the same archive.
+    basic_tar_gz_archive(const Device& dev, const tar_index& index)
+        : dev_(dev), index_(new tar_index(index))
+        { }
+
+    const tar_index& index() const { return *index_; }
+    size_type size() const { return index_->size(); }
+    const_iterator begin() const { return index_->begin(); }
+    const_iterator end() const { return index_->end(); }
+    const tar_entry& operator[](size_type n) const { return (*index_)[n]; }
+    const tar_entry* find(const std::string& name) const
+    { return index_->find(name); }
+
+    member_source open(const tar_entry& e) const
+    { return member_source(dev_, *index_, e); }
+
+    member_source open(const std::string& name) const
+    {
+        const tar_entry* e = find(name);
+        if (!e)
+            boost::throw_exception(tar_error(tar::member_not_found));
+        return open(*e);
+    }
+private:
+    Device                 dev_;
+    shared_ptr<tar_index>  index_;
+};
+
+//
+// Typedef name: tar_gz_archive.
+// Description: A basic_tar_gz_archive which reads a memory-mapped file.
+//
+typedef basic_tar_gz_archive<mapped_file_source> tar_gz_archive;
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+#ifdef BOOST_MSVC
+# pragma warning(pop)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_TAR_ARCHIVE_HPP_INCLUDED
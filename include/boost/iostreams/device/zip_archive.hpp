@@ -0,0 +1,291 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definition of the class zip_archive, which reads the members
+// of a ZIP archive stored in a memory-mapped file or in any seekable
+// Source. The central directory is read once, when the archive is opened;
+// members may then be read through instances of zip_member_source, or
+// extracted in bulk by a group of threads. Members stored with the methods
+// "stored" and "deflated" are supported, as are ZIP64 archives; archives
+// spanning several disks and encrypted members are not.
+
+#ifndef BOOST_IOSTREAMS_ZIP_ARCHIVE_HPP_INCLUDED
+#define BOOST_IOSTREAMS_ZIP_ARCHIVE_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <cstddef>                              // size_t.
+#include <string>
+#include <utility>                              // pair.
+#include <vector>
+#include <boost/config.hpp>  // BOOST_PREVENT_MACRO_SUBSTITUTION.
+#include <boost/cstdint.hpp>                    // uint16_t, uint32_t.
+#include <boost/function.hpp>
+#include <boost/iostreams/categories.hpp>       // source_tag.
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/ios.hpp>       // failure, streamsize.
+#include <boost/iostreams/input_sequence.hpp>
+#include <boost/iostreams/positioning.hpp>      // stream_offset.
+#include <boost/iostreams/read.hpp>
+#include <boost/iostreams/seek.hpp>
+#include <boost/iostreams/traits.hpp>           // is_direct.
+#include <boost/mpl/if.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/thread/mutex.hpp>
+
+// Must come last.
+#ifdef BOOST_MSVC
+# pragma warning(push)
+# pragma warning(disable:4251 4231 4660)
+#endif
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace zip {
+
+                    // Status codes
+
+BOOST_IOSTREAMS_DECL extern const int okay;
+BOOST_IOSTREAMS_DECL extern const int bad_archive;
+BOOST_IOSTREAMS_DECL extern const int bad_local_header;
+BOOST_IOSTREAMS_DECL extern const int multiple_disks;
+BOOST_IOSTREAMS_DECL extern const int unsupported_method;
+BOOST_IOSTREAMS_DECL extern const int encrypted;
+BOOST_IOSTREAMS_DECL extern const int data_error;
+BOOST_IOSTREAMS_DECL extern const int crc_error;
+BOOST_IOSTREAMS_DECL extern const int unexpected_eof;
+BOOST_IOSTREAMS_DECL extern const int member_not_found;
+
+                    // Compression methods
+
+const int stored    = 0;
+const int deflated  = 8;
+
+} // End namespace zip.
+
+//
+// Class name: zip_error.
+// Description: Subclass of std::ios::failure thrown to indicate that an
+//      archive or one of its members is invalid or unsupported.
+//
+class BOOST_IOSTREAMS_DECL zip_error : public BOOST_IOSTREAMS_FAILURE {
+public:
+    explicit zip_error(int error);
+    int error() const { return error_; }
+    static void check BOOST_PREVENT_MACRO_SUBSTITUTION(int error);
+private:
+    int error_;
+};
+
+// Returns the category of the values of the status codes in namespace zip.
+BOOST_IOSTREAMS_DECL const boost::system::error_category& zip_category();
+
+//
+// Class name: zip_entry.
+// Description: Description of an archive member, taken from the central
+//      directory. Sizes and offsets are in characters; header_offset is
+//      the position of the member's local header within the archive.
+//
+struct zip_entry {
+    zip_entry()
+        : method(zip::stored), flags(0), crc(0), compressed_size(0),
+          size(0), header_offset(0)
+        { }
+    bool is_directory() const
+    { return !name.empty() && name[name.size() - 1] == '/'; }
+    std::string      name;
+    int              method;
+    boost::uint16_t  flags;
+    boost::uint32_t  crc;
+    stream_offset    compressed_size;
+    stream_offset    size;
+    stream_offset    header_offset;
+};
+
+namespace detail {
+
+class zip_archive_impl;
+
+//
+// Class name: zip_device.
+// Description: Random-access view of the characters of an archive, used by
+//      zip_archive to erase the type of the Device from which it reads.
+//      read_at() may be called from several threads at once; data()
+//      returns the characters of the archive, if they are stored
+//      contiguously in memory, and a null pointer otherwise.
+//
+class BOOST_IOSTREAMS_DECL zip_device {
+public:
+    virtual ~zip_device();
+    virtual stream_offset size() = 0;
+    virtual const char* data() = 0;
+    virtual std::streamsize
+    read_at(stream_offset off, char* s, std::streamsize n) = 0;
+};
+
+template<typename Device>
+class zip_direct_device : public zip_device {
+public:
+    explicit zip_direct_device(const Device& dev) : dev_(dev)
+    {
+        std::pair<char*, char*> seq = iostreams::input_sequence(dev_);
+        begin_ = seq.first;
+        size_ = static_cast<stream_offset>(seq.second - seq.first);
+    }
+    stream_offset size() { return size_; }
+    const char* data() { return begin_; }
+    std::streamsize read_at(stream_offset off, char* s, std::streamsize n)
+    {
+        if (off >= size_)
+            return 0;
+        if (n > size_ - off)
+            n = static_cast<std::streamsize>(size_ - off);
+        std::char_traits<char>::copy(s, begin_ + off, n);
+        return n;
+    }
+private:
+    Device         dev_;
+    const char*    begin_;
+    stream_offset  size_;
+};
+
+template<typename Device>
+class zip_indirect_device : public zip_device {
+public:
+    explicit zip_indirect_device(const Device& dev) : dev_(dev)
+    { size_ = iostreams::seek(dev_, 0, BOOST_IOS::end, BOOST_IOS::in); }
+    stream_offset size() { return size_; }
+    const char* data() { return 0; }
+    std::streamsize read_at(stream_offset off, char* s, std::streamsize n)
+    {
+        mutex::scoped_lock lock(mtx_);
+        iostreams::seek(dev_, off, BOOST_IOS::beg, BOOST_IOS::in);
+        std::streamsize result = 0;
+        while (result < n) {
+            std::streamsize amt =
+                iostreams::read(dev_, s + result, n - result);
+            if (amt == -1)
+                break;
+            result += amt;
+        }
+        return result;
+    }
+private:
+    Device         dev_;
+    stream_offset  size_;
+    mutex          mtx_;
+};
+
+template<typename Device>
+struct zip_device_type
+    : mpl::if_<
+          is_direct<Device>,
+          zip_direct_device<Device>,
+          zip_indirect_device<Device>
+      >
+    { };
+
+} // End namespace detail.
+
+//
+// Class name: zip_member_source.
+// Description: Model of Source which reads the uncompressed contents of an
+//      archive member. The CRC and size of the contents are verified when
+//      the end of the member is reached; a zip_error is thrown if they do
+//      not match the central directory. Copies of a zip_member_source
+//      share their position, and remain valid after the zip_archive from
+//      which they were obtained has been destroyed.
+//
+class BOOST_IOSTREAMS_DECL zip_member_source {
+public:
+    typedef char        char_type;
+    typedef source_tag  category;
+    std::streamsize read(char* s, std::streamsize n);
+    const zip_entry& entry() const;
+private:
+    friend class zip_archive;
+    class impl;
+    explicit zip_member_source(impl* pimpl);
+    shared_ptr<impl> pimpl_;
+};
+
+//
+// Class name: zip_archive.
+// Description: Index of the members of a ZIP archive, built from its
+//      central directory. Instances are immutable once constructed, and may
+//      be used by several threads at once.
+//
+class BOOST_IOSTREAMS_DECL zip_archive {
+public:
+    typedef std::vector<zip_entry>::size_type       size_type;
+    typedef std::vector<zip_entry>::const_iterator  const_iterator;
+
+    // Type of the function object invoked by extract() with the
+    // uncompressed contents of each member; the characters are only valid
+    // for the duration of the call.
+    typedef boost::function<
+                void (const zip_entry&, const char*, std::size_t)
+            >                                       extract_handler;
+
+    // Opens the archive with the given pathname by mapping it into memory.
+    explicit zip_archive(const std::string& path);
+    explicit zip_archive(const char* path);
+
+    // Reads the archive from a copy of the given seekable Source. Sources
+    // which provide direct access to their characters, such as
+    // mapped_file_source and array_source, are read without locking or
+    // copying; others are read under a lock, one member at a time.
+    template<typename Device>
+    explicit zip_archive(const Device& dev)
+    { init(new typename detail::zip_device_type<Device>::type(dev)); }
+
+    size_type size() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+    const zip_entry& operator[](size_type n) const;
+
+    // Returns the entry with the given name, or a null pointer.
+    const zip_entry* find(const std::string& name) const;
+
+    zip_member_source open(const zip_entry& e) const;
+    zip_member_source open(const std::string& name) const;
+
+    // Returns the contents of a stored member of an archive which is held
+    // in memory, without copying; returns a pair of null pointers for other
+    // members. The CRC of the contents is not verified.
+    std::pair<const char*, const char*> data(const zip_entry& e) const;
+
+    // Passes the uncompressed contents of each member other than a
+    // directory, or of each of the given members, to handler, decompressing
+    // members concurrently on the given number of threads; if threads is
+    // zero, the number of hardware threads is used. The handler is invoked
+    // on the worker threads, in no particular order. Stored members of an
+    // archive held in memory are passed without copying. If decompression
+    // or the handler fails, the remaining members are skipped and the first
+    // exception is rethrown once all threads have finished.
+    void extract(const extract_handler& handler, unsigned threads = 0) const;
+    void extract( const std::vector<size_type>& members,
+                  const extract_handler& handler,
+                  unsigned threads = 0 ) const;
+private:
+    void init(detail::zip_device* dev);
+    shared_ptr<detail::zip_archive_impl> pimpl_;
+};
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+#ifdef BOOST_MSVC
+# pragma warning(pop)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_ZIP_ARCHIVE_HPP_INCLUDED
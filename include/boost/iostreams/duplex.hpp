@@ -0,0 +1,250 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definition of the class template basic_duplex_stream, which
+// performs filtered i/o in both directions on a single Device through an
+// input chain and an output chain which may be used concurrently from
+// different threads. A bidirectional filtering_stream performs both
+// directions through a single chain of stream buffers, so that a thread
+// blocked writing to a socket prevents another from reading from it. The
+// chains of a basic_duplex_stream have their own stream buffers, buffers and
+// stream state, and share only the Device:
+//
+//     duplex_stream io;
+//     io.push(zlib_decompressor(), zlib_compressor());
+//     io.open(file_descriptor(sock, never_close_handle));
+//     boost::thread reader(boost::bind(&receive, boost::ref(io.in())));
+//     io.out() << request;
+//     io.close_out();  // Writes the compressor's trailer.
+//     reader.join();
+
+#ifndef BOOST_IOSTREAMS_DUPLEX_HPP_INCLUDED
+#define BOOST_IOSTREAMS_DUPLEX_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <memory>                                  // allocator.
+#include <boost/atomic.hpp>
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/close.hpp>
+#include <boost/iostreams/detail/char_traits.hpp>
+#include <boost/iostreams/detail/ios.hpp>          // openmode, streamsize.
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/flush.hpp>
+#include <boost/iostreams/optimal_buffer_size.hpp>
+#include <boost/iostreams/read.hpp>
+#include <boost/iostreams/traits.hpp>
+#include <boost/iostreams/write.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_convertible.hpp>
+
+// Must come last.
+#include <boost/iostreams/detail/config/disable_warnings.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace detail {
+
+//
+// Template name: duplex_device.
+// Description: Device shared by the chains of a basic_duplex_stream. A
+//      Device with two sequences, such as combined_device, is closed one
+//      direction at a time; other Devices, such as file_descriptor, are
+//      closed when the second direction is closed.
+// Template parameters:
+//      Device - An indirect model of BidirectionalDevice or SeekableDevice
+//          which may be read and written concurrently.
+//
+template<typename Device>
+class duplex_device : private noncopyable {
+public:
+    typedef typename mode_of<Device>::type mode;
+    BOOST_STATIC_ASSERT(is_device<Device>::value);
+    BOOST_STATIC_ASSERT(!is_direct<Device>::value);
+    BOOST_STATIC_ASSERT((is_convertible<mode, input>::value));
+    BOOST_STATIC_ASSERT((is_convertible<mode, output>::value));
+    explicit duplex_device(const Device& dev) : dev_(dev), open_(2) { }
+    Device& device() { return dev_; }
+    void close(BOOST_IOS::openmode which)
+    {
+        if (is_convertible<mode, two_sequence>::value)
+            iostreams::close(dev_, which);
+        else if (--open_ == 0)
+            iostreams::close(dev_);
+    }
+private:
+    Device              dev_;
+    boost::atomic<int>  open_;  // Number of directions not yet closed.
+};
+
+//
+// Template name: duplex_source.
+// Description: Source which reads from the Device of a basic_duplex_stream.
+//
+template<typename Device>
+class duplex_source {
+public:
+    typedef typename char_type_of<Device>::type  char_type;
+    struct category
+        : input,
+          device_tag,
+          closable_tag,
+          optimally_buffered_tag
+        { };
+    explicit duplex_source(const shared_ptr< duplex_device<Device> >& dev)
+        : dev_(dev)
+        { }
+    std::streamsize read(char_type* s, std::streamsize n)
+    { return iostreams::read(dev_->device(), s, n); }
+    void close() { dev_->close(BOOST_IOS::in); }
+    std::streamsize optimal_buffer_size() const
+    { return iostreams::optimal_buffer_size(dev_->device()); }
+private:
+    shared_ptr< duplex_device<Device> > dev_;
+};
+
+//
+// Template name: duplex_sink.
+// Description: Sink which writes to the Device of a basic_duplex_stream.
+//      Only the output chain flushes the Device.
+//
+template<typename Device>
+class duplex_sink {
+public:
+    typedef typename char_type_of<Device>::type  char_type;
+    struct category
+        : output,
+          device_tag,
+          closable_tag,
+          flushable_tag,
+          optimally_buffered_tag
+        { };
+    explicit duplex_sink(const shared_ptr< duplex_device<Device> >& dev)
+        : dev_(dev)
+        { }
+    std::streamsize write(const char_type* s, std::streamsize n)
+    { return iostreams::write(dev_->device(), s, n); }
+    bool flush() { return iostreams::flush(dev_->device()); }
+    void close() { dev_->close(BOOST_IOS::out); }
+    std::streamsize optimal_buffer_size() const
+    { return iostreams::optimal_buffer_size(dev_->device()); }
+private:
+    shared_ptr< duplex_device<Device> > dev_;
+};
+
+} // End namespace detail.
+
+//
+// Template name: basic_duplex_stream.
+// Description: Pair of filtering streams, one for input and one for output,
+//      which end in the same Device. Each direction has its own filters,
+//      buffers and stream state, so that in() may be used by one thread
+//      while out() is used by another; each stream, like any other, must be
+//      used by one thread at a time. Flushing out() flushes only the output
+//      chain and the Device; closing either direction closes only the
+//      filters of that direction.
+// Template parameters:
+//      Ch - The character type.
+//      Tr - The character traits type.
+//      Alloc - The allocator type.
+//
+template< typename Ch,
+          typename Tr = BOOST_IOSTREAMS_CHAR_TRAITS(Ch),
+          typename Alloc = std::allocator<Ch> >
+class basic_duplex_stream : private noncopyable {
+public:
+    typedef Ch                                       char_type;
+    typedef filtering_stream<input, Ch, Tr, Alloc>   istream_type;
+    typedef filtering_stream<output, Ch, Tr, Alloc>  ostream_type;
+
+    ~basic_duplex_stream()
+    {
+        try {
+            close();
+        } catch (...) { }
+    }
+
+    // Appends an input filter to the input chain and an output filter to
+    // the output chain. Since the filters are used by different threads,
+    // they must not share state; in particular, a single bidirectional
+    // filter cannot be split between the chains.
+    template<typename InputFilter, typename OutputFilter>
+    void push( const InputFilter& in, const OutputFilter& out,
+               std::streamsize buffer_size = -1,
+               std::streamsize pback_size = -1 )
+    {
+        BOOST_STATIC_ASSERT(is_filter<InputFilter>::value);
+        BOOST_STATIC_ASSERT(is_filter<OutputFilter>::value);
+        in_.push(in, buffer_size, pback_size);
+        out_.push(out, buffer_size, pback_size);
+    }
+
+    // Completes both chains with the given Device, which must support a
+    // read concurrent with a write, as does file_descriptor for a pipe or
+    // socket.
+    template<typename Device>
+    void open( const Device& dev, std::streamsize buffer_size = -1,
+               std::streamsize pback_size = -1 )
+    {
+        shared_ptr< detail::duplex_device<Device> >
+            shared(new detail::duplex_device<Device>(dev));
+        in_.push( detail::duplex_source<Device>(shared),
+                  buffer_size, pback_size );
+        try {
+            out_.push( detail::duplex_sink<Device>(shared),
+                       buffer_size, pback_size );
+        } catch (...) {
+            in_.reset();
+            throw;
+        }
+    }
+
+    istream_type& in() { return in_; }
+    ostream_type& out() { return out_; }
+    bool is_complete() const
+    { return in_.is_complete() && out_.is_complete(); }
+
+    // Closes and removes the filters of the input chain.
+    void close_in() { in_.reset(); }
+
+    // Closes and removes the filters of the output chain, writing any data
+    // they have buffered, such as a compressor's trailer.
+    void close_out() { out_.reset(); }
+
+    void close()
+    {
+        try {
+            close_out();
+        } catch (...) {
+            try {
+                close_in();
+            } catch (...) { }
+            throw;
+        }
+        close_in();
+    }
+private:
+    istream_type  in_;
+    ostream_type  out_;
+};
+
+//
+// Typedef names: duplex_stream, wduplex_stream.
+// Description: basic_duplex_streams with character types char and wchar_t.
+//
+typedef basic_duplex_stream<char>     duplex_stream;
+typedef basic_duplex_stream<wchar_t>  wduplex_stream;
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/iostreams/detail/config/enable_warnings.hpp>
+
+#endif // #ifndef BOOST_IOSTREAMS_DUPLEX_HPP_INCLUDED
@@ -0,0 +1,488 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2005-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains overloads of the operations read, write, seek and close which
+// report errors by setting a boost::system::error_code rather than by
+// throwing an exception, together with the error category used for errors
+// which have no more specific category.
+//
+// Components whose category is convertible to error_code_tag implement
+// non-throwing versions of their member functions, taking an additional
+// error_code& argument:
+//
+//      Devices: read(s, n, ec), write(s, n, ec), seek(off, way, ec) -- or
+//               seek(off, way, which, ec) for two-head devices -- and
+//               close(ec) -- or close(which, ec) for two-sequence devices.
+//      Filters: read(src, s, n, ec), write(snk, s, n, ec) and
+//               close(dev, ec) -- or close(dev, which, ec) for
+//               two-sequence and dual-use filters.
+//
+// The operations below call these functions directly. For other components
+// they call the ordinary operation and convert any exception derived from
+// std::exception into an error_code, so that callers need not distinguish
+// between the two cases. On error, read returns -1, write returns the number
+// of characters consumed before the error occurred and seek returns -1.
+
+#ifndef BOOST_IOSTREAMS_ERROR_CODE_HPP_INCLUDED
+#define BOOST_IOSTREAMS_ERROR_CODE_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <exception>
+#include <new>                                    // bad_alloc.
+#include <string>
+#include <boost/config.hpp>                       // BOOST_DEDUCED_TYPENAME.
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/detail/select.hpp>
+#include <boost/iostreams/operations.hpp>
+#include <boost/iostreams/positioning.hpp>
+#include <boost/iostreams/traits.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/mpl/not.hpp>
+#include <boost/mpl/or.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/system/system_error.hpp>
+#include <boost/type_traits/is_convertible.hpp>
+
+// Must come last.
+#include <boost/iostreams/detail/config/disable_warnings.hpp>
+
+namespace boost { namespace iostreams {
+
+//------------------Definition of iostreams_category--------------------------//
+
+namespace errors {
+
+    // Error codes in iostreams_category().
+
+enum error_type {
+    failure      = 1,  // Unclassified failure, e.g., a user-defined exception.
+    bad_read     = 2,
+    bad_write    = 3,
+    bad_seek     = 4,
+    bad_putback  = 5
+};
+
+} // End namespace errors.
+
+} } // End namespaces iostreams, boost.
+
+namespace boost { namespace system {
+
+template<>
+struct is_error_code_enum<boost::iostreams::errors::error_type> {
+    BOOST_STATIC_CONSTANT(bool, value = true);
+};
+
+} } // End namespaces system, boost.
+
+namespace boost { namespace iostreams {
+
+namespace detail {
+
+class iostreams_category_impl : public boost::system::error_category {
+public:
+    const char* name() const BOOST_SYSTEM_NOEXCEPT { return "iostreams"; }
+    std::string message(int ev) const
+    {
+        switch (ev) {
+        case errors::failure:     return "iostreams failure";
+        case errors::bad_read:    return "bad read";
+        case errors::bad_write:   return "bad write";
+        case errors::bad_seek:    return "bad seek";
+        case errors::bad_putback: return "putback buffer full";
+        default:                  return "unknown iostreams error";
+        }
+    }
+};
+
+} // End namespace detail.
+
+inline const boost::system::error_category& iostreams_category()
+{
+    static const detail::iostreams_category_impl instance;
+    return instance;
+}
+
+namespace errors {
+
+inline boost::system::error_code make_error_code(error_type e)
+{ return boost::system::error_code(static_cast<int>(e), iostreams_category()); }
+
+} // End namespace errors.
+
+//------------------Definition of reports_error_codes-------------------------//
+
+template<typename T>
+struct reports_error_codes : detail::has_trait<T, error_code_tag> { };
+
+namespace detail {
+
+// Stores in ec the error code corresponding to the exception currently
+// being handled; must be called from within a catch block.
+inline void set_error_code(boost::system::error_code& ec)
+{
+    try {
+        throw;
+    } catch (const std::bad_alloc&) {
+        ec = boost::system::errc::make_error_code(
+                 boost::system::errc::not_enough_memory
+             );
+    } catch (const boost::system::system_error& e) {
+        ec = e.code();
+    } catch (const std::exception&) {
+        ec = errors::failure;
+    }
+}
+
+// Stores next in first, unless first already holds an error.
+inline void keep_first_error( boost::system::error_code& first,
+                              const boost::system::error_code& next )
+{
+    if (!first)
+        first = next;
+}
+
+//------------------Definition of error_code_impl-----------------------------//
+
+template<bool ReportsErrorCodes>
+struct error_code_impl;
+
+// Selects the member function close() of a component which reports errors
+// through an error_code: any_tag if the component is not closable, in which
+// case the ordinary close() operation is used.
+template<typename T>
+struct error_code_close_tag {
+    typedef typename category_of<T>::type category;
+    typedef typename
+            iostreams::select<
+                mpl::not_< is_convertible<category, closable_tag> >,
+                any_tag,
+                mpl::or_<
+                    is_convertible<category, two_sequence>,
+                    is_convertible<category, dual_use>
+                >,
+                two_sequence,
+                else_,
+                closable_tag
+            >::type type;
+};
+
+// Components which report errors by throwing exceptions
+template<>
+struct error_code_impl<false> {
+    template<typename T>
+    static std::streamsize
+    read( T& t, typename char_type_of<T>::type* s, std::streamsize n,
+          boost::system::error_code& ec )
+    {
+        try {
+            return iostreams::read(t, s, n);
+        } catch (const std::exception&) {
+            set_error_code(ec);
+            return -1;
+        }
+    }
+
+    template<typename T, typename Source>
+    static std::streamsize
+    read( T& t, Source& src, typename char_type_of<T>::type* s,
+          std::streamsize n, boost::system::error_code& ec )
+    {
+        try {
+            return iostreams::read(t, src, s, n);
+        } catch (const std::exception&) {
+            set_error_code(ec);
+            return -1;
+        }
+    }
+
+    template<typename T>
+    static std::streamsize
+    write( T& t, const typename char_type_of<T>::type* s, std::streamsize n,
+           boost::system::error_code& ec )
+    {
+        try {
+            return iostreams::write(t, s, n);
+        } catch (const std::exception&) {
+            set_error_code(ec);
+            return 0;
+        }
+    }
+
+    template<typename T, typename Sink>
+    static std::streamsize
+    write( T& t, Sink& snk, const typename char_type_of<T>::type* s,
+           std::streamsize n, boost::system::error_code& ec )
+    {
+        try {
+            return iostreams::write(t, snk, s, n);
+        } catch (const std::exception&) {
+            set_error_code(ec);
+            return 0;
+        }
+    }
+
+    template<typename T>
+    static std::streampos
+    seek( T& t, stream_offset off, BOOST_IOS::seekdir way,
+          BOOST_IOS::openmode which, boost::system::error_code& ec )
+    {
+        try {
+            return iostreams::seek(t, off, way, which);
+        } catch (const std::exception&) {
+            set_error_code(ec);
+            return offset_to_position(-1);
+        }
+    }
+
+    template<typename T>
+    static void close( T& t, BOOST_IOS::openmode which,
+                       boost::system::error_code& ec )
+    {
+        try {
+            iostreams::close(t, which);
+        } catch (const std::exception&) {
+            set_error_code(ec);
+        }
+    }
+
+    template<typename T, typename Sink>
+    static void close( T& t, Sink& snk, BOOST_IOS::openmode which,
+                       boost::system::error_code& ec )
+    {
+        try {
+            iostreams::close(t, snk, which);
+        } catch (const std::exception&) {
+            set_error_code(ec);
+        }
+    }
+};
+
+// Components which report errors through an error_code
+template<>
+struct error_code_impl<true> {
+    template<typename T>
+    static std::streamsize
+    read( T& t, typename char_type_of<T>::type* s, std::streamsize n,
+          boost::system::error_code& ec )
+    { return t.read(s, n, ec); }
+
+    template<typename T, typename Source>
+    static std::streamsize
+    read( T& t, Source& src, typename char_type_of<T>::type* s,
+          std::streamsize n, boost::system::error_code& ec )
+    { return t.read(src, s, n, ec); }
+
+    template<typename T>
+    static std::streamsize
+    write( T& t, const typename char_type_of<T>::type* s, std::streamsize n,
+           boost::system::error_code& ec )
+    { return t.write(s, n, ec); }
+
+    template<typename T, typename Sink>
+    static std::streamsize
+    write( T& t, Sink& snk, const typename char_type_of<T>::type* s,
+           std::streamsize n, boost::system::error_code& ec )
+    { return t.write(snk, s, n, ec); }
+
+    template<typename T>
+    static std::streampos
+    seek( T& t, stream_offset off, BOOST_IOS::seekdir way,
+          BOOST_IOS::openmode which, boost::system::error_code& ec )
+    {
+        typedef typename category_of<T>::type           category;
+        typedef mpl::bool_<
+                    is_convertible<category, two_head>::value
+                >                                       is_two_head;
+        return seek(t, off, way, which, ec, is_two_head());
+    }
+
+    template<typename T>
+    static std::streampos
+    seek( T& t, stream_offset off, BOOST_IOS::seekdir way,
+          BOOST_IOS::openmode which, boost::system::error_code& ec,
+          mpl::true_ )
+    { return t.seek(off, way, which, ec); }
+
+    template<typename T>
+    static std::streampos
+    seek( T& t, stream_offset off, BOOST_IOS::seekdir way,
+          BOOST_IOS::openmode, boost::system::error_code& ec, mpl::false_ )
+    { return t.seek(off, way, ec); }
+
+    template<typename T>
+    static void close( T& t, BOOST_IOS::openmode which,
+                       boost::system::error_code& ec )
+    { close(t, which, ec, BOOST_DEDUCED_TYPENAME error_code_close_tag<T>::type()); }
+
+    template<typename T>
+    static void close( T& t, BOOST_IOS::openmode which,
+                       boost::system::error_code& ec, any_tag )
+    { error_code_impl<false>::close(t, which, ec); }
+
+    template<typename T>
+    static void close( T& t, BOOST_IOS::openmode which,
+                       boost::system::error_code& ec, two_sequence )
+    { t.close(which, ec); }
+
+    template<typename T>
+    static void close( T& t, BOOST_IOS::openmode which,
+                       boost::system::error_code& ec, closable_tag )
+    {
+        typedef typename category_of<T>::type category;
+        const bool in =  is_convertible<category, input>::value &&
+                        !is_convertible<category, output>::value;
+        if (in == (which == BOOST_IOS::in))
+            t.close(ec);
+    }
+
+    template<typename T, typename Sink>
+    static void close( T& t, Sink& snk, BOOST_IOS::openmode which,
+                       boost::system::error_code& ec )
+    { 
+        close( t, snk, which, ec, 
+               BOOST_DEDUCED_TYPENAME error_code_close_tag<T>::type() ); 
+    }
+
+    template<typename T, typename Sink>
+    static void close( T& t, Sink& snk, BOOST_IOS::openmode which,
+                       boost::system::error_code& ec, any_tag )
+    { error_code_impl<false>::close(t, snk, which, ec); }
+
+    template<typename T, typename Sink>
+    static void close( T& t, Sink& snk, BOOST_IOS::openmode which,
+                       boost::system::error_code& ec, two_sequence )
+    { t.close(snk, which, ec); }
+
+    template<typename T, typename Sink>
+    static void close( T& t, Sink& snk, BOOST_IOS::openmode which,
+                       boost::system::error_code& ec, closable_tag )
+    {
+        typedef typename category_of<T>::type category;
+        const bool in =  is_convertible<category, input>::value &&
+                        !is_convertible<category, output>::value;
+        if (in == (which == BOOST_IOS::in))
+            t.close(snk, ec);
+    }
+};
+
+template<typename T>
+struct error_code_dispatch
+    : error_code_impl<
+          reports_error_codes<
+              BOOST_DEDUCED_TYPENAME detail::unwrapped_type<T>::type
+          >::value
+      >
+    { };
+
+} // End namespace detail.
+
+//------------------Definition of the non-throwing operations-----------------//
+
+template<typename T>
+std::streamsize
+read( T& t, typename char_type_of<T>::type* s, std::streamsize n,
+      boost::system::error_code& ec )
+{
+    ec.clear();
+    return detail::error_code_dispatch<T>::read(detail::unwrap(t), s, n, ec);
+}
+
+template<typename T, typename Source>
+std::streamsize
+read( T& t, Source& src, typename char_type_of<T>::type* s,
+      std::streamsize n, boost::system::error_code& ec )
+{
+    ec.clear();
+    return detail::error_code_dispatch<T>::read(detail::unwrap(t), src, s, n, ec);
+}
+
+template<typename T>
+std::streamsize
+write( T& t, const typename char_type_of<T>::type* s, std::streamsize n,
+       boost::system::error_code& ec )
+{
+    ec.clear();
+    return detail::error_code_dispatch<T>::write(detail::unwrap(t), s, n, ec);
+}
+
+template<typename T, typename Sink>
+std::streamsize
+write( T& t, Sink& snk, const typename char_type_of<T>::type* s,
+       std::streamsize n, boost::system::error_code& ec )
+{
+    ec.clear();
+    return detail::error_code_dispatch<T>::write(detail::unwrap(t), snk, s, n, ec);
+}
+
+template<typename T>
+std::streampos
+seek( T& t, stream_offset off, BOOST_IOS::seekdir way,
+      BOOST_IOS::openmode which, boost::system::error_code& ec )
+{
+    ec.clear();
+    return detail::error_code_dispatch<T>::seek(
+               detail::unwrap(t), off, way, which, ec
+           );
+}
+
+template<typename T>
+std::streampos
+seek( T& t, stream_offset off, BOOST_IOS::seekdir way,
+      boost::system::error_code& ec )
+{ return iostreams::seek(t, off, way, BOOST_IOS::in | BOOST_IOS::out, ec); }
+
+// Closes t for reading, for writing or, if which is in | out, for both; in
+// the last case, both sequences are closed even if the first close fails,
+// and ec reports the first error.
+template<typename T>
+void close( T& t, BOOST_IOS::openmode which, boost::system::error_code& ec )
+{
+    ec.clear();
+    if (which == (BOOST_IOS::in | BOOST_IOS::out)) {
+        boost::system::error_code out;
+        detail::error_code_dispatch<T>::close(
+            detail::unwrap(t), BOOST_IOS::in, ec
+        );
+        detail::error_code_dispatch<T>::close(
+            detail::unwrap(t), BOOST_IOS::out, out
+        );
+        detail::keep_first_error(ec, out);
+    } else {
+        detail::error_code_dispatch<T>::close(detail::unwrap(t), which, ec);
+    }
+}
+
+template<typename T, typename Sink>
+void close( T& t, Sink& snk, BOOST_IOS::openmode which,
+            boost::system::error_code& ec )
+{
+    ec.clear();
+    if (which == (BOOST_IOS::in | BOOST_IOS::out)) {
+        boost::system::error_code out;
+        detail::error_code_dispatch<T>::close(
+            detail::unwrap(t), snk, BOOST_IOS::in, ec
+        );
+        detail::error_code_dispatch<T>::close(
+            detail::unwrap(t), snk, BOOST_IOS::out, out
+        );
+        detail::keep_first_error(ec, out);
+    } else {
+        detail::error_code_dispatch<T>::close(
+            detail::unwrap(t), snk, which, ec
+        );
+    }
+}
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/iostreams/detail/config/enable_warnings.hpp>
+
+#endif // #ifndef BOOST_IOSTREAMS_ERROR_CODE_HPP_INCLUDED
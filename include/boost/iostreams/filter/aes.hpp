@@ -0,0 +1,632 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definitions of the class templates basic_aes_gcm_encryptor,
+// basic_aes_gcm_decryptor and basic_aes_ctr_filter, which encrypt using
+// AES by delegating to OpenSSL's libcrypto. libcrypto selects AES-NI,
+// VAES and PCLMULQDQ implementations at run time when they are available.
+//
+// aes_gcm_encryptor writes a stream consisting of a 20-byte header followed
+// by a sequence of chunks:
+//
+//     header:  "AGCM"  nonce[12]  chunk_size[4]
+//     chunk:   length[4]  ciphertext[length & 0x7fffffff]  tag[16]
+//
+// Integers are little-endian. The high bit of a chunk's length is set for
+// the last chunk of the stream. Each chunk is sealed with the nonce
+// obtained by XORing its zero-based index, as a big-endian 64-bit integer,
+// into the last eight bytes of the stream's nonce, and with the header,
+// index and length as additional authenticated data, so that chunks cannot
+// be reordered, dropped or truncated without detection.
+
+#ifndef BOOST_IOSTREAMS_AES_HPP_INCLUDED
+#define BOOST_IOSTREAMS_AES_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <algorithm>                       // max, min.
+#include <cstddef>                         // size_t.
+#include <cstring>                         // memcpy.
+#include <memory>                          // allocator.
+#include <string>
+#include <boost/config.hpp>                // BOOST_PREVENT_MACRO_SUBSTITUTION.
+#include <boost/cstdint.hpp>               // uint64_t.
+#include <boost/iostreams/constants.hpp>   // buffer size.
+#include <boost/iostreams/detail/buffer.hpp>
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/ios.hpp>  // failure, streamsize.
+#include <boost/iostreams/filter/symmetric.hpp>
+#include <boost/iostreams/pipeline.hpp>
+#include <boost/system/error_code.hpp>
+
+// Must come last.
+#ifdef BOOST_MSVC
+# pragma warning(push)
+# pragma warning(disable:4251 4231 4660)
+#endif
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace aes {
+
+                    // Status codes
+
+BOOST_IOSTREAMS_DECL extern const int okay;
+BOOST_IOSTREAMS_DECL extern const int bad_key;
+BOOST_IOSTREAMS_DECL extern const int bad_iv;
+BOOST_IOSTREAMS_DECL extern const int bad_chunk_size;
+BOOST_IOSTREAMS_DECL extern const int bad_header;
+BOOST_IOSTREAMS_DECL extern const int bad_chunk;
+BOOST_IOSTREAMS_DECL extern const int authentication_failed;
+BOOST_IOSTREAMS_DECL extern const int unexpected_eof;
+BOOST_IOSTREAMS_DECL extern const int trailing_data;
+BOOST_IOSTREAMS_DECL extern const int library_error;
+
+                    // Sizes
+
+const std::size_t gcm_nonce_size  = 12;
+const std::size_t gcm_tag_size    = 16;
+const std::size_t ctr_iv_size     = 16;
+const std::size_t max_chunk_size  = 1 << 24;
+
+                    // Default values
+
+const std::size_t default_chunk_size = 65536;
+
+} // End namespace aes.
+
+//
+// Class name: aes_params.
+// Description: Encapsulates the parameters used to customize encryption
+//      and decryption. key must have 16, 24 or 32 bytes, selecting AES-128,
+//      AES-192 or AES-256. For the GCM encryptor, iv is the 12-byte nonce of
+//      the stream; if it is empty, a random nonce is generated for each
+//      stream. A nonce must never be used twice with the same key. The GCM
+//      decryptor reads the nonce from the stream and ignores iv. For the CTR
+//      filters, iv is the required 16-byte initial counter block.
+//      chunk_size, used only by the GCM encryptor, is the number of
+//      plaintext characters sealed with each tag.
+//
+struct aes_params {
+
+    // Non-explicit constructor.
+    aes_params( const std::string& key = std::string(),
+                const std::string& iv = std::string(),
+                std::size_t chunk_size = aes::default_chunk_size )
+        : key(key), iv(iv), chunk_size(chunk_size)
+        { }
+    std::string  key;
+    std::string  iv;
+    std::size_t  chunk_size;
+};
+
+//
+// Class name: aes_error.
+// Description: Subclass of std::ios_base::failure thrown to indicate
+//     invalid parameters, malformed or forged ciphertext, and failures
+//     reported by the underlying library.
+//
+class BOOST_IOSTREAMS_DECL aes_error : public BOOST_IOSTREAMS_FAILURE {
+public:
+    explicit aes_error(int error);
+    int error() const { return error_; }
+    static void check BOOST_PREVENT_MACRO_SUBSTITUTION(int error);
+
+    // Non-throwing version of check: stores in ec a code in aes_category()
+    // and returns false if error indicates failure.
+    static bool check BOOST_PREVENT_MACRO_SUBSTITUTION
+        (int error, boost::system::error_code& ec);
+private:
+    int error_;
+};
+
+// Returns the category of the error codes reported by the AES filters; the
+// values are the constants aes::bad_key, etc.
+BOOST_IOSTREAMS_DECL const boost::system::error_category& aes_category();
+
+namespace detail {
+
+//
+// Class name: aes_base.
+// Description: Wraps a libcrypto cipher context and implements the chunk
+//      format used by the GCM filters.
+//
+class BOOST_IOSTREAMS_DECL aes_base {
+public:
+    typedef char char_type;
+protected:
+    static const std::size_t header_size = 20;
+    static const std::size_t chunk_header_size = 4;
+    static const std::size_t chunk_overhead =
+        chunk_header_size + aes::gcm_tag_size;
+    enum usage { gcm_seal, gcm_open, ctr_mode };
+    aes_base();
+    ~aes_base();
+
+    // Returns aes::okay if the given parameters are suitable for the given
+    // usage, and an error code otherwise.
+    static int validate(const aes_params& p, usage u);
+
+    // Prepares to encrypt or decrypt a CTR stream.
+    void init_ctr(const aes_params& p);
+
+    // Prepares to write a GCM stream, and writes its header to dest.
+    void init_seal(const aes_params& p, char* dest);
+
+    // Prepares to read the GCM stream with the given header; returns
+    // aes::okay or an error code.
+    int init_open(const aes_params& p, const char* header);
+
+    // The chunk size of the current GCM stream.
+    std::size_t chunk_size() const { return chunk_size_; }
+
+    // Encrypts or decrypts n characters using CTR mode.
+    int ctr(const char* src, std::size_t n, char* dest);
+
+    // Writes to dest the next chunk of a GCM stream, containing the n
+    // characters beginning at src, and returns its size.
+    std::size_t seal(const char* src, std::size_t n, bool last, char* dest);
+
+    // Parses the header of the next chunk of a GCM stream, storing the
+    // length of its ciphertext in n; returns aes::okay or an error code.
+    int open_header(const char* header, std::size_t& n, bool& last);
+
+    // Verifies and decrypts the ciphertext and tag of the chunk whose header
+    // was last parsed, writing n characters to dest; returns aes::okay or
+    // an error code.
+    int open(const char* src, std::size_t n, char* dest);
+    void reset() { index_ = 0; }
+private:
+    void start_chunk(bool encrypt);
+    void*            ctx_;   // Actual type: EVP_CIPHER_CTX*.
+    char             header_[header_size];
+    char             chunk_header_[chunk_header_size];
+    std::size_t      chunk_size_;
+    boost::uint64_t  index_;
+};
+
+//
+// Template name: aes_gcm_encryptor_impl
+// Description: Model of SymmetricFilter implementing encryption with
+//      AES-GCM. Each chunk is sealed with a single call into libcrypto,
+//      directly from the input range and into the output range when they
+//      are large enough.
+//
+template<typename Alloc = std::allocator<char> >
+class aes_gcm_encryptor_impl : public aes_base {
+public:
+    aes_gcm_encryptor_impl(const aes_params& p);
+    bool filter( const char*& src_begin, const char* src_end,
+                 char*& dest_begin, char* dest_end, bool flush );
+    void close();
+private:
+    void encrypt( const char* src, std::size_t n, bool last,
+                  char*& dest_begin, char* dest_end );
+    bool drain(char*& dest_begin, char* dest_end);
+    aes_params           params_;
+    buffer<char, Alloc>  in_;   // Partial chunk, in [data(), eptr()).
+    buffer<char, Alloc>  out_;  // Sealed chunk, in [ptr(), eptr()).
+    bool                 started_;
+    bool                 finished_;
+};
+
+//
+// Template name: aes_gcm_decryptor_impl
+// Description: Model of SymmetricFilter implementing decryption with
+//      AES-GCM. No plaintext is produced from a chunk until its tag has been
+//      verified.
+//
+template<typename Alloc = std::allocator<char> >
+class aes_gcm_decryptor_impl : public aes_base {
+public:
+    typedef void error_code_support;
+    aes_gcm_decryptor_impl(const aes_params& p);
+    bool filter( const char*& src_begin, const char* src_end,
+                 char*& dest_begin, char* dest_end, bool flush );
+    bool filter( const char*& src_begin, const char* src_end,
+                 char*& dest_begin, char* dest_end, bool flush,
+                 boost::system::error_code& ec );
+    void close();
+private:
+    enum state_type { s_header, s_chunk_header, s_chunk, s_done };
+    int decrypt( const char*& src_begin, const char* src_end,
+                 char*& dest_begin, char* dest_end, bool flush );
+    bool drain(char*& dest_begin, char* dest_end);
+    bool pending() const { return out_.ptr() != out_.eptr(); }
+    aes_params           params_;
+    buffer<char, Alloc>  in_;   // Partial header or chunk.
+    buffer<char, Alloc>  out_;  // Decrypted chunk, in [ptr(), eptr()).
+    std::size_t          length_;
+    bool                 last_;
+    state_type           state_;
+};
+
+//
+// Template name: aes_ctr_impl
+// Description: Model of SymmetricFilter implementing encryption and
+//      decryption with AES-CTR, which are the same operation.
+//
+template<typename Alloc = std::allocator<char> >
+class aes_ctr_impl : public aes_base {
+public:
+    aes_ctr_impl(const aes_params& p);
+    bool filter( const char*& src_begin, const char* src_end,
+                 char*& dest_begin, char* dest_end, bool flush );
+    void close();
+private:
+    aes_params params_;
+};
+
+} // End namespace detail.
+
+//
+// Template name: aes_gcm_encryptor
+// Description: Model of InputFilter and OutputFilter implementing
+//      authenticated encryption using AES-GCM.
+//
+template<typename Alloc = std::allocator<char> >
+struct basic_aes_gcm_encryptor
+    : symmetric_filter<detail::aes_gcm_encryptor_impl<Alloc>, Alloc>
+{
+private:
+    typedef detail::aes_gcm_encryptor_impl<Alloc>       impl_type;
+    typedef symmetric_filter<impl_type, Alloc>          base_type;
+public:
+    typedef typename base_type::char_type               char_type;
+    typedef typename base_type::category                category;
+    basic_aes_gcm_encryptor( const aes_params& p,
+                             int buffer_size = default_device_buffer_size );
+};
+BOOST_IOSTREAMS_PIPABLE(basic_aes_gcm_encryptor, 1)
+
+typedef basic_aes_gcm_encryptor<> aes_gcm_encryptor;
+
+//
+// Template name: aes_gcm_decryptor
+// Description: Model of InputFilter and OutputFilter implementing
+//      authenticated decryption using AES-GCM.
+//
+template<typename Alloc = std::allocator<char> >
+struct basic_aes_gcm_decryptor
+    : symmetric_filter<detail::aes_gcm_decryptor_impl<Alloc>, Alloc>
+{
+private:
+    typedef detail::aes_gcm_decryptor_impl<Alloc>       impl_type;
+    typedef symmetric_filter<impl_type, Alloc>          base_type;
+public:
+    typedef typename base_type::char_type               char_type;
+    typedef typename base_type::category                category;
+    basic_aes_gcm_decryptor( const aes_params& p,
+                             int buffer_size = default_device_buffer_size );
+};
+BOOST_IOSTREAMS_PIPABLE(basic_aes_gcm_decryptor, 1)
+
+typedef basic_aes_gcm_decryptor<> aes_gcm_decryptor;
+
+//
+// Template name: aes_ctr_filter
+// Description: Model of InputFilter and OutputFilter implementing
+//      encryption and decryption using AES-CTR. CTR mode provides no
+//      authentication.
+//
+template<typename Alloc = std::allocator<char> >
+struct basic_aes_ctr_filter
+    : symmetric_filter<detail::aes_ctr_impl<Alloc>, Alloc>
+{
+private:
+    typedef detail::aes_ctr_impl<Alloc>                 impl_type;
+    typedef symmetric_filter<impl_type, Alloc>          base_type;
+public:
+    typedef typename base_type::char_type               char_type;
+    typedef typename base_type::category                category;
+    basic_aes_ctr_filter( const aes_params& p,
+                          int buffer_size = default_device_buffer_size );
+};
+BOOST_IOSTREAMS_PIPABLE(basic_aes_ctr_filter, 1)
+
+typedef basic_aes_ctr_filter<> aes_ctr_filter;
+typedef basic_aes_ctr_filter<> aes_ctr_encryptor;
+typedef basic_aes_ctr_filter<> aes_ctr_decryptor;
+
+//----------------------------------------------------------------------------//
+
+namespace detail {
+
+//------------------Implementation of aes_gcm_encryptor_impl------------------//
+
+template<typename Alloc>
+aes_gcm_encryptor_impl<Alloc>::aes_gcm_encryptor_impl(const aes_params& p)
+    : params_(p),
+      in_(static_cast<int>(p.chunk_size)),
+      out_(static_cast<int>(p.chunk_size + chunk_overhead)),
+      started_(false), finished_(false)
+{
+    aes_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(validate(p, gcm_seal));
+    in_.set(0, 0);
+    out_.set(0, 0);
+}
+
+template<typename Alloc>
+bool aes_gcm_encryptor_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    const std::size_t chunk = params_.chunk_size;
+    while (drain(dest_begin, dest_end)) {
+        if (!started_) {
+            init_seal(params_, out_.data());
+            out_.set(0, static_cast<std::streamsize>(header_size));
+            started_ = true;
+            continue;
+        }
+        if (finished_)
+            return false;
+
+        // A full chunk is sealed only once it is known not to be the last
+        std::size_t avail =
+                        static_cast<std::size_t>(src_end - src_begin),
+                    buffered =
+                        static_cast<std::size_t>(in_.eptr() - in_.data());
+        if (buffered == chunk && avail != 0) {
+            encrypt(in_.data(), chunk, false, dest_begin, dest_end);
+            in_.set(0, 0);
+        } else if (buffered == 0 && avail > chunk) {
+            encrypt(src_begin, chunk, false, dest_begin, dest_end);
+            src_begin += chunk;
+        } else if (avail != 0) {
+            std::size_t amt = (std::min)(avail, chunk - buffered);
+            std::memcpy(in_.eptr(), src_begin, amt);
+            in_.eptr() += amt;
+            src_begin += amt;
+        } else if (flush) {
+            encrypt(in_.data(), buffered, true, dest_begin, dest_end);
+            in_.set(0, 0);
+            finished_ = true;
+        } else {
+            return true;
+        }
+    }
+    return true;
+}
+
+template<typename Alloc>
+void aes_gcm_encryptor_impl<Alloc>::close()
+{
+    in_.set(0, 0);
+    out_.set(0, 0);
+    started_ = finished_ = false;
+    reset();
+}
+
+template<typename Alloc>
+void aes_gcm_encryptor_impl<Alloc>::encrypt
+    ( const char* src, std::size_t n, bool last,
+      char*& dest_begin, char* dest_end )
+{
+    if (static_cast<std::size_t>(dest_end - dest_begin) >= n + chunk_overhead)
+        dest_begin += seal(src, n, last, dest_begin);
+    else
+        out_.set(0, static_cast<std::streamsize>(
+                        seal(src, n, last, out_.data())
+                    ));
+}
+
+// Copies as much pending output as possible to the given range; returns
+// true if no output remains pending.
+template<typename Alloc>
+bool aes_gcm_encryptor_impl<Alloc>::drain(char*& dest_begin, char* dest_end)
+{
+    std::size_t amt =
+        (std::min)( static_cast<std::size_t>(out_.eptr() - out_.ptr()),
+                    static_cast<std::size_t>(dest_end - dest_begin) );
+    std::memcpy(dest_begin, out_.ptr(), amt);
+    out_.ptr() += amt;
+    dest_begin += amt;
+    return out_.ptr() == out_.eptr();
+}
+
+//------------------Implementation of aes_gcm_decryptor_impl------------------//
+
+template<typename Alloc>
+aes_gcm_decryptor_impl<Alloc>::aes_gcm_decryptor_impl(const aes_params& p)
+    : params_(p), in_(static_cast<int>(header_size)), out_(1)
+{
+    aes_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(validate(p, gcm_open));
+    close();
+}
+
+template<typename Alloc>
+bool aes_gcm_decryptor_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    int result = decrypt(src_begin, src_end, dest_begin, dest_end, flush);
+    aes_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result);
+    return !flush || pending() || src_begin != src_end;
+}
+
+template<typename Alloc>
+bool aes_gcm_decryptor_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush,
+      boost::system::error_code& ec )
+{
+    int result = decrypt(src_begin, src_end, dest_begin, dest_end, flush);
+    return aes_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result, ec) &&
+           (!flush || pending() || src_begin != src_end);
+}
+
+template<typename Alloc>
+void aes_gcm_decryptor_impl<Alloc>::close()
+{
+    in_.set(0, 0);
+    out_.set(0, 0);
+    length_ = 0;
+    last_ = false;
+    state_ = s_header;
+    reset();
+}
+
+template<typename Alloc>
+int aes_gcm_decryptor_impl<Alloc>::decrypt
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    while (drain(dest_begin, dest_end) && src_begin != src_end) {
+        if (state_ == s_done)
+            return aes::trailing_data;
+
+        // Gather the next header or chunk, in place if it lies entirely
+        // within the input range
+        std::size_t  needed =
+                         state_ == s_header ?
+                             header_size :
+                         state_ == s_chunk_header ?
+                             chunk_header_size :
+                             length_ + aes::gcm_tag_size;
+        std::size_t  avail = static_cast<std::size_t>(src_end - src_begin),
+                     buffered =
+                         static_cast<std::size_t>(in_.eptr() - in_.data());
+        const char*  data;
+        if (buffered == 0 && avail >= needed) {
+            data = src_begin;
+            src_begin += needed;
+        } else {
+            std::size_t amt = (std::min)(avail, needed - buffered);
+            std::memcpy(in_.eptr(), src_begin, amt);
+            in_.eptr() += amt;
+            src_begin += amt;
+            if (buffered + amt < needed)
+                continue;
+            data = in_.data();
+        }
+        in_.set(0, 0);
+
+        switch (state_) {
+        case s_header:
+            if (int result = init_open(params_, data))
+                return result;
+            in_.resize(static_cast<int>(
+                (std::max)(chunk_size() + aes::gcm_tag_size, header_size)
+            ));
+            out_.resize(static_cast<int>(chunk_size()));
+            in_.set(0, 0);
+            out_.set(0, 0);
+            state_ = s_chunk_header;
+            break;
+        case s_chunk_header:
+            if (int result = open_header(data, length_, last_))
+                return result;
+            state_ = s_chunk;
+            break;
+        case s_chunk:
+            {
+                bool   direct =
+                           static_cast<std::size_t>(dest_end - dest_begin) >=
+                           length_;
+                char*  dest = direct ? dest_begin : out_.data();
+                if (int result = open(data, length_, dest))
+                    return result;
+                if (direct)
+                    dest_begin += length_;
+                else
+                    out_.set(0, static_cast<std::streamsize>(length_));
+                state_ = last_ ? s_done : s_chunk_header;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    if (flush && src_begin == src_end && state_ != s_done)
+        return aes::unexpected_eof;
+    return aes::okay;
+}
+
+// Copies as much pending output as possible to the given range; returns
+// true if no output remains pending.
+template<typename Alloc>
+bool aes_gcm_decryptor_impl<Alloc>::drain(char*& dest_begin, char* dest_end)
+{
+    std::size_t amt =
+        (std::min)( static_cast<std::size_t>(out_.eptr() - out_.ptr()),
+                    static_cast<std::size_t>(dest_end - dest_begin) );
+    std::memcpy(dest_begin, out_.ptr(), amt);
+    out_.ptr() += amt;
+    dest_begin += amt;
+    return out_.ptr() == out_.eptr();
+}
+
+//------------------Implementation of aes_ctr_impl----------------------------//
+
+template<typename Alloc>
+aes_ctr_impl<Alloc>::aes_ctr_impl(const aes_params& p)
+    : params_(p)
+{
+    aes_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(validate(p, ctr_mode));
+    init_ctr(params_);
+}
+
+template<typename Alloc>
+bool aes_ctr_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    std::size_t amt =
+        (std::min)( static_cast<std::size_t>(src_end - src_begin),
+                    static_cast<std::size_t>(dest_end - dest_begin) );
+    aes_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(
+        ctr(src_begin, amt, dest_begin)
+    );
+    src_begin += amt;
+    dest_begin += amt;
+    return !flush || src_begin != src_end;
+}
+
+template<typename Alloc>
+void aes_ctr_impl<Alloc>::close() { init_ctr(params_); }
+
+} // End namespace detail.
+
+//------------------Implementation of aes_gcm_encryptor-----------------------//
+
+template<typename Alloc>
+basic_aes_gcm_encryptor<Alloc>::basic_aes_gcm_encryptor
+        (const aes_params& p, int buffer_size)
+    : base_type(buffer_size, p)
+    { }
+
+//------------------Implementation of aes_gcm_decryptor-----------------------//
+
+template<typename Alloc>
+basic_aes_gcm_decryptor<Alloc>::basic_aes_gcm_decryptor
+        (const aes_params& p, int buffer_size)
+    : base_type(buffer_size, p)
+    { }
+
+//------------------Implementation of aes_ctr_filter--------------------------//
+
+template<typename Alloc>
+basic_aes_ctr_filter<Alloc>::basic_aes_ctr_filter
+        (const aes_params& p, int buffer_size)
+    : base_type(buffer_size, p)
+    { }
+
+//----------------------------------------------------------------------------//
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+#ifdef BOOST_MSVC
+# pragma warning(pop)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_AES_HPP_INCLUDED
@@ -87,7 +87,7 @@ public:
             close_impl();
         if ((state_ & f_write) != 0 && which == BOOST_IOS::out) {
             try {
-                vector_type filtered;
+                vector_type filtered(data_.get_allocator());
                 do_filter(data_, filtered);
                 do_write( 
                     sink, &filtered[0],
@@ -112,7 +112,7 @@ private:
     void do_read(Source& src)
     {
         using std::streamsize;
-        vector_type data;
+        vector_type data(data_.get_allocator());
         while (true) {
             const std::streamsize  size = default_device_buffer_size;
             Ch                     buf[size];
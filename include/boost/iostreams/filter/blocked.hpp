@@ -0,0 +1,735 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definitions of the class templates blocked_compressor,
+// blocked_decompressor and blocked_source, which implement a container format
+// in which the input is divided into blocks compressed independently by any
+// compression filter based on symmetric_filter, such as zlib_compressor or
+// bzip2_compressor. Blocks are compressed and decompressed on a group of
+// threads, and blocked_source uses the index stored at the end of the
+// container to decompress only the blocks containing the characters read:
+//
+//     filtering_ostream out;
+//     out.push(blocked_compressor<zlib_compressor>(1024 * 1024));
+//     out.push(file_sink("data.blk"));
+//
+//     stream< blocked_source<zlib_decompressor, file_source> >
+//         in(file_source("data.blk"));
+//     in.seekg(offset);
+//
+// The container consists of the following, where all integers are unsigned
+// and stored in little-endian order:
+//
+//     The characters "BIOBLK01".
+//     For each block, its compressed size and its uncompressed size, as
+//         32-bit integers, followed by the compressed characters.
+//     Two zero 32-bit integers.
+//     For each block, and once more at the end, the offset of its header
+//         within the container and the offset of its first character within
+//         the uncompressed data, as 64-bit integers.
+//     The number of blocks, as a 64-bit integer, followed by the characters
+//         "BIOIDX01".
+
+#ifndef BOOST_IOSTREAMS_BLOCKED_HPP_INCLUDED
+#define BOOST_IOSTREAMS_BLOCKED_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <algorithm>                            // min, upper_bound.
+#include <cstddef>                              // size_t.
+#include <cstring>                              // memcmp, memcpy.
+#include <vector>
+#include <boost/config.hpp>                     // PREVENT_MACRO_SUBSTITUTION.
+#include <boost/cstdint.hpp>                    // uint32_t, uint64_t.
+#include <boost/function.hpp>
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/close.hpp>
+#include <boost/iostreams/detail/adapter/direct_adapter.hpp>
+#include <boost/iostreams/detail/adapter/non_blocking_adapter.hpp>
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/ios.hpp>       // failure, streamsize.
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/pipeline.hpp>
+#include <boost/iostreams/positioning.hpp>
+#include <boost/iostreams/read.hpp>
+#include <boost/iostreams/seek.hpp>
+#include <boost/iostreams/traits.hpp>           // is_direct.
+#include <boost/iostreams/write.hpp>
+#include <boost/mpl/if.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/throw_exception.hpp>
+
+// Must come last.
+#ifdef BOOST_MSVC
+# pragma warning(push)
+# pragma warning(disable:4251 4231 4660)
+#endif
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace blocked {
+
+                    // Status codes
+
+const int okay            = 0;
+const int bad_header      = 1;
+const int bad_block       = 2;
+const int bad_index       = 3;
+const int unexpected_eof  = 4;
+
+                    // Limits
+
+// The maximum number of uncompressed characters in a block.
+const std::size_t max_block_size = 0x40000000;
+
+                    // Default values
+
+const std::size_t default_block_size = 1024 * 1024;
+
+} // End namespace blocked.
+
+//
+// Class name: blocked_params.
+// Description: Encapsulates the parameters of the blocked filters.
+//      block_size - The number of uncompressed characters in each block
+//          except the last; ignored when decompressing.
+//      threads - The number of threads on which blocks are compressed or
+//          decompressed; if zero, the number of hardware threads is used.
+//
+struct blocked_params {
+
+    // Non-explicit constructor.
+    blocked_params( std::size_t block_size = blocked::default_block_size,
+                    unsigned threads = 0 )
+        : block_size(block_size), threads(threads)
+        { }
+    std::size_t  block_size;
+    unsigned     threads;
+};
+
+//
+// Class name: blocked_error.
+// Description: Subclass of std::ios::failure thrown to indicate a malformed
+//      container; the status code is one of the constants in namespace
+//      blocked. Errors reported by a codec are propagated unchanged.
+//
+class BOOST_IOSTREAMS_DECL blocked_error : public BOOST_IOSTREAMS_FAILURE {
+public:
+    explicit blocked_error(int error);
+    int error() const { return error_; }
+    static void check BOOST_PREVENT_MACRO_SUBSTITUTION(int error);
+private:
+    int error_;
+};
+
+namespace detail {
+
+const std::size_t blocked_header_size = 8;
+const std::size_t blocked_index_entry_size = 16;
+const std::size_t blocked_trailer_size = 16;
+const char blocked_magic[] = "BIOBLK01";
+const char blocked_index_magic[] = "BIOIDX01";
+
+inline void blocked_store(char* p, boost::uint64_t value, int size)
+{
+    for (int z = 0; z < size; ++z, value >>= 8)
+        p[z] = static_cast<char>(value & 0xff);
+}
+
+inline boost::uint64_t blocked_load(const char* p, int size)
+{
+    boost::uint64_t result = 0;
+    for (int z = size; z-- > 0; )
+        result = (result << 8) | static_cast<unsigned char>(p[z]);
+    return result;
+}
+
+// Function which replaces its second argument with the result of
+// compressing or decompressing its first argument.
+typedef boost::function<
+            void (const std::vector<char>&, std::vector<char>&)
+        > block_transform;
+
+class block_pool_impl;
+
+//
+// Class name: block_pool.
+// Description: Applies a block_transform to a sequence of blocks on a group
+//      of threads, returning the results in the order in which the blocks
+//      were submitted. Exceptions thrown by the transform are rethrown by
+//      take().
+//
+class BOOST_IOSTREAMS_DECL block_pool {
+public:
+    block_pool(const block_transform& f, unsigned threads);
+
+    // Returns the number of blocks which should be in progress at once.
+    std::size_t limit() const;
+
+    // Returns the number of blocks submitted but not yet taken.
+    std::size_t size() const;
+
+    // Returns true if the oldest block has been transformed.
+    bool ready() const;
+
+    // Submits the given block, leaving the argument empty.
+    void submit(std::vector<char>& input);
+
+    // Stores in output the result of transforming the oldest block, waiting
+    // if necessary.
+    void take(std::vector<char>& output);
+
+    // Discards the blocks not yet taken.
+    void clear();
+private:
+    shared_ptr<block_pool_impl> pimpl_;
+};
+
+// Applies a new Codec, obtained from a factory, to a block.
+template<typename Codec>
+struct block_codec {
+    typedef boost::function<Codec ()> factory;
+    explicit block_codec(const factory& make) : make(make) { }
+    void operator()( const std::vector<char>& input,
+                     std::vector<char>& output ) const
+    {
+        Codec                                   codec = make();
+        back_insert_device< std::vector<char> > dest(output);
+        output.clear();
+        const char*      s = input.empty() ? 0 : &input[0];
+        std::streamsize  n = static_cast<std::streamsize>(input.size());
+        while (n > 0) {
+            std::streamsize amt = iostreams::write(codec, dest, s, n);
+            s += amt;
+            n -= amt;
+        }
+        iostreams::close(codec, dest, BOOST_IOS::out);
+    }
+    factory make;
+};
+
+template<typename Codec>
+Codec construct_codec() { return Codec(); }
+
+// Reads exactly n characters unless end-of-stream is reached; returns the
+// number of characters read.
+template<typename Source>
+std::size_t blocked_read(Source& src, char* s, std::size_t n)
+{
+    std::size_t result = 0;
+    while (result < n) {
+        std::streamsize amt =
+            iostreams::read( src, s + result,
+                             static_cast<std::streamsize>(n - result) );
+        if (amt == -1)
+            break;
+        result += static_cast<std::size_t>(amt);
+    }
+    return result;
+}
+
+} // End namespace detail.
+
+//
+// Template name: blocked_compressor.
+// Description: Model of OutputFilter which divides its input into blocks of
+//      blocked_params::block_size characters, compresses them using copies
+//      of Codec, which must be a model of OutputFilter, and writes them
+//      followed by an index. Codecs are obtained from the given factory,
+//      which by default value-initializes them.
+//
+template<typename Codec>
+class blocked_compressor {
+public:
+    typedef char char_type;
+    struct category : multichar_output_filter_tag, closable_tag { };
+    typedef boost::function<Codec ()> factory;
+
+    explicit blocked_compressor
+        ( const blocked_params& p = blocked_params(),
+          const factory& make = &detail::construct_codec<Codec> )
+        : pimpl_(new impl(p, make))
+        { }
+
+    template<typename Sink>
+    std::streamsize write(Sink& snk, const char* s, std::streamsize n)
+    {
+        non_blocking_adapter<Sink> nb(snk);
+        pimpl_->write(nb, s, static_cast<std::size_t>(n));
+        return n;
+    }
+
+    template<typename Sink>
+    void close(Sink& snk)
+    {
+        non_blocking_adapter<Sink> nb(snk);
+        pimpl_->close(nb);
+    }
+private:
+    struct impl {
+        impl(const blocked_params& p, const factory& make)
+            : pool_(detail::block_codec<Codec>(make), p.threads),
+              block_size_(p.block_size)
+        {
+            if (block_size_ == 0 || block_size_ > blocked::max_block_size)
+                block_size_ = blocked::max_block_size;
+            reset();
+        }
+        void reset()
+        {
+            pool_.clear();
+            block_.clear();
+            sizes_.clear();
+            index_.clear();
+            offset_ = size_ = 0;
+        }
+        template<typename Sink>
+        void write(Sink& snk, const char* s, std::size_t n)
+        {
+            if (offset_ == 0)
+                put(snk, detail::blocked_magic, detail::blocked_header_size);
+            while (n != 0) {
+                std::size_t amt = (std::min)(n, block_size_ - block_.size());
+                block_.insert(block_.end(), s, s + amt);
+                s += amt;
+                n -= amt;
+                if (block_.size() == block_size_) {
+                    submit();
+                    drain(snk, false);
+                }
+            }
+        }
+        template<typename Sink>
+        void close(Sink& snk)
+        {
+            if (offset_ == 0)
+                put(snk, detail::blocked_magic, detail::blocked_header_size);
+            if (!block_.empty())
+                submit();
+            drain(snk, true);
+
+            // Write the terminating header, the index and the trailer
+            std::vector<char> tail(
+                detail::blocked_header_size +
+                (index_.size() + 1) * detail::blocked_index_entry_size +
+                detail::blocked_trailer_size
+            );
+            char* p = &tail[detail::blocked_header_size];
+            index_.push_back(entry(offset_, size_));
+            for (std::size_t z = 0; z < index_.size(); ++z) {
+                detail::blocked_store(p, index_[z].first, 8);
+                detail::blocked_store(p + 8, index_[z].second, 8);
+                p += detail::blocked_index_entry_size;
+            }
+            detail::blocked_store(p, index_.size() - 1, 8);
+            std::memcpy(p + 8, detail::blocked_index_magic, 8);
+            put(snk, &tail[0], tail.size());
+            reset();
+        }
+        void submit()
+        {
+            sizes_.push_back(block_.size());
+            pool_.submit(block_);
+            block_.reserve(block_size_);
+        }
+
+        // Writes the blocks which have been compressed; if all is true,
+        // waits for the remaining blocks.
+        template<typename Sink>
+        void drain(Sink& snk, bool all)
+        {
+            while ( pool_.size() != 0 &&
+                    (all || pool_.size() > pool_.limit() || pool_.ready()) )
+            {
+                pool_.take(out_);
+                if (out_.size() > 0xffffffffu)
+                    boost::throw_exception(blocked_error(blocked::bad_block));
+                char header[detail::blocked_header_size];
+                detail::blocked_store(header, out_.size(), 4);
+                detail::blocked_store(header + 4, sizes_.front(), 4);
+                index_.push_back(entry(offset_, size_));
+                put(snk, header, detail::blocked_header_size);
+                if (!out_.empty())
+                    put(snk, &out_[0], out_.size());
+                size_ += sizes_.front();
+                sizes_.erase(sizes_.begin());
+            }
+        }
+        template<typename Sink>
+        void put(Sink& snk, const char* s, std::size_t n)
+        {
+            iostreams::write(snk, s, static_cast<std::streamsize>(n));
+            offset_ += n;
+        }
+        typedef std::pair<boost::uint64_t, boost::uint64_t> entry;
+        detail::block_pool        pool_;
+        std::size_t               block_size_;
+        std::vector<char>         block_;  // Block being filled.
+        std::vector<char>         out_;
+        std::vector<std::size_t>  sizes_;  // Sizes of blocks in the pool.
+        std::vector<entry>        index_;
+        boost::uint64_t           offset_; // Characters written.
+        boost::uint64_t           size_;   // Characters in blocks written.
+    };
+    shared_ptr<impl> pimpl_;
+};
+BOOST_IOSTREAMS_PIPABLE(blocked_compressor, 1)
+
+//
+// Template name: blocked_decompressor.
+// Description: Model of InputFilter which reads a container written by
+//      blocked_compressor, decompressing blocks ahead of the reader using
+//      copies of Codec, which must be a model of OutputFilter. Reading stops
+//      after the last block; the index is not read.
+//
+template<typename Codec>
+class blocked_decompressor {
+public:
+    typedef char char_type;
+    struct category : multichar_input_filter_tag, closable_tag { };
+    typedef boost::function<Codec ()> factory;
+
+    explicit blocked_decompressor
+        ( const blocked_params& p = blocked_params(),
+          const factory& make = &detail::construct_codec<Codec> )
+        : pimpl_(new impl(p, make))
+        { }
+
+    template<typename Source>
+    std::streamsize read(Source& src, char* s, std::streamsize n)
+    { return pimpl_->read(src, s, n); }
+
+    template<typename Source>
+    void close(Source&) { pimpl_->reset(); }
+private:
+    struct impl {
+        impl(const blocked_params& p, const factory& make)
+            : pool_(detail::block_codec<Codec>(make), p.threads)
+            { reset(); }
+        void reset()
+        {
+            pool_.clear();
+            sizes_.clear();
+            block_.clear();
+            pos_ = 0;
+            started_ = eof_ = false;
+        }
+        template<typename Source>
+        std::streamsize read(Source& src, char* s, std::streamsize n)
+        {
+            if (!started_) {
+                char header[detail::blocked_header_size];
+                std::size_t amt =
+                    detail::blocked_read(src, header, sizeof(header));
+                if (amt == 0)
+                    return -1;
+                if ( amt != sizeof(header) ||
+                     std::memcmp( header, detail::blocked_magic,
+                                  sizeof(header) ) != 0 )
+                {
+                    boost::throw_exception(
+                        blocked_error(blocked::bad_header)
+                    );
+                }
+                started_ = true;
+            }
+            std::streamsize result = 0;
+            while (result < n) {
+                if (pos_ == block_.size()) {
+                    fill(src);
+                    if (pool_.size() == 0)
+                        break;
+                    pool_.take(block_);
+                    if (block_.size() != sizes_.front())
+                        boost::throw_exception(
+                            blocked_error(blocked::bad_block)
+                        );
+                    sizes_.erase(sizes_.begin());
+                    pos_ = 0;
+                }
+                std::size_t amt =
+                    (std::min)( block_.size() - pos_,
+                                static_cast<std::size_t>(n - result) );
+                std::memcpy(s + result, &block_[pos_], amt);
+                pos_ += amt;
+                result += static_cast<std::streamsize>(amt);
+            }
+            return result != 0 ? result : -1;
+        }
+
+        // Reads compressed blocks until the pool is full or the last block
+        // has been read.
+        template<typename Source>
+        void fill(Source& src)
+        {
+            while (!eof_ && pool_.size() <= pool_.limit()) {
+                char header[detail::blocked_header_size];
+                if ( detail::blocked_read(src, header, sizeof(header)) !=
+                         sizeof(header) )
+                {
+                    boost::throw_exception(
+                        blocked_error(blocked::unexpected_eof)
+                    );
+                }
+                std::size_t csize = static_cast<std::size_t>(
+                                detail::blocked_load(header, 4)
+                            ),
+                            size = static_cast<std::size_t>(
+                                detail::blocked_load(header + 4, 4)
+                            );
+                if (csize == 0 && size == 0) {
+                    eof_ = true;
+                    break;
+                }
+                if (size == 0 || size > blocked::max_block_size)
+                    boost::throw_exception(blocked_error(blocked::bad_block));
+                in_.resize(csize);
+                if ( csize != 0 &&
+                     detail::blocked_read(src, &in_[0], csize) != csize )
+                {
+                    boost::throw_exception(
+                        blocked_error(blocked::unexpected_eof)
+                    );
+                }
+                sizes_.push_back(size);
+                pool_.submit(in_);
+            }
+        }
+        detail::block_pool        pool_;
+        std::vector<char>         in_;
+        std::vector<char>         block_;  // Block being read.
+        std::size_t               pos_;    // Position within block_.
+        std::vector<std::size_t>  sizes_;  // Sizes of blocks in the pool.
+        bool                      started_;
+        bool                      eof_;
+    };
+    shared_ptr<impl> pimpl_;
+};
+BOOST_IOSTREAMS_PIPABLE(blocked_decompressor, 1)
+
+//
+// Template name: blocked_source.
+// Description: Model of SeekableDevice providing read-only access to the
+//      uncompressed contents of a container written by blocked_compressor
+//      and stored in the given seekable Source. Only the blocks containing
+//      the characters read are decompressed; when a read spans several
+//      blocks, they are decompressed concurrently. The most recently
+//      decompressed block is retained. Copies of a blocked_source share
+//      their position.
+//
+template<typename Codec, typename Source>
+class blocked_source {
+public:
+    typedef char char_type;
+    struct category : input_seekable, device_tag, closable_tag { };
+    typedef boost::function<Codec ()> factory;
+
+    explicit blocked_source
+        ( const Source& src, const blocked_params& p = blocked_params(),
+          const factory& make = &detail::construct_codec<Codec> )
+        : pimpl_(new impl(src, p, make))
+        { }
+
+    std::streamsize read(char* s, std::streamsize n)
+    { return pimpl_->read(s, n); }
+
+    std::streampos seek(stream_offset off, BOOST_IOS::seekdir way)
+    { return pimpl_->seek(off, way); }
+
+    void close() { iostreams::close(pimpl_->src_, BOOST_IOS::in); }
+
+    // Returns the number of uncompressed characters.
+    stream_offset size() const
+    { return static_cast<stream_offset>(pimpl_->uoffs_.back()); }
+
+    // Returns the number of blocks.
+    std::size_t blocks() const { return pimpl_->coffs_.size() - 1; }
+private:
+    typedef typename
+            mpl::if_<
+                is_direct<Source>,
+                detail::direct_adapter<Source>,
+                Source
+            >::type                                     device_type;
+    struct impl {
+        impl(const Source& src, const blocked_params& p, const factory& make)
+            : src_(src), pool_(detail::block_codec<Codec>(make), p.threads),
+              pos_(0), cached_(static_cast<std::size_t>(-1))
+            { read_index(); }
+        void read_index()
+        {
+            const std::size_t  header = detail::blocked_header_size,
+                               entry = detail::blocked_index_entry_size,
+                               trailer = detail::blocked_trailer_size;
+            boost::uint64_t total = position_to_offset(
+                iostreams::seek(src_, 0, BOOST_IOS::end, BOOST_IOS::in)
+            );
+            if (total < 2 * header + entry + trailer)
+                boost::throw_exception(blocked_error(blocked::bad_index));
+            char buf[trailer];
+            read_at(0, buf, header);
+            if (std::memcmp(buf, detail::blocked_magic, header) != 0)
+                boost::throw_exception(blocked_error(blocked::bad_header));
+            read_at(total - trailer, buf, trailer);
+            boost::uint64_t count = detail::blocked_load(buf, 8);
+            if ( std::memcmp(buf + 8, detail::blocked_index_magic, 8) != 0 ||
+                 count > (total - 2 * header - trailer) / entry - 1 )
+            {
+                boost::throw_exception(blocked_error(blocked::bad_index));
+            }
+            std::size_t        n = static_cast<std::size_t>(count) + 1;
+            std::vector<char>  index(n * entry);
+            boost::uint64_t    start = total - trailer - n * entry;
+            read_at(start, &index[0], index.size());
+            coffs_.resize(n);
+            uoffs_.resize(n);
+            for (std::size_t z = 0; z < n; ++z) {
+                coffs_[z] = detail::blocked_load(&index[z * entry], 8);
+                uoffs_[z] = detail::blocked_load(&index[z * entry + 8], 8);
+                bool valid = z == 0 ?
+                    coffs_[z] == header && uoffs_[z] == 0 :
+                    coffs_[z] >= coffs_[z - 1] + header &&
+                        uoffs_[z] > uoffs_[z - 1] &&
+                        uoffs_[z] - uoffs_[z - 1] <= blocked::max_block_size;
+                if (!valid)
+                    boost::throw_exception(blocked_error(blocked::bad_index));
+            }
+            if (coffs_.back() + header != start)
+                boost::throw_exception(blocked_error(blocked::bad_index));
+        }
+        std::streamsize read(char* s, std::streamsize n)
+        {
+            const boost::uint64_t total = uoffs_.back();
+            std::streamsize result = 0;
+            while (result < n && pos_ < total) {
+                std::size_t first = block_of(pos_);
+                if (first != cached_) {
+
+                    // Decompress the blocks containing the rest of the
+                    // request, up to the capacity of the pool, retaining the
+                    // last
+                    boost::uint64_t end =
+                        (std::min)( pos_ + static_cast<boost::uint64_t>(
+                                               n - result ),
+                                    total );
+                    std::size_t last =
+                        (std::min)(block_of(end - 1), first + pool_.limit());
+                    for (std::size_t z = first; z <= last; ++z)
+                        submit(z);
+                    for (std::size_t z = first; z < last; ++z) {
+                        take(z, buf_);
+                        std::size_t off =
+                            static_cast<std::size_t>(pos_ - uoffs_[z]);
+                        std::size_t amt = buf_.size() - off;
+                        std::memcpy(s + result, &buf_[off], amt);
+                        pos_ += amt;
+                        result += static_cast<std::streamsize>(amt);
+                    }
+                    take(last, cache_);
+                    cached_ = last;
+                }
+                std::size_t off =
+                    static_cast<std::size_t>(pos_ - uoffs_[cached_]);
+                std::size_t amt =
+                    (std::min)( cache_.size() - off,
+                                static_cast<std::size_t>(n - result) );
+                std::memcpy(s + result, &cache_[off], amt);
+                pos_ += amt;
+                result += static_cast<std::streamsize>(amt);
+            }
+            return result != 0 ? result : -1;
+        }
+        std::streampos seek(stream_offset off, BOOST_IOS::seekdir way)
+        {
+            stream_offset next;
+            if (way == BOOST_IOS::beg)
+                next = off;
+            else if (way == BOOST_IOS::cur)
+                next = static_cast<stream_offset>(pos_) + off;
+            else
+                next = static_cast<stream_offset>(uoffs_.back()) + off;
+            if (next < 0)
+                boost::throw_exception(BOOST_IOSTREAMS_FAILURE("bad seek"));
+            pos_ = static_cast<boost::uint64_t>(next);
+            return offset_to_position(next);
+        }
+
+        // Returns the index of the block containing the given offset.
+        std::size_t block_of(boost::uint64_t off) const
+        {
+            return static_cast<std::size_t>(
+                std::upper_bound(uoffs_.begin(), uoffs_.end(), off) -
+                uoffs_.begin()
+            ) - 1;
+        }
+        void submit(std::size_t z)
+        {
+            char header[detail::blocked_header_size];
+            read_at(coffs_[z], header, sizeof(header));
+            std::size_t csize =
+                static_cast<std::size_t>(detail::blocked_load(header, 4));
+            if ( coffs_[z] + sizeof(header) + csize != coffs_[z + 1] ||
+                 detail::blocked_load(header + 4, 4) !=
+                     uoffs_[z + 1] - uoffs_[z] )
+            {
+                pool_.clear();
+                boost::throw_exception(blocked_error(blocked::bad_block));
+            }
+            in_.resize(csize);
+            if (csize != 0)
+                read_at(coffs_[z] + sizeof(header), &in_[0], csize);
+            pool_.submit(in_);
+        }
+        void take(std::size_t z, std::vector<char>& output)
+        {
+            try {
+                pool_.take(output);
+            } catch (...) {
+                pool_.clear();
+                cached_ = static_cast<std::size_t>(-1);
+                throw;
+            }
+            if (output.size() != uoffs_[z + 1] - uoffs_[z]) {
+                pool_.clear();
+                cached_ = static_cast<std::size_t>(-1);
+                boost::throw_exception(blocked_error(blocked::bad_block));
+            }
+        }
+        void read_at(boost::uint64_t off, char* s, std::size_t n)
+        {
+            iostreams::seek( src_, static_cast<stream_offset>(off),
+                             BOOST_IOS::beg, BOOST_IOS::in );
+            if (detail::blocked_read(src_, s, n) != n)
+                boost::throw_exception(
+                    blocked_error(blocked::unexpected_eof)
+                );
+        }
+        device_type                    src_;
+        detail::block_pool             pool_;
+        std::vector<boost::uint64_t>   coffs_;   // Offsets of block headers.
+        std::vector<boost::uint64_t>   uoffs_;   // Uncompressed offsets.
+        boost::uint64_t                pos_;
+        std::size_t                    cached_;  // Index of block in cache_.
+        std::vector<char>              cache_;
+        std::vector<char>              in_;
+        std::vector<char>              buf_;
+    };
+    shared_ptr<impl> pimpl_;
+};
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+#ifdef BOOST_MSVC
+# pragma warning(pop)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_BLOCKED_HPP_INCLUDED
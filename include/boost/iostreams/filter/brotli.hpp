@@ -0,0 +1,478 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definitions of the class templates basic_brotli_compressor
+// and basic_brotli_decompressor, which implement compression in the Brotli
+// format (RFC 7932) by delegating to the reference implementation.
+
+#ifndef BOOST_IOSTREAMS_BROTLI_HPP_INCLUDED
+#define BOOST_IOSTREAMS_BROTLI_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <cstddef>           // size_t.
+#include <memory>            // allocator.
+#include <new>               // bad_alloc.
+#include <string>
+#include <boost/config.hpp>  // MSVC, STATIC_CONSTANT, DEDUCED_TYPENAME, DINKUM.
+#include <boost/detail/workaround.hpp>
+#include <boost/iostreams/categories.hpp>  // flushable_tag.
+#include <boost/iostreams/constants.hpp>   // buffer size.
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/ios.hpp>  // failure, streamsize.
+#include <boost/iostreams/filter/symmetric.hpp>
+#include <boost/iostreams/pipeline.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/type_traits/is_same.hpp>
+
+// Must come last.
+#ifdef BOOST_MSVC
+# pragma warning(push)
+# pragma warning(disable:4251 4231 4660)
+#endif
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace brotli {
+
+                    // Typedefs.
+
+typedef void* (*alloc_func)(void*, std::size_t);
+typedef void (*free_func)(void*, void*);
+
+                    // Compression modes
+
+BOOST_IOSTREAMS_DECL extern const int generic;
+BOOST_IOSTREAMS_DECL extern const int text;
+BOOST_IOSTREAMS_DECL extern const int font;
+
+                    // Status codes. Errors detected by the decoder are
+                    // reported using its (negative) error codes.
+
+BOOST_IOSTREAMS_DECL extern const int okay;
+BOOST_IOSTREAMS_DECL extern const int param_error;
+BOOST_IOSTREAMS_DECL extern const int encoder_error;
+BOOST_IOSTREAMS_DECL extern const int unexpected_eof;
+BOOST_IOSTREAMS_DECL extern const int dictionary_unsupported;
+
+                    // Ranges of parameters
+
+BOOST_IOSTREAMS_DECL extern const int min_quality;
+BOOST_IOSTREAMS_DECL extern const int max_quality;
+BOOST_IOSTREAMS_DECL extern const int min_window_bits;
+BOOST_IOSTREAMS_DECL extern const int max_window_bits;
+BOOST_IOSTREAMS_DECL extern const int max_large_window_bits;
+
+                    // Default values
+
+const int default_quality      = 11;
+const int default_window_bits  = 22;
+const bool default_large_window = false;
+
+} // End namespace brotli.
+
+//
+// Class name: brotli_params.
+// Description: Encapsulates the parameters used to customize compression
+//      and decompression. The compressor uses all of the parameters; the
+//      decompressor uses only large_window and dictionary, which must match
+//      those used for compression. size_hint, if non-zero, is the expected
+//      size of the uncompressed data. A non-empty dictionary is used as a
+//      custom raw dictionary; it requires Brotli 1.1 or later.
+//
+struct brotli_params {
+
+    // Non-explicit constructor.
+    brotli_params( int quality          = brotli::default_quality,
+                   int window_bits      = brotli::default_window_bits,
+                   int mode             = brotli::generic,
+                   std::size_t size_hint = 0 )
+        : quality(quality), window_bits(window_bits), mode(mode),
+          size_hint(size_hint), large_window(brotli::default_large_window)
+        { }
+    int          quality;
+    int          window_bits;   // The parameter lgwin.
+    int          mode;
+    std::size_t  size_hint;
+    bool         large_window;  // Allows window_bits above 24.
+    std::string  dictionary;
+};
+
+//
+// Class name: brotli_error.
+// Description: Subclass of std::ios_base::failure thrown to indicate
+//     Brotli errors other than out-of-memory conditions.
+//
+class BOOST_IOSTREAMS_DECL brotli_error : public BOOST_IOSTREAMS_FAILURE {
+public:
+    explicit brotli_error(int error);
+    int error() const { return error_; }
+    static void check BOOST_PREVENT_MACRO_SUBSTITUTION(int error);
+
+    // Non-throwing version of check: stores in ec a code in
+    // brotli_category(), or errc::not_enough_memory for out-of-memory
+    // conditions, and returns false if error indicates failure.
+    static bool check BOOST_PREVENT_MACRO_SUBSTITUTION
+        (int error, boost::system::error_code& ec);
+private:
+    int error_;
+};
+
+// Returns the category of the error codes reported by the Brotli filters;
+// the values are the constants brotli::param_error, etc., and the error
+// codes of the Brotli decoder.
+BOOST_IOSTREAMS_DECL const boost::system::error_category& brotli_category();
+
+namespace detail {
+
+template<typename Alloc>
+struct brotli_allocator_traits {
+#ifndef BOOST_NO_STD_ALLOCATOR
+    typedef typename Alloc::template rebind<char>::other type;
+#else
+    typedef std::allocator<char> type;
+#endif
+};
+
+template< typename Alloc,
+          typename Base = // VC6 workaround (C2516)
+              BOOST_DEDUCED_TYPENAME brotli_allocator_traits<Alloc>::type >
+struct brotli_allocator : private Base {
+private:
+    typedef typename Base::size_type size_type;
+public:
+    BOOST_STATIC_CONSTANT(bool, custom =
+        (!is_same<std::allocator<char>, Base>::value));
+    typedef typename brotli_allocator_traits<Alloc>::type allocator_type;
+    static void* allocate(void* self, std::size_t size);
+    static void deallocate(void* self, void* address);
+};
+
+class BOOST_IOSTREAMS_DECL brotli_base {
+public:
+    typedef char char_type;
+protected:
+                    // Encoder operations.
+    enum operation { op_process, op_flush, op_finish };
+    brotli_base(const brotli_params& params);
+    ~brotli_base();
+    bool ready() const { return state_ != 0; }
+    template<typename Alloc>
+    void init( bool compress,
+               brotli_allocator<Alloc>& alloc )
+        {
+            bool custom = brotli_allocator<Alloc>::custom;
+            do_init( compress,
+                     custom ? brotli_allocator<Alloc>::allocate : 0,
+                     custom ? brotli_allocator<Alloc>::deallocate : 0,
+                     custom ? &alloc : 0 );
+        }
+
+    // The following return brotli::okay or an error code, and update the
+    // given pointers to reflect the characters consumed and produced.
+    int compress( const char*& src_begin, const char* src_end,
+                  char*& dest_begin, char* dest_end, int op );
+    int decompress( const char*& src_begin, const char* src_end,
+                    char*& dest_begin, char* dest_end, bool flush );
+    bool finished() const;      // Compressor has written the last block.
+    bool output_pending() const; // Compressor holds unwritten output.
+    bool eof() const { return eof_; }
+    void end(bool compress);
+private:
+    void do_init( bool compress,
+                  brotli::alloc_func,
+                  brotli::free_func,
+                  void* derived );
+    brotli_params  params_;
+    void*          state_;   // Actual type: BrotliEncoderState* or
+                             // BrotliDecoderState*.
+    void*          dictionary_; // Actual type:
+                                // BrotliEncoderPreparedDictionary*.
+    bool           eof_;
+};
+
+//
+// Template name: brotli_compressor_impl
+// Description: Model of SymmetricFilter implementing compression by
+//      delegating to the Brotli function BrotliEncoderCompressStream.
+//
+template<typename Alloc = std::allocator<char> >
+class brotli_compressor_impl
+    : public brotli_base,
+      #if BOOST_WORKAROUND(__BORLANDC__, < 0x600)
+          public
+      #endif
+      brotli_allocator<Alloc>
+{
+public:
+    typedef void error_code_support;
+    brotli_compressor_impl(const brotli_params& = brotli::default_quality);
+    ~brotli_compressor_impl();
+    bool filter( const char*& src_begin, const char* src_end,
+                 char*& dest_begin, char* dest_end, bool flush );
+    bool filter( const char*& src_begin, const char* src_end,
+                 char*& dest_begin, char* dest_end, bool flush,
+                 boost::system::error_code& ec );
+    void close();
+
+    // Causes the next calls to filter() with no input to emit all data
+    // received so far, as by BROTLI_OPERATION_FLUSH.
+    void sync() { flush_ = true; }
+private:
+    int compress_step( const char*& src_begin, const char* src_end,
+                       char*& dest_begin, char* dest_end, bool flush );
+    bool flush_;
+};
+
+//
+// Template name: brotli_decompressor_impl
+// Description: Model of SymmetricFilter implementing decompression by
+//      delegating to the Brotli function BrotliDecoderDecompressStream.
+//
+template<typename Alloc = std::allocator<char> >
+class brotli_decompressor_impl
+    : public brotli_base,
+      #if BOOST_WORKAROUND(__BORLANDC__, < 0x600)
+          public
+      #endif
+      brotli_allocator<Alloc>
+{
+public:
+    typedef void error_code_support;
+    brotli_decompressor_impl(const brotli_params& = brotli_params());
+    ~brotli_decompressor_impl();
+    bool filter( const char*& begin_in, const char* end_in,
+                 char*& begin_out, char* end_out, bool flush );
+    bool filter( const char*& begin_in, const char* end_in,
+                 char*& begin_out, char* end_out, bool flush,
+                 boost::system::error_code& ec );
+    void close();
+};
+
+} // End namespace detail.
+
+//
+// Template name: brotli_compressor
+// Description: Model of InputFilter and OutputFilter implementing
+//      compression using Brotli. When used for output, flush() writes all
+//      data received so far to the downstream Sink, so that it can be
+//      decompressed immediately; frequent flushing reduces compression.
+//
+template<typename Alloc = std::allocator<char> >
+struct basic_brotli_compressor
+    : symmetric_filter<detail::brotli_compressor_impl<Alloc>, Alloc>
+{
+private:
+    typedef detail::brotli_compressor_impl<Alloc>       impl_type;
+    typedef symmetric_filter<impl_type, Alloc>          base_type;
+public:
+    typedef typename base_type::char_type               char_type;
+    struct category
+        : base_type::category,
+          flushable_tag
+        { };
+    basic_brotli_compressor( const brotli_params& = brotli::default_quality,
+                             int buffer_size = default_device_buffer_size );
+
+    template<typename Sink>
+    bool flush(Sink& snk)
+    {
+        // Flushing is meaningless for input
+        if (this->drain(snk)) {
+            this->filter().sync();
+            this->drain(snk);
+        }
+        return true;
+    }
+};
+BOOST_IOSTREAMS_PIPABLE(basic_brotli_compressor, 1)
+
+typedef basic_brotli_compressor<> brotli_compressor;
+
+//
+// Template name: brotli_decompressor
+// Description: Model of InputFilter and OutputFilter implementing
+//      decompression using Brotli.
+//
+template<typename Alloc = std::allocator<char> >
+struct basic_brotli_decompressor
+    : symmetric_filter<detail::brotli_decompressor_impl<Alloc>, Alloc>
+{
+private:
+    typedef detail::brotli_decompressor_impl<Alloc>     impl_type;
+    typedef symmetric_filter<impl_type, Alloc>          base_type;
+public:
+    typedef typename base_type::char_type               char_type;
+    typedef typename base_type::category                category;
+    basic_brotli_decompressor( const brotli_params& = brotli_params(),
+                               int buffer_size = default_device_buffer_size );
+};
+BOOST_IOSTREAMS_PIPABLE(basic_brotli_decompressor, 1)
+
+typedef basic_brotli_decompressor<> brotli_decompressor;
+
+//----------------------------------------------------------------------------//
+
+//------------------Implementation of brotli_allocator------------------------//
+
+namespace detail {
+
+template<typename Alloc, typename Base>
+void* brotli_allocator<Alloc, Base>::allocate(void* self, std::size_t size)
+{
+    size_type len = static_cast<size_type>(size);
+    char* ptr;
+    try {
+        ptr = static_cast<allocator_type*>(self)->allocate
+                  (len + sizeof(size_type)
+                  #if BOOST_WORKAROUND(BOOST_DINKUMWARE_STDLIB, == 1)
+                      , (char*)0
+                  #endif
+                  );
+    } catch (...) {
+        return 0; // Reported as a memory error; must not propagate into C.
+    }
+    *reinterpret_cast<size_type*>(ptr) = len;
+    return ptr + sizeof(size_type);
+}
+
+template<typename Alloc, typename Base>
+void brotli_allocator<Alloc, Base>::deallocate(void* self, void* address)
+{
+    if (!address)
+        return;
+    char* ptr = reinterpret_cast<char*>(address) - sizeof(size_type);
+    size_type len = *reinterpret_cast<size_type*>(ptr) + sizeof(size_type);
+    static_cast<allocator_type*>(self)->deallocate(ptr, len);
+}
+
+//------------------Implementation of brotli_compressor_impl------------------//
+
+template<typename Alloc>
+brotli_compressor_impl<Alloc>::brotli_compressor_impl(const brotli_params& p)
+    : brotli_base(p), flush_(false) { }
+
+template<typename Alloc>
+brotli_compressor_impl<Alloc>::~brotli_compressor_impl() { end(true); }
+
+template<typename Alloc>
+bool brotli_compressor_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    int result = compress_step(src_begin, src_end, dest_begin, dest_end, flush);
+    brotli_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result);
+    return !(flush && finished());
+}
+
+template<typename Alloc>
+bool brotli_compressor_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush,
+      boost::system::error_code& ec )
+{
+    int result = compress_step(src_begin, src_end, dest_begin, dest_end, flush);
+    return brotli_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result, ec) &&
+           !(flush && finished());
+}
+
+template<typename Alloc>
+void brotli_compressor_impl<Alloc>::close()
+{
+    flush_ = false;
+    end(true);
+}
+
+template<typename Alloc>
+int brotli_compressor_impl<Alloc>::compress_step
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    if (!ready())
+        init(true, static_cast<brotli_allocator<Alloc>&>(*this));
+
+    // Calls with no input are only made to complete a flush
+    if (src_begin == src_end && !flush && !flush_)
+        return brotli::okay;
+    int result =
+        compress( src_begin, src_end, dest_begin, dest_end,
+                  flush ? op_finish : flush_ ? op_flush : op_process );
+    if (flush_ && src_begin == src_end && !output_pending())
+        flush_ = false;
+    return result;
+}
+
+//------------------Implementation of brotli_decompressor_impl----------------//
+
+template<typename Alloc>
+brotli_decompressor_impl<Alloc>::brotli_decompressor_impl
+    (const brotli_params& p)
+    : brotli_base(p) { }
+
+template<typename Alloc>
+brotli_decompressor_impl<Alloc>::~brotli_decompressor_impl() { end(false); }
+
+template<typename Alloc>
+bool brotli_decompressor_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    if (!ready())
+        init(false, static_cast<brotli_allocator<Alloc>&>(*this));
+    int result = decompress(src_begin, src_end, dest_begin, dest_end, flush);
+    brotli_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result);
+    return !eof();
+}
+
+template<typename Alloc>
+bool brotli_decompressor_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush,
+      boost::system::error_code& ec )
+{
+    if (!ready())
+        init(false, static_cast<brotli_allocator<Alloc>&>(*this));
+    int result = decompress(src_begin, src_end, dest_begin, dest_end, flush);
+    return brotli_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result, ec) &&
+           !eof();
+}
+
+template<typename Alloc>
+void brotli_decompressor_impl<Alloc>::close() { end(false); }
+
+} // End namespace detail.
+
+//------------------Implementation of brotli_compressor-----------------------//
+
+template<typename Alloc>
+basic_brotli_compressor<Alloc>::basic_brotli_compressor
+        (const brotli_params& p, int buffer_size)
+    : base_type(buffer_size, p)
+    { }
+
+//------------------Implementation of brotli_decompressor---------------------//
+
+template<typename Alloc>
+basic_brotli_decompressor<Alloc>::basic_brotli_decompressor
+        (const brotli_params& p, int buffer_size)
+    : base_type(buffer_size, p)
+    { }
+
+//----------------------------------------------------------------------------//
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+#ifdef BOOST_MSVC
+# pragma warning(pop)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_BROTLI_HPP_INCLUDED
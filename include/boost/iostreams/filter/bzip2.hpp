@@ -28,6 +28,7 @@
 #include <boost/iostreams/detail/ios.hpp>  // failure, streamsize.
 #include <boost/iostreams/filter/symmetric.hpp>               
 #include <boost/iostreams/pipeline.hpp>       
+#include <boost/system/error_code.hpp>
 #include <boost/type_traits/is_same.hpp>     
 
 // Must come last.
@@ -114,10 +115,20 @@ public:
     explicit bzip2_error(int error);
     int error() const { return error_; }
     static void check BOOST_PREVENT_MACRO_SUBSTITUTION(int error);
+
+    // Non-throwing version of check: stores in ec a code in 
+    // bzip2_category(), or errc::not_enough_memory for out-of-memory 
+    // conditions, and returns false if error indicates failure.
+    static bool check BOOST_PREVENT_MACRO_SUBSTITUTION
+        (int error, boost::system::error_code& ec);
 private:
     int error_;
 };
 
+// Returns the category of the error codes reported by the bzip2 filters; the
+// values are libbzip2's return codes.
+BOOST_IOSTREAMS_DECL const boost::system::error_category& bzip2_category();
+
 namespace detail {
 
 template<typename Alloc>
@@ -196,9 +207,13 @@ class bzip2_compressor_impl
       bzip2_allocator<Alloc> 
 {
 public: 
+    typedef void error_code_support;
     bzip2_compressor_impl(const bzip2_params&);
     bool filter( const char*& src_begin, const char* src_end,
                  char*& dest_begin, char* dest_end, bool flush );
+    bool filter( const char*& src_begin, const char* src_end,
+                 char*& dest_begin, char* dest_end, bool flush,
+                 boost::system::error_code& ec );
     void close();
 private:
     void init();
@@ -219,9 +234,13 @@ class bzip2_decompressor_impl
       bzip2_allocator<Alloc> 
 { 
 public:
+    typedef void error_code_support;
     bzip2_decompressor_impl(bool small = bzip2::default_small);
     bool filter( const char*& begin_in, const char* end_in,
                  char*& begin_out, char* end_out, bool flush );
+    bool filter( const char*& begin_in, const char* end_in,
+                 char*& begin_out, char* end_out, bool flush,
+                 boost::system::error_code& ec );
     void close();
 private:
     void init();
@@ -284,13 +303,17 @@ template<typename Alloc, typename Base>
 void* bzip2_allocator<Alloc, Base>::allocate(void* self, int items, int size)
 { 
     size_type len = items * size;
-    char* ptr = 
-        static_cast<allocator_type*>(self)->allocate
-            (len + sizeof(size_type)
-            #if BOOST_WORKAROUND(BOOST_DINKUMWARE_STDLIB, == 1)
-                , (char*)0
-            #endif
-            );
+    char* ptr;
+    try {
+        ptr = static_cast<allocator_type*>(self)->allocate
+                  (len + sizeof(size_type)
+                  #if BOOST_WORKAROUND(BOOST_DINKUMWARE_STDLIB, == 1)
+                      , (char*)0
+                  #endif
+                  );
+    } catch (...) {
+        return 0; // Reported as a memory error; must not propagate into C.
+    }
     *reinterpret_cast<size_type*>(ptr) = len;
     return ptr + sizeof(size_type);
 }
@@ -323,6 +346,21 @@ bool bzip2_compressor_impl<Alloc>::filter
     return !(eof_ = result == bzip2::stream_end);
 }
 
+template<typename Alloc>
+bool bzip2_compressor_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush,
+      boost::system::error_code& ec )
+{
+    if (!ready()) init();
+    if (eof_) return false;
+    before(src_begin, src_end, dest_begin, dest_end);
+    int result = compress(flush ? bzip2::finish : bzip2::run);
+    after(src_begin, dest_begin);
+    return bzip2_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result, ec) &&
+           !(eof_ = result == bzip2::stream_end);
+}
+
 template<typename Alloc>
 void bzip2_compressor_impl<Alloc>::close() 
 { 
@@ -369,6 +407,32 @@ bool bzip2_decompressor_impl<Alloc>::filter
     return true; 
 }
 
+template<typename Alloc>
+bool bzip2_decompressor_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush,
+      boost::system::error_code& ec )
+{
+    if (eof_) {
+        // reset the stream if there are more characters
+        if(src_begin == src_end)
+            return false;
+        else
+            close();
+    }
+    if (!ready()) 
+        init();
+    before(src_begin, src_end, dest_begin, dest_end);
+    int result = decompress();
+    if(result == bzip2::ok && flush)
+        result = check_end(src_begin, dest_begin);
+    after(src_begin, dest_begin);
+    if (!bzip2_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result, ec))
+        return false;
+    eof_ = result == bzip2::stream_end;
+    return true; 
+}
+
 template<typename Alloc>
 void bzip2_decompressor_impl<Alloc>::close() 
 { 
@@ -0,0 +1,210 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definition of the class dfa_regex, a regular expression
+// compiled to deterministic finite automata, and of dfa_regex_engine, which
+// allows it to be used with basic_grep_filter and basic_regex_filter:
+//
+//     basic_grep_filter<char, dfa_regex_engine> grep(dfa_regex("err(or)?"));
+//
+// Matching takes time linear in the length of the text, independent of the
+// pattern, but only patterns without backreferences, lookaround, lazy or
+// possessive quantifiers and word boundaries are supported, and an
+// exception is thrown if the automata would have too many states. The
+// supported syntax is that of Perl, restricted to literals, escapes such
+// as \d, \w, \s and \x41, ".", bracket expressions, including the classes
+// [:alpha:], etc., groups, "|", and the quantifiers "*", "+", "?" and
+// {m,n}. "^" and "$" may appear only at the beginning and end of the
+// pattern, and match only at the beginning and end of the text. Where
+// several matches begin at the same position, the longest is chosen, as in
+// POSIX.
+
+#ifndef BOOST_IOSTREAMS_DFA_REGEX_HPP_INCLUDED
+#define BOOST_IOSTREAMS_DFA_REGEX_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <cstddef>                            // size_t.
+#include <stdexcept>                          // runtime_error.
+#include <string>
+#include <vector>
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/shared_ptr.hpp>
+
+// Must come last.
+#ifdef BOOST_MSVC
+# pragma warning(push)
+# pragma warning(disable:4251 4231 4660 4275)
+#endif
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace dfa {
+
+                    // Syntax options
+
+const int normal          = 0;
+const int icase           = 1;
+
+                    // Match flags
+
+const int match_default   = 0;
+const int match_not_bol   = 1;
+const int match_not_eol   = match_not_bol << 1;
+
+                    // Default values
+
+const std::size_t default_max_states = 10000;
+
+} // End namespace dfa.
+
+//
+// Class name: dfa_regex_error.
+// Description: Exception thrown to indicate invalid or unsupported
+//      patterns, and patterns whose automata would be too large.
+//
+class BOOST_IOSTREAMS_DECL dfa_regex_error : public std::runtime_error {
+public:
+    explicit dfa_regex_error(const std::string& what)
+        : std::runtime_error(what)
+        { }
+};
+
+//
+// Class name: dfa_match.
+// Description: The range of characters matched by a dfa_regex.
+//
+struct dfa_match {
+    dfa_match() : first(0), second(0) { }
+    dfa_match(const char* first, const char* second)
+        : first(first), second(second)
+        { }
+    std::size_t length() const
+    { return static_cast<std::size_t>(second - first); }
+    std::string str() const { return std::string(first, second); }
+    const char*  first;
+    const char*  second;
+};
+
+namespace detail {
+
+class dfa_regex_impl;
+
+} // End namespace detail.
+
+//
+// Class name: dfa_regex.
+// Description: Regular expression compiled to deterministic finite
+//      automata. Copies share their automata, which are never modified, so
+//      that a dfa_regex may be used by several threads at once.
+//
+class BOOST_IOSTREAMS_DECL dfa_regex {
+public:
+    explicit dfa_regex( const std::string& pattern,
+                        int options = dfa::normal,
+                        std::size_t max_states = dfa::default_max_states );
+    explicit dfa_regex( const char* pattern,
+                        int options = dfa::normal,
+                        std::size_t max_states = dfa::default_max_states );
+
+    // Returns true if the expression matches some subsequence of
+    // [first, last).
+    bool search( const char* first, const char* last,
+                 int flags = dfa::match_default ) const;
+
+    // Returns true if the expression matches all of [first, last).
+    bool match( const char* first, const char* last,
+                int flags = dfa::match_default ) const;
+
+    // Appends to matches the successive leftmost longest matches in
+    // [first, last); an empty match is never followed by one beginning at
+    // the same position.
+    void find_all( const char* first, const char* last,
+                   std::vector<dfa_match>& matches,
+                   int flags = dfa::match_default ) const;
+private:
+    void init(const std::string& pattern, int options, std::size_t max_states);
+    boost::shared_ptr<const detail::dfa_regex_impl> pimpl_;
+};
+
+//
+// Class name: dfa_regex_engine.
+// Description: Regex engine, as described in
+//      <boost/iostreams/filter/regex_engine.hpp>, based on dfa_regex. In
+//      format strings, "$&" and "$0" stand for the match and "$$" for "$".
+//
+struct dfa_regex_engine {
+    typedef void                 regex_engine_tag;
+    typedef char                 char_type;
+    typedef std::string          string_type;
+    typedef dfa_regex            regex_type;
+    typedef int                  flag_type;
+    typedef dfa_match            match_type;
+
+    static flag_type match_default() { return dfa::match_default; }
+    static flag_type format_default() { return 0; }
+
+    static bool search( const char* first, const char* last,
+                        const regex_type& re, flag_type flags )
+    { return re.search(first, last, flags); }
+
+    static bool match( const char* first, const char* last,
+                       const regex_type& re, flag_type flags )
+    { return re.match(first, last, flags); }
+
+    template<typename Formatter, typename Vector>
+    static void replace( const char* first, const char* last,
+                         const regex_type& re, flag_type flags,
+                         const Formatter& fmt, Vector& dest )
+    {
+        std::vector<dfa_match> matches;
+        re.find_all(first, last, matches, flags);
+        const char* prefix = first;
+        for (std::size_t z = 0; z < matches.size(); ++z) {
+            dest.insert(dest.end(), prefix, matches[z].first);
+            string_type replacement = fmt(matches[z]);
+            dest.insert(dest.end(), replacement.begin(), replacement.end());
+            prefix = matches[z].second;
+        }
+        dest.insert(dest.end(), prefix, last);
+    }
+
+    static string_type format( const match_type& m, const string_type& fmt,
+                               flag_type )
+    {
+        string_type result;
+        for (string_type::size_type z = 0; z < fmt.size(); ++z) {
+            if (fmt[z] == '$' && z + 1 < fmt.size()) {
+                char c = fmt[z + 1];
+                if (c == '&' || c == '0') {
+                    result.append(m.first, m.second);
+                    ++z;
+                    continue;
+                } else if (c == '$') {
+                    result += '$';
+                    ++z;
+                    continue;
+                }
+            }
+            result += fmt[z];
+        }
+        return result;
+    }
+};
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+#ifdef BOOST_MSVC
+# pragma warning(pop)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_DFA_REGEX_HPP_INCLUDED
@@ -11,7 +11,8 @@
  * Contact:     turkanis at coderage dot com
  *
  * Defines the class template basic_grep_filter and its specializations
- * grep_filter and wgrep_filter.
+ * grep_filter and wgrep_filter. The regex traits argument may instead be a
+ * regex engine, as described in <boost/iostreams/filter/regex_engine.hpp>.
  */
 
 #ifndef BOOST_IOSTREAMS_GREP_FILTER_HPP_INCLUDED
@@ -26,8 +27,11 @@
 #include <memory>  // allocator.
 #include <boost/iostreams/char_traits.hpp>   
 #include <boost/iostreams/filter/line.hpp>              
+#include <boost/iostreams/filter/regex_engine.hpp>
 #include <boost/iostreams/pipeline.hpp>
 #include <boost/regex.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_same.hpp>
 
 namespace boost { namespace iostreams {
 
@@ -49,11 +53,16 @@ public:
     typedef typename base_type::category               category;
     typedef char_traits<char_type>                     traits_type;
     typedef typename base_type::string_type            string_type;
-    typedef basic_regex<Ch, Tr>                        regex_type;
-    typedef regex_constants::match_flag_type           match_flag_type;
+    typedef typename
+            detail::regex_engine_of<Ch, Tr>::type      engine_type;
+    typedef typename engine_type::regex_type           regex_type;
+    typedef typename engine_type::flag_type            match_flag_type;
+    BOOST_STATIC_ASSERT((
+        is_same<Ch, typename engine_type::char_type>::value
+    ));
     basic_grep_filter( const regex_type& re,
                        match_flag_type match_flags = 
-                           regex_constants::match_default,
+                           engine_type::match_default(),
                        int options = 0 );
     int count() const { return count_; }
 
@@ -70,9 +79,11 @@ private:
             options_ |= f_initialized;
             count_ = 0;
         }
-        bool matches = (options_ & grep::whole_line) ?
-            regex_match(line, re_, match_flags_) :
-            regex_search(line, re_, match_flags_);
+        const Ch*  first = line.data();
+        const Ch*  last = first + line.size();
+        bool       matches = (options_ & grep::whole_line) ?
+            engine_type::match(first, last, re_, match_flags_) :
+            engine_type::search(first, last, re_, match_flags_);
         if (options_ & grep::invert)
             matches = !matches;
         if (matches)
@@ -174,6 +174,11 @@ private:
     int zlib_error_code_;
 };
 
+// Returns the category of the error codes reported by gzip_decompressor for
+// errors in the gzip format, i.e., the constants gzip::bad_crc, etc.; errors 
+// detected by zlib are reported in zlib_category().
+BOOST_IOSTREAMS_DECL const boost::system::error_category& gzip_category();
+
 //------------------Definition of gzip_compressor-----------------------------//
 
 //
@@ -265,6 +270,31 @@ public:
         }
         close_impl();
     }
+
+    // Writes the header, if necessary, and a sync point to snk, and returns
+    // a checkpoint from which a compressor can continue the current member
+    // after the output has been truncated to the checkpoint's
+    // compressed_offset. Requires a blocking Sink.
+    template<typename Sink>
+    zlib_checkpoint checkpoint(Sink& snk)
+    {
+        write(snk, 0, 0);
+        zlib_checkpoint cp = base_type::checkpoint(snk);
+        cp.compressed_offset += header_.size();
+        return cp;
+    }
+
+    // Continues the member from which the given checkpoint was taken; the
+    // header is not written again. Must be called before any data is
+    // written.
+    void restore(const zlib_checkpoint& cp)
+    {
+        zlib_checkpoint body(cp);
+        body.compressed_offset -= header_.size();
+        base_type::restore(body);
+        close_impl();
+        flags_ = f_header_done;
+    }
 private:
     static gzip_params normalize_params(gzip_params p);
     void prepare_footer();
@@ -328,6 +358,7 @@ public:
 
     // Members for processing header data
     void process(char c);
+    int try_process(char c); // Returns 0 or a gzip error code; doesn't throw.
     bool done() const { return state_ == s_done; }
     void reset();
 
@@ -408,13 +439,157 @@ public:
         : dual_use,
           filter_tag,
           multichar_tag,
-          closable_tag
+          closable_tag,
+          error_code_tag
         { };
     basic_gzip_decompressor( int window_bits = gzip::default_window_bits,
                              int buffer_size = default_device_buffer_size );
 
     template<typename Sink>
     std::streamsize write(Sink& snk, const char_type* s, std::streamsize n)
+    { return write_impl(snk, s, n, 0); }
+
+    template<typename Sink>
+    std::streamsize write( Sink& snk, const char_type* s, std::streamsize n,
+                           boost::system::error_code& ec )
+    {
+        ec.clear();
+        return write_impl(snk, s, n, &ec);
+    }
+
+    template<typename Source>
+    std::streamsize read(Source& src, char_type* s, std::streamsize n)
+    { return read_impl(src, s, n, 0); }
+
+    template<typename Source>
+    std::streamsize read( Source& src, char_type* s, std::streamsize n,
+                          boost::system::error_code& ec )
+    {
+        ec.clear();
+        return read_impl(src, s, n, &ec);
+    }
+
+    template<typename Source>
+    void close(Source& src, BOOST_IOS::openmode m)
+    { close_impl(src, m, 0); }
+
+    template<typename Source>
+    void close( Source& src, BOOST_IOS::openmode m, 
+                boost::system::error_code& ec )
+    {
+        ec.clear();
+        close_impl(src, m, &ec);
+    }
+
+    std::string file_name() const { return header_.file_name(); }
+    std::string comment() const { return header_.comment(); }
+    bool text() const { return header_.text(); }
+    int os() const { return header_.os(); }
+    std::time_t mtime() const { return header_.mtime(); }
+
+    // Checkpoints are recorded within the bodies of members, as described
+    // for basic_zlib_decompressor; offsets are relative to the beginning of
+    // the first member. A decompressor passed a checkpoint by restore()
+    // resumes in the body of the member, verifying its footer when the
+    // body ends; the header fields of the member are not restored.
+    void enable_checkpoints(std::streamsize spacing)
+    { base_type::enable_checkpoints(spacing); }
+    bool has_checkpoint() { return base_type::has_checkpoint(); }
+    zlib_checkpoint checkpoint() { return base_type::checkpoint(); }
+    void restore(const zlib_checkpoint& cp)
+    {
+        base_type::restore(cp);
+        header_.reset();
+        footer_.reset();
+        putback_.clear();
+        state_ = s_body;
+    }
+private:
+    static gzip_params make_params(int window_bits);
+
+    // Source adapter allowing an arbitrary character sequence to be put back.
+    template<typename Source>
+    struct peekable_source {
+        typedef char char_type;
+        struct category : source_tag, peekable_tag, error_code_tag { };
+        explicit peekable_source(Source& src, const string_type& putback = "") 
+            : src_(src), putback_(putback), offset_(0)
+            { }
+        std::streamsize read(char* s, std::streamsize n)
+        { return read(s, n, 0); }
+        std::streamsize 
+        read(char* s, std::streamsize n, boost::system::error_code& ec)
+        {
+            ec.clear();
+            return read(s, n, &ec);
+        }
+        std::streamsize 
+        read(char* s, std::streamsize n, boost::system::error_code* ec)
+        {
+            std::streamsize result = 0;
+
+            // Copy characters from putback buffer
+            std::streamsize pbsize = 
+                static_cast<std::streamsize>(putback_.size());
+            if (offset_ < pbsize) {
+                result = (std::min)(n, pbsize - offset_);
+                BOOST_IOSTREAMS_CHAR_TRAITS(char)::copy(
+                    s, putback_.data() + offset_, result);
+                offset_ += result;
+                if (result == n)
+                    return result;
+            }
+
+            // Read characters from src_
+            std::streamsize amt = ec ?
+                boost::iostreams::read(src_, s + result, n - result, *ec) :
+                boost::iostreams::read(src_, s + result, n - result);
+            if (ec && *ec)
+                return -1;
+            return amt != -1 ? 
+                result + amt : 
+                result ? result : -1;
+        }
+        bool putback(char c)
+        {
+            if (offset_) {
+                putback_[--offset_] = c;
+            } else {
+                boost::throw_exception(
+                    boost::iostreams::detail::bad_putback());
+            }
+            return true;
+        }
+        void putback(const string_type& s)
+        {
+            putback_.replace(0, offset_, s);
+            offset_ = 0;
+        }
+
+        // Returns true if some characters have been putback but not re-read.
+        bool has_unconsumed_input() const 
+        {
+            return offset_ < static_cast<std::streamsize>(putback_.size());
+        }
+
+        // Returns the sequence of characters that have been put back but not re-read.
+        string_type unconsumed_input() const
+        {
+            return string_type( putback_, offset_, putback_.size() - offset_,
+                                putback_.get_allocator() );
+        }
+        Source&          src_;
+        string_type      putback_;
+        std::streamsize  offset_;
+    };
+
+    // The following functions report errors through *ec if ec is non-null,
+    // and by throwing gzip_error otherwise.
+
+    template<typename Sink>
+    std::streamsize write_impl( Sink& snk, const char_type* s, 
+                                std::streamsize n, 
+                                boost::system::error_code* ec )
     {
         std::streamsize result = 0;
         while(result < n) {
@@ -425,32 +600,47 @@ public:
             }
             if (state_ == s_header) {
                 int c = s[result++];
-                header_.process(c);
+                if (int error = header_.try_process(c))
+                    return fail(error, ec, result);
+                ++compressed_;
                 if (header_.done())
-                    state_ = s_body;
+                    begin_body();
             } else if (state_ == s_body) {
-                try {
-                    std::streamsize amt = 
-                        base_type::write(snk, s + result, n - result);
-                    result += amt;
-                    if (!this->eof()) {
-                        break;
-                    } else {
-                        state_ = s_footer;
+                std::streamsize amt;
+                if (ec) {
+                    amt = base_type::write(snk, s + result, n - result, *ec);
+                    if (*ec)
+                        return result + amt;
+                } else {
+                    try {
+                        amt = base_type::write(snk, s + result, n - result);
+                    } catch (const zlib_error& e) {
+                        boost::throw_exception(gzip_error(e));
                     }
-                } catch (const zlib_error& e) {
-                    boost::throw_exception(gzip_error(e));
+                }
+                result += amt;
+                if (!this->eof()) {
+                    break;
+                } else {
+                    end_body();
                 }
             } else { // state_ == s_footer
                 if (footer_.done()) {
                     if (footer_.crc() != this->crc())
-                        boost::throw_exception(gzip_error(gzip::bad_crc));
+                        return fail(gzip::bad_crc, ec, result);
 
-                    base_type::close(snk, BOOST_IOS::out);
+                    if (ec) {
+                        base_type::close(snk, BOOST_IOS::out, *ec);
+                        if (*ec)
+                            return result;
+                    } else {
+                        base_type::close(snk, BOOST_IOS::out);
+                    }
                     state_ = s_start;
                 } else {
                     int c = s[result++];
                     footer_.process(c);
+                    ++compressed_;
                 }
             }
         }
@@ -458,7 +648,8 @@ public:
     }
 
     template<typename Source>
-    std::streamsize read(Source& src, char_type* s, std::streamsize n)
+    std::streamsize read_impl( Source& src, char_type* s, std::streamsize n,
+                               boost::system::error_code* ec )
     {
         typedef char_traits<char>  traits_type;
         std::streamsize            result = 0;
@@ -470,43 +661,58 @@ public:
                 footer_.reset();
             }
             if (state_ == s_header) {
-                int c = boost::iostreams::get(peek);
-                if (traits_type::is_eof(c)) {
-                    boost::throw_exception(gzip_error(gzip::bad_header));
+                int c = get(peek, ec);
+                if (ec && *ec) {
+                    return -1;
+                } else if (traits_type::is_eof(c)) {
+                    return fail(gzip::bad_header, ec, -1);
                 } else if (traits_type::would_block(c)) {
                     break;
                 }
-                header_.process(c);
+                if (int error = header_.try_process(c))
+                    return fail(error, ec, -1);
+                ++compressed_;
                 if (header_.done())
-                    state_ = s_body;
+                    begin_body();
             } else if (state_ == s_body) {
-                try {
-                    std::streamsize amt = 
-                        base_type::read(peek, s + result, n - result);
-                    if (amt != -1) {
-                        result += amt;
-                        if (amt < n - result)
-                            break;
-                    } else {
-                        peek.putback(this->unconsumed_input());
-                        state_ = s_footer;
+                std::streamsize amt;
+                if (ec) {
+                    amt = base_type::read(peek, s + result, n - result, *ec);
+                    if (*ec)
+                        return -1;
+                } else {
+                    try {
+                        amt = base_type::read(peek, s + result, n - result);
+                    } catch (const zlib_error& e) {
+                        boost::throw_exception(gzip_error(e));
                     }
-                } catch (const zlib_error& e) {
-                    boost::throw_exception(gzip_error(e));
+                }
+                if (amt != -1) {
+                    result += amt;
+                    if (amt < n - result)
+                        break;
+                } else {
+                    peek.putback(this->unconsumed_input());
+                    end_body();
                 }
             } else { // state_ == s_footer
-                int c = boost::iostreams::get(peek);
-                if (traits_type::is_eof(c)) {
-                    boost::throw_exception(gzip_error(gzip::bad_footer));
+                int c = get(peek, ec);
+                if (ec && *ec) {
+                    return -1;
+                } else if (traits_type::is_eof(c)) {
+                    return fail(gzip::bad_footer, ec, -1);
                 } else if (traits_type::would_block(c)) {
                     break;
                 }
                 footer_.process(c);
+                ++compressed_;
                 if (footer_.done()) {
                     if (footer_.crc() != this->crc())
-                        boost::throw_exception(gzip_error(gzip::bad_crc));
-                    int c = boost::iostreams::get(peek);
-                    if (traits_type::is_eof(c)) {
+                        return fail(gzip::bad_crc, ec, -1);
+                    int c = get(peek, ec);
+                    if (ec && *ec) {
+                        return -1;
+                    } else if (traits_type::is_eof(c)) {
                         state_ = s_done;
                     } else {
                         peek.putback(c);
@@ -529,101 +735,88 @@ public:
     }
 
     template<typename Source>
-    void close(Source& src, BOOST_IOS::openmode m)
+    void close_impl( Source& src, BOOST_IOS::openmode m, 
+                     boost::system::error_code* ec )
     {
-        try {
-            base_type::close(src, m);
-        } catch (const zlib_error& e) {
-            state_ = s_start;
-            boost::throw_exception(gzip_error(e));
+        compressed_ = uncompressed_ = 0;
+        if (ec) {
+            base_type::close(src, m, *ec);
+            if (*ec) {
+                state_ = s_start;
+                return;
+            }
+        } else {
+            try {
+                base_type::close(src, m);
+            } catch (const zlib_error& e) {
+                state_ = s_start;
+                boost::throw_exception(gzip_error(e));
+            }
         }
         if (m == BOOST_IOS::out) {
+            int error = 0;
             if (state_ == s_start || state_ == s_header)
-                boost::throw_exception(gzip_error(gzip::bad_header));
+                error = gzip::bad_header;
             else if (state_ == s_body)
-                boost::throw_exception(gzip_error(gzip::bad_footer));
+                error = gzip::bad_footer;
             else if (state_ == s_footer) {
                 if (!footer_.done())
-                    boost::throw_exception(gzip_error(gzip::bad_footer));
+                    error = gzip::bad_footer;
                 else if(footer_.crc() != this->crc())
-                    boost::throw_exception(gzip_error(gzip::bad_crc));
+                    error = gzip::bad_crc;
             } else {
                 BOOST_ASSERT(!"Bad state");
             }
+            if (error) {
+                fail(error, ec, 0);
+                return;
+            }
         }
         state_ = s_start;
     }
 
-    std::string file_name() const { return header_.file_name(); }
-    std::string comment() const { return header_.comment(); }
-    bool text() const { return header_.text(); }
-    int os() const { return header_.os(); }
-    std::time_t mtime() const { return header_.mtime(); }
-private:
-    static gzip_params make_params(int window_bits);
+    // The offsets reported in checkpoints are maintained by the zlib
+    // decompressor within member bodies, and by the following functions
+    // and compressed_ and uncompressed_ elsewhere.
+    void begin_body()
+    {
+        this->filter().set_offsets(compressed_, uncompressed_);
+        state_ = s_body;
+    }
+    void end_body()
+    {
+        compressed_ = this->filter().compressed_offset();
+        uncompressed_ = this->filter().uncompressed_offset();
+        state_ = s_footer;
+    }
 
-    // Source adapter allowing an arbitrary character sequence to be put back.
+    // Reads a character from peek, reporting errors through *ec if ec is 
+    // non-null.
     template<typename Source>
-    struct peekable_source {
-        typedef char char_type;
-        struct category : source_tag, peekable_tag { };
-        explicit peekable_source(Source& src, const string_type& putback = "") 
-            : src_(src), putback_(putback), offset_(0)
-            { }
-        std::streamsize read(char* s, std::streamsize n)
-        {
-            std::streamsize result = 0;
-
-            // Copy characters from putback buffer
-            std::streamsize pbsize = 
-                static_cast<std::streamsize>(putback_.size());
-            if (offset_ < pbsize) {
-                result = (std::min)(n, pbsize - offset_);
-                BOOST_IOSTREAMS_CHAR_TRAITS(char)::copy(
-                    s, putback_.data() + offset_, result);
-                offset_ += result;
-                if (result == n)
-                    return result;
-            }
-
-            // Read characters from src_
-            std::streamsize amt = 
-                boost::iostreams::read(src_, s + result, n - result);
-            return amt != -1 ? 
-                result + amt : 
-                result ? result : -1;
-        }
-        bool putback(char c)
-        {
-            if (offset_) {
-                putback_[--offset_] = c;
-            } else {
-                boost::throw_exception(
-                    boost::iostreams::detail::bad_putback());
-            }
-            return true;
-        }
-        void putback(const string_type& s)
-        {
-            putback_.replace(0, offset_, s);
-            offset_ = 0;
-        }
-
-        // Returns true if some characters have been putback but not re-read.
-        bool has_unconsumed_input() const 
-        {
-            return offset_ < static_cast<std::streamsize>(putback_.size());
-        }
+    static int get(peekable_source<Source>& peek, boost::system::error_code* ec)
+    {
+        typedef char_traits<char>  traits_type;
+        if (!ec)
+            return boost::iostreams::get(peek);
+        char c;
+        std::streamsize amt = peek.read(&c, 1, *ec);
+        return amt == 1 ?
+            traits_type::to_int_type(c) :
+            amt == 0 ?
+                traits_type::would_block() :
+                traits_type::eof();
+    }
 
-        // Returns the sequence of characters that have been put back but not re-read.
-        string_type unconsumed_input() const
-        {
-            return string_type(putback_, offset_, putback_.size() - offset_);
-        }
-        Source&          src_;
-        string_type      putback_;
-        std::streamsize  offset_;
-    };
+    // Reports the given gzip error and returns result, if ec is non-null;
+    // throws gzip_error otherwise.
+    static std::streamsize 
+    fail(int error, boost::system::error_code* ec, std::streamsize result)
+    {
+        if (!ec)
+            boost::throw_exception(gzip_error(error));
+        ec->assign(error, gzip_category());
+        return result;
+    }
 
     enum state_type {
         s_start   = 1,
@@ -636,6 +829,8 @@ private:
     detail::gzip_footer  footer_;
     string_type          putback_;
     int                  state_;
+    std::streamoff       compressed_;
+    std::streamoff       uncompressed_;
 };
 BOOST_IOSTREAMS_PIPABLE(basic_gzip_decompressor, 1)
 
@@ -733,7 +928,7 @@ template<typename Alloc>
 basic_gzip_decompressor<Alloc>::basic_gzip_decompressor
     (int window_bits, int buffer_size)
     : base_type(make_params(window_bits), buffer_size),
-      state_(s_start)
+      state_(s_start), compressed_(0), uncompressed_(0)
     { }
 
 template<typename Alloc>
@@ -0,0 +1,158 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definition of the class parallel_gzip_decompressor, which
+// decompresses ordinary gzip files, including files with a single member, on
+// several threads. The compressed data is divided into chunks; the first
+// chunk of each round is decoded from a known block boundary, while each of
+// the others is decoded from the first position within the chunk at which a
+// valid deflate block appears to begin. Back-references to characters
+// preceding such a chunk are recorded as markers, which are replaced once
+// the preceding chunk has been decoded and its last 32K characters are
+// known. A chunk is used only if it begins exactly where the preceding chunk
+// ended; otherwise it is decoded again. The CRC and length stored in each
+// member's trailer are verified:
+//
+//     filtering_istream in;
+//     in.push(parallel_gzip_decompressor(parallel_gzip_params(0, 8)));
+//     in.push(file_source("data.gz", BOOST_IOS::binary));
+//
+// The library must be built with zlib support.
+
+#ifndef BOOST_IOSTREAMS_PARALLEL_GZIP_HPP_INCLUDED
+#define BOOST_IOSTREAMS_PARALLEL_GZIP_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <cstddef>                            // size_t.
+#include <vector>
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/ios.hpp>     // streamsize.
+#include <boost/iostreams/filter/gzip.hpp>    // gzip_error.
+#include <boost/iostreams/pipeline.hpp>
+#include <boost/iostreams/read.hpp>
+#include <boost/shared_ptr.hpp>
+
+// Must come last.
+#ifdef BOOST_MSVC
+# pragma warning(push)
+# pragma warning(disable:4251 4231 4660)
+#endif
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace parallel_gzip {
+
+                    // Default values
+
+const std::size_t default_chunk_size = 4 * 1024 * 1024;
+
+} // End namespace parallel_gzip.
+
+//
+// Class name: parallel_gzip_params.
+// Description: Encapsulates the parameters of a parallel_gzip_decompressor.
+//      chunk_size - The number of compressed characters decoded by each
+//          thread at a time; if zero, the default is used.
+//      threads - The number of threads; if zero, the number of hardware
+//          threads is used. With a single thread, no chunks are decoded
+//          speculatively.
+//
+struct parallel_gzip_params {
+
+    // Non-explicit constructor.
+    parallel_gzip_params(
+        std::size_t chunk_size = parallel_gzip::default_chunk_size,
+        unsigned threads = 0 )
+        : chunk_size(chunk_size), threads(threads)
+        { }
+    std::size_t  chunk_size;
+    unsigned     threads;
+};
+
+namespace detail {
+
+class parallel_gzip_impl;
+
+//
+// Class name: parallel_gzip_state.
+// Description: Decompresses the gzip data passed to feed(); read() returns
+//      zero if more input is required, in which case wanted() returns the
+//      number of additional characters required.
+//
+class BOOST_IOSTREAMS_DECL parallel_gzip_state {
+public:
+    explicit parallel_gzip_state(const parallel_gzip_params& p);
+    std::size_t wanted() const;
+    void feed(const char* s, std::size_t n);
+    void finish();   // Indicates end-of-stream.
+    std::streamsize read(char* s, std::streamsize n);
+    void reset();
+private:
+    shared_ptr<parallel_gzip_impl> pimpl_;
+};
+
+} // End namespace detail.
+
+//
+// Class name: parallel_gzip_decompressor.
+// Description: Model of InputFilter which decompresses data in the gzip
+//      format on several threads. Errors in the deflate data are reported
+//      as instances of gzip_error with the code gzip::zlib_error and the
+//      zlib error code zlib::data_error.
+//
+class parallel_gzip_decompressor {
+public:
+    typedef char char_type;
+    struct category : multichar_input_filter_tag, closable_tag { };
+
+    explicit parallel_gzip_decompressor
+        (const parallel_gzip_params& p = parallel_gzip_params())
+        : state_(p)
+        { }
+
+    template<typename Source>
+    std::streamsize read(Source& src, char* s, std::streamsize n)
+    {
+        for (;;) {
+            std::streamsize result = state_.read(s, n);
+            if (result != 0)
+                return result;
+            buf_.resize(state_.wanted());
+            std::streamsize amt =
+                iostreams::read( src, &buf_[0],
+                                 static_cast<std::streamsize>(buf_.size()) );
+            if (amt == 0)
+                return 0;
+            if (amt == -1)
+                state_.finish();
+            else
+                state_.feed(&buf_[0], static_cast<std::size_t>(amt));
+        }
+    }
+
+    template<typename Source>
+    void close(Source&) { state_.reset(); }
+private:
+    detail::parallel_gzip_state  state_;
+    std::vector<char>            buf_;
+};
+BOOST_IOSTREAMS_PIPABLE(parallel_gzip_decompressor, 0)
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+#ifdef BOOST_MSVC
+# pragma warning(pop)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_PARALLEL_GZIP_HPP_INCLUDED
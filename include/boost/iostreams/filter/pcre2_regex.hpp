@@ -0,0 +1,251 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definition of the class pcre2_regex, a regular expression
+// compiled by the 8-bit PCRE2 library, using its just-in-time compiler when
+// available, and of pcre2_regex_engine, which allows it to be used with
+// basic_grep_filter and basic_regex_filter:
+//
+//     basic_regex_filter<char, pcre2_regex_engine>
+//         filter(pcre2_regex("(\\w+)@example\\.com"), "$1@example.org");
+//
+// The library must be built with PCRE2 support; see build/Jamfile.v2.
+
+#ifndef BOOST_IOSTREAMS_PCRE2_REGEX_HPP_INCLUDED
+#define BOOST_IOSTREAMS_PCRE2_REGEX_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <cstddef>                            // size_t.
+#include <stdexcept>                          // runtime_error.
+#include <string>
+#include <vector>
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/shared_ptr.hpp>
+
+// Must come last.
+#ifdef BOOST_MSVC
+# pragma warning(push)
+# pragma warning(disable:4251 4231 4660 4275)
+#endif
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace pcre2 {
+
+                    // Syntax options
+
+const int normal           = 0;
+const int icase            = 1;
+const int multiline        = icase << 1;
+const int dotall           = multiline << 1;
+const int extended         = dotall << 1;
+const int utf              = extended << 1;
+
+                    // Match flags
+
+const int match_default    = 0;
+const int match_not_bol    = 1;
+const int match_not_eol    = match_not_bol << 1;
+const int match_not_empty  = match_not_eol << 1;
+
+} // End namespace pcre2.
+
+//
+// Class name: pcre2_error.
+// Description: Exception thrown to indicate invalid patterns and errors
+//      reported while matching, such as exceeding the match limit; error()
+//      returns the PCRE2 error code.
+//
+class BOOST_IOSTREAMS_DECL pcre2_error : public std::runtime_error {
+public:
+    pcre2_error(const std::string& what, int error)
+        : std::runtime_error(what), error_(error)
+        { }
+    int error() const { return error_; }
+private:
+    int error_;
+};
+
+//
+// Class name: pcre2_match_results.
+// Description: The ranges of characters matched by a pcre2_regex and by
+//      its capturing groups.
+//
+class pcre2_match_results {
+public:
+    pcre2_match_results() : subject_(0) { }
+
+    // Returns the number of groups, plus one for the whole match.
+    std::size_t size() const { return offsets_.size() / 2; }
+    bool matched(std::size_t n = 0) const
+    { return n < size() && offsets_[2 * n] != npos(); }
+    const char* first(std::size_t n = 0) const
+    { return matched(n) ? subject_ + offsets_[2 * n] : 0; }
+    const char* second(std::size_t n = 0) const
+    { return matched(n) ? subject_ + offsets_[2 * n + 1] : 0; }
+    std::size_t position(std::size_t n = 0) const
+    { return matched(n) ? offsets_[2 * n] : npos(); }
+    std::size_t length(std::size_t n = 0) const
+    { return matched(n) ? offsets_[2 * n + 1] - offsets_[2 * n] : 0; }
+    std::string str(std::size_t n = 0) const
+    { return matched(n) ? std::string(first(n), second(n)) : std::string(); }
+private:
+    friend class pcre2_regex;
+    static std::size_t npos() { return static_cast<std::size_t>(-1); }
+    const char*               subject_;
+    std::vector<std::size_t>  offsets_;  // Pairs of offsets, or npos().
+};
+
+namespace detail {
+
+class pcre2_regex_impl;
+
+} // End namespace detail.
+
+//
+// Class name: pcre2_regex.
+// Description: Regular expression compiled by PCRE2. Copies share the
+//      compiled pattern but not the memory used while matching, so that
+//      separate copies may be used by separate threads.
+//
+class BOOST_IOSTREAMS_DECL pcre2_regex {
+public:
+    explicit pcre2_regex( const std::string& pattern,
+                          int options = pcre2::normal, bool jit = true );
+    explicit pcre2_regex( const char* pattern,
+                          int options = pcre2::normal, bool jit = true );
+    pcre2_regex(const pcre2_regex& other);
+    pcre2_regex& operator=(const pcre2_regex& other);
+
+    // Returns the number of capturing groups.
+    std::size_t mark_count() const;
+
+    // Returns true if the expression matches some subsequence of
+    // [first, last).
+    bool search( const char* first, const char* last,
+                 int flags = pcre2::match_default ) const;
+
+    // Returns true if the expression matches all of [first, last).
+    bool match( const char* first, const char* last,
+                int flags = pcre2::match_default ) const;
+
+    // Appends to matches the successive matches in [first, last); an
+    // empty match is never followed by one beginning at the same position.
+    void find_all( const char* first, const char* last,
+                   std::vector<pcre2_match_results>& matches,
+                   int flags = pcre2::match_default ) const;
+private:
+    void init(const std::string& pattern, int options, bool jit);
+    boost::shared_ptr<const detail::pcre2_regex_impl>  pimpl_;
+    mutable boost::shared_ptr<void>                    data_;
+};
+
+//
+// Class name: pcre2_regex_engine.
+// Description: Regex engine, as described in
+//      <boost/iostreams/filter/regex_engine.hpp>, based on pcre2_regex. In
+//      format strings, "$n" and "${n}" stand for the n-th group, "$&" for
+//      the match and "$$" for "$".
+//
+struct pcre2_regex_engine {
+    typedef void                 regex_engine_tag;
+    typedef char                 char_type;
+    typedef std::string          string_type;
+    typedef pcre2_regex          regex_type;
+    typedef int                  flag_type;
+    typedef pcre2_match_results  match_type;
+
+    static flag_type match_default() { return pcre2::match_default; }
+    static flag_type format_default() { return 0; }
+
+    static bool search( const char* first, const char* last,
+                        const regex_type& re, flag_type flags )
+    { return re.search(first, last, flags); }
+
+    static bool match( const char* first, const char* last,
+                       const regex_type& re, flag_type flags )
+    { return re.match(first, last, flags); }
+
+    template<typename Formatter, typename Vector>
+    static void replace( const char* first, const char* last,
+                         const regex_type& re, flag_type flags,
+                         const Formatter& fmt, Vector& dest )
+    {
+        std::vector<match_type> matches;
+        re.find_all(first, last, matches, flags);
+        const char* prefix = first;
+        for (std::size_t z = 0; z < matches.size(); ++z) {
+            dest.insert(dest.end(), prefix, matches[z].first());
+            string_type replacement = fmt(matches[z]);
+            dest.insert(dest.end(), replacement.begin(), replacement.end());
+            prefix = matches[z].second();
+        }
+        dest.insert(dest.end(), prefix, last);
+    }
+
+    static string_type format( const match_type& m, const string_type& fmt,
+                               flag_type )
+    {
+        string_type result;
+        for (string_type::size_type z = 0; z < fmt.size(); ++z) {
+            if (fmt[z] != '$' || z + 1 == fmt.size()) {
+                result += fmt[z];
+                continue;
+            }
+            char c = fmt[z + 1];
+            if (c == '$') {
+                result += '$';
+                ++z;
+            } else if (c == '&') {
+                result += m.str();
+                ++z;
+            } else if (c >= '0' && c <= '9') {
+                std::size_t n = 0;
+                while (z + 1 < fmt.size() && fmt[z + 1] >= '0' &&
+                       fmt[z + 1] <= '9')
+                {
+                    n = 10 * n + (fmt[++z] - '0');
+                }
+                result += m.str(n);
+            } else if (c == '{') {
+                string_type::size_type  end = fmt.find('}', z + 2);
+                std::size_t             n = 0;
+                bool                    valid =
+                                            end != string_type::npos &&
+                                            end != z + 2;
+                for (string_type::size_type k = z + 2; valid && k < end; ++k)
+                    if (fmt[k] >= '0' && fmt[k] <= '9')
+                        n = 10 * n + (fmt[k] - '0');
+                    else
+                        valid = false;
+                if (valid) {
+                    result += m.str(n);
+                    z = end;
+                } else {
+                    result += fmt[z];
+                }
+            } else {
+                result += fmt[z];
+            }
+        }
+        return result;
+    }
+};
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+#ifdef BOOST_MSVC
+# pragma warning(pop)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_PCRE2_REGEX_HPP_INCLUDED
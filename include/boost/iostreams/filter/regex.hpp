@@ -15,11 +15,24 @@
 #include <memory>                         // allocator.
 #include <boost/function.hpp>        
 #include <boost/iostreams/filter/aggregate.hpp>              
+#include <boost/iostreams/filter/regex_engine.hpp>
 #include <boost/iostreams/pipeline.hpp>                
 #include <boost/regex.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_same.hpp>
 
 namespace boost { namespace iostreams {
 
+//
+// Template name: basic_regex_filter.
+// Template parameters:
+//      Ch - The character type.
+//      Tr - The regex traits type, or a regex engine, as described in
+//          <boost/iostreams/filter/regex_engine.hpp>.
+//      Alloc - The allocator type.
+// Description: Filter which replaces each match of a regular expression
+//      using a formatter or a format string.
+//
 template< typename Ch,
           typename Tr = regex_traits<Ch>,
           typename Alloc = std::allocator<Ch> >
@@ -30,56 +43,44 @@ public:
     typedef typename base_type::char_type              char_type;
     typedef typename base_type::category               category;
     typedef std::basic_string<Ch>                      string_type;
-    typedef basic_regex<Ch, Tr>                        regex_type;
-    typedef regex_constants::match_flag_type           flag_type;
-    typedef match_results<const Ch*>                   match_type;
+    typedef typename
+            detail::regex_engine_of<Ch, Tr>::type      engine_type;
+    typedef typename engine_type::regex_type           regex_type;
+    typedef typename engine_type::flag_type            flag_type;
+    typedef typename engine_type::match_type           match_type;
     typedef function1<string_type, const match_type&>  formatter;
+    BOOST_STATIC_ASSERT((
+        is_same<Ch, typename engine_type::char_type>::value
+    ));
 
     basic_regex_filter( const regex_type& re,
                         const formatter& replace,
-                        flag_type flags = regex_constants::match_default )
+                        flag_type flags = engine_type::match_default() )
         : re_(re), replace_(replace), flags_(flags) { }
     basic_regex_filter( const regex_type& re,
                         const string_type& fmt,
-                        flag_type flags = regex_constants::match_default,
-                        flag_type fmt_flags = regex_constants::format_default )
+                        flag_type flags = engine_type::match_default(),
+                        flag_type fmt_flags = engine_type::format_default() )
         : re_(re), replace_(simple_formatter(fmt, fmt_flags)), flags_(flags) { }
     basic_regex_filter( const regex_type& re,
                         const char_type* fmt,
-                        flag_type flags = regex_constants::match_default,
-                        flag_type fmt_flags = regex_constants::format_default )
+                        flag_type flags = engine_type::match_default(),
+                        flag_type fmt_flags = engine_type::format_default() )
         : re_(re), replace_(simple_formatter(fmt, fmt_flags)), flags_(flags) { }
 private:
     typedef typename base_type::vector_type       vector_type;
     void do_filter(const vector_type& src, vector_type& dest)
         {
-            typedef regex_iterator<const Ch*, Ch, Tr> iterator;
             if (src.empty())
                 return;
-            iterator first(&src[0], &src[0] + src.size(), re_, flags_);
-            iterator last;
-            const Ch* suffix = 0;
-            for (; first != last; ++first) {
-                dest.insert( dest.end(), 
-                             first->prefix().first,
-                             first->prefix().second );
-                string_type replacement = replace_(*first);
-                dest.insert( dest.end(), 
-                             replacement.begin(),
-                             replacement.end() );
-                suffix = first->suffix().first;
-            }
-            if (suffix) {
-                dest.insert(dest.end(), suffix, &src[0] + src.size());
-            } else {
-                dest.insert(dest.end(), &src[0], &src[0] + src.size());
-            }
+            engine_type::replace( &src[0], &src[0] + src.size(), re_,
+                                  flags_, replace_, dest );
         }
     struct simple_formatter {
         simple_formatter(const string_type& fmt, flag_type fmt_flags) 
             : fmt_(fmt), fmt_flags_(fmt_flags) { }
         string_type operator() (const match_type& match) const
-        { return match.format(fmt_, fmt_flags_); }
+        { return engine_type::format(match, fmt_, fmt_flags_); }
         string_type  fmt_;
         flag_type    fmt_flags_;
     };
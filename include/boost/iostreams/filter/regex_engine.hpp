@@ -0,0 +1,127 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Defines the class template boost_regex_engine, which adapts Boost.Regex
+// to the interface used by basic_grep_filter and basic_regex_filter to
+// match regular expressions.
+//
+// A regex engine is a class with the following static members, which is
+// passed in place of the regex traits argument of the filters:
+//
+//   regex_engine_tag - A type, whose presence identifies the class as an
+//       engine rather than a regex traits class.
+//   char_type, regex_type, flag_type, match_type - The character type, the
+//       type of compiled expressions, the type of match and format flags,
+//       and the type describing a match, which is passed to formatters.
+//   match_default(), format_default() - The default flags.
+//   search(first, last, re, flags) - Returns true if re matches some
+//       subsequence of [first, last).
+//   match(first, last, re, flags) - Returns true if re matches all of
+//       [first, last).
+//   replace(first, last, re, flags, fmt, dest) - Appends [first, last) to
+//       the vector dest, replacing each match m with fmt(m).
+//   format(m, fmt, flags) - Returns the format string fmt, with references
+//       to the match m replaced.
+//
+// See also <boost/iostreams/filter/dfa_regex.hpp> and
+// <boost/iostreams/filter/pcre2_regex.hpp>.
+
+#ifndef BOOST_IOSTREAMS_REGEX_ENGINE_HPP_INCLUDED
+#define BOOST_IOSTREAMS_REGEX_ENGINE_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <string>
+#include <boost/mpl/has_xxx.hpp>
+#include <boost/mpl/if.hpp>
+#include <boost/regex.hpp>
+
+namespace boost { namespace iostreams {
+
+//
+// Template name: boost_regex_engine.
+// Template parameters:
+//      Ch - The character type.
+//      Tr - The regex traits type.
+// Description: Regex engine based on Boost.Regex; the default.
+//
+template<typename Ch, typename Tr = regex_traits<Ch> >
+struct boost_regex_engine {
+    typedef void                                       regex_engine_tag;
+    typedef Ch                                         char_type;
+    typedef std::basic_string<Ch>                      string_type;
+    typedef basic_regex<Ch, Tr>                        regex_type;
+    typedef regex_constants::match_flag_type           flag_type;
+    typedef match_results<const Ch*>                   match_type;
+
+    static flag_type match_default() { return regex_constants::match_default; }
+    static flag_type format_default()
+    { return regex_constants::format_default; }
+
+    static bool search( const Ch* first, const Ch* last,
+                        const regex_type& re, flag_type flags )
+    { return regex_search(first, last, re, flags); }
+
+    static bool match( const Ch* first, const Ch* last,
+                       const regex_type& re, flag_type flags )
+    { return regex_match(first, last, re, flags); }
+
+    template<typename Formatter, typename Vector>
+    static void replace( const Ch* first, const Ch* last,
+                         const regex_type& re, flag_type flags,
+                         const Formatter& fmt, Vector& dest )
+    {
+        typedef regex_iterator<const Ch*, Ch, Tr> iterator;
+        iterator it(first, last, re, flags);
+        iterator end;
+        const Ch* suffix = 0;
+        for (; it != end; ++it) {
+            dest.insert( dest.end(),
+                         it->prefix().first,
+                         it->prefix().second );
+            string_type replacement = fmt(*it);
+            dest.insert( dest.end(),
+                         replacement.begin(),
+                         replacement.end() );
+            suffix = it->suffix().first;
+        }
+        if (suffix) {
+            dest.insert(dest.end(), suffix, last);
+        } else {
+            dest.insert(dest.end(), first, last);
+        }
+    }
+
+    static string_type format( const match_type& m, const string_type& fmt,
+                               flag_type flags )
+    { return m.format(fmt, flags); }
+};
+
+namespace detail {
+
+BOOST_MPL_HAS_XXX_TRAIT_NAMED_DEF(
+    is_regex_engine, regex_engine_tag, false
+)
+
+// Returns Tr if it is a regex engine and otherwise the Boost.Regex engine
+// using the regex traits Tr.
+template<typename Ch, typename Tr>
+struct regex_engine_of
+    : mpl::if_<
+          is_regex_engine<Tr>,
+          Tr,
+          boost_regex_engine<Ch, Tr>
+      >
+    { };
+
+} // End namespace detail.
+
+} } // End namespaces iostreams, boost.
+
+#endif // #ifndef BOOST_IOSTREAMS_REGEX_ENGINE_HPP_INCLUDED
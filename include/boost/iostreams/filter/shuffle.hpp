@@ -0,0 +1,324 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definitions of the class templates shuffle_filter and
+// basic_bitshuffle_filter, which rearrange arrays of fixed-size elements,
+// such as integers or floating point numbers, so that they compress better.
+//
+// Data is processed in blocks of a fixed number of characters. Within a
+// block of n elements of size k, shuffle_filter stores the first byte of
+// each element, followed by the second byte of each element, and so on.
+// bitshuffle_filter goes further and stores, for each byte position j and
+// bit b, a row of n / 8 bytes whose t-th bit, counting from the least
+// significant bit of each byte, is bit b of byte j of the t-th element. The
+// last block of a stream may be shorter than the others; characters which
+// don't form a whole element, and for bitshuffle_filter the elements which
+// remain after the largest multiple of eight, are passed through unchanged.
+//
+// Both filters transform data written to them and restore data read
+// through them, so that the same filter is used in front of a compressor
+// when writing and behind a decompressor when reading.
+
+#ifndef BOOST_IOSTREAMS_SHUFFLE_HPP_INCLUDED
+#define BOOST_IOSTREAMS_SHUFFLE_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <algorithm>                           // max, min.
+#include <cstddef>                             // size_t.
+#include <memory>                              // allocator.
+#include <vector>
+#include <boost/assert.hpp>
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/char_traits.hpp>
+#include <boost/iostreams/checked_operations.hpp>
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/ios.hpp>      // openmode, streamsize.
+#include <boost/iostreams/pipeline.hpp>
+#include <boost/iostreams/read.hpp>
+#include <boost/iostreams/write.hpp>
+
+// Must come last.
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace shuffle {
+
+                    // Default values
+
+const std::size_t default_block_size = 65536;
+
+} // End namespace shuffle.
+
+namespace detail {
+
+// Transpose the bytes, or the bits, of count elements of the given size
+// from src to dest, which must not overlap. The bit transpositions require
+// count to be a multiple of eight.
+BOOST_IOSTREAMS_DECL void
+shuffle_bytes( const char* src, char* dest, std::size_t count,
+               std::size_t size );
+BOOST_IOSTREAMS_DECL void
+unshuffle_bytes( const char* src, char* dest, std::size_t count,
+                 std::size_t size );
+BOOST_IOSTREAMS_DECL void
+shuffle_bits( const char* src, char* dest, std::size_t count,
+              std::size_t size );
+BOOST_IOSTREAMS_DECL void
+unshuffle_bits( const char* src, char* dest, std::size_t count,
+                std::size_t size );
+
+//
+// Template name: shuffle_filter_base.
+// Description: Dual-use filter which transposes the bytes or bits of the
+//      elements of each block of data written to it, and applies the
+//      inverse transposition to each block of data read through it.
+// Note: This filter should not be copied while it is in use.
+//
+template<typename Alloc>
+class shuffle_filter_base {
+public:
+    typedef char char_type;
+    struct category
+        : dual_use,
+          filter_tag,
+          multichar_tag,
+          closable_tag
+        { };
+
+    template<typename Source>
+    std::streamsize read(Source& src, char_type* s, std::streamsize n)
+    {
+        BOOST_ASSERT(!(state_ & f_write));
+        state_ |= f_read;
+        std::streamsize result = 0;
+        while (result < n) {
+            if (ptr_ == end_) {
+                if (state_ & f_eof)
+                    break;
+
+                // Blocks are transformed only once they are complete, so
+                // that their sizes match those used when writing
+                allocate();
+                while (size_ < block_size_) {
+                    std::streamsize amt =
+                        iostreams::read( src, &in_[size_],
+                                         static_cast<std::streamsize>(
+                                             block_size_ - size_
+                                         ) );
+                    if (amt == -1) {
+                        state_ |= f_eof;
+                        break;
+                    }
+                    if (amt == 0)
+                        return result;
+                    size_ += static_cast<std::size_t>(amt);
+                }
+                if (size_ == 0)
+                    break;
+                transform(false);
+            }
+            std::streamsize amt =
+                (std::min)( n - result,
+                            static_cast<std::streamsize>(end_ - ptr_) );
+            char_traits<char>::copy(s + result, &out_[ptr_], amt);
+            ptr_ += static_cast<std::size_t>(amt);
+            result += amt;
+        }
+        return result != 0 || !(state_ & f_eof) ? result : -1;
+    }
+
+    template<typename Sink>
+    std::streamsize write(Sink& snk, const char_type* s, std::streamsize n)
+    {
+        BOOST_ASSERT(!(state_ & f_read));
+        state_ |= f_write;
+        allocate();
+        std::streamsize result = 0;
+        while (result < n) {
+            if (ptr_ != end_ && !flush_block(snk))
+                break;
+            std::streamsize amt =
+                (std::min)( n - result,
+                            static_cast<std::streamsize>(block_size_ - size_) );
+            char_traits<char>::copy(&in_[size_], s + result, amt);
+            size_ += static_cast<std::size_t>(amt);
+            result += amt;
+            if (size_ == block_size_)
+                transform(true);
+        }
+        return result;
+    }
+
+    template<typename Sink>
+    void close(Sink& snk, BOOST_IOS::openmode which)
+    {
+        if ((state_ & f_read) && which == BOOST_IOS::in)
+            reset();
+        if ((state_ & f_write) && which == BOOST_IOS::out) {
+            try {
+                while (ptr_ != end_)
+                    flush_block(snk);
+                if (size_ != 0) {
+                    transform(true);
+                    while (ptr_ != end_)
+                        flush_block(snk);
+                }
+            } catch (...) {
+                reset();
+                throw;
+            }
+            reset();
+        }
+    }
+protected:
+    shuffle_filter_base( std::size_t element_size, bool bits,
+                         std::size_t block_size )
+        : element_size_((std::max)(element_size, std::size_t(1))),
+          block_size_(block_size), size_(0), ptr_(0), end_(0),
+          bits_(bits), state_(0)
+    {
+        // Blocks hold a whole number of elements, or of groups of eight
+        // elements for bitshuffle
+        std::size_t unit = element_size_ * (bits ? 8 : 1);
+        block_size_ = (std::max)(block_size_ / unit, std::size_t(1)) * unit;
+    }
+private:
+    void allocate()
+    {
+        if (in_.empty()) {
+            in_.resize(block_size_);
+            out_.resize(block_size_);
+        }
+    }
+
+    // Transforms the size_ characters of in_ into out_.
+    void transform(bool forward)
+    {
+        std::size_t count = size_ / element_size_;
+        if (bits_)
+            count -= count % 8;
+        std::size_t done = count * element_size_;
+        if (count != 0) {
+            if (bits_) {
+                if (forward)
+                    shuffle_bits(&in_[0], &out_[0], count, element_size_);
+                else
+                    unshuffle_bits(&in_[0], &out_[0], count, element_size_);
+            } else {
+                if (forward)
+                    shuffle_bytes(&in_[0], &out_[0], count, element_size_);
+                else
+                    unshuffle_bytes(&in_[0], &out_[0], count, element_size_);
+            }
+        }
+        if (done != size_)
+            char_traits<char>::copy(&out_[done], &in_[done], size_ - done);
+        ptr_ = 0;
+        end_ = size_;
+        size_ = 0;
+    }
+
+    // Attempts to write the transformed block to the given sink; returns
+    // true if it has been written completely.
+    template<typename Sink>
+    bool flush_block(Sink& snk)
+    {
+        std::streamsize amt =
+            iostreams::write_if( snk, &out_[ptr_],
+                                 static_cast<std::streamsize>(end_ - ptr_) );
+        ptr_ += static_cast<std::size_t>(amt);
+        return ptr_ == end_;
+    }
+
+    void reset()
+    {
+        size_ = ptr_ = end_ = 0;
+        state_ = 0;
+    }
+
+    enum flag_type {
+        f_read   = 1,
+        f_write  = f_read << 1,
+        f_eof    = f_write << 1
+    };
+
+    std::vector<char, Alloc>  in_;
+    std::vector<char, Alloc>  out_;
+    std::size_t               element_size_;
+    std::size_t               block_size_;
+    std::size_t               size_;   // Untransformed characters in in_.
+    std::size_t               ptr_;    // Next transformed character in out_.
+    std::size_t               end_;    // End of transformed characters.
+    bool                      bits_;
+    int                       state_;
+};
+
+} // End namespace detail.
+
+//
+// Template name: shuffle_filter.
+// Template parameters:
+//      ElementSize - The size of the elements, in characters.
+//      Alloc - The allocator type.
+// Description: Dual-use filter which groups the bytes of the elements of
+//      each block by their position within an element when writing, and
+//      restores the original order when reading.
+//
+template< std::size_t ElementSize,
+          typename Alloc = std::allocator<char> >
+class shuffle_filter : public detail::shuffle_filter_base<Alloc> {
+public:
+    explicit shuffle_filter
+        (std::size_t block_size = shuffle::default_block_size)
+        : detail::shuffle_filter_base<Alloc>(ElementSize, false, block_size)
+        { }
+};
+
+template<std::size_t ElementSize, typename Alloc, typename Component>
+pipeline<
+    detail::pipeline_segment< shuffle_filter<ElementSize, Alloc> >,
+    Component
+>
+operator|(const shuffle_filter<ElementSize, Alloc>& f, const Component& c)
+{
+    typedef detail::pipeline_segment<
+                shuffle_filter<ElementSize, Alloc>
+            > segment;
+    return pipeline<segment, Component>(segment(f), c);
+}
+
+//
+// Template name: basic_bitshuffle_filter.
+// Template parameters:
+//      Alloc - The allocator type.
+// Description: Dual-use filter which groups the bits of the elements of
+//      each block by their position within an element when writing, and
+//      restores the original order when reading.
+//
+template<typename Alloc = std::allocator<char> >
+class basic_bitshuffle_filter : public detail::shuffle_filter_base<Alloc> {
+public:
+    explicit basic_bitshuffle_filter
+        ( std::size_t element_size,
+          std::size_t block_size = shuffle::default_block_size )
+        : detail::shuffle_filter_base<Alloc>(element_size, true, block_size)
+        { }
+};
+BOOST_IOSTREAMS_PIPABLE(basic_bitshuffle_filter, 1)
+
+typedef basic_bitshuffle_filter<> bitshuffle_filter;
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+
+#endif // #ifndef BOOST_IOSTREAMS_SHUFFLE_HPP_INCLUDED
@@ -0,0 +1,531 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definitions of the class templates basic_snappy_compressor
+// and basic_snappy_decompressor, which implement the Snappy framing format.
+// The Snappy block format is implemented in src/snappy.cpp, so that no
+// external library is required.
+
+#ifndef BOOST_IOSTREAMS_SNAPPY_HPP_INCLUDED
+#define BOOST_IOSTREAMS_SNAPPY_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <algorithm>                       // min.
+#include <cstddef>                         // size_t.
+#include <cstring>                         // memcpy.
+#include <memory>                          // allocator.
+#include <boost/config.hpp>                // BOOST_PREVENT_MACRO_SUBSTITUTION.
+#include <boost/cstdint.hpp>               // uint32_t.
+#include <boost/iostreams/constants.hpp>   // buffer size.
+#include <boost/iostreams/detail/buffer.hpp>
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/ios.hpp>  // failure, streamsize.
+#include <boost/iostreams/filter/symmetric.hpp>
+#include <boost/iostreams/pipeline.hpp>
+#include <boost/system/error_code.hpp>
+
+// Must come last.
+#ifdef BOOST_MSVC
+# pragma warning(push)
+# pragma warning(disable:4251 4231 4660)
+#endif
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace snappy {
+
+                    // Chunk types
+
+BOOST_IOSTREAMS_DECL extern const int compressed_data;
+BOOST_IOSTREAMS_DECL extern const int uncompressed_data;
+BOOST_IOSTREAMS_DECL extern const int padding;
+BOOST_IOSTREAMS_DECL extern const int stream_identifier;
+
+                    // Status codes
+
+BOOST_IOSTREAMS_DECL extern const int okay;
+BOOST_IOSTREAMS_DECL extern const int bad_stream_identifier;
+BOOST_IOSTREAMS_DECL extern const int bad_chunk_length;
+BOOST_IOSTREAMS_DECL extern const int unskippable_chunk;
+BOOST_IOSTREAMS_DECL extern const int checksum_error;
+BOOST_IOSTREAMS_DECL extern const int data_error;
+BOOST_IOSTREAMS_DECL extern const int unexpected_eof;
+
+                    // Limits
+
+// The maximum number of uncompressed characters in a chunk.
+const std::size_t chunk_size = 65536;
+
+                    // Default values
+
+const bool default_verify_checksums = true;
+
+} // End namespace snappy.
+
+//
+// Class name: snappy_params.
+// Description: Encapsulates the parameters used to customize decompression.
+//      If verify_checksums is false, the masked CRC-32C stored with each
+//      chunk is ignored.
+//
+struct snappy_params {
+
+    // Non-explicit constructor.
+    snappy_params(bool verify_checksums = snappy::default_verify_checksums)
+        : verify_checksums(verify_checksums)
+        { }
+    bool verify_checksums;
+};
+
+//
+// Class name: snappy_error.
+// Description: Subclass of std::ios_base::failure thrown to indicate
+//     malformed Snappy streams.
+//
+class BOOST_IOSTREAMS_DECL snappy_error : public BOOST_IOSTREAMS_FAILURE {
+public:
+    explicit snappy_error(int error);
+    int error() const { return error_; }
+    static void check BOOST_PREVENT_MACRO_SUBSTITUTION(int error);
+
+    // Non-throwing version of check: stores in ec a code in
+    // snappy_category() and returns false if error indicates failure.
+    static bool check BOOST_PREVENT_MACRO_SUBSTITUTION
+        (int error, boost::system::error_code& ec);
+private:
+    int error_;
+};
+
+// Returns the category of the error codes reported by the Snappy filters;
+// the values are the constants snappy::bad_stream_identifier, etc.
+BOOST_IOSTREAMS_DECL const boost::system::error_category& snappy_category();
+
+namespace detail {
+
+//
+// Class name: snappy_base.
+// Description: Encodes and decodes individual chunks of the framing format.
+//
+class BOOST_IOSTREAMS_DECL snappy_base {
+public:
+    typedef char char_type;
+protected:
+
+    // The size of a chunk header, and the maximum size of a chunk produced
+    // by encode_chunk(), including its header.
+    static const std::size_t header_size = 4;
+    static std::size_t max_encoded_size();
+
+    // The maximum size of the body of a chunk which is not skipped.
+    static std::size_t max_body_size();
+
+    // Writes the stream identifier chunk to dest and returns its size.
+    static std::size_t encode_identifier(char* dest);
+
+    // Writes to dest a chunk containing the n <= snappy::chunk_size
+    // characters beginning at src, and returns its size.
+    static std::size_t encode_chunk(const char* src, std::size_t n, char* dest);
+
+    // Stores in size the number of characters contained in a chunk with the
+    // given type and body; returns snappy::okay or an error code.
+    static int decoded_size( int type, const char* body, std::size_t len,
+                             std::size_t& size );
+
+    // Writes to dest, which must have room for the number of characters
+    // reported by decoded_size(), the characters contained in a chunk.
+    static int decode_chunk( int type, const char* body, std::size_t len,
+                             char* dest, bool verify );
+};
+
+//
+// Template name: snappy_compressor_impl
+// Description: Model of SymmetricFilter implementing compression in the
+//      Snappy framing format. Input is compressed in whole chunks, directly
+//      from the input range and into the output range when they are large
+//      enough.
+//
+template<typename Alloc = std::allocator<char> >
+class snappy_compressor_impl : public snappy_base {
+public:
+    snappy_compressor_impl(const snappy_params& = snappy_params());
+    bool filter( const char*& src_begin, const char* src_end,
+                 char*& dest_begin, char* dest_end, bool flush );
+    void close();
+private:
+    void encode( const char* src, std::size_t n,
+                 char*& dest_begin, char* dest_end );
+    bool drain(char*& dest_begin, char* dest_end);
+    buffer<char, Alloc>  in_;   // Partial chunk, in [data(), eptr()).
+    buffer<char, Alloc>  out_;  // Encoded chunk, in [ptr(), eptr()).
+    bool                 identified_;
+};
+
+//
+// Template name: snappy_decompressor_impl
+// Description: Model of SymmetricFilter implementing decompression of the
+//      Snappy framing format.
+//
+template<typename Alloc = std::allocator<char> >
+class snappy_decompressor_impl : public snappy_base {
+public:
+    typedef void error_code_support;
+    snappy_decompressor_impl(const snappy_params& = snappy_params());
+    bool filter( const char*& begin_in, const char* end_in,
+                 char*& begin_out, char* end_out, bool flush );
+    bool filter( const char*& begin_in, const char* end_in,
+                 char*& begin_out, char* end_out, bool flush,
+                 boost::system::error_code& ec );
+    void close();
+private:
+    enum state_type { s_header, s_body, s_skip };
+    int decompress( const char*& begin_in, const char* end_in,
+                    char*& begin_out, char* end_out, bool flush );
+    int decode( const char* body, char*& begin_out, char* end_out );
+    bool drain(char*& dest_begin, char* dest_end);
+    bool pending() const { return out_.ptr() != out_.eptr(); }
+    buffer<char, Alloc>  in_;   // Partial chunk body, in [data(), eptr()).
+    buffer<char, Alloc>  out_;  // Decoded chunk, in [ptr(), eptr()).
+    char                 header_[header_size];
+    std::size_t          header_len_;
+    int                  type_;
+    std::size_t          length_;
+    state_type           state_;
+    bool                 identified_;
+    bool                 verify_;
+};
+
+} // End namespace detail.
+
+//
+// Template name: snappy_compressor
+// Description: Model of InputFilter and OutputFilter implementing
+//      compression in the Snappy framing format.
+//
+template<typename Alloc = std::allocator<char> >
+struct basic_snappy_compressor
+    : symmetric_filter<detail::snappy_compressor_impl<Alloc>, Alloc>
+{
+private:
+    typedef detail::snappy_compressor_impl<Alloc>       impl_type;
+    typedef symmetric_filter<impl_type, Alloc>          base_type;
+public:
+    typedef typename base_type::char_type               char_type;
+    typedef typename base_type::category                category;
+    basic_snappy_compressor( const snappy_params& = snappy_params(),
+                             int buffer_size = default_device_buffer_size );
+};
+BOOST_IOSTREAMS_PIPABLE(basic_snappy_compressor, 1)
+
+typedef basic_snappy_compressor<> snappy_compressor;
+
+//
+// Template name: snappy_decompressor
+// Description: Model of InputFilter and OutputFilter implementing
+//      decompression of the Snappy framing format. Reserved skippable
+//      chunks and padding are ignored.
+//
+template<typename Alloc = std::allocator<char> >
+struct basic_snappy_decompressor
+    : symmetric_filter<detail::snappy_decompressor_impl<Alloc>, Alloc>
+{
+private:
+    typedef detail::snappy_decompressor_impl<Alloc>     impl_type;
+    typedef symmetric_filter<impl_type, Alloc>          base_type;
+public:
+    typedef typename base_type::char_type               char_type;
+    typedef typename base_type::category                category;
+    basic_snappy_decompressor( const snappy_params& = snappy_params(),
+                               int buffer_size = default_device_buffer_size );
+};
+BOOST_IOSTREAMS_PIPABLE(basic_snappy_decompressor, 1)
+
+typedef basic_snappy_decompressor<> snappy_decompressor;
+
+//----------------------------------------------------------------------------//
+
+//------------------Implementation of snappy_compressor_impl------------------//
+
+namespace detail {
+
+template<typename Alloc>
+snappy_compressor_impl<Alloc>::snappy_compressor_impl(const snappy_params&)
+    : in_(static_cast<int>(snappy::chunk_size)),
+      out_(static_cast<int>(max_encoded_size())),
+      identified_(false)
+{ close(); }
+
+template<typename Alloc>
+bool snappy_compressor_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    while (drain(dest_begin, dest_end)) {
+        if (!identified_) {
+            if (static_cast<std::size_t>(dest_end - dest_begin) >=
+                    max_encoded_size())
+            {
+                dest_begin += encode_identifier(dest_begin);
+            } else {
+                out_.set(0, encode_identifier(out_.data()));
+            }
+            identified_ = true;
+            continue;
+        }
+        std::size_t avail =
+                        static_cast<std::size_t>(src_end - src_begin),
+                    buffered =
+                        static_cast<std::size_t>(in_.eptr() - in_.data());
+        if (buffered == 0 && avail >= snappy::chunk_size) {
+            encode(src_begin, snappy::chunk_size, dest_begin, dest_end);
+            src_begin += snappy::chunk_size;
+            continue;
+        }
+        std::size_t amt = (std::min)(avail, snappy::chunk_size - buffered);
+        std::memcpy(in_.eptr(), src_begin, amt);
+        in_.eptr() += amt;
+        src_begin += amt;
+        buffered += amt;
+        if (buffered == snappy::chunk_size || (flush && buffered != 0)) {
+            encode(in_.data(), buffered, dest_begin, dest_end);
+            in_.set(0, 0);
+            continue;
+        }
+        return !flush;
+    }
+    return true;
+}
+
+template<typename Alloc>
+void snappy_compressor_impl<Alloc>::close()
+{
+    in_.set(0, 0);
+    out_.set(0, 0);
+    identified_ = false;
+}
+
+template<typename Alloc>
+void snappy_compressor_impl<Alloc>::encode
+    (const char* src, std::size_t n, char*& dest_begin, char* dest_end)
+{
+    if (static_cast<std::size_t>(dest_end - dest_begin) >= max_encoded_size())
+        dest_begin += encode_chunk(src, n, dest_begin);
+    else
+        out_.set(0, encode_chunk(src, n, out_.data()));
+}
+
+// Copies as much pending output as possible to the given range; returns
+// true if no output remains pending.
+template<typename Alloc>
+bool snappy_compressor_impl<Alloc>::drain(char*& dest_begin, char* dest_end)
+{
+    std::size_t amt =
+        (std::min)( static_cast<std::size_t>(out_.eptr() - out_.ptr()),
+                    static_cast<std::size_t>(dest_end - dest_begin) );
+    std::memcpy(dest_begin, out_.ptr(), amt);
+    out_.ptr() += amt;
+    dest_begin += amt;
+    return out_.ptr() == out_.eptr();
+}
+
+//------------------Implementation of snappy_decompressor_impl----------------//
+
+template<typename Alloc>
+snappy_decompressor_impl<Alloc>::snappy_decompressor_impl
+    (const snappy_params& p)
+    : in_(static_cast<int>(max_body_size())),
+      out_(static_cast<int>(snappy::chunk_size)),
+      verify_(p.verify_checksums)
+{ close(); }
+
+template<typename Alloc>
+bool snappy_decompressor_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    int result = decompress(src_begin, src_end, dest_begin, dest_end, flush);
+    snappy_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result);
+    return !flush || pending() || src_begin != src_end;
+}
+
+template<typename Alloc>
+bool snappy_decompressor_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush,
+      boost::system::error_code& ec )
+{
+    int result = decompress(src_begin, src_end, dest_begin, dest_end, flush);
+    return snappy_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result, ec) &&
+           (!flush || pending() || src_begin != src_end);
+}
+
+template<typename Alloc>
+void snappy_decompressor_impl<Alloc>::close()
+{
+    in_.set(0, 0);
+    out_.set(0, 0);
+    header_len_ = 0;
+    type_ = 0;
+    length_ = 0;
+    state_ = s_header;
+    identified_ = false;
+}
+
+template<typename Alloc>
+int snappy_decompressor_impl<Alloc>::decompress
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    while (drain(dest_begin, dest_end) && src_begin != src_end) {
+        std::size_t avail = static_cast<std::size_t>(src_end - src_begin);
+        switch (state_) {
+        case s_header:
+            {
+                std::size_t amt = (std::min)(avail, header_size - header_len_);
+                std::memcpy(header_ + header_len_, src_begin, amt);
+                header_len_ += amt;
+                src_begin += amt;
+                if (header_len_ < header_size)
+                    break;
+                header_len_ = 0;
+                type_ = static_cast<unsigned char>(header_[0]);
+                length_ =
+                    static_cast<std::size_t>(
+                        static_cast<unsigned char>(header_[1]) |
+                        (static_cast<unsigned char>(header_[2]) << 8) |
+                        (static_cast<unsigned char>(header_[3]) << 16)
+                    );
+                if (!identified_ && type_ != snappy::stream_identifier)
+                    return snappy::bad_stream_identifier;
+                if (type_ >= 0x80 && type_ != snappy::stream_identifier) {
+                    state_ = length_ != 0 ? s_skip : s_header;
+                } else if ( type_ != snappy::compressed_data &&
+                            type_ != snappy::uncompressed_data &&
+                            type_ != snappy::stream_identifier )
+                {
+                    return snappy::unskippable_chunk;
+                } else if (length_ < 4 || length_ > max_body_size()) {
+                    return snappy::bad_chunk_length;
+                } else {
+                    in_.set(0, 0);
+                    state_ = s_body;
+                }
+            }
+            break;
+        case s_skip:
+            {
+                std::size_t amt = (std::min)(avail, length_);
+                src_begin += amt;
+                length_ -= amt;
+                if (length_ == 0)
+                    state_ = s_header;
+            }
+            break;
+        case s_body:
+            {
+                // Decode the body in place if it lies entirely within the
+                // input range
+                std::size_t  buffered =
+                                 static_cast<std::size_t>(
+                                     in_.eptr() - in_.data()
+                                 );
+                const char*  body;
+                if (buffered == 0 && avail >= length_) {
+                    body = src_begin;
+                    src_begin += length_;
+                } else {
+                    std::size_t amt = (std::min)(avail, length_ - buffered);
+                    std::memcpy(in_.eptr(), src_begin, amt);
+                    in_.eptr() += amt;
+                    src_begin += amt;
+                    if (buffered + amt < length_)
+                        break;
+                    body = in_.data();
+                }
+                state_ = s_header;
+                if (int result = decode(body, dest_begin, dest_end))
+                    return result;
+            }
+            break;
+        }
+    }
+    if (flush && src_begin == src_end && (state_ != s_header || header_len_))
+        return snappy::unexpected_eof;
+    return snappy::okay;
+}
+
+// Decodes the chunk described by type_, length_ and body, directly into
+// the given range if it has room and otherwise into out_.
+template<typename Alloc>
+int snappy_decompressor_impl<Alloc>::decode
+    (const char* body, char*& dest_begin, char* dest_end)
+{
+    std::size_t size;
+    if (int result = decoded_size(type_, body, length_, size))
+        return result;
+    if (type_ == snappy::stream_identifier) {
+        identified_ = true;
+        return snappy::okay;
+    }
+    bool   direct =
+               static_cast<std::size_t>(dest_end - dest_begin) >= size;
+    char*  dest = direct ? dest_begin : out_.data();
+    if (int result = decode_chunk(type_, body, length_, dest, verify_))
+        return result;
+    if (direct)
+        dest_begin += size;
+    else
+        out_.set(0, static_cast<std::streamsize>(size));
+    return snappy::okay;
+}
+
+// Copies as much pending output as possible to the given range; returns
+// true if no output remains pending.
+template<typename Alloc>
+bool snappy_decompressor_impl<Alloc>::drain(char*& dest_begin, char* dest_end)
+{
+    std::size_t amt =
+        (std::min)( static_cast<std::size_t>(out_.eptr() - out_.ptr()),
+                    static_cast<std::size_t>(dest_end - dest_begin) );
+    std::memcpy(dest_begin, out_.ptr(), amt);
+    out_.ptr() += amt;
+    dest_begin += amt;
+    return out_.ptr() == out_.eptr();
+}
+
+} // End namespace detail.
+
+//------------------Implementation of snappy_compressor-----------------------//
+
+template<typename Alloc>
+basic_snappy_compressor<Alloc>::basic_snappy_compressor
+        (const snappy_params& p, int buffer_size)
+    : base_type(buffer_size, p)
+    { }
+
+//------------------Implementation of snappy_decompressor---------------------//
+
+template<typename Alloc>
+basic_snappy_decompressor<Alloc>::basic_snappy_decompressor
+        (const snappy_params& p, int buffer_size)
+    : base_type(buffer_size, p)
+    { }
+
+//----------------------------------------------------------------------------//
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+#ifdef BOOST_MSVC
+# pragma warning(pop)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_SNAPPY_HPP_INCLUDED
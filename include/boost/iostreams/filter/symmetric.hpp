@@ -49,10 +49,14 @@
 #include <boost/iostreams/detail/buffer.hpp>
 #include <boost/iostreams/detail/char_traits.hpp>
 #include <boost/iostreams/detail/config/limits.hpp>
+#include <boost/iostreams/detail/probe.hpp>
 #include <boost/iostreams/detail/template_params.hpp>
+#include <boost/iostreams/error_code.hpp>
 #include <boost/iostreams/traits.hpp>
 #include <boost/iostreams/operations.hpp>       // read, write.
 #include <boost/iostreams/pipeline.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/mpl/has_xxx.hpp>
 #include <boost/preprocessor/iteration/local.hpp>
 #include <boost/preprocessor/punctuation/comma_if.hpp>
 #include <boost/preprocessor/repetition/enum_binary_params.hpp>
@@ -64,6 +68,17 @@
 
 namespace boost { namespace iostreams {
 
+namespace detail {
+
+// A SymmetricFilter which defines a member type named error_code_support
+// provides an overload of filter() taking a trailing error_code& argument,
+// which reports errors without throwing.
+BOOST_MPL_HAS_XXX_TRAIT_NAMED_DEF( 
+    has_error_code_support, error_code_support, false
+)
+
+} // End namespace detail.
+
 template< typename SymmetricFilter,
           typename Alloc =
               std::allocator<
@@ -78,7 +93,8 @@ public:
         : dual_use,
           filter_tag,
           multichar_tag,
-          closable_tag
+          closable_tag,
+          error_code_tag
         { };
 
     // Expands to a sequence of ctors which forward to impl.
@@ -97,6 +113,135 @@ public:
 
     template<typename Source>
     std::streamsize read(Source& src, char_type* s, std::streamsize n)
+    { return read_impl(src, s, n, 0); }
+
+    template<typename Source>
+    std::streamsize read( Source& src, char_type* s, std::streamsize n,
+                          boost::system::error_code& ec )
+    {
+        ec.clear();
+        return read_impl(src, s, n, &ec);
+    }
+
+    template<typename Sink>
+    std::streamsize write(Sink& snk, const char_type* s, std::streamsize n)
+    { return write_impl(snk, s, n, 0); }
+
+    template<typename Sink>
+    std::streamsize write( Sink& snk, const char_type* s, std::streamsize n,
+                           boost::system::error_code& ec )
+    {
+        ec.clear();
+        return write_impl(snk, s, n, &ec);
+    }
+
+    template<typename Sink>
+    void close(Sink& snk, BOOST_IOS::openmode mode)
+    {
+        if (mode == BOOST_IOS::out) {
+
+            if (!(state() & f_write))
+                begin_write();
+
+            // Repeatedly invoke filter() with no input.
+            try {
+                buffer_type&     buf = pimpl_->buf_;
+                char_type        dummy;
+                const char_type* end = &dummy;
+                bool             again = true;
+                while (again) {
+                    if (buf.ptr() != buf.eptr())
+                        again = filter().filter( end, end, buf.ptr(),
+                                                 buf.eptr(), true );
+                    flush(snk);
+                }
+            } catch (...) {
+                try { close_impl(); } catch (...) { }
+                throw;
+            }
+            close_impl();
+        } else {
+            close_impl();
+        }
+    }
+
+    template<typename Sink>
+    void close( Sink& snk, BOOST_IOS::openmode mode, 
+                boost::system::error_code& ec )
+    {
+        ec.clear();
+        if (mode == BOOST_IOS::out) {
+
+            if (!(state() & f_write))
+                begin_write();
+
+            // Repeatedly invoke filter() with no input, then write out
+            // whatever remains in the buffer.
+            buffer_type&     buf = pimpl_->buf_;
+            char_type        dummy;
+            const char_type* end = &dummy;
+            bool             again = true;
+            while (again && !ec) {
+                if (buf.ptr() != buf.eptr())
+                    again = call_filter( end, end, buf.ptr(), 
+                                         buf.eptr(), true, &ec );
+                if (!ec)
+                    flush(snk, &ec);
+            }
+            while (!ec && buf.ptr() != buf.data() && flush(snk, &ec)) ;
+        }
+        try {
+            close_impl();
+        } catch (const std::exception&) {
+            if (!ec)
+                detail::set_error_code(ec);
+        }
+    }
+    // Repeatedly invokes filter() with no input, until it produces no more
+    // output, and writes the result to snk. Used by filters which can be
+    // instructed to emit buffered output partway through a stream, e.g., at
+    // a sync point. Returns false, having no effect, if the filter is not
+    // being used for output. Like close(), requires a blocking Sink.
+    template<typename Sink>
+    bool drain(Sink& snk)
+    {
+        if (!(state() & f_write))
+            return false;
+        buffer_type&     buf = pimpl_->buf_;
+        char_type        dummy;
+        const char_type* end = &dummy;
+        while (true) {
+            if (buf.ptr() == buf.eptr()) {
+                flush(snk);
+                continue;
+            }
+            char_type* next = buf.ptr();
+            filter().filter(end, end, buf.ptr(), buf.eptr(), false);
+            if (buf.ptr() == next)
+                break;
+        }
+        while (buf.ptr() != buf.data())
+            flush(snk);
+        return true;
+    }
+    SymmetricFilter& filter() { return *pimpl_; }
+    string_type unconsumed_input() const;
+
+// Give impl access to buffer_type on Tru64
+#if !BOOST_WORKAROUND(__DECCXX_VER, BOOST_TESTED_AT(60590042)) 
+    private:
+#endif
+    typedef detail::buffer<char_type, Alloc> buffer_type;
+private:
+    buffer_type& buf() { return pimpl_->buf_; }
+    const buffer_type& buf() const { return pimpl_->buf_; }
+    int& state() { return pimpl_->state_; }
+    void begin_read();
+    void begin_write();
+
+    template<typename Source>
+    std::streamsize read_impl( Source& src, char_type* s, std::streamsize n,
+                               boost::system::error_code* ec )
     {
         using namespace std;
         if (!(state() & f_read))
@@ -114,8 +259,10 @@ public:
             if (buf.ptr() != buf.eptr() || flush) {
                 const char_type* next = buf.ptr();
                 bool done =
-                    !filter().filter(next, buf.eptr(), next_s, end_s, flush);
+                    !call_filter(next, buf.eptr(), next_s, end_s, flush, ec);
                 buf.ptr() = buf.data() + (next - buf.data());
+                if (ec && *ec)
+                    return -1;
                 if (done)
                     return detail::check_eof(
                                static_cast<std::streamsize>(next_s - s)
@@ -131,13 +278,18 @@ public:
             }
 
             // Fill buffer.
-            if (status == f_good)
-                status = fill(src);
+            if (status == f_good) {
+                status = fill(src, ec);
+                if (ec && *ec)
+                    return -1;
+            }
         }
     }
 
     template<typename Sink>
-    std::streamsize write(Sink& snk, const char_type* s, std::streamsize n)
+    std::streamsize write_impl( Sink& snk, const char_type* s, 
+                                std::streamsize n, 
+                                boost::system::error_code* ec )
     {
         if (!(state() & f_write))
             begin_write();
@@ -145,64 +297,69 @@ public:
         buffer_type&     buf = pimpl_->buf_;
         const char_type *next_s, *end_s;
         for (next_s = s, end_s = s + n; next_s != end_s; ) {
-            if (buf.ptr() == buf.eptr() && !flush(snk))
+            if (buf.ptr() == buf.eptr() && !flush(snk, ec))
                 break;
-            if(!filter().filter(next_s, end_s, buf.ptr(), buf.eptr(), false)) {
-                flush(snk);
+            if ( !call_filter( next_s, end_s, buf.ptr(), 
+                               buf.eptr(), false, ec ) )
+            {
+                if (!(ec && *ec))
+                    flush(snk, ec);
                 break;
             }
         }
         return static_cast<std::streamsize>(next_s - s);
     }
 
-    template<typename Sink>
-    void close(Sink& snk, BOOST_IOS::openmode mode)
+    // Invokes filter(), reporting errors through *ec if ec is non-null and
+    // by throwing otherwise. Returns false if the filter is done or if an 
+    // error was reported.
+    bool call_filter( const char_type*& begin_in, const char_type* end_in,
+                      char_type*& begin_out, char_type* end_out, bool flush,
+                      boost::system::error_code* ec )
     {
-        if (mode == BOOST_IOS::out) {
+        typedef mpl::bool_<
+                    detail::has_error_code_support<SymmetricFilter>::value
+                > supported;
+        return ec ?
+            call_filter( begin_in, end_in, begin_out, end_out, 
+                         flush, *ec, supported() ) :
+            filter().filter(begin_in, end_in, begin_out, end_out, flush);
+    }
 
-            if (!(state() & f_write))
-                begin_write();
+    bool call_filter( const char_type*& begin_in, const char_type* end_in,
+                      char_type*& begin_out, char_type* end_out, bool flush,
+                      boost::system::error_code& ec, mpl::true_ )
+    {
+        return filter().filter( begin_in, end_in, begin_out, 
+                                end_out, flush, ec );
+    }
 
-            // Repeatedly invoke filter() with no input.
-            try {
-                buffer_type&     buf = pimpl_->buf_;
-                char_type        dummy;
-                const char_type* end = &dummy;
-                bool             again = true;
-                while (again) {
-                    if (buf.ptr() != buf.eptr())
-                        again = filter().filter( end, end, buf.ptr(),
-                                                 buf.eptr(), true );
-                    flush(snk);
-                }
-            } catch (...) {
-                try { close_impl(); } catch (...) { }
-                throw;
-            }
-            close_impl();
-        } else {
-            close_impl();
+    bool call_filter( const char_type*& begin_in, const char_type* end_in,
+                      char_type*& begin_out, char_type* end_out, bool flush,
+                      boost::system::error_code& ec, mpl::false_ )
+    {
+        try {
+            return filter().filter(begin_in, end_in, begin_out, end_out, flush);
+        } catch (const std::exception&) {
+            detail::set_error_code(ec);
+            return false;
         }
     }
-    SymmetricFilter& filter() { return *pimpl_; }
-    string_type unconsumed_input() const;
-
-// Give impl access to buffer_type on Tru64
-#if !BOOST_WORKAROUND(__DECCXX_VER, BOOST_TESTED_AT(60590042)) 
-    private:
-#endif
-    typedef detail::buffer<char_type, Alloc> buffer_type;
-private:
-    buffer_type& buf() { return pimpl_->buf_; }
-    const buffer_type& buf() const { return pimpl_->buf_; }
-    int& state() { return pimpl_->state_; }
-    void begin_read();
-    void begin_write();
 
     template<typename Source>
-    int fill(Source& src)
+    int fill(Source& src, boost::system::error_code* ec = 0)
     {
-        std::streamsize amt = iostreams::read(src, buf().data(), buf().size());
+        BOOST_IOSTREAMS_PROBE3(
+            symmetric_fill_start, pimpl_.get(),
+            typeid(SymmetricFilter).name(), buf().size()
+        );
+        std::streamsize amt = ec ?
+            iostreams::read(src, buf().data(), buf().size(), *ec) :
+            iostreams::read(src, buf().data(), buf().size());
+        BOOST_IOSTREAMS_PROBE3(
+            symmetric_fill_done, pimpl_.get(),
+            typeid(SymmetricFilter).name(), amt
+        );
         if (amt == -1) {
             state() |= f_eof;
             return f_eof;
@@ -214,20 +371,29 @@ private:
     // Attempts to write the contents of the buffer the given Sink.
     // Returns true if at least on character was written.
     template<typename Sink>
-    bool flush(Sink& snk)
+    bool flush(Sink& snk, boost::system::error_code* ec = 0)
     {
         typedef typename iostreams::category_of<Sink>::type  category;
         typedef is_convertible<category, output>             can_write;
-        return flush(snk, can_write());
+        return flush(snk, ec, can_write());
     }
 
     template<typename Sink>
-    bool flush(Sink& snk, mpl::true_)
+    bool flush(Sink& snk, boost::system::error_code* ec, mpl::true_)
     {
         std::streamsize amt =
             static_cast<std::streamsize>(buf().ptr() - buf().data());
-        std::streamsize result =
+        BOOST_IOSTREAMS_PROBE3(
+            symmetric_flush_start, pimpl_.get(),
+            typeid(SymmetricFilter).name(), amt
+        );
+        std::streamsize result = ec ?
+            boost::iostreams::write(snk, buf().data(), amt, *ec) :
             boost::iostreams::write(snk, buf().data(), amt);
+        BOOST_IOSTREAMS_PROBE3(
+            symmetric_flush_done, pimpl_.get(),
+            typeid(SymmetricFilter).name(), result
+        );
         if (result < amt && result > 0)
             traits_type::move(buf().data(), buf().data() + result, amt - result);
         buf().set(amt - result, buf().size());
@@ -235,7 +401,7 @@ private:
     }
 
     template<typename Sink>
-    bool flush(Sink&, mpl::false_) { return true;}
+    bool flush(Sink&, boost::system::error_code*, mpl::false_) { return true;}
 
     void close_impl();
 
@@ -255,7 +421,8 @@ private:
         impl( int buffer_size BOOST_PP_COMMA_IF(n) \
               BOOST_PP_ENUM_BINARY_PARAMS(n, const T, &t) ) \
             : SymmetricFilter(BOOST_PP_ENUM_PARAMS(n, t)), \
-              buf_(buffer_size), state_(0) \
+              buf_(detail::adjust_buffer_size(Alloc(), buffer_size, 1)), \
+              state_(0) \
             { } \
         /**/
     #define BOOST_PP_LOCAL_LIMITS (0, BOOST_IOSTREAMS_MAX_FORWARDING_ARITY)
@@ -0,0 +1,535 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definitions of the class templates
+// basic_delta_varint_encoder and basic_delta_varint_decoder, which compact
+// streams of fixed-width integers, such as timestamps or sorted identifiers,
+// whose successive values are close together.
+//
+// The encoder reads integers of width 1 to 8 characters, stored with the
+// byte order given by varint_params, and replaces each by its difference
+// from the previous integer, modulo 2^(8 * width). Differences are mapped
+// to unsigned values by the zigzag transform (0, -1, 1, -2, ... become
+// 0, 1, 2, 3, ...) and stored as variable-length integers, in blocks of at
+// most varint_params::block_size integers. Each block begins with two
+// LEB128 integers giving the number of integers in the block and the size
+// of the remainder of the block, which contains, depending on the format:
+//
+//   varint::leb128 - each value in LEB128 form: seven bits per byte, least
+//       significant group first, the high bit set on all but the last byte.
+//   varint::group_varint - groups of up to four values, each preceded by a
+//       control byte whose bits 2i and 2i + 1 give the length of the i-th
+//       value, which is stored in little-endian order. The lengths 1, 2, 3
+//       and 4 are available for widths up to 4; for wider integers they are
+//       1, 2, 4 and the width.
+//
+// Differences are taken across blocks, so a stream must be decoded from its
+// beginning, with the same parameters used to encode it.
+
+#ifndef BOOST_IOSTREAMS_VARINT_HPP_INCLUDED
+#define BOOST_IOSTREAMS_VARINT_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <algorithm>                       // min.
+#include <cstddef>                         // size_t.
+#include <cstring>                         // memcpy.
+#include <memory>                          // allocator.
+#include <boost/config.hpp>                // BOOST_PREVENT_MACRO_SUBSTITUTION.
+#include <boost/cstdint.hpp>               // uint64_t.
+#include <boost/throw_exception.hpp>
+#include <boost/iostreams/constants.hpp>   // buffer size.
+#include <boost/iostreams/detail/buffer.hpp>
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/ios.hpp>  // failure, streamsize.
+#include <boost/iostreams/filter/symmetric.hpp>
+#include <boost/iostreams/pipeline.hpp>
+#include <boost/system/error_code.hpp>
+
+// Must come last.
+#ifdef BOOST_MSVC
+# pragma warning(push)
+# pragma warning(disable:4251 4231 4660)
+#endif
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace varint {
+
+                    // Formats
+
+BOOST_IOSTREAMS_DECL extern const int leb128;
+BOOST_IOSTREAMS_DECL extern const int group_varint;
+
+                    // Byte orders
+
+BOOST_IOSTREAMS_DECL extern const int little_endian;
+BOOST_IOSTREAMS_DECL extern const int big_endian;
+
+                    // Status codes
+
+BOOST_IOSTREAMS_DECL extern const int okay;
+BOOST_IOSTREAMS_DECL extern const int bad_params;
+BOOST_IOSTREAMS_DECL extern const int partial_integer;
+BOOST_IOSTREAMS_DECL extern const int bad_block_header;
+BOOST_IOSTREAMS_DECL extern const int data_error;
+BOOST_IOSTREAMS_DECL extern const int unexpected_eof;
+
+                    // Default values
+
+const int default_width = 8;
+const std::size_t default_block_size = 4096;
+
+} // End namespace varint.
+
+//
+// Class name: varint_params.
+// Description: Encapsulates the parameters used to customize encoding and
+//      decoding: the width of the integers, in characters, the format of
+//      the encoded values, the byte order of the integers and the maximum
+//      number of integers in a block.
+//
+struct varint_params {
+
+    // Non-explicit constructor.
+    varint_params( int width = varint::default_width,
+                   int format = varint::leb128,
+                   int byte_order = varint::little_endian,
+                   std::size_t block_size = varint::default_block_size )
+        : width(width), format(format), byte_order(byte_order),
+          block_size(block_size)
+        { }
+    int          width;
+    int          format;
+    int          byte_order;
+    std::size_t  block_size;
+};
+
+//
+// Class name: varint_error.
+// Description: Subclass of std::ios_base::failure thrown to indicate
+//     invalid parameters, input which doesn't consist of whole integers
+//     and malformed encoded streams.
+//
+class BOOST_IOSTREAMS_DECL varint_error : public BOOST_IOSTREAMS_FAILURE {
+public:
+    explicit varint_error(int error);
+    int error() const { return error_; }
+    static void check BOOST_PREVENT_MACRO_SUBSTITUTION(int error);
+
+    // Non-throwing version of check: stores in ec a code in
+    // varint_category() and returns false if error indicates failure.
+    static bool check BOOST_PREVENT_MACRO_SUBSTITUTION
+        (int error, boost::system::error_code& ec);
+private:
+    int error_;
+};
+
+// Returns the category of the error codes reported by the varint filters;
+// the values are the constants varint::bad_params, etc.
+BOOST_IOSTREAMS_DECL const boost::system::error_category& varint_category();
+
+namespace detail {
+
+//
+// Class name: varint_base.
+// Description: Encodes and decodes individual blocks, keeping track of the
+//      last integer of the previous block.
+//
+class BOOST_IOSTREAMS_DECL varint_base {
+public:
+    typedef char char_type;
+protected:
+    explicit varint_base(const varint_params& p);
+
+    // The maximum size of a block header.
+    static const std::size_t header_size = 20;
+
+    // The number of characters in a block of integers, and the maximum
+    // size of an encoded block, including its header.
+    std::size_t block_bytes() const { return block_size_ * width_; }
+    std::size_t max_encoded_size() const;
+
+    // Writes to dest a block containing the count <= block_size integers
+    // beginning at src, and returns its size.
+    std::size_t encode_block(const char* src, std::size_t count, char* dest);
+
+    // Stores in count and len the number of integers in a block and the
+    // size of its body, given the len characters of its header.
+    int decode_header( const char* header, std::size_t len,
+                       std::size_t& count, std::size_t& body_len ) const;
+
+    // Writes to dest, which must have room for count integers, the
+    // integers contained in a block body.
+    int decode_block( const char* body, std::size_t len, std::size_t count,
+                      char* dest );
+
+    // Forgets the last integer of the previous block.
+    void reset() { last_ = 0; }
+
+    std::size_t      width_;
+    int              format_;
+    int              byte_order_;
+    std::size_t      block_size_;
+    boost::uint64_t  last_;
+};
+
+//
+// Template name: delta_varint_encoder_impl
+// Description: Model of SymmetricFilter implementing delta and varint
+//      encoding. Input is encoded in whole blocks, directly from the input
+//      range and into the output range when they are large enough.
+//
+template<typename Alloc = std::allocator<char> >
+class delta_varint_encoder_impl : public varint_base {
+public:
+    delta_varint_encoder_impl(const varint_params& = varint_params());
+    bool filter( const char*& src_begin, const char* src_end,
+                 char*& dest_begin, char* dest_end, bool flush );
+    void close();
+private:
+    void encode( const char* src, std::size_t n,
+                 char*& dest_begin, char* dest_end );
+    bool drain(char*& dest_begin, char* dest_end);
+    buffer<char, Alloc>  in_;   // Partial block, in [data(), eptr()).
+    buffer<char, Alloc>  out_;  // Encoded block, in [ptr(), eptr()).
+};
+
+//
+// Template name: delta_varint_decoder_impl
+// Description: Model of SymmetricFilter implementing delta and varint
+//      decoding.
+//
+template<typename Alloc = std::allocator<char> >
+class delta_varint_decoder_impl : public varint_base {
+public:
+    typedef void error_code_support;
+    delta_varint_decoder_impl(const varint_params& = varint_params());
+    bool filter( const char*& begin_in, const char* end_in,
+                 char*& begin_out, char* end_out, bool flush );
+    bool filter( const char*& begin_in, const char* end_in,
+                 char*& begin_out, char* end_out, bool flush,
+                 boost::system::error_code& ec );
+    void close();
+private:
+    enum state_type { s_header, s_body };
+    int decode( const char*& begin_in, const char* end_in,
+                char*& begin_out, char* end_out, bool flush );
+    int decode_body( const char* body, char*& begin_out, char* end_out );
+    bool drain(char*& dest_begin, char* dest_end);
+    bool pending() const { return out_.ptr() != out_.eptr(); }
+    buffer<char, Alloc>  in_;   // Partial block body, in [data(), eptr()).
+    buffer<char, Alloc>  out_;  // Decoded block, in [ptr(), eptr()).
+    char                 header_[header_size];
+    std::size_t          header_len_;
+    int                  terminators_;  // Complete integers in header_.
+    std::size_t          count_;
+    std::size_t          length_;
+    state_type           state_;
+};
+
+} // End namespace detail.
+
+//
+// Template name: delta_varint_encoder
+// Description: Model of InputFilter and OutputFilter implementing delta
+//      and varint encoding of fixed-width integers.
+//
+template<typename Alloc = std::allocator<char> >
+struct basic_delta_varint_encoder
+    : symmetric_filter<detail::delta_varint_encoder_impl<Alloc>, Alloc>
+{
+private:
+    typedef detail::delta_varint_encoder_impl<Alloc>    impl_type;
+    typedef symmetric_filter<impl_type, Alloc>          base_type;
+public:
+    typedef typename base_type::char_type               char_type;
+    typedef typename base_type::category                category;
+    basic_delta_varint_encoder
+        ( const varint_params& = varint_params(),
+          int buffer_size = default_device_buffer_size );
+};
+BOOST_IOSTREAMS_PIPABLE(basic_delta_varint_encoder, 1)
+
+typedef basic_delta_varint_encoder<> delta_varint_encoder;
+
+//
+// Template name: delta_varint_decoder
+// Description: Model of InputFilter and OutputFilter implementing delta
+//      and varint decoding of fixed-width integers.
+//
+template<typename Alloc = std::allocator<char> >
+struct basic_delta_varint_decoder
+    : symmetric_filter<detail::delta_varint_decoder_impl<Alloc>, Alloc>
+{
+private:
+    typedef detail::delta_varint_decoder_impl<Alloc>    impl_type;
+    typedef symmetric_filter<impl_type, Alloc>          base_type;
+public:
+    typedef typename base_type::char_type               char_type;
+    typedef typename base_type::category                category;
+    basic_delta_varint_decoder
+        ( const varint_params& = varint_params(),
+          int buffer_size = default_device_buffer_size );
+};
+BOOST_IOSTREAMS_PIPABLE(basic_delta_varint_decoder, 1)
+
+typedef basic_delta_varint_decoder<> delta_varint_decoder;
+
+//----------------------------------------------------------------------------//
+
+//------------------Implementation of delta_varint_encoder_impl---------------//
+
+namespace detail {
+
+template<typename Alloc>
+delta_varint_encoder_impl<Alloc>::delta_varint_encoder_impl
+    (const varint_params& p)
+    : varint_base(p),
+      in_(static_cast<int>(block_bytes())),
+      out_(static_cast<int>(max_encoded_size()))
+{ close(); }
+
+template<typename Alloc>
+bool delta_varint_encoder_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    std::size_t block = block_bytes();
+    while (drain(dest_begin, dest_end)) {
+        std::size_t avail =
+                        static_cast<std::size_t>(src_end - src_begin),
+                    buffered =
+                        static_cast<std::size_t>(in_.eptr() - in_.data());
+        if (buffered == 0 && avail >= block) {
+            encode(src_begin, block_size_, dest_begin, dest_end);
+            src_begin += block;
+            continue;
+        }
+        std::size_t amt = (std::min)(avail, block - buffered);
+        std::memcpy(in_.eptr(), src_begin, amt);
+        in_.eptr() += amt;
+        src_begin += amt;
+        buffered += amt;
+        if (flush && buffered % width_ != 0)
+            boost::throw_exception(varint_error(varint::partial_integer));
+        if (buffered == block || (flush && buffered != 0)) {
+            encode(in_.data(), buffered / width_, dest_begin, dest_end);
+            in_.set(0, 0);
+            continue;
+        }
+        return !flush;
+    }
+    return true;
+}
+
+template<typename Alloc>
+void delta_varint_encoder_impl<Alloc>::close()
+{
+    in_.set(0, 0);
+    out_.set(0, 0);
+    reset();
+}
+
+template<typename Alloc>
+void delta_varint_encoder_impl<Alloc>::encode
+    (const char* src, std::size_t n, char*& dest_begin, char* dest_end)
+{
+    if (static_cast<std::size_t>(dest_end - dest_begin) >= max_encoded_size())
+        dest_begin += encode_block(src, n, dest_begin);
+    else
+        out_.set(0, encode_block(src, n, out_.data()));
+}
+
+// Copies as much pending output as possible to the given range; returns
+// true if no output remains pending.
+template<typename Alloc>
+bool delta_varint_encoder_impl<Alloc>::drain
+    (char*& dest_begin, char* dest_end)
+{
+    std::size_t amt =
+        (std::min)( static_cast<std::size_t>(out_.eptr() - out_.ptr()),
+                    static_cast<std::size_t>(dest_end - dest_begin) );
+    std::memcpy(dest_begin, out_.ptr(), amt);
+    out_.ptr() += amt;
+    dest_begin += amt;
+    return out_.ptr() == out_.eptr();
+}
+
+//------------------Implementation of delta_varint_decoder_impl---------------//
+
+template<typename Alloc>
+delta_varint_decoder_impl<Alloc>::delta_varint_decoder_impl
+    (const varint_params& p)
+    : varint_base(p),
+      in_(static_cast<int>(max_encoded_size())),
+      out_(static_cast<int>(block_bytes()))
+{ close(); }
+
+template<typename Alloc>
+bool delta_varint_decoder_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    int result = decode(src_begin, src_end, dest_begin, dest_end, flush);
+    varint_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result);
+    return !flush || pending() || src_begin != src_end;
+}
+
+template<typename Alloc>
+bool delta_varint_decoder_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush,
+      boost::system::error_code& ec )
+{
+    int result = decode(src_begin, src_end, dest_begin, dest_end, flush);
+    return varint_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result, ec) &&
+           (!flush || pending() || src_begin != src_end);
+}
+
+template<typename Alloc>
+void delta_varint_decoder_impl<Alloc>::close()
+{
+    in_.set(0, 0);
+    out_.set(0, 0);
+    header_len_ = 0;
+    terminators_ = 0;
+    count_ = 0;
+    length_ = 0;
+    state_ = s_header;
+    reset();
+}
+
+template<typename Alloc>
+int delta_varint_decoder_impl<Alloc>::decode
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    while (drain(dest_begin, dest_end) && src_begin != src_end) {
+        std::size_t avail = static_cast<std::size_t>(src_end - src_begin);
+        switch (state_) {
+        case s_header:
+            {
+                // The header ends with the second byte whose high bit is
+                // clear
+                while (src_begin != src_end && terminators_ < 2) {
+                    if (header_len_ == header_size)
+                        return varint::bad_block_header;
+                    char c = *src_begin++;
+                    header_[header_len_++] = c;
+                    if ((static_cast<unsigned char>(c) & 0x80) == 0)
+                        ++terminators_;
+                }
+                if (terminators_ < 2)
+                    break;
+                int result =
+                    decode_header(header_, header_len_, count_, length_);
+                if (result != varint::okay)
+                    return result;
+                header_len_ = 0;
+                terminators_ = 0;
+                in_.set(0, 0);
+                state_ = s_body;
+            }
+            break;
+        case s_body:
+            {
+                // Decode the body in place if it lies entirely within the
+                // input range
+                std::size_t  buffered =
+                                 static_cast<std::size_t>(
+                                     in_.eptr() - in_.data()
+                                 );
+                const char*  body;
+                if (buffered == 0 && avail >= length_) {
+                    body = src_begin;
+                    src_begin += length_;
+                } else {
+                    std::size_t amt = (std::min)(avail, length_ - buffered);
+                    std::memcpy(in_.eptr(), src_begin, amt);
+                    in_.eptr() += amt;
+                    src_begin += amt;
+                    if (buffered + amt < length_)
+                        break;
+                    body = in_.data();
+                }
+                state_ = s_header;
+                if (int result = decode_body(body, dest_begin, dest_end))
+                    return result;
+            }
+            break;
+        }
+    }
+    if (flush && src_begin == src_end && (state_ != s_header || header_len_))
+        return varint::unexpected_eof;
+    return varint::okay;
+}
+
+// Decodes the block described by count_, length_ and body, directly into
+// the given range if it has room and otherwise into out_.
+template<typename Alloc>
+int delta_varint_decoder_impl<Alloc>::decode_body
+    (const char* body, char*& dest_begin, char* dest_end)
+{
+    std::size_t  size = count_ * width_;
+    bool         direct =
+                     static_cast<std::size_t>(dest_end - dest_begin) >= size;
+    char*        dest = direct ? dest_begin : out_.data();
+    if (int result = decode_block(body, length_, count_, dest))
+        return result;
+    if (direct)
+        dest_begin += size;
+    else
+        out_.set(0, static_cast<std::streamsize>(size));
+    return varint::okay;
+}
+
+// Copies as much pending output as possible to the given range; returns
+// true if no output remains pending.
+template<typename Alloc>
+bool delta_varint_decoder_impl<Alloc>::drain
+    (char*& dest_begin, char* dest_end)
+{
+    std::size_t amt =
+        (std::min)( static_cast<std::size_t>(out_.eptr() - out_.ptr()),
+                    static_cast<std::size_t>(dest_end - dest_begin) );
+    std::memcpy(dest_begin, out_.ptr(), amt);
+    out_.ptr() += amt;
+    dest_begin += amt;
+    return out_.ptr() == out_.eptr();
+}
+
+} // End namespace detail.
+
+//------------------Implementation of delta_varint_encoder--------------------//
+
+template<typename Alloc>
+basic_delta_varint_encoder<Alloc>::basic_delta_varint_encoder
+        (const varint_params& p, int buffer_size)
+    : base_type(buffer_size, p)
+    { }
+
+//------------------Implementation of delta_varint_decoder--------------------//
+
+template<typename Alloc>
+basic_delta_varint_decoder<Alloc>::basic_delta_varint_decoder
+        (const varint_params& p, int buffer_size)
+    : base_type(buffer_size, p)
+    { }
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // Pops abi_suffix.hpp pragmas.
+#ifdef BOOST_MSVC
+# pragma warning(pop)
+#endif
+
+#endif // #ifndef BOOST_IOSTREAMS_VARINT_HPP_INCLUDED
@@ -15,10 +15,13 @@
 # pragma once
 #endif              
 
+#include <algorithm>         // min.
 #include <cassert>                            
+#include <cstring>           // memcpy.
 #include <iosfwd>            // streamsize.                 
 #include <memory>            // allocator, bad_alloc.
 #include <new>          
+#include <string>
 #include <boost/config.hpp>  // MSVC, STATIC_CONSTANT, DEDUCED_TYPENAME, DINKUM.
 #include <boost/cstdint.hpp> // uint*_t
 #include <boost/detail/workaround.hpp>
@@ -30,6 +33,7 @@
 #include <boost/iostreams/detail/ios.hpp>  // failure, streamsize.
 #include <boost/iostreams/filter/symmetric.hpp>                
 #include <boost/iostreams/pipeline.hpp>                
+#include <boost/system/error_code.hpp>
 #include <boost/type_traits/is_same.hpp>
 
 // Must come last.
@@ -84,6 +88,7 @@ BOOST_IOSTREAMS_DECL extern const int buf_error;
 BOOST_IOSTREAMS_DECL extern const int finish;
 BOOST_IOSTREAMS_DECL extern const int no_flush;
 BOOST_IOSTREAMS_DECL extern const int sync_flush;
+BOOST_IOSTREAMS_DECL extern const int full_flush;
 
                     // Code for current OS
 
@@ -99,6 +104,7 @@ const int default_window_bits                = 15;
 const int default_mem_level                  = 8;
 const bool default_crc                       = false;
 const bool default_noheader                  = false;
+const bool default_rsyncable                 = false;
 
 } // End namespace zlib. 
 
@@ -106,6 +112,12 @@ const bool default_noheader                  = false;
 // Class name: zlib_params.
 // Description: Encapsulates the parameters passed to deflateInit2
 //      and inflateInit2 to customize compression and decompression.
+//      If rsyncable is true, a compressor emits a sync flush at points in
+//      the input determined by its content, so that the output following
+//      a change to the input soon becomes identical to that which would
+//      have been produced had the change not been made; this makes the
+//      output suitable for delta transfer with rsync, at a cost of about
+//      one percent in compression ratio.
 //
 struct zlib_params {
 
@@ -116,10 +128,12 @@ struct zlib_params {
                  int mem_level       = zlib::default_mem_level, 
                  int strategy        = zlib::default_strategy,
                  bool noheader       = zlib::default_noheader,
-                 bool calculate_crc  = zlib::default_crc )
+                 bool calculate_crc  = zlib::default_crc,
+                 bool rsyncable      = zlib::default_rsyncable )
         : level(level), method(method), window_bits(window_bits),
           mem_level(mem_level), strategy(strategy),  
-          noheader(noheader), calculate_crc(calculate_crc)
+          noheader(noheader), calculate_crc(calculate_crc),
+          rsyncable(rsyncable)
         { }
     int level;
     int method;
@@ -128,6 +142,7 @@ struct zlib_params {
     int strategy;
     bool noheader;
     bool calculate_crc;
+    bool rsyncable;
 };
 
 //
@@ -140,10 +155,44 @@ public:
     explicit zlib_error(int error);
     int error() const { return error_; }
     static void check BOOST_PREVENT_MACRO_SUBSTITUTION(int error);
+
+    // Non-throwing version of check: stores in ec a code in zlib_category(),
+    // or errc::not_enough_memory for out-of-memory conditions, and returns
+    // false if error indicates failure.
+    static bool check BOOST_PREVENT_MACRO_SUBSTITUTION
+        (int error, boost::system::error_code& ec);
 private:
     int error_;
 };
 
+// Returns the category of the error codes reported by the zlib and gzip
+// filters for errors detected by zlib; the values are zlib's return codes.
+BOOST_IOSTREAMS_DECL const boost::system::error_category& zlib_category();
+
+//
+// Class name: zlib_checkpoint.
+// Description: Snapshot of the state of a zlib or gzip filter, from which a
+//      newly constructed filter can resume processing. A decompressor
+//      records checkpoints at deflate block boundaries; a checkpoint holds
+//      the last 32K of output and the unconsumed bits of the last input
+//      byte. A compressor creates a checkpoint by emitting a sync point.
+//      In both cases the checkpoint holds the CRC and size of the data
+//      processed so far in the current stream, or gzip member.
+//
+struct zlib_checkpoint {
+    zlib_checkpoint()
+        : compressed_offset(0), uncompressed_offset(0), crc(0), size(0),
+          bits(0), byte(0)
+        { }
+    std::streamoff  compressed_offset;    // Position in compressed data.
+    std::streamoff  uncompressed_offset;  // Position in uncompressed data.
+    zlib::ulong     crc;                  // CRC of current stream.
+    zlib::ulong     size;                 // Size of current stream, mod 2^32.
+    int             bits;                 // Bits of last byte not consumed.
+    int             byte;                 // Last byte consumed.
+    std::string     window;               // Preceding output, for inflate.
+};
+
 namespace detail {
 
 template<typename Alloc>
@@ -200,6 +249,19 @@ public:
     zlib::ulong crc() const { return crc_; }
     int total_in() const { return total_in_; }
     int total_out() const { return total_out_; }
+
+    // Members supporting checkpoints. A decompressor records a checkpoint
+    // at the first block boundary after each spacing characters of output,
+    // if spacing is non-zero. Offsets are relative to the beginning of the
+    // data, unless changed with set_offsets(); restore() must be called
+    // before any data has been processed.
+    void checkpoint_spacing(std::streamsize spacing) { spacing_ = spacing; }
+    bool has_checkpoint() const { return has_checkpoint_; }
+    const zlib_checkpoint& checkpoint() const { return checkpoint_; }
+    void restore(const zlib_checkpoint& cp);
+    std::streamoff compressed_offset() const;
+    std::streamoff uncompressed_offset() const;
+    void set_offsets(std::streamoff compressed, std::streamoff uncompressed);
 private:
     void do_init( const zlib_params& p, bool compress, 
                   #if !BOOST_WORKAROUND(BOOST_MSVC, < 1300)
@@ -207,12 +269,22 @@ private:
                       zlib::xfree_func, 
                   #endif
                   void* derived );
-    void*        stream_;         // Actual type: z_stream*.
-    bool         calculate_crc_;
-    zlib::ulong  crc_;
-    zlib::ulong  crc_imp_;
-    int          total_in_;
-    int          total_out_;
+    int xinflate_blocks();
+    void save_checkpoint(const zlib::byte* begin_out);
+    void*            stream_;         // Actual type: z_stream*.
+    bool             calculate_crc_;
+    bool             compress_;
+    int              window_bits_;    // As passed to zlib; negative if raw.
+    zlib::ulong      crc_;
+    zlib::ulong      crc_imp_;
+    int              total_in_;
+    int              total_out_;
+    std::streamoff   compressed_base_;
+    std::streamoff   uncompressed_base_;
+    std::streamsize  spacing_;
+    bool             has_checkpoint_;
+    zlib_checkpoint  checkpoint_;
+    zlib::byte       last_byte_;
 };
 
 //
@@ -223,11 +295,37 @@ private:
 template<typename Alloc = std::allocator<char> >
 class zlib_compressor_impl : public zlib_base, public zlib_allocator<Alloc> { 
 public: 
+    typedef void error_code_support;
     zlib_compressor_impl(const zlib_params& = zlib::default_compression);
     ~zlib_compressor_impl();
     bool filter( const char*& src_begin, const char* src_end,
                  char*& dest_begin, char* dest_end, bool flush );
+    bool filter( const char*& src_begin, const char* src_end,
+                 char*& dest_begin, char* dest_end, bool flush,
+                 boost::system::error_code& ec );
     void close();
+
+    // Causes the next calls to filter() with no input to emit a sync point,
+    // at which all input so far has been compressed and which ends on a
+    // byte boundary.
+    void sync() { flush_ = zlib::full_flush; }
+private:
+    int deflate_step( const char*& src_begin, const char* src_end,
+                      char*& dest_begin, char* dest_end, bool flush );
+    int rsync_step( const char*& src_begin, const char* src_end,
+                    char*& dest_begin, char* dest_end, bool flush );
+    int rsync_flush();
+    bool rsync_scan(const char* src_begin, const char* src_end);
+    int complete_sync( const char* dest_begin, const char* dest_end,
+                       int result );
+    int              flush_;
+    bool             rsyncable_;
+    boost::uint32_t  rsync_hash_;   // Rolling hash of preceding characters.
+    std::size_t      rsync_count_;  // Characters since last rsync point.
+    std::size_t      rsync_size_;   // Characters hashed but not consumed.
+    bool             rsync_hit_;    // Rsync point follows rsync_size_.
+    std::string      rsync_output_; // Output of last rsync point.
+    std::size_t      rsync_next_;   // Characters of rsync_output_ copied.
 };
 
 //
@@ -239,11 +337,16 @@ template<typename Alloc = std::allocator<char> >
 class zlib_decompressor_impl : public zlib_base, public zlib_allocator<Alloc> {
 public:
     zlib_decompressor_impl(const zlib_params&);
+    typedef void error_code_support;
     zlib_decompressor_impl(int window_bits = zlib::default_window_bits);
     ~zlib_decompressor_impl();
     bool filter( const char*& begin_in, const char* end_in,
                  char*& begin_out, char* end_out, bool flush );
+    bool filter( const char*& begin_in, const char* end_in,
+                 char*& begin_out, char* end_out, bool flush,
+                 boost::system::error_code& ec );
     void close();
+    void restore(const zlib_checkpoint& cp);
     bool eof() const { return eof_; }
 private:
     bool eof_;
@@ -270,6 +373,26 @@ public:
                            int buffer_size = default_device_buffer_size );
     zlib::ulong crc() { return this->filter().crc(); }
     int total_in() {  return this->filter().total_in(); }
+
+    // Emits a sync point, writes all pending output to snk, and returns a
+    // checkpoint from which a compressor constructed with the same
+    // parameters can continue the stream after its compressed data has
+    // been truncated to the checkpoint's compressed_offset. Requires raw
+    // deflate, i.e., zlib_params::noheader, and a blocking Sink.
+    template<typename Sink>
+    zlib_checkpoint checkpoint(Sink& snk)
+    {
+        impl_type& f = this->filter();
+        f.sync();
+        this->drain(snk);
+        zlib_checkpoint cp;
+        cp.compressed_offset = f.compressed_offset();
+        cp.uncompressed_offset = f.uncompressed_offset();
+        cp.crc = f.crc();
+        cp.size = static_cast<zlib::ulong>(f.total_in());
+        return cp;
+    }
+    void restore(const zlib_checkpoint& cp) { this->filter().restore(cp); }
 };
 BOOST_IOSTREAMS_PIPABLE(basic_zlib_compressor, 1)
 
@@ -297,6 +420,19 @@ public:
     zlib::ulong crc() { return this->filter().crc(); }
     int total_out() {  return this->filter().total_out(); }
     bool eof() { return this->filter().eof(); }
+
+    // Causes a checkpoint to be recorded at the first deflate block boundary
+    // after each spacing characters of output. The most recent checkpoint
+    // can be passed to restore() on a newly constructed decompressor, which
+    // will then produce the output following the checkpoint's
+    // uncompressed_offset when given the input following its
+    // compressed_offset. When decompressing the zlib format, the trailing
+    // adler-32 checksum is not verified after restore().
+    void enable_checkpoints(std::streamsize spacing)
+    { this->filter().checkpoint_spacing(spacing); }
+    bool has_checkpoint() { return this->filter().has_checkpoint(); }
+    zlib_checkpoint checkpoint() { return this->filter().checkpoint(); }
+    void restore(const zlib_checkpoint& cp) { this->filter().restore(cp); }
 };
 BOOST_IOSTREAMS_PIPABLE(basic_zlib_decompressor, 1)
 
@@ -313,13 +449,17 @@ void* zlib_allocator<Alloc, Base>::allocate
     (void* self, zlib::uint items, zlib::uint size)
 { 
     size_type len = items * size;
-    char* ptr = 
-        static_cast<allocator_type*>(self)->allocate
-            (len + sizeof(size_type)
-            #if BOOST_WORKAROUND(BOOST_DINKUMWARE_STDLIB, == 1)
-                , (char*)0
-            #endif
-            );
+    char* ptr;
+    try {
+        ptr = static_cast<allocator_type*>(self)->allocate
+                  (len + sizeof(size_type)
+                  #if BOOST_WORKAROUND(BOOST_DINKUMWARE_STDLIB, == 1)
+                      , (char*)0
+                  #endif
+                  );
+    } catch (...) {
+        return 0; // Reported as a memory error; must not propagate into C.
+    }
     *reinterpret_cast<size_type*>(ptr) = len;
     return ptr + sizeof(size_type);
 }
@@ -336,6 +476,8 @@ void zlib_allocator<Alloc, Base>::deallocate(void* self, void* address)
 
 template<typename Alloc>
 zlib_compressor_impl<Alloc>::zlib_compressor_impl(const zlib_params& p)
+    : flush_(zlib::no_flush), rsyncable_(p.rsyncable), rsync_hash_(0),
+      rsync_count_(0), rsync_size_(0), rsync_hit_(false), rsync_next_(0)
 { init(p, true, static_cast<zlib_allocator<Alloc>&>(*this)); }
 
 template<typename Alloc>
@@ -347,15 +489,163 @@ bool zlib_compressor_impl<Alloc>::filter
     ( const char*& src_begin, const char* src_end,
       char*& dest_begin, char* dest_end, bool flush )
 {
-    before(src_begin, src_end, dest_begin, dest_end);
-    int result = xdeflate(flush ? zlib::finish : zlib::no_flush);
-    after(src_begin, dest_begin, true);
+    int result = deflate_step(src_begin, src_end, dest_begin, dest_end, flush);
     zlib_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result);
     return result != zlib::stream_end; 
 }
 
 template<typename Alloc>
-void zlib_compressor_impl<Alloc>::close() { reset(true, true); }
+bool zlib_compressor_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush,
+      boost::system::error_code& ec )
+{
+    int result = deflate_step(src_begin, src_end, dest_begin, dest_end, flush);
+    return zlib_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result, ec) &&
+           result != zlib::stream_end; 
+}
+
+template<typename Alloc>
+void zlib_compressor_impl<Alloc>::close() 
+{ 
+    flush_ = zlib::no_flush;
+    rsync_hash_ = 0;
+    rsync_count_ = 0;
+    rsync_size_ = 0;
+    rsync_hit_ = false;
+    rsync_output_.clear();
+    rsync_next_ = 0;
+    reset(true, true); 
+}
+
+template<typename Alloc>
+int zlib_compressor_impl<Alloc>::deflate_step
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    // Calls with no input are only made to complete a sync point
+    if (src_begin == src_end && !flush && flush_ == zlib::no_flush)
+        return zlib::okay;
+
+    // Input is consumed up to each rsync point in turn, since symmetric_filter
+    // expects all input to be consumed while output space remains
+    if (rsyncable_) {
+        int result;
+        do {
+            result =
+                rsync_step(src_begin, src_end, dest_begin, dest_end, flush);
+        } while ( result == zlib::okay && dest_begin != dest_end &&
+                  ( src_begin != src_end || flush_ != zlib::no_flush ||
+                    rsync_next_ != rsync_output_.size() ) );
+        return result;
+    }
+    before(src_begin, src_end, dest_begin, dest_end);
+    int result = xdeflate(flush ? zlib::finish : flush_);
+    after(src_begin, dest_begin, true);
+    return complete_sync(dest_begin, dest_end, result);
+}
+
+template<typename Alloc>
+int zlib_compressor_impl<Alloc>::rsync_step
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    // Output of the last rsync point is copied before any further input is
+    // processed
+    if (rsync_next_ != rsync_output_.size()) {
+        std::size_t amt =
+            (std::min)( static_cast<std::size_t>(dest_end - dest_begin),
+                        rsync_output_.size() - rsync_next_ );
+        std::memcpy(dest_begin, rsync_output_.data() + rsync_next_, amt);
+        dest_begin += amt;
+        if ((rsync_next_ += amt) == rsync_output_.size()) {
+            rsync_output_.clear();
+            rsync_next_ = 0;
+        }
+        return zlib::okay;
+    }
+
+    const char* next = src_begin;
+    int action = flush ? zlib::finish : zlib::no_flush;
+    if (flush_ != zlib::no_flush) {
+        action = flush_;
+        src_end = src_begin;
+    } else if (rsync_scan(src_begin, src_end)) {
+        action = zlib::no_flush;
+        src_end = src_begin + rsync_size_;
+    }
+    before(src_begin, src_end, dest_begin, dest_end);
+    int result = xdeflate(action);
+    after(src_begin, dest_begin, true);
+    rsync_size_ -= static_cast<std::size_t>(src_begin - next);
+    if (rsync_hit_ && rsync_size_ == 0) {
+        rsync_hit_ = false;
+        result = rsync_flush();
+    }
+    return complete_sync(dest_begin, dest_end, result);
+}
+
+// Performs a sync flush once the input preceding an rsync point has been
+// consumed, so that deflate emits the same blocks following it as it would
+// for any input with the same preceding 32K characters. The output is
+// buffered, since a sync flush is only complete once deflate leaves output
+// space unused, and may otherwise emit flush markers indefinitely when
+// given little output space.
+template<typename Alloc>
+int zlib_compressor_impl<Alloc>::rsync_flush()
+{
+    char buf[1024];
+    int result;
+    char* end;
+    do {
+        const char* src = buf;
+        end = buf;
+        before(src, src, end, buf + sizeof(buf));
+        result = xdeflate(zlib::sync_flush);
+        after(src, end, true);
+        rsync_output_.append(buf, end);
+    } while (result == zlib::okay && end == buf + sizeof(buf));
+    return result == zlib::buf_error ? zlib::okay : result;
+}
+
+// The sync point is complete once deflate leaves output space unused;
+// a buffer error indicates that there was nothing left to flush.
+template<typename Alloc>
+int zlib_compressor_impl<Alloc>::complete_sync
+    (const char* dest_begin, const char* dest_end, int result)
+{
+    if (flush_ != zlib::no_flush && dest_begin != dest_end) {
+        flush_ = zlib::no_flush;
+        if (result == zlib::buf_error)
+            result = zlib::okay;
+    }
+    return result;
+}
+
+// Hashes the characters of the given range not yet hashed, stopping after the
+// first at which an rsync point occurs, and returns true if one was found. The
+// top bits of the hash depend only on the last 32 characters, so rsync points
+// recur at the same places in unchanged regions of the input; they are at
+// least 8K characters apart, and on average 16K.
+template<typename Alloc>
+bool zlib_compressor_impl<Alloc>::rsync_scan
+    (const char* src_begin, const char* src_end)
+{
+    const boost::uint32_t  mask = ~(~boost::uint32_t(0) >> 13);
+    const std::size_t      min_spacing = 8192;
+    const char* p = src_begin + rsync_size_;
+    while (!rsync_hit_ && p != src_end) {
+        boost::uint32_t c = static_cast<unsigned char>(*p++) + 1u;
+        c *= 2654435761u;
+        rsync_hash_ = (rsync_hash_ << 1) + (c ^ (c >> 15));
+        rsync_hit_ =
+            ++rsync_count_ >= min_spacing && (rsync_hash_ & mask) == 0;
+    }
+    if (rsync_hit_)
+        rsync_count_ = 0;
+    rsync_size_ = static_cast<std::size_t>(p - src_begin);
+    return rsync_hit_;
+}
 
 //------------------Implementation of zlib_decompressor_impl------------------//
 
@@ -388,12 +678,32 @@ bool zlib_decompressor_impl<Alloc>::filter
     return !(eof_ = result == zlib::stream_end);
 }
 
+template<typename Alloc>
+bool zlib_decompressor_impl<Alloc>::filter
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool /* flush */,
+      boost::system::error_code& ec )
+{
+    before(src_begin, src_end, dest_begin, dest_end);
+    int result = xinflate(zlib::sync_flush);
+    after(src_begin, dest_begin, false);
+    return zlib_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(result, ec) &&
+           !(eof_ = result == zlib::stream_end);
+}
+
 template<typename Alloc>
 void zlib_decompressor_impl<Alloc>::close() {
     eof_ = false;
     reset(false, true);
 }
 
+template<typename Alloc>
+void zlib_decompressor_impl<Alloc>::restore(const zlib_checkpoint& cp)
+{
+    eof_ = false;
+    zlib_base::restore(cp);
+}
+
 } // End namespace detail.
 
 //------------------Implementation of zlib_decompressor-----------------------//
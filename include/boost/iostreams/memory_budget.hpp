@@ -0,0 +1,255 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definitions of the class memory_budget, which records the
+// memory allocated on behalf of one or more chains and enforces an upper
+// limit on it, and of the class template budget_allocator, a model of
+// Allocator which charges its allocations to a memory_budget.
+//
+// Every component which allocates memory does so through its Alloc template
+// parameter: the buffers of indirect_streambuf and symmetric_filter, the
+// z_stream and bz_stream state of the compression filters, the vectors of
+// aggregate_filter and the putback strings of gzip_decompressor. Passing
+// budget_allocator<Ch> as Alloc therefore charges all of that memory to a
+// budget. A default constructed budget_allocator charges the budget which is
+// current for the calling thread; a chain with a budget makes it current
+// while links are pushed, and memory_budget::scope makes a budget current
+// for the duration of a block, e.g., while filters are being constructed.
+
+#ifndef BOOST_IOSTREAMS_MEMORY_BUDGET_HPP_INCLUDED
+#define BOOST_IOSTREAMS_MEMORY_BUDGET_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <algorithm>                  // max.
+#include <cstddef>                    // ptrdiff_t, size_t.
+#include <new>                        // bad_alloc, placement new.
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>           // BOOST_STATIC_CONSTANT.
+#include <boost/iostreams/detail/config/thread_local.hpp>
+#include <boost/iostreams/detail/ios.hpp>  // streamsize.
+#include <boost/noncopyable.hpp>
+#include <boost/throw_exception.hpp>
+
+namespace boost { namespace iostreams {
+
+//
+// Class name: memory_budget_exceeded.
+// Description: Subclass of std::bad_alloc thrown when an allocation or
+//      a call to push() would exceed the limit of a memory_budget.
+//
+class memory_budget_exceeded : public std::bad_alloc {
+public:
+    const char* what() const throw() { return "memory budget exceeded"; }
+};
+
+//
+// Class name: memory_budget.
+// Description: Thread-safe record of the number of bytes allocated on behalf
+//      of one or more chains, with an optional upper limit. The policy
+//      determines what happens when an allocation would exceed the limit:
+//
+//      throw_exception - the allocation throws memory_budget_exceeded.
+//      shrink_buffers  - buffers are allocated with as many characters
+//                        as fit within the remaining budget; other
+//                        allocations throw memory_budget_exceeded.
+//      fail_push       - allocations always succeed, but a call to push()
+//                        which leaves the budget exceeded is rolled back
+//                        and throws memory_budget_exceeded.
+//
+class memory_budget : private noncopyable {
+public:
+    enum policy_type {
+        throw_exception,
+        shrink_buffers,
+        fail_push
+    };
+    BOOST_STATIC_CONSTANT(std::size_t, unlimited = ~static_cast<std::size_t>(0));
+    class scope;
+
+    explicit memory_budget( std::size_t limit = unlimited,
+                            policy_type policy = throw_exception )
+        : used_(0), peak_(0), limit_(limit), policy_(policy)
+        { }
+
+    std::size_t limit() const { return limit_.load(); }
+    void set_limit(std::size_t limit) { limit_.store(limit); }
+    policy_type policy() const { return static_cast<policy_type>(policy_.load()); }
+    void set_policy(policy_type policy) { policy_.store(policy); }
+
+    // Returns the number of bytes currently charged to this budget.
+    std::size_t used() const { return used_.load(); }
+
+    // Returns the largest value returned by used() since construction or
+    // since the last call to reset_peak().
+    std::size_t peak() const { return peak_.load(); }
+    void reset_peak() { peak_.store(used_.load()); }
+
+    // Returns the number of bytes which may be charged before the limit is
+    // reached.
+    std::size_t available() const
+    {
+        std::size_t used = used_.load(), limit = limit_.load();
+        return used < limit ? limit - used : 0;
+    }
+    bool exceeded() const { return used_.load() > limit_.load(); }
+
+    // Charges n bytes to this budget. Throws memory_budget_exceeded, without
+    // charging anything, if the limit would be exceeded, unless the policy
+    // is fail_push.
+    void allocate(std::size_t n)
+    {
+        std::size_t used = used_.load(), next;
+        do {
+            next = used + n;
+            if ( (next > limit_.load() || next < used) &&
+                 policy() != fail_push )
+            {
+                boost::throw_exception(memory_budget_exceeded());
+            }
+        } while (!used_.compare_exchange_weak(used, next));
+        std::size_t peak = peak_.load();
+        while (peak < next && !peak_.compare_exchange_weak(peak, next)) ;
+    }
+
+    // Returns n bytes to this budget.
+    void deallocate(std::size_t n) { used_.fetch_sub(n); }
+
+    // Returns the number of bytes which should be allocated for a buffer
+    // when n bytes have been requested, given that a buffer of fewer than
+    // min bytes is useless. The result is less than n only if the policy is
+    // shrink_buffers.
+    std::streamsize buffer_size(std::streamsize n, std::streamsize min) const
+    {
+        if (policy() != shrink_buffers)
+            return n;
+        std::size_t avail = available();
+        return static_cast<std::size_t>(n) <= avail ?
+            n :
+            (std::max)(min, static_cast<std::streamsize>(avail));
+    }
+
+    // Returns the budget charged by default constructed instances of
+    // budget_allocator created by the calling thread, or a null pointer.
+    static memory_budget* current() { return current_ref(); }
+private:
+    static memory_budget*& current_ref()
+    {
+        static BOOST_IOSTREAMS_THREAD_LOCAL memory_budget* current = 0;
+        return current;
+    }
+    boost::atomic<std::size_t>  used_;
+    boost::atomic<std::size_t>  peak_;
+    boost::atomic<std::size_t>  limit_;
+    boost::atomic<int>          policy_;
+};
+
+//
+// Class name: memory_budget::scope.
+// Description: Makes a budget current for the calling thread for the
+//      lifetime of an instance, restoring the previous budget on
+//      destruction. Constructing a scope from a null pointer leaves the
+//      current budget unchanged.
+//
+class memory_budget::scope : private noncopyable {
+public:
+    explicit scope(memory_budget& budget) : saved_(current_ref())
+    { current_ref() = &budget; }
+    explicit scope(memory_budget* budget) : saved_(current_ref())
+    { if (budget) current_ref() = budget; }
+    ~scope() { current_ref() = saved_; }
+private:
+    memory_budget* saved_;
+};
+
+//
+// Template name: budget_allocator.
+// Template parameters:
+//      T - The value type.
+// Description: Model of Allocator which charges the memory it allocates
+//      to a memory_budget. A default constructed instance uses the budget
+//      which is current when it is constructed; copies, including rebound
+//      copies, use the same budget.
+//
+template<typename T>
+class budget_allocator {
+public:
+    typedef T                  value_type;
+    typedef T*                 pointer;
+    typedef const T*           const_pointer;
+    typedef T&                 reference;
+    typedef const T&           const_reference;
+    typedef std::size_t        size_type;
+    typedef std::ptrdiff_t     difference_type;
+    template<typename U>
+    struct rebind { typedef budget_allocator<U> other; };
+
+    budget_allocator() : budget_(memory_budget::current()) { }
+    explicit budget_allocator(memory_budget& budget) : budget_(&budget) { }
+    template<typename U>
+    budget_allocator(const budget_allocator<U>& other)
+        : budget_(other.budget())
+        { }
+    memory_budget* budget() const { return budget_; }
+
+    pointer allocate(size_type n, const void* = 0)
+    {
+        if (n > max_size())
+            boost::throw_exception(std::bad_alloc());
+        std::size_t bytes = n * sizeof(T);
+        if (budget_)
+            budget_->allocate(bytes);
+        try {
+            return static_cast<pointer>(::operator new(bytes));
+        } catch (...) {
+            if (budget_)
+                budget_->deallocate(bytes);
+            throw;
+        }
+    }
+    void deallocate(pointer p, size_type n)
+    {
+        ::operator delete(p);
+        if (budget_)
+            budget_->deallocate(n * sizeof(T));
+    }
+    size_type max_size() const
+    { return static_cast<size_type>(-1) / sizeof(T); }
+    pointer address(reference x) const { return &x; }
+    const_pointer address(const_reference x) const { return &x; }
+    void construct(pointer p, const T& val) { new (static_cast<void*>(p)) T(val); }
+    void destroy(pointer p) { p->~T(); }
+
+    // Used by the buffers of indirect_streambuf and symmetric_filter to
+    // apply the shrink_buffers policy; see detail::budgeted_buffer_size.
+    friend std::streamsize budgeted_buffer_size
+        (const budget_allocator& a, std::streamsize n, std::streamsize min)
+    {
+        if (!a.budget_)
+            return n;
+        std::streamsize size = static_cast<std::streamsize>(sizeof(T));
+        return a.budget_->buffer_size(n * size, min * size) / size;
+    }
+private:
+    memory_budget* budget_;
+};
+
+template<typename T, typename U>
+inline bool operator==
+    (const budget_allocator<T>& lhs, const budget_allocator<U>& rhs)
+{ return lhs.budget() == rhs.budget(); }
+
+template<typename T, typename U>
+inline bool operator!=
+    (const budget_allocator<T>& lhs, const budget_allocator<U>& rhs)
+{ return lhs.budget() != rhs.budget(); }
+
+} } // End namespaces iostreams, boost.
+
+#endif // #ifndef BOOST_IOSTREAMS_MEMORY_BUDGET_HPP_INCLUDED
@@ -0,0 +1,95 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Contains the definition of the class reactor, a single-threaded event loop
+// which invokes handlers when file descriptors become ready for i/o. It is
+// the readiness notification mechanism of the asynchronous operations
+// declared in <boost/iostreams/async.hpp>. On Linux it is implemented with
+// epoll; on other POSIX systems with poll. It is not available on Windows.
+
+#ifndef BOOST_IOSTREAMS_REACTOR_HPP_INCLUDED
+#define BOOST_IOSTREAMS_REACTOR_HPP_INCLUDED
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+# pragma once
+#endif
+
+#include <cstddef>                             // size_t.
+#include <boost/function.hpp>
+#include <boost/iostreams/detail/config/auto_link.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/file_handle.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/system/error_code.hpp>
+
+// Must come last.
+#include <boost/config/abi_prefix.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace detail { class reactor_impl; }
+
+//
+// Class name: reactor.
+// Description: Event loop which invokes handlers when file descriptors
+//      become readable or writable. Handlers are never invoked from within
+//      async_wait() or post(), only from run() and run_one(), on the thread
+//      which calls them; a reactor must not be run by more than one thread
+//      at a time. Handlers receive a default constructed error_code when a
+//      descriptor is ready, errc::operation_canceled when the wait is
+//      cancelled, and the error reported by the system if a descriptor
+//      cannot be waited on.
+//
+class BOOST_IOSTREAMS_DECL reactor : private noncopyable {
+public:
+    typedef detail::file_handle  handle_type;
+    typedef boost::function<
+                void (const boost::system::error_code&)
+            >                    handler_type;
+    enum wait_type {
+        wait_read = 1,
+        wait_write = 2
+    };
+
+    reactor();
+    ~reactor();
+
+    // Arranges for handler to be invoked once h is ready for the given
+    // type of i/o. Any number of handlers may wait on a descriptor; they
+    // are invoked in the order in which they were registered.
+    void async_wait(handle_type h, wait_type type, const handler_type& handler);
+
+    // Arranges for handler to be invoked as soon as possible.
+    void post(const handler_type& handler);
+
+    // Cancels all waits on h; their handlers are invoked with
+    // errc::operation_canceled.
+    void cancel(handle_type h);
+
+    // Runs handlers until there are no more waits or posted handlers, or
+    // until stop() is called. Returns the number of handlers invoked.
+    std::size_t run();
+
+    // Blocks until one handler has been invoked, there is nothing left to
+    // wait for, or stop() is called. Returns the number of handlers invoked.
+    std::size_t run_one();
+
+    // Causes run() and run_one() to return as soon as possible. Waits and
+    // posted handlers are retained until the reactor is restarted.
+    void stop();
+    bool stopped() const;
+    void restart();
+private:
+    shared_ptr<detail::reactor_impl> pimpl_;
+};
+
+} } // End namespaces iostreams, boost.
+
+#include <boost/config/abi_suffix.hpp> // pops abi_suffix.hpp pragmas
+
+#endif // #ifndef BOOST_IOSTREAMS_REACTOR_HPP_INCLUDED
@@ -374,6 +374,9 @@ struct is_filter : detail::has_trait<T, filter_tag> { };
 
 template<typename T>
 struct is_direct : detail::has_trait<T, direct_tag> { };
+
+template<typename T>
+struct is_segmented : detail::has_trait<T, segmented_tag> { };
                     
 //------------------Definition of BOOST_IOSTREAMS_STREAMBUF_TYPEDEFS----------//
 
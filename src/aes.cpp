@@ -0,0 +1,350 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// To configure Boost to work with OpenSSL, see the comments in
+// libs/iostreams/build/Jamfile.v2.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <climits>  // INT_MAX.
+#include <cstring>  // memcmp, memcpy.
+#include <new>      // bad_alloc.
+#include <boost/throw_exception.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/filter/aes.hpp>
+#include <openssl/crypto.h>  // OPENSSL_cleanse.
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+namespace boost { namespace iostreams {
+
+namespace aes {
+
+                    // Status codes
+
+const int okay                   = 0;
+const int bad_key                = 1;
+const int bad_iv                 = 2;
+const int bad_chunk_size         = 3;
+const int bad_header             = 4;
+const int bad_chunk              = 5;
+const int authentication_failed  = 6;
+const int unexpected_eof         = 7;
+const int trailing_data          = 8;
+const int library_error          = 9;
+
+} // End namespace aes.
+
+//------------------Implementation of aes_error-------------------------------//
+
+aes_error::aes_error(int error)
+    : BOOST_IOSTREAMS_FAILURE("aes error"), error_(error)
+    { }
+
+void aes_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(int error)
+{
+    if (error != aes::okay)
+        boost::throw_exception(aes_error(error));
+}
+
+bool aes_error::check BOOST_PREVENT_MACRO_SUBSTITUTION
+    (int error, boost::system::error_code& ec)
+{
+    if (error == aes::okay)
+        return true;
+    ec.assign(error, aes_category());
+    return false;
+}
+
+//------------------Implementation of aes_category----------------------------//
+
+namespace detail {
+
+class aes_category_impl : public boost::system::error_category {
+public:
+    const char* name() const BOOST_SYSTEM_NOEXCEPT { return "aes"; }
+    std::string message(int ev) const
+    {
+        switch (ev) {
+        case aes::bad_key:
+            return "aes key must have 16, 24 or 32 bytes";
+        case aes::bad_iv:
+            return "aes invalid nonce or initial counter block";
+        case aes::bad_chunk_size:
+            return "aes invalid chunk size";
+        case aes::bad_header:
+            return "aes invalid stream header";
+        case aes::bad_chunk:
+            return "aes invalid chunk length";
+        case aes::authentication_failed:
+            return "aes authentication failed";
+        case aes::unexpected_eof:
+            return "aes unexpected end of data";
+        case aes::trailing_data:
+            return "aes data following the last chunk";
+        case aes::library_error:
+            return "aes cryptographic library error";
+        default:
+            return "aes error";
+        }
+    }
+};
+
+} // End namespace detail.
+
+const boost::system::error_category& aes_category()
+{
+    static const detail::aes_category_impl instance;
+    return instance;
+}
+
+//------------------Implementation of aes_base--------------------------------//
+
+namespace detail {
+
+namespace {
+
+const char magic[] = "AGCM";
+const std::size_t magic_size = 4;
+
+const EVP_CIPHER* gcm_cipher(std::size_t key_size)
+{
+    return key_size == 16 ?
+        EVP_aes_128_gcm() :
+        key_size == 24 ? EVP_aes_192_gcm() : EVP_aes_256_gcm();
+}
+
+const EVP_CIPHER* ctr_cipher(std::size_t key_size)
+{
+    return key_size == 16 ?
+        EVP_aes_128_ctr() :
+        key_size == 24 ? EVP_aes_192_ctr() : EVP_aes_256_ctr();
+}
+
+const unsigned char* bytes(const char* s)
+{ return reinterpret_cast<const unsigned char*>(s); }
+
+unsigned char* bytes(char* s)
+{ return reinterpret_cast<unsigned char*>(s); }
+
+void check(int result)
+{
+    if (result != 1)
+        boost::throw_exception(aes_error(aes::library_error));
+}
+
+void store_le(char* p, boost::uint32_t value)
+{
+    for (int z = 0; z < 4; ++z, value >>= 8)
+        p[z] = static_cast<char>(value & 0xff);
+}
+
+boost::uint32_t load_le(const char* p)
+{
+    const unsigned char* q = bytes(p);
+    return q[0] | (q[1] << 8) | (q[2] << 16) |
+           (static_cast<boost::uint32_t>(q[3]) << 24);
+}
+
+} // End unnamed namespace.
+
+const std::size_t aes_base::header_size;
+const std::size_t aes_base::chunk_header_size;
+const std::size_t aes_base::chunk_overhead;
+
+aes_base::aes_base()
+    : ctx_(EVP_CIPHER_CTX_new()), chunk_size_(0), index_(0)
+{
+    if (!ctx_)
+        boost::throw_exception(std::bad_alloc());
+}
+
+aes_base::~aes_base()
+{ EVP_CIPHER_CTX_free(static_cast<EVP_CIPHER_CTX*>(ctx_)); }
+
+int aes_base::validate(const aes_params& p, usage u)
+{
+    std::size_t k = p.key.size();
+    if (k != 16 && k != 24 && k != 32)
+        return aes::bad_key;
+    switch (u) {
+    case gcm_seal:
+        if (!p.iv.empty() && p.iv.size() != aes::gcm_nonce_size)
+            return aes::bad_iv;
+        if (p.chunk_size == 0 || p.chunk_size > aes::max_chunk_size)
+            return aes::bad_chunk_size;
+        break;
+    case ctr_mode:
+        if (p.iv.size() != aes::ctr_iv_size)
+            return aes::bad_iv;
+        break;
+    default:
+        break;
+    }
+    return aes::okay;
+}
+
+void aes_base::init_ctr(const aes_params& p)
+{
+    check(
+        EVP_EncryptInit_ex( static_cast<EVP_CIPHER_CTX*>(ctx_),
+                            ctr_cipher(p.key.size()), 0,
+                            bytes(p.key.data()), bytes(p.iv.data()) )
+    );
+}
+
+void aes_base::init_seal(const aes_params& p, char* dest)
+{
+    std::memcpy(header_, magic, magic_size);
+    if (p.iv.empty())
+        check(RAND_bytes(bytes(header_ + magic_size), aes::gcm_nonce_size));
+    else
+        std::memcpy(header_ + magic_size, p.iv.data(), aes::gcm_nonce_size);
+    store_le( header_ + magic_size + aes::gcm_nonce_size,
+              static_cast<boost::uint32_t>(p.chunk_size) );
+    chunk_size_ = p.chunk_size;
+    index_ = 0;
+    check(
+        EVP_EncryptInit_ex( static_cast<EVP_CIPHER_CTX*>(ctx_),
+                            gcm_cipher(p.key.size()), 0,
+                            bytes(p.key.data()), 0 )
+    );
+    std::memcpy(dest, header_, header_size);
+}
+
+int aes_base::init_open(const aes_params& p, const char* header)
+{
+    std::size_t size = load_le(header + magic_size + aes::gcm_nonce_size);
+    if ( std::memcmp(header, magic, magic_size) != 0 ||
+         size == 0 || size > aes::max_chunk_size )
+    {
+        return aes::bad_header;
+    }
+    std::memcpy(header_, header, header_size);
+    chunk_size_ = size;
+    index_ = 0;
+    return EVP_DecryptInit_ex( static_cast<EVP_CIPHER_CTX*>(ctx_),
+                               gcm_cipher(p.key.size()), 0,
+                               bytes(p.key.data()), 0 ) == 1 ?
+        aes::okay :
+        aes::library_error;
+}
+
+int aes_base::ctr(const char* src, std::size_t n, char* dest)
+{
+    EVP_CIPHER_CTX* ctx = static_cast<EVP_CIPHER_CTX*>(ctx_);
+    while (n != 0) {
+        int amt = n < INT_MAX ? static_cast<int>(n) : INT_MAX;
+        int len;
+        if (EVP_EncryptUpdate(ctx, bytes(dest), &len, bytes(src), amt) != 1)
+            return aes::library_error;
+        src += amt;
+        dest += amt;
+        n -= amt;
+    }
+    return aes::okay;
+}
+
+// Sets the nonce for the next chunk and supplies the additional
+// authenticated data, consisting of the stream header, the chunk index and
+// the chunk header.
+void aes_base::start_chunk(bool encrypt)
+{
+    EVP_CIPHER_CTX*  ctx = static_cast<EVP_CIPHER_CTX*>(ctx_);
+    unsigned char    nonce[aes::gcm_nonce_size];
+    unsigned char    aad[header_size + 8 + chunk_header_size];
+    std::memcpy(nonce, header_ + magic_size, aes::gcm_nonce_size);
+    std::memcpy(aad, header_, header_size);
+    for (int z = 0; z < 8; ++z) {
+        unsigned char c = static_cast<unsigned char>(index_ >> (56 - 8 * z));
+        nonce[aes::gcm_nonce_size - 8 + z] ^= c;
+        aad[header_size + z] = c;
+    }
+    std::memcpy(aad + header_size + 8, chunk_header_, chunk_header_size);
+    int len;
+    check(
+        encrypt ?
+            EVP_EncryptInit_ex(ctx, 0, 0, 0, nonce) :
+            EVP_DecryptInit_ex(ctx, 0, 0, 0, nonce)
+    );
+    check(
+        encrypt ?
+            EVP_EncryptUpdate(ctx, 0, &len, aad, sizeof(aad)) :
+            EVP_DecryptUpdate(ctx, 0, &len, aad, sizeof(aad))
+    );
+}
+
+std::size_t aes_base::seal
+    (const char* src, std::size_t n, bool last, char* dest)
+{
+    EVP_CIPHER_CTX* ctx = static_cast<EVP_CIPHER_CTX*>(ctx_);
+    store_le( chunk_header_,
+              static_cast<boost::uint32_t>(n) | (last ? 0x80000000u : 0) );
+    std::memcpy(dest, chunk_header_, chunk_header_size);
+    start_chunk(true);
+    char* out = dest + chunk_header_size;
+    int   len;
+    check(
+        EVP_EncryptUpdate( ctx, bytes(out), &len, bytes(src),
+                           static_cast<int>(n) )
+    );
+    check(EVP_EncryptFinal_ex(ctx, bytes(out + len), &len));
+    check(
+        EVP_CIPHER_CTX_ctrl( ctx, EVP_CTRL_GCM_GET_TAG, aes::gcm_tag_size,
+                             out + n )
+    );
+    ++index_;
+    return n + chunk_overhead;
+}
+
+int aes_base::open_header(const char* header, std::size_t& n, bool& last)
+{
+    boost::uint32_t value = load_le(header);
+    last = (value & 0x80000000u) != 0;
+    n = value & 0x7fffffff;
+
+    // All chunks but the last are full
+    if (n > chunk_size_ || (!last && n != chunk_size_))
+        return aes::bad_chunk;
+    std::memcpy(chunk_header_, header, chunk_header_size);
+    return aes::okay;
+}
+
+int aes_base::open(const char* src, std::size_t n, char* dest)
+{
+    EVP_CIPHER_CTX* ctx = static_cast<EVP_CIPHER_CTX*>(ctx_);
+    int len;
+    try {
+        start_chunk(false);
+    } catch (const aes_error& e) {
+        return e.error();
+    }
+    if ( EVP_DecryptUpdate( ctx, bytes(dest), &len, bytes(src),
+                            static_cast<int>(n) ) != 1 ||
+         EVP_CIPHER_CTX_ctrl( ctx, EVP_CTRL_GCM_SET_TAG, aes::gcm_tag_size,
+                              const_cast<char*>(src + n) ) != 1 )
+    {
+        return aes::library_error;
+    }
+    if (EVP_DecryptFinal_ex(ctx, bytes(dest + len), &len) != 1) {
+
+        // Don't leave unauthenticated plaintext behind
+        OPENSSL_cleanse(dest, n);
+        return aes::authentication_failed;
+    }
+    ++index_;
+    return aes::okay;
+}
+
+} // End namespace detail.
+
+//----------------------------------------------------------------------------//
+
+} } // End namespaces iostreams, boost.
@@ -0,0 +1,190 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Implements blocked_error and block_pool. The worker threads of a
+// block_pool are started when the first block is submitted; a pool with a
+// single thread transforms each block as it is submitted, on the calling
+// thread.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <algorithm>  // max.
+#include <deque>
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/throw_exception.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/filter/blocked.hpp>
+
+namespace boost { namespace iostreams {
+
+//------------------Implementation of blocked_error---------------------------//
+
+blocked_error::blocked_error(int error)
+    : BOOST_IOSTREAMS_FAILURE("blocked container error"), error_(error)
+    { }
+
+void blocked_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(int error)
+{
+    if (error != blocked::okay)
+        boost::throw_exception(blocked_error(error));
+}
+
+//------------------Implementation of block_pool------------------------------//
+
+namespace detail {
+
+class block_pool_impl {
+public:
+    block_pool_impl(const block_transform& f, unsigned threads)
+        : transform_(f), threads_(threads), stop_(false)
+    {
+        if (threads_ == 0)
+            threads_ = (std::max)(boost::thread::hardware_concurrency(), 1u);
+    }
+    ~block_pool_impl()
+    {
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            stop_ = true;
+            work_.notify_all();
+        }
+        group_.join_all();
+    }
+    std::size_t limit() const { return 2 * threads_; }
+    std::size_t size() const
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        return jobs_.size();
+    }
+    bool ready() const
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        return !jobs_.empty() && jobs_.front()->done;
+    }
+    void submit(std::vector<char>& input);
+    void take(std::vector<char>& output);
+    void clear()
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        jobs_.clear();
+        todo_.clear();
+    }
+private:
+    struct job {
+        job() : done(false) { }
+        std::vector<char>     input;
+        std::vector<char>     output;
+        boost::exception_ptr  error;
+        bool                  done;
+    };
+    typedef boost::shared_ptr<job> job_ptr;
+    void run(job& j);
+    void work();
+
+    block_transform            transform_;
+    unsigned                   threads_;
+    mutable boost::mutex       mtx_;
+    boost::condition_variable  work_;   // Signalled when todo_ grows.
+    boost::condition_variable  done_;   // Signalled when a job finishes.
+    std::deque<job_ptr>        jobs_;   // Jobs not yet taken.
+    std::deque<job_ptr>        todo_;   // Jobs not yet started.
+    boost::thread_group        group_;
+    bool                       stop_;
+};
+
+void block_pool_impl::submit(std::vector<char>& input)
+{
+    job_ptr j(new job);
+    j->input.swap(input);
+    if (threads_ == 1) {
+        run(*j);
+        j->done = true;
+        jobs_.push_back(j);
+        return;
+    }
+    if (group_.size() == 0)
+        for (unsigned z = 0; z < threads_; ++z)
+            group_.create_thread(boost::bind(&block_pool_impl::work, this));
+    boost::mutex::scoped_lock lock(mtx_);
+    jobs_.push_back(j);
+    todo_.push_back(j);
+    work_.notify_one();
+}
+
+void block_pool_impl::take(std::vector<char>& output)
+{
+    job_ptr j;
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        BOOST_ASSERT(!jobs_.empty());
+        j = jobs_.front();
+        while (!j->done)
+            done_.wait(lock);
+        jobs_.pop_front();
+    }
+    if (j->error)
+        boost::rethrow_exception(j->error);
+    output.swap(j->output);
+}
+
+void block_pool_impl::run(job& j)
+{
+    try {
+        transform_(j.input, j.output);
+    } catch (...) {
+        j.error = boost::current_exception();
+    }
+    std::vector<char>().swap(j.input);
+}
+
+void block_pool_impl::work()
+{
+    for (;;) {
+        job_ptr j;
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            while (todo_.empty() && !stop_)
+                work_.wait(lock);
+            if (stop_)
+                return;
+            j = todo_.front();
+            todo_.pop_front();
+        }
+        run(*j);
+        boost::mutex::scoped_lock lock(mtx_);
+        j->done = true;
+        done_.notify_all();
+    }
+}
+
+block_pool::block_pool(const block_transform& f, unsigned threads)
+    : pimpl_(new block_pool_impl(f, threads))
+    { }
+
+std::size_t block_pool::limit() const { return pimpl_->limit(); }
+
+std::size_t block_pool::size() const { return pimpl_->size(); }
+
+bool block_pool::ready() const { return pimpl_->ready(); }
+
+void block_pool::submit(std::vector<char>& input) { pimpl_->submit(input); }
+
+void block_pool::take(std::vector<char>& output) { pimpl_->take(output); }
+
+void block_pool::clear() { pimpl_->clear(); }
+
+} // End namespace detail.
+
+} } // End namespaces iostreams, boost.
@@ -0,0 +1,345 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// To configure Boost to work with Brotli, see the comments in
+// libs/iostreams/build/Jamfile.v2.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <boost/throw_exception.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/probe.hpp>
+#include <boost/iostreams/filter/brotli.hpp>
+#include <brotli/decode.h>  // The reference implementation of Brotli.
+#include <brotli/encode.h>
+
+// Custom dictionaries were reintroduced in Brotli 1.1, along with the
+// header defining this macro.
+#ifdef SHARED_BROTLI_MAX_COMPOUND_DICTS
+# define BOOST_IOSTREAMS_BROTLI_HAS_DICTIONARIES
+#endif
+
+namespace boost { namespace iostreams {
+
+namespace brotli {
+
+                    // Compression modes
+
+const int generic                 = BROTLI_MODE_GENERIC;
+const int text                    = BROTLI_MODE_TEXT;
+const int font                    = BROTLI_MODE_FONT;
+
+                    // Status codes
+
+const int okay                    = 0;
+const int param_error             = 1;
+const int encoder_error           = 2;
+const int unexpected_eof          = 3;
+const int dictionary_unsupported  = 4;
+
+                    // Ranges of parameters
+
+const int min_quality             = BROTLI_MIN_QUALITY;
+const int max_quality             = BROTLI_MAX_QUALITY;
+const int min_window_bits         = BROTLI_MIN_WINDOW_BITS;
+const int max_window_bits         = BROTLI_MAX_WINDOW_BITS;
+const int max_large_window_bits   = BROTLI_LARGE_MAX_WINDOW_BITS;
+
+} // End namespace brotli.
+
+//------------------Implementation of brotli_error----------------------------//
+
+namespace {
+
+// Returns true if the given decoder error code indicates a failed allocation.
+bool is_alloc_error(int error)
+{
+    return error <= BROTLI_DECODER_ERROR_ALLOC_CONTEXT_MODES &&
+           error >= BROTLI_DECODER_ERROR_ALLOC_BLOCK_TYPE_TREES;
+}
+
+} // End unnamed namespace.
+
+brotli_error::brotli_error(int error)
+    : BOOST_IOSTREAMS_FAILURE("brotli error"), error_(error)
+    { }
+
+void brotli_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(int error)
+{
+    if (error == brotli::okay)
+        return;
+    if (is_alloc_error(error))
+        boost::throw_exception(std::bad_alloc());
+    boost::throw_exception(brotli_error(error));
+}
+
+bool brotli_error::check BOOST_PREVENT_MACRO_SUBSTITUTION
+    (int error, boost::system::error_code& ec)
+{
+    if (error == brotli::okay)
+        return true;
+    if (is_alloc_error(error)) {
+        ec = boost::system::errc::make_error_code(
+                 boost::system::errc::not_enough_memory
+             );
+    } else {
+        ec.assign(error, brotli_category());
+    }
+    return false;
+}
+
+//------------------Implementation of brotli_category-------------------------//
+
+namespace detail {
+
+class brotli_category_impl : public boost::system::error_category {
+public:
+    const char* name() const BOOST_SYSTEM_NOEXCEPT { return "brotli"; }
+    std::string message(int ev) const
+    {
+        switch (ev) {
+        case brotli::param_error: 
+            return "brotli parameter error";
+        case brotli::encoder_error: 
+            return "brotli encoder error";
+        case brotli::unexpected_eof: 
+            return "brotli unexpected end of data";
+        case brotli::dictionary_unsupported:
+            return "brotli custom dictionaries not supported";
+        default:
+            if (ev < 0) {
+                return std::string("brotli decoder error ") +
+                       BrotliDecoderErrorString(
+                           static_cast<BrotliDecoderErrorCode>(ev)
+                       );
+            }
+            return "brotli error";
+        }
+    }
+};
+
+} // End namespace detail.
+
+const boost::system::error_category& brotli_category()
+{
+    static const detail::brotli_category_impl instance;
+    return instance;
+}
+
+//------------------Implementation of brotli_base-----------------------------//
+
+namespace detail {
+
+brotli_base::brotli_base(const brotli_params& params)
+    : params_(params), state_(0), dictionary_(0), eof_(false)
+    { }
+
+brotli_base::~brotli_base()
+{
+#ifdef BOOST_IOSTREAMS_BROTLI_HAS_DICTIONARIES
+    if (dictionary_)
+        BrotliEncoderDestroyPreparedDictionary(
+            static_cast<BrotliEncoderPreparedDictionary*>(dictionary_)
+        );
+#endif
+}
+
+int brotli_base::compress
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, int op )
+{
+    BrotliEncoderState*  s = static_cast<BrotliEncoderState*>(state_);
+    std::size_t          avail_in =
+                             static_cast<std::size_t>(src_end - src_begin);
+    std::size_t          avail_out =
+                             static_cast<std::size_t>(dest_end - dest_begin);
+    const uint8_t*       next_in =
+                             reinterpret_cast<const uint8_t*>(src_begin);
+    uint8_t*             next_out = reinterpret_cast<uint8_t*>(dest_begin);
+    BrotliEncoderOperation operation =
+        op == op_finish ?
+            BROTLI_OPERATION_FINISH :
+            op == op_flush ?
+                BROTLI_OPERATION_FLUSH :
+                BROTLI_OPERATION_PROCESS;
+    BOOST_IOSTREAMS_PROBE4(
+        brotli_compress_start, this, avail_in, avail_out, op
+    );
+    BROTLI_BOOL result =
+        BrotliEncoderCompressStream( s, operation, &avail_in, &next_in,
+                                     &avail_out, &next_out, 0 );
+    BOOST_IOSTREAMS_PROBE4(
+        brotli_compress_done, this, avail_in, avail_out, result
+    );
+    src_begin = reinterpret_cast<const char*>(next_in);
+    dest_begin = reinterpret_cast<char*>(next_out);
+    return result ? brotli::okay : brotli::encoder_error;
+}
+
+int brotli_base::decompress
+    ( const char*& src_begin, const char* src_end,
+      char*& dest_begin, char* dest_end, bool flush )
+{
+    if (eof_)
+        return brotli::okay;
+    BrotliDecoderState*  s = static_cast<BrotliDecoderState*>(state_);
+    std::size_t          avail_in =
+                             static_cast<std::size_t>(src_end - src_begin);
+    std::size_t          avail_out =
+                             static_cast<std::size_t>(dest_end - dest_begin);
+    const uint8_t*       next_in =
+                             reinterpret_cast<const uint8_t*>(src_begin);
+    uint8_t*             next_out = reinterpret_cast<uint8_t*>(dest_begin);
+    BOOST_IOSTREAMS_PROBE3(
+        brotli_decompress_start, this, avail_in, avail_out
+    );
+    BrotliDecoderResult result =
+        BrotliDecoderDecompressStream( s, &avail_in, &next_in,
+                                       &avail_out, &next_out, 0 );
+    BOOST_IOSTREAMS_PROBE4(
+        brotli_decompress_done, this, avail_in, avail_out, result
+    );
+    src_begin = reinterpret_cast<const char*>(next_in);
+    dest_begin = reinterpret_cast<char*>(next_out);
+    switch (result) {
+    case BROTLI_DECODER_RESULT_SUCCESS:
+        eof_ = true;
+        return brotli::okay;
+    case BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT:
+
+        // When flush is true, no more input will arrive
+        return flush ? brotli::unexpected_eof : brotli::okay;
+    case BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT:
+        return brotli::okay;
+    default:
+        return BrotliDecoderGetErrorCode(s);
+    }
+}
+
+bool brotli_base::finished() const
+{
+    return BrotliEncoderIsFinished(static_cast<BrotliEncoderState*>(state_))
+               != BROTLI_FALSE;
+}
+
+bool brotli_base::output_pending() const
+{
+    return BrotliEncoderHasMoreOutput(
+               static_cast<BrotliEncoderState*>(state_)
+           ) != BROTLI_FALSE;
+}
+
+void brotli_base::end(bool compress)
+{
+    eof_ = false;
+    if (!state_)
+        return;
+    if (compress)
+        BrotliEncoderDestroyInstance(static_cast<BrotliEncoderState*>(state_));
+    else
+        BrotliDecoderDestroyInstance(static_cast<BrotliDecoderState*>(state_));
+    state_ = 0;
+}
+
+void brotli_base::do_init
+    ( bool compress, brotli::alloc_func alloc, brotli::free_func free,
+      void* derived )
+{
+    // Null pointers select Brotli's own memory management; the functions
+    // supplied for custom allocators report failure to Brotli by returning
+    // a null pointer rather than by throwing.
+    const brotli_params& p = params_;
+#ifndef BOOST_IOSTREAMS_BROTLI_HAS_DICTIONARIES
+    if (!p.dictionary.empty())
+        boost::throw_exception(brotli_error(brotli::dictionary_unsupported));
+#endif
+    if (compress) {
+        BrotliEncoderState* s =
+            BrotliEncoderCreateInstance(alloc, free, derived);
+        if (!s)
+            boost::throw_exception(std::bad_alloc());
+        state_ = s;
+        bool good =
+            BrotliEncoderSetParameter(
+                s, BROTLI_PARAM_QUALITY, static_cast<uint32_t>(p.quality) ) &&
+            BrotliEncoderSetParameter(
+                s, BROTLI_PARAM_LGWIN, static_cast<uint32_t>(p.window_bits) ) &&
+            BrotliEncoderSetParameter(
+                s, BROTLI_PARAM_MODE, static_cast<uint32_t>(p.mode) ) &&
+            BrotliEncoderSetParameter(
+                s, BROTLI_PARAM_LARGE_WINDOW, p.large_window ? 1 : 0 ) &&
+            ( p.size_hint == 0 ||
+              BrotliEncoderSetParameter(
+                  s, BROTLI_PARAM_SIZE_HINT,
+                  static_cast<uint32_t>(
+                      p.size_hint < (1u << 30) ? p.size_hint : (1u << 30)
+                  ) ) );
+        bool valid =
+            p.quality >= BROTLI_MIN_QUALITY &&
+            p.quality <= BROTLI_MAX_QUALITY &&
+            p.window_bits >= BROTLI_MIN_WINDOW_BITS &&
+            p.window_bits <= ( p.large_window ?
+                                   BROTLI_LARGE_MAX_WINDOW_BITS :
+                                   BROTLI_MAX_WINDOW_BITS );
+        if (!good || !valid) {
+            end(true);
+            boost::throw_exception(brotli_error(brotli::param_error));
+        }
+#ifdef BOOST_IOSTREAMS_BROTLI_HAS_DICTIONARIES
+        if (!p.dictionary.empty()) {
+            if (!dictionary_)
+                dictionary_ =
+                    BrotliEncoderPrepareDictionary(
+                        BROTLI_SHARED_DICTIONARY_RAW,
+                        p.dictionary.size(),
+                        reinterpret_cast<const uint8_t*>(p.dictionary.data()),
+                        BROTLI_MAX_QUALITY, alloc, free, derived
+                    );
+            if ( !dictionary_ ||
+                 !BrotliEncoderAttachPreparedDictionary(
+                      s,
+                      static_cast<BrotliEncoderPreparedDictionary*>(
+                          dictionary_
+                      ) ) )
+            {
+                end(true);
+                boost::throw_exception(brotli_error(brotli::param_error));
+            }
+        }
+#endif
+    } else {
+        BrotliDecoderState* s =
+            BrotliDecoderCreateInstance(alloc, free, derived);
+        if (!s)
+            boost::throw_exception(std::bad_alloc());
+        state_ = s;
+        bool good =
+            BrotliDecoderSetParameter(
+                s, BROTLI_DECODER_PARAM_LARGE_WINDOW, p.large_window ? 1 : 0
+            ) != BROTLI_FALSE;
+#ifdef BOOST_IOSTREAMS_BROTLI_HAS_DICTIONARIES
+        if (good && !p.dictionary.empty())
+            good = BrotliDecoderAttachDictionary(
+                       s, BROTLI_SHARED_DICTIONARY_RAW, p.dictionary.size(),
+                       reinterpret_cast<const uint8_t*>(p.dictionary.data())
+                   ) != BROTLI_FALSE;
+#endif
+        if (!good) {
+            end(false);
+            boost::throw_exception(brotli_error(brotli::param_error));
+        }
+    }
+}
+
+} // End namespace detail.
+
+//----------------------------------------------------------------------------//
+
+} } // End namespaces iostreams, boost.
@@ -16,6 +16,7 @@
 
 #include <boost/throw_exception.hpp>
 #include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/probe.hpp>
 #include <boost/iostreams/filter/bzip2.hpp> 
 #include "bzlib.h"  // Julian Seward's "bzip.h" header.
                     // To configure Boost to work with libbz2, see the 
@@ -72,6 +73,59 @@ void bzip2_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(int error)
     }
 }
 
+bool bzip2_error::check BOOST_PREVENT_MACRO_SUBSTITUTION
+    (int error, boost::system::error_code& ec)
+{
+    switch (error) {
+    case BZ_OK: 
+    case BZ_RUN_OK: 
+    case BZ_FLUSH_OK:
+    case BZ_FINISH_OK:
+    case BZ_STREAM_END:
+        return true;
+    case BZ_MEM_ERROR: 
+        ec = boost::system::errc::make_error_code(
+                 boost::system::errc::not_enough_memory
+             );
+        return false;
+    default:
+        ec.assign(error, bzip2_category());
+        return false;
+    }
+}
+
+//------------------Implementation of bzip2_category--------------------------//
+
+namespace detail {
+
+class bzip2_category_impl : public boost::system::error_category {
+public:
+    const char* name() const BOOST_SYSTEM_NOEXCEPT { return "bzip2"; }
+    std::string message(int ev) const
+    {
+        switch (ev) {
+        case BZ_SEQUENCE_ERROR:   return "bzip2 sequence error";
+        case BZ_PARAM_ERROR:      return "bzip2 parameter error";
+        case BZ_MEM_ERROR:        return "bzip2 out of memory";
+        case BZ_DATA_ERROR:       return "bzip2 data error";
+        case BZ_DATA_ERROR_MAGIC: return "bzip2 bad magic number";
+        case BZ_IO_ERROR:         return "bzip2 i/o error";
+        case BZ_UNEXPECTED_EOF:   return "bzip2 unexpected end of data";
+        case BZ_OUTBUFF_FULL:     return "bzip2 output buffer full";
+        case BZ_CONFIG_ERROR:     return "bzip2 configuration error";
+        default:                  return "bzip2 error";
+        }
+    }
+};
+
+} // End namespace detail.
+
+const boost::system::error_category& bzip2_category()
+{
+    static const detail::bzip2_category_impl instance;
+    return instance;
+}
+
 //------------------Implementation of bzip2_base------------------------------//
 
 namespace detail {
@@ -125,33 +179,50 @@ void bzip2_base::end(bool compress)
 
 int bzip2_base::compress(int action)
 {
-    return BZ2_bzCompress(static_cast<bz_stream*>(stream_), action);
+    bz_stream* s = static_cast<bz_stream*>(stream_);
+    BOOST_IOSTREAMS_PROBE4(
+        bzip2_compress_start, this, s->avail_in, s->avail_out, action
+    );
+    int result = BZ2_bzCompress(s, action);
+    BOOST_IOSTREAMS_PROBE4(
+        bzip2_compress_done, this, s->avail_in, s->avail_out, result
+    );
+    return result;
 }
 
 int bzip2_base::decompress()
 {
-    return BZ2_bzDecompress(static_cast<bz_stream*>(stream_));
+    bz_stream* s = static_cast<bz_stream*>(stream_);
+    BOOST_IOSTREAMS_PROBE3(
+        bzip2_decompress_start, this, s->avail_in, s->avail_out
+    );
+    int result = BZ2_bzDecompress(s);
+    BOOST_IOSTREAMS_PROBE4(
+        bzip2_decompress_done, this, s->avail_in, s->avail_out, result
+    );
+    return result;
 }
 
 void bzip2_base::do_init
     ( bool compress, 
       #if !BOOST_WORKAROUND(BOOST_MSVC, < 1300)
-          bzip2::alloc_func /* alloc */, 
-          bzip2::free_func /* free */, 
+          bzip2::alloc_func alloc, 
+          bzip2::free_func free, 
       #endif
       void* derived )
 {
     bz_stream* s = static_cast<bz_stream*>(stream_);
 
-    // Current interface for customizing memory management 
-    // is non-conforming and has been disabled:
-    //#if !BOOST_WORKAROUND(BOOST_MSVC, < 1300)
-    //    s->bzalloc = alloc;
-    //    s->bzfree = free;
-    //#else
+    // Null pointers select libbzip2's own memory management; the functions
+    // supplied for custom allocators report failure to libbzip2 by returning
+    // a null pointer rather than by throwing.
+    #if !BOOST_WORKAROUND(BOOST_MSVC, < 1300)
+        s->bzalloc = alloc;
+        s->bzfree = free;
+    #else
         s->bzalloc = 0;
         s->bzfree = 0;
-    //#endif
+    #endif
     s->opaque = derived;
     bzip2_error::check BOOST_PREVENT_MACRO_SUBSTITUTION( 
         compress ?
@@ -0,0 +1,34 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Implements compressed_block_error.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <boost/throw_exception.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/device/compressed_block.hpp>
+
+namespace boost { namespace iostreams {
+
+//------------------Implementation of compressed_block_error------------------//
+
+compressed_block_error::compressed_block_error(int error)
+    : BOOST_IOSTREAMS_FAILURE("compressed block container error"),
+      error_(error)
+    { }
+
+void compressed_block_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(int error)
+{
+    if (error != compressed_block::okay)
+        boost::throw_exception(compressed_block_error(error));
+}
+
+} } // End namespaces iostreams, boost.
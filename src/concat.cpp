@@ -0,0 +1,347 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Implements concat_source. A single background thread runs the generator,
+// reads each part in chunks, decompressing it if necessary, and appends the
+// chunks to a queue, which is bounded by the number of characters it holds;
+// read() removes chunks from the front of the queue.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <algorithm>  // min.
+#include <cstring>    // memcpy.
+#include <deque>
+#include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/throw_exception.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/device/concat.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace detail {
+
+concat_reader::~concat_reader() { }
+
+namespace {
+
+// Returns the next part of a fixed list of files.
+struct concat_path_generator {
+    explicit concat_path_generator(const std::vector<std::string>& paths)
+        : paths(paths), next(0)
+        { }
+    bool operator()(concat_part& p)
+    {
+        if (next == paths.size())
+            return false;
+        p.open(paths[next++]);
+        return true;
+    }
+    std::vector<std::string>  paths;
+    std::size_t               next;
+};
+
+// Source which reads the given characters, which have already been read
+// from a part to determine its format, followed by the rest of the part.
+struct concat_prefixed_source {
+    typedef char        char_type;
+    typedef source_tag  category;
+    concat_prefixed_source( const std::vector<char>& prefix,
+                            concat_reader& reader )
+        : prefix(&prefix), reader(&reader), pos(0)
+        { }
+    std::streamsize read(char* s, std::streamsize n)
+    {
+        if (pos < prefix->size()) {
+            std::streamsize amt = static_cast<std::streamsize>(
+                (std::min)(prefix->size() - pos, static_cast<std::size_t>(n))
+            );
+            std::memcpy(s, &(*prefix)[pos], static_cast<std::size_t>(amt));
+            pos += static_cast<std::size_t>(amt);
+            return amt;
+        }
+        return reader->read(s, n);
+    }
+    const std::vector<char>*  prefix;
+    concat_reader*            reader;
+    std::size_t               pos;
+};
+
+} // End unnamed namespace.
+
+class concat_source_impl {
+public:
+    concat_source_impl( const concat_source::generator& gen,
+                        const concat_params& p )
+        : gen_(gen), params_(p), buffered_(0), pos_(0), part_(0),
+          done_(false), closed_(false)
+    {
+        if (params_.chunk_size == 0)
+            params_.chunk_size = concat::default_chunk_size;
+        thread_ = boost::thread(boost::bind(&concat_source_impl::run, this));
+    }
+    ~concat_source_impl() { close(); }
+    std::streamsize read(char* s, std::streamsize n);
+    void close();
+    std::size_t part() const
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        return part_;
+    }
+    std::string part_name() const
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        return part_ < names_.size() ? names_[part_] : std::string();
+    }
+private:
+    struct chunk {
+        chunk() : part(0) { }
+        std::vector<char>  data;
+        std::size_t        part;
+    };
+    void run();
+    bool read_part(concat_part& p, std::size_t index);
+    bool push(chunk& c);
+
+    concat_source::generator   gen_;
+    concat_params              params_;
+    mutable boost::mutex       mtx_;
+    boost::condition_variable  not_empty_;
+    boost::condition_variable  not_full_;
+    std::deque<chunk>          queue_;
+    std::size_t                buffered_;  // Characters in queue_.
+    chunk                      current_;   // The chunk being read.
+    std::size_t                pos_;       // Position within current_.
+    std::size_t                part_;
+    std::vector<std::string>   names_;
+    boost::exception_ptr       error_;
+    bool                       done_;      // The thread has finished.
+    bool                       closed_;
+    boost::thread              thread_;
+};
+
+std::streamsize concat_source_impl::read(char* s, std::streamsize n)
+{
+    std::streamsize result = 0;
+    boost::mutex::scoped_lock lock(mtx_);
+    if (closed_)
+        return -1;
+    while (result < n) {
+        if (pos_ == current_.data.size()) {
+
+            // Wait only if no characters have been read
+            while (queue_.empty() && !done_ && !closed_ && result == 0)
+                not_empty_.wait(lock);
+            if (queue_.empty())
+                break;
+            current_.data.swap(queue_.front().data);
+            current_.part = queue_.front().part;
+            queue_.pop_front();
+            buffered_ -= current_.data.size();
+            pos_ = 0;
+            part_ = current_.part;
+            not_full_.notify_one();
+        }
+        std::size_t amt =
+            (std::min)( current_.data.size() - pos_,
+                        static_cast<std::size_t>(n - result) );
+        std::memcpy(s + result, &current_.data[pos_], amt);
+        pos_ += amt;
+        result += static_cast<std::streamsize>(amt);
+    }
+    if (result != 0)
+        return result;
+    if (error_) {
+        boost::exception_ptr error = error_;
+        error_ = boost::exception_ptr();
+        lock.unlock();
+        boost::rethrow_exception(error);
+    }
+    return -1;
+}
+
+void concat_source_impl::close()
+{
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        closed_ = true;
+        queue_.clear();
+        buffered_ = 0;
+        not_full_.notify_all();
+    }
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void concat_source_impl::run()
+{
+    try {
+        for (std::size_t index = 0; ; ++index) {
+            concat_part p;
+            if (!gen_(p))
+                break;
+            {
+                boost::mutex::scoped_lock lock(mtx_);
+                if (closed_)
+                    break;
+                names_.push_back(p.name_);
+            }
+            if (index != 0 && !params_.separator.empty()) {
+                chunk c;
+                c.data.assign( params_.separator.begin(),
+                               params_.separator.end() );
+                c.part = index;
+                if (!push(c))
+                    break;
+            }
+            if (!read_part(p, index))
+                break;
+        }
+    } catch (...) {
+        boost::mutex::scoped_lock lock(mtx_);
+        error_ = boost::current_exception();
+    }
+    boost::mutex::scoped_lock lock(mtx_);
+    done_ = true;
+    not_empty_.notify_all();
+}
+
+// Reads the given part; returns false if the source has been closed.
+bool concat_source_impl::read_part(concat_part& p, std::size_t index)
+{
+    concat_reader&  reader = *p.reader_;
+    std::size_t     size = params_.chunk_size;
+
+    // Read the first chunk, from which the format is determined
+    chunk first;
+    first.part = index;
+    first.data.resize(size);
+    std::size_t amt = 0;
+    while (amt < size) {
+        std::streamsize result =
+            reader.read( &first.data[amt],
+                         static_cast<std::streamsize>(size - amt) );
+        if (result == -1)
+            break;
+        amt += static_cast<std::size_t>(result);
+    }
+    first.data.resize(amt);
+    int compression = params_.compression;
+    if (compression == concat::automatic)
+        compression =
+            amt >= 2 &&
+            static_cast<unsigned char>(first.data[0]) == 0x1f &&
+            static_cast<unsigned char>(first.data[1]) == 0x8b ?
+                concat::gzip :
+                concat::none;
+
+    // Read the rest of the part, decompressing it if necessary
+    bool more = true;
+    if (compression == concat::none) {
+        if (amt < size)
+            more = false;
+        if (amt != 0 && !push(first))
+            return false;
+        while (more) {
+            chunk c;
+            c.part = index;
+            c.data.resize(size);
+            std::streamsize result =
+                reader.read(&c.data[0], static_cast<std::streamsize>(size));
+            if (result == -1)
+                break;
+            c.data.resize(static_cast<std::size_t>(result));
+            if (result != 0 && !push(c))
+                return false;
+        }
+    } else {
+        concat_prefixed_source                src(first.data, reader);
+        scoped_ptr<gzip_decompressor>         gz;
+        scoped_ptr<zlib_decompressor>         zl;
+        if (compression == concat::gzip)
+            gz.reset(new gzip_decompressor);
+        else
+            zl.reset(new zlib_decompressor);
+        while (more) {
+            chunk c;
+            c.part = index;
+            c.data.resize(size);
+            std::streamsize  n = static_cast<std::streamsize>(size);
+            std::streamsize  result = gz ?
+                gz->read(src, &c.data[0], n) :
+                zl->read(src, &c.data[0], n);
+            if (result == -1)
+                break;
+            c.data.resize(static_cast<std::size_t>(result));
+            if (result != 0 && !push(c))
+                return false;
+        }
+    }
+    reader.close();
+    return true;
+}
+
+// Appends c to the queue, waiting while the queue is full; returns false if
+// the source has been closed.
+bool concat_source_impl::push(chunk& c)
+{
+    boost::mutex::scoped_lock lock(mtx_);
+    while ( !closed_ && buffered_ != 0 &&
+            buffered_ + c.data.size() > params_.read_ahead )
+    {
+        not_full_.wait(lock);
+    }
+    if (closed_)
+        return false;
+    buffered_ += c.data.size();
+    queue_.push_back(chunk());
+    queue_.back().data.swap(c.data);
+    queue_.back().part = c.part;
+    not_empty_.notify_one();
+    return true;
+}
+
+} // End namespace detail.
+
+//------------------Implementation of concat_part-----------------------------//
+
+void concat_part::open(const std::string& path)
+{ open(file_descriptor_source(path, BOOST_IOS::in | BOOST_IOS::binary), path); }
+
+//------------------Implementation of concat_source---------------------------//
+
+concat_source::concat_source
+    (const std::vector<std::string>& paths, const concat_params& p)
+    : pimpl_(new detail::concat_source_impl(
+                 detail::concat_path_generator(paths), p
+             ))
+    { }
+
+concat_source::concat_source(const generator& gen, const concat_params& p)
+    : pimpl_(new detail::concat_source_impl(gen, p))
+    { }
+
+std::streamsize concat_source::read(char* s, std::streamsize n)
+{ return pimpl_->read(s, n); }
+
+void concat_source::close() { pimpl_->close(); }
+
+std::size_t concat_source::part() const { return pimpl_->part(); }
+
+std::string concat_source::part_name() const { return pimpl_->part_name(); }
+
+} } // End namespaces iostreams, boost.
@@ -0,0 +1,844 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Implements dfa_regex. A pattern is parsed into a syntax tree, from which
+// a Thompson NFA is built; the NFA, and the NFA recognizing the reversed
+// language, are then converted to DFAs by the subset construction, over
+// classes of characters which no part of the pattern distinguishes.
+//
+// Three DFAs are used: one matching the pattern at a given position, one
+// matching it at any position, for searches, and one run backwards over
+// the text to find the positions at which matches begin, from which
+// find_all() extends each leftmost match as far as possible.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <algorithm>  // sort, unique.
+#include <bitset>
+#include <map>
+#include <utility>    // pair.
+#include <boost/throw_exception.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/filter/dfa_regex.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace detail {
+
+namespace {
+
+typedef std::bitset<256> char_set;
+
+// The limits on the number of NFA states and on repetition counts.
+const std::size_t max_nfa_states = 100000;
+const int max_repeat = 1000;
+
+void fail(const std::string& msg)
+{
+    boost::throw_exception(dfa_regex_error("dfa_regex: " + msg));
+}
+
+                    // Syntax trees
+
+struct ast_node {
+    enum kind_type { k_empty, k_set, k_concat, k_alt, k_repeat };
+    explicit ast_node(kind_type kind)
+        : kind(kind), set(-1), min(0), max(0)
+        { }
+    kind_type         kind;
+    int               set;       // Index of the characters, for k_set.
+    std::vector<int>  children;
+    int               min, max;  // Repetition counts; max is -1 if
+                                 // unbounded.
+};
+
+class parser {
+public:
+    parser( const std::string& pattern, int options,
+            std::vector<ast_node>& nodes, std::vector<char_set>& sets )
+        : pattern_(pattern), pos_(0), icase_((options & dfa::icase) != 0),
+          alternation_(false), nodes_(nodes), sets_(sets)
+        { }
+
+    // Returns the root of the syntax tree.
+    int parse()
+    {
+        int root = parse_alt(true);
+        if (pos_ != pattern_.size())
+            fail("unmatched ')'");
+        return root;
+    }
+
+    // Returns true if the pattern has alternatives outside any group.
+    bool alternation() const { return alternation_; }
+private:
+    bool more() const { return pos_ < pattern_.size(); }
+    char peek() const { return pattern_[pos_]; }
+
+    int add(const ast_node& n)
+    {
+        nodes_.push_back(n);
+        return static_cast<int>(nodes_.size() - 1);
+    }
+
+    int add_set(char_set s)
+    {
+        if (icase_)
+            fold_case(s);
+        ast_node n(ast_node::k_set);
+        sets_.push_back(s);
+        n.set = static_cast<int>(sets_.size() - 1);
+        return add(n);
+    }
+
+    int parse_alt(bool top = false)
+    {
+        int first = parse_concat();
+        if (!more() || peek() != '|')
+            return first;
+        alternation_ = top;
+        ast_node n(ast_node::k_alt);
+        n.children.push_back(first);
+        while (more() && peek() == '|') {
+            ++pos_;
+            n.children.push_back(parse_concat());
+        }
+        return add(n);
+    }
+
+    int parse_concat()
+    {
+        ast_node n(ast_node::k_concat);
+        while (more() && peek() != '|' && peek() != ')')
+            n.children.push_back(parse_repeat());
+        if (n.children.empty())
+            return add(ast_node(ast_node::k_empty));
+        return n.children.size() == 1 ? n.children[0] : add(n);
+    }
+
+    int parse_repeat()
+    {
+        int atom = parse_atom();
+        while (more()) {
+            int min, max;
+            char c = peek();
+            if (c == '*') {
+                min = 0; max = -1; ++pos_;
+            } else if (c == '+') {
+                min = 1; max = -1; ++pos_;
+            } else if (c == '?') {
+                min = 0; max = 1; ++pos_;
+            } else if (c != '{' || !parse_bounds(min, max)) {
+                break;
+            }
+            if (more() && (peek() == '?' || peek() == '+'))
+                fail("lazy and possessive quantifiers are not supported");
+            ast_node n(ast_node::k_repeat);
+            n.children.push_back(atom);
+            n.min = min;
+            n.max = max;
+            atom = add(n);
+        }
+        return atom;
+    }
+
+    // Parses {m}, {m,} or {m,n}; if the brace doesn't begin a valid
+    // quantifier, returns false and leaves it to be parsed as a literal.
+    bool parse_bounds(int& min, int& max)
+    {
+        std::string::size_type p = pos_ + 1;
+        if (!read_int(p, min))
+            return false;
+        max = min;
+        if (p < pattern_.size() && pattern_[p] == ',') {
+            ++p;
+            max = -1;
+            if (p < pattern_.size() && pattern_[p] != '}' && !read_int(p, max))
+                return false;
+        }
+        if (p >= pattern_.size() || pattern_[p] != '}')
+            return false;
+        if (min > max_repeat || max > max_repeat || (max != -1 && max < min))
+            fail("invalid repetition count");
+        pos_ = p + 1;
+        return true;
+    }
+
+    bool read_int(std::string::size_type& p, int& value)
+    {
+        std::string::size_type start = p;
+        value = 0;
+        while ( p < pattern_.size() && pattern_[p] >= '0' &&
+                pattern_[p] <= '9' && p - start < 6 )
+        {
+            value = 10 * value + (pattern_[p++] - '0');
+        }
+        return p != start;
+    }
+
+    int parse_atom()
+    {
+        char c = pattern_[pos_++];
+        switch (c) {
+        case '(':
+            {
+                if (more() && peek() == '?') {
+                    if ( pos_ + 1 < pattern_.size() &&
+                         pattern_[pos_ + 1] == ':' )
+                    {
+                        pos_ += 2;
+                    } else {
+                        fail("unsupported group construct");
+                    }
+                }
+                int inner = parse_alt();
+                if (!more() || peek() != ')')
+                    fail("unmatched '('");
+                ++pos_;
+                return inner;
+            }
+        case '[':
+            return add_set(parse_bracket());
+        case '.':
+            {
+                char_set s;
+                s.set();
+                s.reset('\n');
+                return add_set(s);
+            }
+        case '\\':
+            {
+                char_set s;
+                parse_escape(s, false);
+                return add_set(s);
+            }
+        case '*': case '+': case '?':
+            fail("quantifier without operand");
+        case '^': case '$':
+            fail( "'^' and '$' are supported only at the beginning and end "
+                  "of the pattern" );
+        default:
+            {
+                char_set s;
+                s.set(static_cast<unsigned char>(c));
+                return add_set(s);
+            }
+        }
+        return -1; // Not reached.
+    }
+
+    // Parses the escape sequence following a backslash, adding the
+    // characters it stands for to s; returns false if it is a class
+    // escape, such as \d, rather than a single character.
+    bool parse_escape(char_set& s, bool in_bracket)
+    {
+        if (!more())
+            fail("trailing backslash");
+        char c = pattern_[pos_++];
+        switch (c) {
+        case 'd': add_class(s, "digit", false); return false;
+        case 'D': add_class(s, "digit", true); return false;
+        case 'w': add_class(s, "word", false); return false;
+        case 'W': add_class(s, "word", true); return false;
+        case 's': add_class(s, "space", false); return false;
+        case 'S': add_class(s, "space", true); return false;
+        case 'n': s.set('\n'); return true;
+        case 't': s.set('\t'); return true;
+        case 'r': s.set('\r'); return true;
+        case 'f': s.set('\f'); return true;
+        case 'v': s.set('\v'); return true;
+        case 'e': s.set(0x1b); return true;
+        case 'a': s.set(0x07); return true;
+        case '0': s.set(0); return true;
+        case 'x':
+            {
+                int value = 0, digits = 0;
+                while (more() && digits < 2 && hex_value(peek()) >= 0) {
+                    value = 16 * value + hex_value(peek());
+                    ++pos_;
+                    ++digits;
+                }
+                if (digits == 0)
+                    fail("invalid hexadecimal escape");
+                s.set(value);
+                return true;
+            }
+        case 'b':
+            if (in_bracket) {
+                s.set('\b');
+                return true;
+            }
+            fail("word boundaries are not supported");
+        default:
+            if ( (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                 (c >= '1' && c <= '9') )
+            {
+                fail(std::string("unsupported escape \\") + c);
+            }
+            s.set(static_cast<unsigned char>(c));
+            return true;
+        }
+        return true; // Not reached.
+    }
+
+    char_set parse_bracket()
+    {
+        char_set  s;
+        bool      negate = false;
+        if (more() && peek() == '^') {
+            negate = true;
+            ++pos_;
+        }
+        bool first = true;
+        while (true) {
+            if (!more())
+                fail("unmatched '['");
+            char c = peek();
+            if (c == ']' && !first) {
+                ++pos_;
+                break;
+            }
+            first = false;
+
+            // Named classes
+            if (c == '[' && pos_ + 1 < pattern_.size() &&
+                pattern_[pos_ + 1] == ':')
+            {
+                std::string::size_type end = pattern_.find(":]", pos_ + 2);
+                if (end == std::string::npos)
+                    fail("unterminated character class name");
+                add_class(s, pattern_.substr(pos_ + 2, end - pos_ - 2), false);
+                pos_ = end + 2;
+                continue;
+            }
+
+            // Single characters and ranges
+            int lo;
+            if (!bracket_char(s, lo))
+                continue;
+            if ( pos_ + 1 < pattern_.size() && peek() == '-' &&
+                 pattern_[pos_ + 1] != ']' )
+            {
+                ++pos_;
+                int hi;
+                if (!bracket_char(s, hi))
+                    fail("invalid range");
+                if (hi < lo)
+                    fail("invalid range");
+                for (int z = lo; z <= hi; ++z)
+                    s.set(z);
+            } else {
+                s.set(lo);
+            }
+        }
+        if (icase_)
+            fold_case(s);
+        if (negate)
+            s.flip();
+        return s;
+    }
+
+    static void fold_case(char_set& s)
+    {
+        for (int c = 'a'; c <= 'z'; ++c)
+            if (s.test(c) || s.test(c - 'a' + 'A'))
+                s.set(c).set(c - 'a' + 'A');
+    }
+
+    // Reads a character within a bracket expression; returns false if it
+    // was a class escape, whose characters have been added to s.
+    bool bracket_char(char_set& s, int& value)
+    {
+        char c = pattern_[pos_++];
+        if (c != '\\') {
+            value = static_cast<unsigned char>(c);
+            return true;
+        }
+        char_set single;
+        if (!parse_escape(single, true)) {
+            s |= single;
+            return false;
+        }
+        for (value = 0; !single.test(value); ++value) ;
+        return true;
+    }
+
+    static int hex_value(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    // Adds the characters of the named ASCII class, or its complement, to s
+    static void add_class(char_set& s, const std::string& name, bool negate)
+    {
+        char_set c;
+        for (int z = 0; z < 128; ++z) {
+            bool upper = z >= 'A' && z <= 'Z',
+                 lower = z >= 'a' && z <= 'z',
+                 digit = z >= '0' && z <= '9',
+                 space = z == ' ' || (z >= '\t' && z <= '\r'),
+                 print = z >= ' ' && z < 127,
+                 member;
+            if (name == "alpha")
+                member = upper || lower;
+            else if (name == "digit")
+                member = digit;
+            else if (name == "alnum")
+                member = upper || lower || digit;
+            else if (name == "word")
+                member = upper || lower || digit || z == '_';
+            else if (name == "space")
+                member = space;
+            else if (name == "blank")
+                member = z == ' ' || z == '\t';
+            else if (name == "upper")
+                member = upper;
+            else if (name == "lower")
+                member = lower;
+            else if (name == "xdigit")
+                member = digit || (z >= 'a' && z <= 'f') ||
+                         (z >= 'A' && z <= 'F');
+            else if (name == "punct")
+                member = print && z != ' ' && !upper && !lower && !digit;
+            else if (name == "print")
+                member = print;
+            else if (name == "graph")
+                member = print && z != ' ';
+            else if (name == "cntrl")
+                member = z < ' ' || z == 127;
+            else
+                fail("unknown character class " + name);
+            c.set(z, member);
+        }
+        if (negate)
+            c.flip();
+        s |= c;
+    }
+
+    const std::string&      pattern_;
+    std::string::size_type  pos_;
+    bool                    icase_;
+    bool                    alternation_;
+    std::vector<ast_node>&  nodes_;
+    std::vector<char_set>&  sets_;
+};
+
+                    // NFAs
+
+struct nfa {
+    struct state {
+        std::vector<int>                   eps;
+        std::vector< std::pair<int, int> > trans;  // (set, target).
+    };
+
+    int add_state()
+    {
+        if (states.size() == max_nfa_states)
+            fail("pattern too complex");
+        states.push_back(state());
+        return static_cast<int>(states.size() - 1);
+    }
+
+    // Adds states recognizing the language of the given node between the
+    // states from and to.
+    void build(const std::vector<ast_node>& nodes, int node, int from, int to)
+    {
+        const ast_node& n = nodes[node];
+        switch (n.kind) {
+        case ast_node::k_empty:
+            states[from].eps.push_back(to);
+            break;
+        case ast_node::k_set:
+            states[from].trans.push_back(std::make_pair(n.set, to));
+            break;
+        case ast_node::k_concat:
+            for (std::size_t z = 0; z < n.children.size(); ++z) {
+                int next = z + 1 == n.children.size() ? to : add_state();
+                build(nodes, n.children[z], from, next);
+                from = next;
+            }
+            break;
+        case ast_node::k_alt:
+            for (std::size_t z = 0; z < n.children.size(); ++z)
+                build(nodes, n.children[z], from, to);
+            break;
+        case ast_node::k_repeat:
+            {
+                int child = n.children[0];
+                for (int z = 0; z < n.min; ++z) {
+                    int next = add_state();
+                    build(nodes, child, from, next);
+                    from = next;
+                }
+                if (n.max == -1) {
+                    int in = add_state(), out = add_state();
+                    states[from].eps.push_back(in);
+                    build(nodes, child, in, out);
+                    states[out].eps.push_back(in);
+                    states[out].eps.push_back(to);
+                    states[from].eps.push_back(to);
+                } else {
+                    for (int z = n.min; z < n.max; ++z) {
+                        int next = add_state();
+                        states[from].eps.push_back(to);
+                        build(nodes, child, from, next);
+                        from = next;
+                    }
+                    states[from].eps.push_back(to);
+                }
+            }
+            break;
+        }
+    }
+
+    // Returns the NFA recognizing the reversed language.
+    nfa reverse() const
+    {
+        nfa result;
+        result.states.resize(states.size());
+        for (std::size_t s = 0; s < states.size(); ++s) {
+            for (std::size_t z = 0; z < states[s].eps.size(); ++z)
+                result.states[states[s].eps[z]].eps.push_back(
+                    static_cast<int>(s)
+                );
+            for (std::size_t z = 0; z < states[s].trans.size(); ++z)
+                result.states[states[s].trans[z].second].trans.push_back(
+                    std::make_pair( states[s].trans[z].first,
+                                    static_cast<int>(s) )
+                );
+        }
+        result.start = accept;
+        result.accept = start;
+        return result;
+    }
+
+    std::vector<state>  states;
+    int                 start, accept;
+};
+
+} // End unnamed namespace.
+
+                    // DFAs
+
+struct dfa_automaton {
+    int step(int s, unsigned char c, const unsigned char* classes) const
+    { return next[s * nclasses + classes[c]]; }
+    std::vector<int>   next;       // Transitions; -1 is the dead state.
+    std::vector<char>  accepting;
+    int                nclasses;
+};
+
+class dfa_regex_impl {
+public:
+    dfa_regex_impl( const std::string& pattern, int options,
+                    std::size_t max_states );
+    bool search(const char* first, const char* last, int flags) const;
+    bool match(const char* first, const char* last, int flags) const;
+    void find_all( const char* first, const char* last,
+                   std::vector<dfa_match>& matches, int flags ) const;
+private:
+    void make_classes();
+    void make_dfa(const nfa& a, bool unanchored, dfa_automaton& d);
+    void closure(const nfa& a, std::vector<int>& set);
+
+    // Returns the end of the longest match beginning at first, or 0.
+    const char* longest(const char* first, const char* last) const;
+
+    std::vector<char_set>  sets_;
+    unsigned char          classes_[256];
+    std::vector<int>       representatives_;
+    std::size_t            max_states_;
+    std::vector<char>      seen_;      // Used by closure().
+    bool                   bol_, eol_;
+    dfa_automaton          forward_;   // Matches at a given position.
+    dfa_automaton          search_;    // Matches at any position.
+    dfa_automaton          reverse_;   // Finds the beginnings of matches.
+};
+
+dfa_regex_impl::dfa_regex_impl
+    (const std::string& pattern, int options, std::size_t max_states)
+    : max_states_(max_states), bol_(false), eol_(false)
+{
+    // Strip the anchors
+    std::string::size_type first = 0, last = pattern.size();
+    if (last != first && pattern[first] == '^') {
+        bol_ = true;
+        ++first;
+    }
+    if (last != first && pattern[last - 1] == '$') {
+        std::string::size_type backslashes = 0;
+        while ( last - 1 - backslashes > first &&
+                pattern[last - 2 - backslashes] == '\\' )
+        {
+            ++backslashes;
+        }
+        if (backslashes % 2 == 0) {
+            eol_ = true;
+            --last;
+        }
+    }
+
+    std::vector<ast_node>  nodes;
+    std::string            body = pattern.substr(first, last - first);
+    parser                 p(body, options, nodes, sets_);
+    int                    root = p.parse();
+    if ((bol_ || eol_) && p.alternation())
+        fail("anchors may not apply to only some alternatives");
+
+    nfa a;
+    a.start = a.add_state();
+    a.accept = a.add_state();
+    a.build(nodes, root, a.start, a.accept);
+    make_classes();
+    make_dfa(a, false, forward_);
+    if (!bol_) {
+        make_dfa(a, true, search_);
+        make_dfa(a.reverse(), !eol_, reverse_);
+    }
+}
+
+bool dfa_regex_impl::search
+    (const char* first, const char* last, int flags) const
+{
+    if ( (bol_ && (flags & dfa::match_not_bol)) ||
+         (eol_ && (flags & dfa::match_not_eol)) )
+    {
+        return false;
+    }
+    const dfa_automaton&  d = bol_ ? forward_ : search_;
+    const unsigned char*  p = reinterpret_cast<const unsigned char*>(first);
+    const unsigned char*  end = reinterpret_cast<const unsigned char*>(last);
+    int                   s = 0;
+    if (!eol_ && d.accepting[s])
+        return true;
+    for (; p != end; ++p) {
+        s = d.step(s, *p, classes_);
+        if (s < 0)
+            return false;
+        if (!eol_ && d.accepting[s])
+            return true;
+    }
+    return d.accepting[s] != 0;
+}
+
+bool dfa_regex_impl::match
+    (const char* first, const char* last, int flags) const
+{
+    if ( (bol_ && (flags & dfa::match_not_bol)) ||
+         (eol_ && (flags & dfa::match_not_eol)) )
+    {
+        return false;
+    }
+    const unsigned char*  p = reinterpret_cast<const unsigned char*>(first);
+    const unsigned char*  end = reinterpret_cast<const unsigned char*>(last);
+    int                   s = 0;
+    for (; p != end; ++p)
+        if ((s = forward_.step(s, *p, classes_)) < 0)
+            return false;
+    return forward_.accepting[s] != 0;
+}
+
+void dfa_regex_impl::find_all
+    ( const char* first, const char* last,
+      std::vector<dfa_match>& matches, int flags ) const
+{
+    if ( (bol_ && (flags & dfa::match_not_bol)) ||
+         (eol_ && (flags & dfa::match_not_eol)) )
+    {
+        return;
+    }
+    if (bol_) {
+        if (const char* end = longest(first, last))
+            matches.push_back(dfa_match(first, end));
+        return;
+    }
+
+    // Mark the positions at which matches begin
+    std::size_t        n = static_cast<std::size_t>(last - first);
+    std::vector<char>  starts(n + 1, 0);
+    int                s = 0;
+    starts[n] = reverse_.accepting[s];
+    for (std::size_t z = n; z-- != 0; ) {
+        s = reverse_.step(s, static_cast<unsigned char>(first[z]), classes_);
+        if (s < 0)
+            break;
+        starts[z] = reverse_.accepting[s];
+    }
+
+    // Extend each leftmost match
+    for (std::size_t z = 0; z <= n; ++z) {
+        if (!starts[z])
+            continue;
+        const char* end = eol_ ? last : longest(first + z, last);
+        matches.push_back(dfa_match(first + z, end));
+        if (end == first + z)
+            continue;
+        z = static_cast<std::size_t>(end - first) - 1;
+    }
+}
+
+const char* dfa_regex_impl::longest(const char* first, const char* last) const
+{
+    const char*  result = 0;
+    int          s = 0;
+    if (forward_.accepting[s] && (!eol_ || first == last))
+        result = first;
+    for (const char* p = first; p != last; ) {
+        s = forward_.step(s, static_cast<unsigned char>(*p++), classes_);
+        if (s < 0)
+            break;
+        if (forward_.accepting[s] && (!eol_ || p == last))
+            result = p;
+    }
+    return result;
+}
+
+// Partitions the characters into classes, such that each set used by the
+// pattern is a union of classes.
+void dfa_regex_impl::make_classes()
+{
+    std::vector<int> classes(256, 0);
+    int count = 1;
+    for (std::size_t z = 0; z < sets_.size(); ++z) {
+        std::map<std::pair<int, bool>, int> refined;
+        for (int c = 0; c < 256; ++c) {
+            std::pair<int, bool> key(classes[c], sets_[z].test(c));
+            std::map<std::pair<int, bool>, int>::iterator it =
+                refined.find(key);
+            if (it == refined.end())
+                it = refined.insert(
+                         std::make_pair(key, static_cast<int>(refined.size()))
+                     ).first;
+            classes[c] = it->second;
+        }
+        count = static_cast<int>(refined.size());
+    }
+    representatives_.assign(count, -1);
+    for (int c = 0; c < 256; ++c) {
+        classes_[c] = static_cast<unsigned char>(classes[c]);
+        if (representatives_[classes[c]] == -1)
+            representatives_[classes[c]] = c;
+    }
+}
+
+// Builds the DFA equivalent to the given NFA; if unanchored is true, the
+// DFA recognizes the texts which end with a match.
+void dfa_regex_impl::make_dfa
+    (const nfa& a, bool unanchored, dfa_automaton& d)
+{
+    typedef std::map<std::vector<int>, int> map_type;
+    map_type                        ids;
+    std::vector< std::vector<int> > subsets(1, std::vector<int>(1, a.start));
+    closure(a, subsets[0]);
+    ids[subsets[0]] = 0;
+    d.nclasses = static_cast<int>(representatives_.size());
+    d.next.clear();
+    d.accepting.clear();
+    for (std::size_t i = 0; i < subsets.size(); ++i) {
+        std::vector<int> current = subsets[i];
+        d.accepting.push_back(
+            std::binary_search(current.begin(), current.end(), a.accept)
+        );
+        for (int c = 0; c < d.nclasses; ++c) {
+            std::vector<int> target;
+            for (std::size_t j = 0; j < current.size(); ++j) {
+                const nfa::state& st = a.states[current[j]];
+                for (std::size_t k = 0; k < st.trans.size(); ++k)
+                    if (sets_[st.trans[k].first].test(representatives_[c]))
+                        target.push_back(st.trans[k].second);
+            }
+            if (unanchored)
+                target.push_back(a.start);
+            if (target.empty()) {
+                d.next.push_back(-1);
+                continue;
+            }
+            closure(a, target);
+            map_type::iterator it = ids.find(target);
+            if (it == ids.end()) {
+                if (subsets.size() == max_states_)
+                    fail("pattern requires too many states");
+                it = ids.insert(
+                         std::make_pair(
+                             target, static_cast<int>(subsets.size())
+                         )
+                     ).first;
+                subsets.push_back(target);
+            }
+            d.next.push_back(it->second);
+        }
+    }
+}
+
+// Replaces the given set of states by its epsilon-closure, sorted.
+void dfa_regex_impl::closure(const nfa& a, std::vector<int>& set)
+{
+    std::vector<char>&  seen = seen_;
+    std::vector<int>    stack;
+    seen.resize(a.states.size());
+    for (std::size_t z = 0; z < set.size(); ++z)
+        if (!seen[set[z]]) {
+            seen[set[z]] = 1;
+            stack.push_back(set[z]);
+        }
+    set.clear();
+    while (!stack.empty()) {
+        int s = stack.back();
+        stack.pop_back();
+        set.push_back(s);
+        const std::vector<int>& eps = a.states[s].eps;
+        for (std::size_t z = 0; z < eps.size(); ++z)
+            if (!seen[eps[z]]) {
+                seen[eps[z]] = 1;
+                stack.push_back(eps[z]);
+            }
+    }
+    std::sort(set.begin(), set.end());
+    for (std::size_t z = 0; z < set.size(); ++z)
+        seen[set[z]] = 0;
+}
+
+} // End namespace detail.
+
+//------------------Implementation of dfa_regex-------------------------------//
+
+dfa_regex::dfa_regex
+    (const std::string& pattern, int options, std::size_t max_states)
+{ init(pattern, options, max_states); }
+
+dfa_regex::dfa_regex(const char* pattern, int options, std::size_t max_states)
+{ init(pattern, options, max_states); }
+
+bool dfa_regex::search(const char* first, const char* last, int flags) const
+{ return pimpl_->search(first, last, flags); }
+
+bool dfa_regex::match(const char* first, const char* last, int flags) const
+{ return pimpl_->match(first, last, flags); }
+
+void dfa_regex::find_all
+    ( const char* first, const char* last,
+      std::vector<dfa_match>& matches, int flags ) const
+{ pimpl_->find_all(first, last, matches, flags); }
+
+void dfa_regex::init
+    (const std::string& pattern, int options, std::size_t max_states)
+{
+    pimpl_.reset(
+        new detail::dfa_regex_impl(pattern, options, max_states)
+    );
+}
+
+} } // End namespaces iostreams, boost.
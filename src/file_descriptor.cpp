@@ -18,9 +18,11 @@
 #include <boost/iostreams/detail/config/dyn_link.hpp>
 #include <boost/iostreams/detail/config/rtl.hpp>  // BOOST_IOSTREAMS_FD_XXX
 #include <boost/iostreams/detail/config/windows_posix.hpp>
+#include <boost/iostreams/detail/probe.hpp>
 #include <boost/iostreams/detail/system_failure.hpp>
 #include <boost/iostreams/detail/ios.hpp>         // openmodes, failure.
 #include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/error_code.hpp>
 #include <boost/integer_traits.hpp>
 #include <boost/throw_exception.hpp>
 
@@ -65,11 +67,21 @@ struct file_descriptor_impl {
     void open(const detail::path&, BOOST_IOS::openmode);
     bool is_open() const;
     void close();
-    void close_impl(bool close_flag, bool throw_);
+    void close(boost::system::error_code& ec);
+    bool close_impl(bool close_flag, bool throw_);
     std::streamsize read(char* s, std::streamsize n);
+    std::streamsize read(char* s, std::streamsize n, boost::system::error_code& ec);
     std::streamsize write(const char* s, std::streamsize n);
+    std::streamsize write( const char* s, std::streamsize n, 
+                           boost::system::error_code& ec );
     std::streampos seek(stream_offset off, BOOST_IOS::seekdir way);
+    std::streampos seek( stream_offset off, BOOST_IOS::seekdir way,
+                         boost::system::error_code& ec );
     static file_handle invalid_handle();
+#ifndef BOOST_IOSTREAMS_WINDOWS
+    static bool would_block();
+#endif
+    static void set_system_error(boost::system::error_code& ec);
     file_handle  handle_;
     int          flags_;
 };
@@ -241,10 +253,17 @@ void file_descriptor_impl::close()
     close_impl(flags_ & close_on_close, true);
 }
 
-void file_descriptor_impl::close_impl(bool close_flag, bool throw_) {
+void file_descriptor_impl::close(boost::system::error_code& ec)
+{
+    if (!close_impl(flags_ & close_on_close, false))
+        set_system_error(ec);
+}
+
+bool file_descriptor_impl::close_impl(bool close_flag, bool throw_) {
+    bool success = true;
     if (handle_ != invalid_handle()) {
         if (close_flag) {
-            bool success = 
+            success = 
                 #ifdef BOOST_IOSTREAMS_WINDOWS
                     ::CloseHandle(handle_) == 1;
                 #else
@@ -256,10 +275,22 @@ void file_descriptor_impl::close_impl(bool close_flag, bool throw_) {
         handle_ = invalid_handle();
         flags_ = 0;
     }
+    return success;
 }
 
 std::streamsize file_descriptor_impl::read(char* s, std::streamsize n)
 {
+    boost::system::error_code ec;
+    std::streamsize result = read(s, n, ec);
+    if (ec)
+        throw_system_failure("failed reading");
+    return result;
+}
+
+std::streamsize file_descriptor_impl::read
+    (char* s, std::streamsize n, boost::system::error_code& ec)
+{
+    BOOST_IOSTREAMS_PROBE3(fd_read_start, this, handle_, n);
 #ifdef BOOST_IOSTREAMS_WINDOWS
     DWORD result;
     if (!::ReadFile(handle_, s, n, &result, NULL))
@@ -270,35 +301,76 @@ std::streamsize file_descriptor_impl::read(char* s, std::streamsize n)
             result = 0;
         }
         else
-            throw_system_failure("failed reading");
+        {
+            set_system_error(ec);
+            return -1;
+        }
     }
+    BOOST_IOSTREAMS_PROBE3(fd_read_done, this, handle_, result);
     return result == 0 ? -1 : static_cast<std::streamsize>(result);
 #else // #ifdef BOOST_IOSTREAMS_WINDOWS
     errno = 0;
     std::streamsize result = BOOST_IOSTREAMS_FD_READ(handle_, s, n);
-    if (errno != 0)
-        throw_system_failure("failed reading");
+    if (errno != 0) {
+        if (would_block()) { // Non-blocking descriptor with no data.
+            BOOST_IOSTREAMS_PROBE3(fd_read_done, this, handle_, 0);
+            return 0;
+        }
+        set_system_error(ec);
+        return -1;
+    }
+    BOOST_IOSTREAMS_PROBE3(fd_read_done, this, handle_, result);
     return result == 0 ? -1 : result;
 #endif // #ifdef BOOST_IOSTREAMS_WINDOWS
 }
 
 std::streamsize file_descriptor_impl::write(const char* s, std::streamsize n)
 {
-#ifdef BOOST_IOSTREAMS_WINDOWS
-    DWORD ignore;
-    if (!::WriteFile(handle_, s, n, &ignore, NULL))
+    boost::system::error_code ec;
+    std::streamsize result = write(s, n, ec);
+    if (ec) // A short count means that a non-blocking fd would block.
         throw_system_failure("failed writing");
-    return n;
+    return result;
+}
+
+std::streamsize file_descriptor_impl::write
+    (const char* s, std::streamsize n, boost::system::error_code& ec)
+{
+    BOOST_IOSTREAMS_PROBE3(fd_write_start, this, handle_, n);
+#ifdef BOOST_IOSTREAMS_WINDOWS
+    DWORD result;
+    if (!::WriteFile(handle_, s, n, &result, NULL)) {
+        set_system_error(ec);
+        return 0;
+    }
+    BOOST_IOSTREAMS_PROBE3(fd_write_done, this, handle_, result);
+    return static_cast<std::streamsize>(result);
 #else // #ifdef BOOST_IOSTREAMS_WINDOWS
-    int amt = BOOST_IOSTREAMS_FD_WRITE(handle_, s, n);
-    if (amt < n) // Handles blocking fd's only.
-        throw_system_failure("failed writing");
-    return n;
+    std::streamsize amt = BOOST_IOSTREAMS_FD_WRITE(handle_, s, n);
+    if (amt == -1) {
+        if (!would_block())
+            set_system_error(ec);
+        return 0;
+    }
+    BOOST_IOSTREAMS_PROBE3(fd_write_done, this, handle_, amt);
+    return amt;
 #endif // #ifdef BOOST_IOSTREAMS_WINDOWS
 }
 
 std::streampos file_descriptor_impl::seek
     (stream_offset off, BOOST_IOS::seekdir way)
+{
+    boost::system::error_code ec;
+    std::streampos result = seek(off, way, ec);
+    if (ec == errors::bad_seek)
+        boost::throw_exception(BOOST_IOSTREAMS_FAILURE("bad offset"));
+    else if (ec)
+        boost::throw_exception(system_failure("failed seeking"));
+    return result;
+}
+
+std::streampos file_descriptor_impl::seek
+    (stream_offset off, BOOST_IOS::seekdir way, boost::system::error_code& ec)
 {
 #ifdef BOOST_IOSTREAMS_WINDOWS
     LONG lDistanceToMove = static_cast<LONG>(off & 0xffffffff);
@@ -315,7 +387,8 @@ std::streampos file_descriptor_impl::seek
     if ( dwResultLow == INVALID_SET_FILE_POINTER &&
          ::GetLastError() != NO_ERROR )
     {
-        boost::throw_exception(system_failure("failed seeking"));
+        set_system_error(ec);
+        return offset_to_position(-1);
     } else {
        return offset_to_position(
                   (stream_offset(lDistanceToMoveHigh) << 32) + dwResultLow
@@ -325,7 +398,8 @@ std::streampos file_descriptor_impl::seek
     if ( off > integer_traits<BOOST_IOSTREAMS_FD_OFFSET>::const_max ||
          off < integer_traits<BOOST_IOSTREAMS_FD_OFFSET>::const_min )
     {
-        boost::throw_exception(BOOST_IOSTREAMS_FAILURE("bad offset"));
+        ec = errors::bad_seek;
+        return offset_to_position(-1);
     }
     stream_offset result =
         BOOST_IOSTREAMS_FD_SEEK(
@@ -338,7 +412,7 @@ std::streampos file_descriptor_impl::seek
                       SEEK_END ) 
         );
     if (result == -1)
-        boost::throw_exception(system_failure("failed seeking"));
+        set_system_error(ec);
     return offset_to_position(result);
 #endif // #ifdef BOOST_IOSTREAMS_WINDOWS
 }
@@ -353,6 +427,27 @@ file_handle file_descriptor_impl::invalid_handle()
 #endif
 }
 
+#ifndef BOOST_IOSTREAMS_WINDOWS
+
+// Returns true if the most recent failed system call failed only because
+// the descriptor is in non-blocking mode and the operation would block
+bool file_descriptor_impl::would_block()
+{
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+#endif
+
+// Stores the error code of the most recent failed system call in ec
+void file_descriptor_impl::set_system_error(boost::system::error_code& ec)
+{
+#ifdef BOOST_IOSTREAMS_WINDOWS
+    ec.assign(::GetLastError(), boost::system::system_category());
+#else
+    ec.assign(errno, boost::system::system_category());
+#endif
+}
+
 } // End namespace detail.
 
 //------------------Implementation of file_descriptor-------------------------//
@@ -437,6 +532,33 @@ std::streamsize file_descriptor::read(char_type* s, std::streamsize n)
 std::streamsize file_descriptor::write(const char_type* s, std::streamsize n)
 { return pimpl_->write(s, n); }
 
+void file_descriptor::close(boost::system::error_code& ec)
+{ 
+    ec.clear();
+    pimpl_->close(ec); 
+}
+
+std::streamsize file_descriptor::read
+    (char_type* s, std::streamsize n, boost::system::error_code& ec)
+{ 
+    ec.clear();
+    return pimpl_->read(s, n, ec); 
+}
+
+std::streamsize file_descriptor::write
+    (const char_type* s, std::streamsize n, boost::system::error_code& ec)
+{ 
+    ec.clear();
+    return pimpl_->write(s, n, ec); 
+}
+
+std::streampos file_descriptor::seek
+    (stream_offset off, BOOST_IOS::seekdir way, boost::system::error_code& ec)
+{ 
+    ec.clear();
+    return pimpl_->seek(off, way, ec); 
+}
+
 std::streampos file_descriptor::seek(stream_offset off, BOOST_IOS::seekdir way)
 { return pimpl_->seek(off, way); }
 
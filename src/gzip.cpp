@@ -25,22 +25,28 @@ namespace boost { namespace iostreams {
 namespace detail {
 
 void gzip_header::process(char c)
+{
+    if (int error = try_process(c))
+        boost::throw_exception(gzip_error(error));
+}
+
+int gzip_header::try_process(char c)
 {
     uint8_t value = static_cast<uint8_t>(c);
     switch (state_) {
     case s_id1:
         if (value != gzip::magic::id1)
-            boost::throw_exception(gzip_error(gzip::bad_header));
+            return gzip::bad_header;
         state_ = s_id2;
         break;
     case s_id2:
         if (value != gzip::magic::id2)
-            boost::throw_exception(gzip_error(gzip::bad_header));
+            return gzip::bad_header;
         state_ = s_cm;
         break;
     case s_cm:
         if (value != gzip::method::deflate)
-            boost::throw_exception(gzip_error(gzip::bad_method));
+            return gzip::bad_method;
         state_ = s_flg;
         break;
     case s_flg:
@@ -126,6 +132,7 @@ void gzip_header::process(char c)
     default:
         BOOST_ASSERT(0);
     }
+    return 0;
 }
 
 void gzip_header::reset()
@@ -169,6 +176,31 @@ void gzip_footer::reset()
     state_ = s_crc;
 }
 
+//------------------Implementation of gzip_category---------------------------//
+
+class gzip_category_impl : public boost::system::error_category {
+public:
+    const char* name() const BOOST_SYSTEM_NOEXCEPT { return "gzip"; }
+    std::string message(int ev) const
+    {
+        switch (ev) {
+        case gzip::zlib_error:  return "gzip zlib error";
+        case gzip::bad_crc:     return "gzip crc mismatch";
+        case gzip::bad_length:  return "gzip length mismatch";
+        case gzip::bad_header:  return "malformed gzip header";
+        case gzip::bad_footer:  return "malformed gzip footer";
+        case gzip::bad_method:  return "unsupported gzip compression method";
+        default:                return "gzip error";
+        }
+    }
+};
+
 } // End namespace boost::iostreams::detail.
 
+const boost::system::error_category& gzip_category()
+{
+    static const detail::gzip_category_impl instance;
+    return instance;
+}
+
 } } // End namespaces iostreams, boost.
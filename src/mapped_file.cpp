@@ -14,6 +14,7 @@
 #include <boost/iostreams/detail/config/rtl.hpp>
 #include <boost/iostreams/detail/config/windows_posix.hpp>
 #include <boost/iostreams/detail/file_handle.hpp>
+#include <boost/iostreams/detail/probe.hpp>
 #include <boost/iostreams/detail/system_failure.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/throw_exception.hpp>
@@ -342,6 +343,10 @@ void mapped_file_impl::try_map_file(param_type p)
 
 void mapped_file_impl::map_file(param_type& p)
 {
+    BOOST_IOSTREAMS_PROBE4(
+        map_file_start, this, handle_, 
+        static_cast<long long>(p.offset), static_cast<long long>(size_)
+    );
     try {
         try_map_file(p);
     } catch (const std::exception&) {
@@ -352,6 +357,9 @@ void mapped_file_impl::map_file(param_type& p)
             throw;
         }
     }
+    BOOST_IOSTREAMS_PROBE3(
+        map_file_done, this, data_, static_cast<long long>(size_)
+    );
 }
 
 bool mapped_file_impl::unmap_file()
@@ -0,0 +1,734 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Implements parallel_gzip_state. Deflate data is decoded by a small inflater
+// defined below, rather than by zlib, since chunks must be decoded from
+// arbitrary bit positions and without a window. Its output consists of
+// 16-bit values: values less than 256 are characters, while the value
+// 256 + j stands for the character at offset j within the (unknown) 32K
+// window preceding the chunk.
+//
+// Decompression proceeds in rounds. In each round, the compressed data
+// following the current block boundary is divided into one chunk per thread.
+// The first chunk is decoded on the calling thread, from the boundary; each
+// of the others is decoded on its own thread from the first bit position in
+// the chunk at which a non-final dynamic or stored block begins, if any.
+// Every chunk is decoded up to the end of the first block ending at or
+// beyond the end of the chunk. The results are then examined in order: a
+// chunk is accepted if it begins exactly where the last accepted chunk
+// ended, and the next round begins at the end of the last accepted chunk.
+// Fixed-Huffman blocks are not used as starting points, since their headers
+// are too easily matched by accident.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <algorithm>  // copy, fill, max, min.
+#include <cstring>    // memcpy.
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/throw_exception.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/filter/parallel_gzip.hpp>
+#include "zlib_backend.hpp"
+
+namespace boost { namespace iostreams { namespace detail {
+
+namespace {
+
+//------------------Inflater--------------------------------------------------//
+
+const std::size_t window_size = 32768;
+
+// The number of characters following the last chunk of a round which are
+// initially made available to the inflater, so that the block containing the
+// end of the chunk can usually be decoded.
+const std::size_t min_slack = 64 * 1024;
+
+// Thrown by the inflater; never escapes this file.
+struct decode_error {
+    enum code { invalid, truncated };
+    explicit decode_error(code c) : value(c) { }
+    code value;
+};
+
+// Reads bits, least significant first, from a buffer.
+class bit_reader {
+public:
+    bit_reader(const unsigned char* data, std::size_t size, std::size_t bit)
+        : data_(data), size_(size), next_(bit / 8), buf_(0), count_(0)
+    {
+        unsigned skip = static_cast<unsigned>(bit % 8);
+        if (skip != 0) {
+            need(skip);
+            drop(skip);
+        }
+    }
+    std::size_t position() const { return next_ * 8 - count_; }
+    void fill()
+    {
+        while (count_ <= 56 && next_ < size_) {
+            buf_ |= static_cast<boost::uint64_t>(data_[next_++]) << count_;
+            count_ += 8;
+        }
+    }
+    void need(unsigned n)
+    {
+        if (count_ < n) {
+            fill();
+            if (count_ < n)
+                throw decode_error(decode_error::truncated);
+        }
+    }
+    unsigned available() { fill(); return count_; }
+    unsigned peek(unsigned n) const
+    { return static_cast<unsigned>(buf_ & ((1u << n) - 1)); }
+    void drop(unsigned n) { buf_ >>= n; count_ -= n; }
+    unsigned bits(unsigned n)
+    {
+        if (n == 0)
+            return 0;
+        need(n);
+        unsigned result = peek(n);
+        drop(n);
+        return result;
+    }
+    void align() { drop(count_ % 8); }
+
+    // Copies n characters from a byte boundary
+    template<typename OutIt>
+    void copy(std::size_t n, OutIt out)
+    {
+        std::size_t pos = position() / 8;
+        if (n > size_ - pos)
+            throw decode_error(decode_error::truncated);
+        std::copy(data_ + pos, data_ + pos + n, out);
+        next_ = pos + n;
+        buf_ = 0;
+        count_ = 0;
+    }
+private:
+    const unsigned char*  data_;
+    std::size_t           size_;
+    std::size_t           next_;
+    boost::uint64_t       buf_;
+    unsigned              count_;
+};
+
+// A Huffman decoding table indexed by the next max_bits bits of input; each
+// entry holds a symbol and its code length, or zero for unused codes.
+class huffman {
+public:
+    enum kind { codes, lengths, distances };
+    huffman() : max_bits_(0) { }
+
+    // Returns false if the code lengths do not describe a valid code
+    bool build(const unsigned char* lens, unsigned n, kind k)
+    {
+        unsigned count[16] = { 0 };
+        for (unsigned z = 0; z < n; ++z)
+            ++count[lens[z]];
+        max_bits_ = 15;
+        while (max_bits_ > 0 && count[max_bits_] == 0)
+            --max_bits_;
+        if (max_bits_ == 0) {
+            if (k == codes)
+                return false;
+            table_.assign(2, 0);
+            max_bits_ = 1;
+            return true;
+        }
+        int left = 1;
+        for (unsigned len = 1; len <= 15; ++len) {
+            left <<= 1;
+            left -= static_cast<int>(count[len]);
+            if (left < 0)
+                return false;
+        }
+        if (left > 0 && (k == codes || max_bits_ != 1))
+            return false;
+        unsigned next[16];
+        unsigned code = 0;
+        count[0] = 0;
+        for (unsigned len = 1; len <= 15; ++len) {
+            code = (code + count[len - 1]) << 1;
+            next[len] = code;
+        }
+        table_.assign(std::size_t(1) << max_bits_, 0);
+        for (unsigned sym = 0; sym < n; ++sym) {
+            unsigned len = lens[sym];
+            if (len == 0)
+                continue;
+            unsigned c = next[len]++, rev = 0;
+            for (unsigned z = 0; z < len; ++z)
+                rev |= ((c >> z) & 1) << (len - 1 - z);
+            boost::uint16_t entry =
+                static_cast<boost::uint16_t>((sym << 4) | len);
+            for (std::size_t i = rev; i < table_.size(); i += 1u << len)
+                table_[i] = entry;
+        }
+        return true;
+    }
+    unsigned decode(bit_reader& in) const
+    {
+        unsigned avail = in.available();
+        unsigned entry =
+            table_[in.peek((std::min)(avail, max_bits_))];
+        unsigned len = entry & 15;
+        if (len == 0 || len > avail)
+            throw decode_error( len == 0 && avail >= max_bits_ ?
+                                    decode_error::invalid :
+                                    decode_error::truncated );
+        in.drop(len);
+        return entry >> 4;
+    }
+private:
+    std::vector<boost::uint16_t>  table_;
+    unsigned                      max_bits_;
+};
+
+const unsigned short length_base[29] =
+    { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51,
+      59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const unsigned char length_extra[29] =
+    { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4,
+      4, 5, 5, 5, 5, 0 };
+const unsigned short dist_base[30] =
+    { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385,
+      513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385,
+      24577 };
+const unsigned char dist_extra[30] =
+    { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10,
+      10, 11, 11, 12, 12, 13, 13 };
+const unsigned char code_order[19] =
+    { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// The tables used by blocks compressed with fixed Huffman codes; constructed
+// before main(), so that they may be shared by all threads.
+struct fixed_tables {
+    fixed_tables()
+    {
+        unsigned char lens[288];
+        std::fill(lens, lens + 144, 8);
+        std::fill(lens + 144, lens + 256, 9);
+        std::fill(lens + 256, lens + 280, 7);
+        std::fill(lens + 280, lens + 288, 8);
+        literals.build(lens, 288, huffman::lengths);
+        std::fill(lens, lens + 32, 5);
+        distances.build(lens, 32, huffman::distances);
+    }
+    huffman literals;
+    huffman distances;
+};
+const fixed_tables fixed = fixed_tables();
+
+typedef std::vector<boost::uint16_t> inflate_buffer;
+
+class inflater {
+public:
+    // Reads the header of a dynamic block, following the block type; returns
+    // false if it is invalid
+    bool read_dynamic(bit_reader& in)
+    {
+        unsigned nlen = in.bits(5) + 257;
+        unsigned ndist = in.bits(5) + 1;
+        unsigned ncode = in.bits(4) + 4;
+        if (nlen > 286 || ndist > 30)
+            return false;
+        unsigned char lens[320] = { 0 };
+        for (unsigned z = 0; z < ncode; ++z)
+            lens[code_order[z]] = static_cast<unsigned char>(in.bits(3));
+        if (!codes_.build(lens, 19, huffman::codes))
+            return false;
+        std::fill(lens, lens + 19, 0);
+        for (unsigned z = 0; z < nlen + ndist; ) {
+            unsigned sym = codes_.decode(in), value = 0, repeat;
+            if (sym < 16) {
+                lens[z++] = static_cast<unsigned char>(sym);
+                continue;
+            } else if (sym == 16) {
+                if (z == 0)
+                    return false;
+                value = lens[z - 1];
+                repeat = 3 + in.bits(2);
+            } else if (sym == 17) {
+                repeat = 3 + in.bits(3);
+            } else {
+                repeat = 11 + in.bits(7);
+            }
+            if (z + repeat > nlen + ndist)
+                return false;
+            while (repeat-- != 0)
+                lens[z++] = static_cast<unsigned char>(value);
+        }
+        return lens[256] != 0 &&
+               literals_.build(lens, nlen, huffman::lengths) &&
+               distances_.build(lens + nlen, ndist, huffman::distances);
+    }
+
+    // Decodes blocks, appending to out, until the final block or the first
+    // block ending at or beyond the bit position stop; returns true if the
+    // final block was decoded
+    bool inflate(bit_reader& in, std::size_t stop, inflate_buffer& out)
+    {
+        for (;;) {
+            unsigned header = in.bits(3);
+            switch (header >> 1) {
+            case 0:
+                stored(in, out);
+                break;
+            case 1:
+                codes(in, fixed.literals, fixed.distances, out);
+                break;
+            case 2:
+                if (!read_dynamic(in))
+                    throw decode_error(decode_error::invalid);
+                codes(in, literals_, distances_, out);
+                break;
+            default:
+                throw decode_error(decode_error::invalid);
+            }
+            if (header & 1)
+                return true;
+            if (in.position() >= stop)
+                return false;
+        }
+    }
+
+    // Returns true if a stored block, following the block type, has a valid
+    // header; leaves the reader positioned at its data
+    static bool read_stored(bit_reader& in)
+    {
+        unsigned pad = in.available() % 8;
+        if (in.bits(pad) != 0)
+            return false;
+        unsigned len = in.bits(16);
+        return len == (~in.bits(16) & 0xFFFF);
+    }
+private:
+    void stored(bit_reader& in, inflate_buffer& out)
+    {
+        in.align();
+        unsigned len = in.bits(16);
+        if (len != (~in.bits(16) & 0xFFFF))
+            throw decode_error(decode_error::invalid);
+        std::size_t size = out.size();
+        out.resize(size + len);
+        in.copy(len, out.begin() + size);
+    }
+
+    void codes( bit_reader& in, const huffman& literals,
+                const huffman& distances, inflate_buffer& out )
+    {
+        for (;;) {
+            unsigned sym = literals.decode(in);
+            if (sym < 256) {
+                out.push_back(static_cast<boost::uint16_t>(sym));
+                continue;
+            }
+            if (sym == 256)
+                return;
+            sym -= 257;
+            if (sym >= 29)
+                throw decode_error(decode_error::invalid);
+            std::size_t len = length_base[sym] + in.bits(length_extra[sym]);
+            unsigned code = distances.decode(in);
+            if (code >= 30)
+                throw decode_error(decode_error::invalid);
+            std::size_t dist = dist_base[code] + in.bits(dist_extra[code]);
+            std::size_t size = out.size();
+            if (dist > size)
+                throw decode_error(decode_error::invalid);
+            out.resize(size + len);
+            boost::uint16_t* p = &out[size];
+            for (std::size_t z = 0; z < len; ++z)
+                p[z] = p[z - dist];
+        }
+    }
+
+    huffman codes_;
+    huffman literals_;
+    huffman distances_;
+};
+
+//------------------Chunks----------------------------------------------------//
+
+struct chunk {
+    chunk() : ok(false), truncated(false), final(false), start(0), end(0) { }
+    bool            ok;
+    bool            truncated;
+    bool            final;
+    std::size_t     start;    // Bit position of first block.
+    std::size_t     end;      // Bit position following last block.
+    std::size_t     prefix;   // Number of values preceding the output.
+    inflate_buffer  output;
+};
+
+// Decodes the chunk beginning at the given block boundary, following the
+// given window
+void decode_exact( const std::vector<unsigned char>& in, std::size_t start,
+                   std::size_t stop, const std::vector<char>& window,
+                   chunk& c )
+{
+    c.start = start;
+    c.prefix = window.size();
+    c.output.resize(c.prefix);
+    for (std::size_t z = 0; z < c.prefix; ++z)
+        c.output[z] = static_cast<unsigned char>(window[z]);
+    try {
+        bit_reader  rd(&in[0], in.size(), start);
+        inflater    inf;
+        c.final = inf.inflate(rd, stop, c.output);
+        c.end = rd.position();
+        c.ok = true;
+    } catch (const decode_error& e) {
+        c.truncated = e.value == decode_error::truncated;
+    }
+}
+
+// Decodes the chunk beginning at the first apparent block boundary in the
+// range of bit positions [first, stop)
+void decode_speculative( const std::vector<unsigned char>* in,
+                         std::size_t first, std::size_t stop, chunk* c )
+{
+    const std::vector<unsigned char>& data = *in;
+    inflater inf;
+    for (std::size_t bit = first; bit < stop; ++bit) {
+        try {
+            bit_reader rd(&data[0], data.size(), bit);
+            unsigned header = rd.bits(3);
+            if (header == 4) {
+                if (!inf.read_dynamic(rd))
+                    continue;
+            } else if (header != 0 || !inflater::read_stored(rd)) {
+                continue;
+            }
+        } catch (const decode_error&) {
+            return;
+        }
+        c->start = bit;
+        c->prefix = window_size;
+        c->output.resize(window_size);
+        for (std::size_t z = 0; z < window_size; ++z)
+            c->output[z] = static_cast<boost::uint16_t>(256 + z);
+        try {
+            bit_reader rd(&data[0], data.size(), bit);
+            c->final = inf.inflate(rd, stop, c->output);
+            c->end = rd.position();
+            c->ok = true;
+            return;
+        } catch (const decode_error& e) {
+            if (e.value == decode_error::truncated)
+                return;
+        }
+    }
+}
+
+void throw_data_error()
+{
+    boost::throw_exception(gzip_error(zlib_error(zlib::data_error)));
+}
+
+boost::uint32_t get_u32(const unsigned char* p)
+{
+    return static_cast<boost::uint32_t>(p[0]) |
+           (static_cast<boost::uint32_t>(p[1]) << 8) |
+           (static_cast<boost::uint32_t>(p[2]) << 16) |
+           (static_cast<boost::uint32_t>(p[3]) << 24);
+}
+
+} // End unnamed namespace.
+
+//------------------Implementation of parallel_gzip_impl---------------------//
+
+class parallel_gzip_impl {
+public:
+    explicit parallel_gzip_impl(const parallel_gzip_params& p)
+        : chunk_size_(p.chunk_size ? p.chunk_size :
+                                     parallel_gzip::default_chunk_size),
+          threads_(p.threads)
+    {
+        if (threads_ == 0)
+            threads_ = (std::max)(boost::thread::hardware_concurrency(), 1u);
+        reset();
+    }
+    std::size_t wanted() const { return want_; }
+    void feed(const char* s, std::size_t n)
+    { input_.insert(input_.end(), s, s + n); }
+    void finish() { eof_ = true; }
+    std::streamsize read(char* s, std::streamsize n);
+    void reset()
+    {
+        std::vector<unsigned char>().swap(input_);
+        std::vector<char>().swap(output_);
+        window_.clear();
+        state_ = s_header;
+        eof_ = false;
+        members_ = 0;
+        pos_ = 0;
+        offset_ = 0;
+        crc_ = 0;
+        isize_ = 0;
+        slack_ = min_slack;
+        want_ = chunk_size_;
+    }
+private:
+    enum state { s_header, s_body, s_footer, s_done };
+    bool step();
+    bool read_header();
+    bool read_body();
+    bool read_footer();
+    void accept(const chunk& c);
+    bool more(std::size_t n);
+    void discard(std::size_t n);
+
+    std::size_t                 chunk_size_;
+    unsigned                    threads_;
+    std::vector<unsigned char>  input_;
+    std::vector<char>           output_;
+    std::size_t                 offset_;   // Characters of output_ read.
+    std::vector<char>           window_;   // Last 32K of member.
+    state                       state_;
+    bool                        eof_;
+    int                         members_;
+    std::size_t                 pos_;      // Bit position in input_.
+    boost::uint32_t             crc_;
+    boost::uint32_t             isize_;
+    std::size_t                 slack_;
+    std::size_t                 want_;
+};
+
+std::streamsize parallel_gzip_impl::read(char* s, std::streamsize n)
+{
+    for (;;) {
+        if (offset_ < output_.size()) {
+            std::size_t amt =
+                (std::min)( static_cast<std::size_t>(n),
+                            output_.size() - offset_ );
+            std::memcpy(s, &output_[offset_], amt);
+            offset_ += amt;
+            if (offset_ == output_.size()) {
+                output_.clear();
+                offset_ = 0;
+            }
+            return static_cast<std::streamsize>(amt);
+        }
+        if (state_ == s_done)
+            return -1;
+        if (!step())
+            return 0;
+    }
+}
+
+bool parallel_gzip_impl::step()
+{
+    switch (state_) {
+    case s_header: return read_header();
+    case s_body:   return read_body();
+    default:       return read_footer();
+    }
+}
+
+// Returns true if at least n characters are available; otherwise, requests
+// the missing characters
+bool parallel_gzip_impl::more(std::size_t n)
+{
+    if (input_.size() >= n)
+        return true;
+    want_ = (std::max)(n - input_.size(), min_slack);
+    return false;
+}
+
+void parallel_gzip_impl::discard(std::size_t n)
+{
+    input_.erase(input_.begin(), input_.begin() + n);
+}
+
+bool parallel_gzip_impl::read_header()
+{
+    using namespace gzip;
+    if (input_.empty() && eof_) {
+        state_ = s_done;
+        return true;
+    }
+    std::size_t z = 0;
+    const unsigned char* p = input_.empty() ? 0 : &input_[0];
+    const std::size_t n = input_.size();
+    bool complete = false;
+    do {
+        if (n < 10)
+            break;
+        if (p[0] != magic::id1 || p[1] != magic::id2)
+            boost::throw_exception(gzip_error(gzip::bad_header));
+        if (p[2] != method::deflate)
+            boost::throw_exception(gzip_error(gzip::bad_method));
+        int flags = p[3];
+        z = 10;
+        if (flags & flags::extra) {
+            if (n < z + 2)
+                break;
+            z += 2 + (p[z] | (p[z + 1] << 8));
+            if (n < z)
+                break;
+        }
+        for (int f = flags::name; f <= flags::comment; f <<= 1) {
+            if ((flags & f) == 0)
+                continue;
+            while (z < n && p[z] != 0)
+                ++z;
+            if (z++ >= n)
+                break;
+        }
+        if (z > n)
+            break;
+        if (flags & flags::header_crc)
+            z += 2;
+        complete = n >= z;
+    } while (false);
+    if (!complete) {
+        if (eof_)
+            boost::throw_exception(gzip_error(gzip::bad_header));
+        return more(n + 1);
+    }
+    discard(z);
+    window_.clear();
+    crc_ = 0;
+    isize_ = 0;
+    pos_ = 0;
+    state_ = s_body;
+    return true;
+}
+
+bool parallel_gzip_impl::read_body()
+{
+    std::size_t first = pos_ / 8;
+    std::size_t threads = threads_;
+    if (!eof_ && !more(first + threads * chunk_size_ + slack_))
+        return false;
+    std::size_t size = input_.size();
+    std::size_t count = 1;
+    while (count < threads && first + count * chunk_size_ < size)
+        ++count;
+
+    // Decode chunks
+    std::vector<chunk> chunks(count);
+    {
+        boost::thread_group group;
+        for (std::size_t k = 1; k < count; ++k)
+            group.create_thread(
+                boost::bind(
+                    &decode_speculative, &input_,
+                    (first + k * chunk_size_) * 8,
+                    (std::min)(first + (k + 1) * chunk_size_, size) * 8,
+                    &chunks[k]
+                )
+            );
+        decode_exact( input_, pos_, (first + chunk_size_) * 8, window_,
+                      chunks[0] );
+        group.join_all();
+    }
+    if (!chunks[0].ok) {
+        if (!chunks[0].truncated || eof_)
+            throw_data_error();
+        slack_ *= 2;
+        return more(size + 1);
+    }
+
+    // Accept the chunks which begin where the preceding chunk ended
+    bool final = false;
+    for (std::size_t k = 0; k < count && !final; ++k) {
+        const chunk& c = chunks[k];
+        if (k > 0 && pos_ >= (first + (k + 1) * chunk_size_) * 8)
+            continue;
+        if (!c.ok || c.start != pos_)
+            break;
+        accept(c);
+        pos_ = c.end;
+        final = c.final;
+    }
+    slack_ = min_slack;
+    if (final) {
+        pos_ = (pos_ + 7) / 8 * 8;
+        state_ = s_footer;
+    }
+    discard(pos_ / 8);
+    pos_ %= 8;
+    return true;
+}
+
+bool parallel_gzip_impl::read_footer()
+{
+    std::size_t first = pos_ / 8;
+    if (input_.size() < first + 8) {
+        if (eof_)
+            boost::throw_exception(gzip_error(gzip::bad_footer));
+        return more(first + 8);
+    }
+    const unsigned char* p = &input_[first];
+    if (get_u32(p) != crc_)
+        boost::throw_exception(gzip_error(gzip::bad_crc));
+    if (get_u32(p + 4) != isize_)
+        boost::throw_exception(gzip_error(gzip::bad_length));
+    discard(first + 8);
+    pos_ = 0;
+    ++members_;
+    state_ = s_header;
+    return true;
+}
+
+void parallel_gzip_impl::accept(const chunk& c)
+{
+    std::size_t missing = window_size - window_.size();
+    std::size_t start = output_.size();
+    output_.resize(start + c.output.size() - c.prefix);
+    char* out = &output_[0] + start;
+    for (std::size_t z = c.prefix; z < c.output.size(); ++z) {
+        boost::uint16_t value = c.output[z];
+        if (value < 256) {
+            *out++ = static_cast<char>(value);
+        } else {
+            std::size_t j = value - 256;
+            if (j < missing)
+                throw_data_error();
+            *out++ = window_[j - missing];
+        }
+    }
+    std::size_t n = output_.size() - start;
+    crc_ = zlib_backend::crc32(crc_, &output_[0] + start, n);
+    isize_ += static_cast<boost::uint32_t>(n);
+    if (n >= window_size) {
+        window_.assign(output_.end() - window_size, output_.end());
+    } else {
+        window_.insert(window_.end(), output_.end() - n, output_.end());
+        if (window_.size() > window_size)
+            window_.erase( window_.begin(),
+                           window_.end() - window_size );
+    }
+}
+
+//------------------Implementation of parallel_gzip_state--------------------//
+
+parallel_gzip_state::parallel_gzip_state(const parallel_gzip_params& p)
+    : pimpl_(new parallel_gzip_impl(p))
+    { }
+
+std::size_t parallel_gzip_state::wanted() const { return pimpl_->wanted(); }
+
+void parallel_gzip_state::feed(const char* s, std::size_t n)
+{ pimpl_->feed(s, n); }
+
+void parallel_gzip_state::finish() { pimpl_->finish(); }
+
+std::streamsize parallel_gzip_state::read(char* s, std::streamsize n)
+{ return pimpl_->read(s, n); }
+
+void parallel_gzip_state::reset() { pimpl_->reset(); }
+
+} } } // End namespaces detail, iostreams, boost.
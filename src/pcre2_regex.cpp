@@ -0,0 +1,248 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Implements pcre2_regex using the 8-bit PCRE2 library. Each pattern is
+// compiled twice: as written, for searches, and anchored at both ends, for
+// whole matches, since anchoring at match time would prevent the use of
+// the just-in-time compiled code.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <new>      // bad_alloc.
+#include <sstream>
+#include <boost/cstdint.hpp>
+#include <boost/throw_exception.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/filter/pcre2_regex.hpp>
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+
+namespace boost { namespace iostreams {
+
+namespace detail {
+
+namespace {
+
+std::string error_message(int error)
+{
+    PCRE2_UCHAR buf[256];
+    if (pcre2_get_error_message(error, buf, sizeof(buf)) < 0)
+        return "pcre2 error";
+    return std::string(reinterpret_cast<const char*>(buf));
+}
+
+void free_match_data(void* data)
+{
+    pcre2_match_data_free(static_cast<pcre2_match_data*>(data));
+}
+
+} // End unnamed namespace.
+
+class pcre2_regex_impl {
+public:
+    pcre2_regex_impl(const std::string& pattern, int options, bool jit)
+        : search_(0), whole_(0), groups_(0), utf_((options & pcre2::utf) != 0)
+    {
+        boost::uint32_t flags = 0;
+        if (options & pcre2::icase)
+            flags |= PCRE2_CASELESS;
+        if (options & pcre2::multiline)
+            flags |= PCRE2_MULTILINE;
+        if (options & pcre2::dotall)
+            flags |= PCRE2_DOTALL;
+        if (options & pcre2::extended)
+            flags |= PCRE2_EXTENDED;
+        if (utf_)
+            flags |= PCRE2_UTF;
+        search_ = compile(pattern, flags, jit);
+        try {
+            whole_ = compile( pattern, flags | PCRE2_ANCHORED |
+                                       PCRE2_ENDANCHORED, jit );
+        } catch (...) {
+            pcre2_code_free(search_);
+            throw;
+        }
+        boost::uint32_t groups = 0;
+        pcre2_pattern_info(search_, PCRE2_INFO_CAPTURECOUNT, &groups);
+        groups_ = groups;
+    }
+
+    ~pcre2_regex_impl()
+    {
+        pcre2_code_free(search_);
+        pcre2_code_free(whole_);
+    }
+
+    std::size_t groups() const { return groups_; }
+
+    // Returns match data suitable for both compiled patterns.
+    pcre2_match_data* create_match_data() const
+    {
+        pcre2_match_data* data =
+            pcre2_match_data_create_from_pattern(search_, 0);
+        if (!data)
+            boost::throw_exception(std::bad_alloc());
+        return data;
+    }
+
+    // Returns true if the given pattern matches [first, last) beginning at
+    // or after offset.
+    bool exec( bool whole, const char* first, const char* last,
+               std::size_t offset, boost::uint32_t options,
+               pcre2_match_data* data ) const
+    {
+        int result =
+            pcre2_match( whole ? whole_ : search_,
+                         reinterpret_cast<PCRE2_SPTR>(first),
+                         static_cast<PCRE2_SIZE>(last - first),
+                         offset, options, data, 0 );
+        if (result == PCRE2_ERROR_NOMATCH)
+            return false;
+        if (result < 0)
+            boost::throw_exception(pcre2_error(error_message(result), result));
+        return true;
+    }
+
+    static boost::uint32_t match_options(int flags)
+    {
+        boost::uint32_t result = 0;
+        if (flags & pcre2::match_not_bol)
+            result |= PCRE2_NOTBOL;
+        if (flags & pcre2::match_not_eol)
+            result |= PCRE2_NOTEOL;
+        if (flags & pcre2::match_not_empty)
+            result |= PCRE2_NOTEMPTY;
+        return result;
+    }
+
+    bool utf() const { return utf_; }
+private:
+    static pcre2_code* compile
+        (const std::string& pattern, boost::uint32_t flags, bool jit)
+    {
+        int         error;
+        PCRE2_SIZE  offset;
+        pcre2_code* code =
+            pcre2_compile( reinterpret_cast<PCRE2_SPTR>(pattern.data()),
+                           pattern.size(), flags, &error, &offset, 0 );
+        if (!code) {
+            std::ostringstream msg;
+            msg << error_message(error) << " at offset " << offset;
+            boost::throw_exception(pcre2_error(msg.str(), error));
+        }
+
+        // Matching falls back to the interpreter if JIT compilation fails
+        if (jit)
+            pcre2_jit_compile(code, PCRE2_JIT_COMPLETE);
+        return code;
+    }
+
+    pcre2_code*  search_;
+    pcre2_code*  whole_;
+    std::size_t  groups_;
+    bool         utf_;
+};
+
+} // End namespace detail.
+
+//------------------Implementation of pcre2_regex-----------------------------//
+
+pcre2_regex::pcre2_regex(const std::string& pattern, int options, bool jit)
+{ init(pattern, options, jit); }
+
+pcre2_regex::pcre2_regex(const char* pattern, int options, bool jit)
+{ init(pattern, options, jit); }
+
+pcre2_regex::pcre2_regex(const pcre2_regex& other)
+    : pimpl_(other.pimpl_)
+    { }
+
+pcre2_regex& pcre2_regex::operator=(const pcre2_regex& other)
+{
+    if (pimpl_ != other.pimpl_) {
+        pimpl_ = other.pimpl_;
+        data_.reset();
+    }
+    return *this;
+}
+
+std::size_t pcre2_regex::mark_count() const { return pimpl_->groups(); }
+
+bool pcre2_regex::search(const char* first, const char* last, int flags) const
+{
+    if (!data_)
+        data_.reset(pimpl_->create_match_data(), &detail::free_match_data);
+    return pimpl_->exec( false, first, last, 0,
+                         pimpl_->match_options(flags),
+                         static_cast<pcre2_match_data*>(data_.get()) );
+}
+
+bool pcre2_regex::match(const char* first, const char* last, int flags) const
+{
+    if (!data_)
+        data_.reset(pimpl_->create_match_data(), &detail::free_match_data);
+    return pimpl_->exec( true, first, last, 0,
+                         pimpl_->match_options(flags),
+                         static_cast<pcre2_match_data*>(data_.get()) );
+}
+
+void pcre2_regex::find_all
+    ( const char* first, const char* last,
+      std::vector<pcre2_match_results>& matches, int flags ) const
+{
+    if (!data_)
+        data_.reset(pimpl_->create_match_data(), &detail::free_match_data);
+    pcre2_match_data*  data = static_cast<pcre2_match_data*>(data_.get());
+    boost::uint32_t    options = pimpl_->match_options(flags);
+    std::size_t        size = static_cast<std::size_t>(last - first),
+                       offset = 0,
+                       groups = pimpl_->groups() + 1;
+    bool               empty = false;
+    while (offset <= size) {
+
+        // After an empty match, look for a non-empty one at the same
+        // position before moving on
+        boost::uint32_t extra =
+            empty ? PCRE2_NOTEMPTY_ATSTART | PCRE2_ANCHORED : 0;
+        if (!pimpl_->exec(false, first, last, offset, options | extra, data)) {
+            if (!empty || offset == size)
+                break;
+            ++offset;
+            if (pimpl_->utf())
+                while ( offset < size &&
+                        (static_cast<unsigned char>(first[offset]) & 0xc0) ==
+                            0x80 )
+                {
+                    ++offset;
+                }
+            empty = false;
+            continue;
+        }
+        PCRE2_SIZE*          ovector = pcre2_get_ovector_pointer(data);
+        std::size_t          count = pcre2_get_ovector_count(data);
+        pcre2_match_results  m;
+        m.subject_ = first;
+        m.offsets_.resize(2 * groups, pcre2_match_results::npos());
+        for (std::size_t n = 0; n < groups && n < count; ++n) {
+            if (ovector[2 * n] == PCRE2_UNSET)
+                continue;
+            m.offsets_[2 * n] = ovector[2 * n];
+            m.offsets_[2 * n + 1] = ovector[2 * n + 1];
+        }
+        matches.push_back(m);
+        offset = ovector[1];
+        empty = ovector[0] == ovector[1];
+    }
+}
+
+void pcre2_regex::init(const std::string& pattern, int options, bool jit)
+{ pimpl_.reset(new detail::pcre2_regex_impl(pattern, options, jit)); }
+
+} } // End namespaces iostreams, boost.
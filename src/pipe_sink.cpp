@@ -0,0 +1,302 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Implements pipe_sink. Buffers are mapped with mmap(2), so that they are
+// page-aligned and so that unmapping a buffer whose pages are still in the
+// pipe does not affect the characters seen by the reader. Each buffer passed
+// to vmsplice(2) is queued together with the total number of characters
+// written to the pipe once it has been passed; since the pipe is a FIFO, the
+// buffer may be reused once that many characters, less the number still in
+// the pipe, as reported by FIONREAD, have been read. Characters written by
+// other processes only delay this. As vmsplice(2) blocks while the pipe is
+// full, the number of buffers in use is bounded by the capacity of the pipe
+// divided by the buffer size, plus two.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+# define _GNU_SOURCE  // vmsplice, F_SETPIPE_SZ.
+#endif
+
+#include <algorithm>   // min.
+#include <cerrno>
+#include <cstring>     // memcpy.
+#include <deque>
+#include <utility>     // pair.
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/system_failure.hpp>
+#include <boost/iostreams/device/pipe_sink.hpp>
+
+#ifdef __linux__
+# include <fcntl.h>
+# include <sys/ioctl.h>  // FIONREAD.
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <sys/uio.h>    // iovec.
+# include <unistd.h>     // sysconf.
+# ifndef F_SETPIPE_SZ
+#  define F_SETPIPE_SZ 1031
+# endif
+# ifndef F_GETPIPE_SZ
+#  define F_GETPIPE_SZ 1032
+# endif
+#endif
+
+namespace boost { namespace iostreams {
+
+namespace detail {
+
+class pipe_sink_impl {
+public:
+    pipe_sink_impl(const file_descriptor_sink& fd, const pipe_params& p);
+    ~pipe_sink_impl();
+    std::streamsize write(const char* s, std::streamsize n);
+    void flush();
+    void close();
+    std::size_t pipe_size() const;
+    std::size_t set_pipe_size(std::size_t size);
+    bool zero_copy() const { return zero_copy_; }
+private:
+    typedef std::pair<char*, boost::uintmax_t> in_flight;
+    void write_direct(const char* s, std::size_t n);
+#ifdef __linux__
+    char* acquire();
+    bool splice(const char* s, std::size_t n);
+    void submit();
+#endif
+
+    file_descriptor_sink   fd_;
+    bool                   zero_copy_;
+    std::size_t            buffer_size_;
+    std::vector<char*>     buffers_;   // All mapped buffers.
+    std::vector<char*>     free_;
+    std::deque<in_flight>  pending_;   // Buffers whose pages are in the pipe.
+    char*                  current_;
+    std::size_t            fill_;      // Characters in current_.
+    boost::uintmax_t       written_;   // Characters written to the pipe.
+};
+
+pipe_sink_impl::pipe_sink_impl
+    (const file_descriptor_sink& fd, const pipe_params& p)
+    : fd_(fd), zero_copy_(false), buffer_size_(0), current_(0), fill_(0),
+      written_(0)
+{
+#ifdef __linux__
+    struct stat info;
+    if (::fstat(fd_.handle(), &info) == -1)
+        throw_system_failure("failed determining the type of a descriptor");
+    if (!S_ISFIFO(info.st_mode))
+        return;
+    if (p.pipe_size != 0 && pipe_size() < p.pipe_size)
+        set_pipe_size(p.pipe_size);
+    if (p.zero_copy) {
+        std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        std::size_t size = p.buffer_size != 0 ? p.buffer_size : page;
+        buffer_size_ = (size + page - 1) / page * page;
+        zero_copy_ = true;
+    }
+#else
+    (void) p;
+#endif
+}
+
+pipe_sink_impl::~pipe_sink_impl()
+{
+#ifdef __linux__
+    // The pipe holds its own references to any pages not yet read
+    for (std::size_t z = 0; z < buffers_.size(); ++z)
+        ::munmap(buffers_[z], buffer_size_);
+#endif
+}
+
+std::streamsize pipe_sink_impl::write(const char* s, std::streamsize n)
+{
+#ifdef __linux__
+    std::size_t left = static_cast<std::size_t>(n);
+    while (zero_copy_ && left != 0) {
+        if (current_ == 0)
+            current_ = acquire();
+        std::size_t amt = (std::min)(left, buffer_size_ - fill_);
+        std::memcpy(current_ + fill_, s, amt);
+        fill_ += amt;
+        s += amt;
+        left -= amt;
+        if (fill_ == buffer_size_)
+            submit();
+    }
+    if (left != 0)
+        write_direct(s, left);
+#else
+    write_direct(s, static_cast<std::size_t>(n));
+#endif
+    return n;
+}
+
+void pipe_sink_impl::flush()
+{
+#ifdef __linux__
+    if (fill_ != 0)
+        submit();
+#endif
+}
+
+void pipe_sink_impl::close()
+{
+    flush();
+    fd_.close();
+}
+
+std::size_t pipe_sink_impl::pipe_size() const
+{
+#ifdef __linux__
+    int result = ::fcntl(fd_.handle(), F_GETPIPE_SZ);
+    return result == -1 ? 0 : static_cast<std::size_t>(result);
+#else
+    return 0;
+#endif
+}
+
+std::size_t pipe_sink_impl::set_pipe_size(std::size_t size)
+{
+#ifdef __linux__
+    int result = ::fcntl(fd_.handle(), F_SETPIPE_SZ, static_cast<int>(size));
+    if (result == -1)
+        throw_system_failure("failed setting pipe size");
+    return static_cast<std::size_t>(result);
+#else
+    (void) size;
+    throw_system_failure("pipe size cannot be set on this platform");
+    return 0;
+#endif
+}
+
+void pipe_sink_impl::write_direct(const char* s, std::size_t n)
+{
+    while (n != 0) {
+        std::streamsize amt =
+            fd_.write(s, static_cast<std::streamsize>(n));
+        s += amt;
+        n -= static_cast<std::size_t>(amt);
+        written_ += static_cast<boost::uintmax_t>(amt);
+    }
+}
+
+#ifdef __linux__
+
+// Returns a buffer which is not referenced by the pipe.
+char* pipe_sink_impl::acquire()
+{
+    if (!pending_.empty()) {
+        int unread = 0;
+        if (::ioctl(fd_.handle(), FIONREAD, &unread) != -1) {
+            boost::uintmax_t consumed =
+                written_ - static_cast<boost::uintmax_t>(unread);
+            while (!pending_.empty() && pending_.front().second <= consumed) {
+                free_.push_back(pending_.front().first);
+                pending_.pop_front();
+            }
+        }
+    }
+    if (!free_.empty()) {
+        char* buf = free_.back();
+        free_.pop_back();
+        return buf;
+    }
+    void* buf =
+        ::mmap( 0, buffer_size_, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if (buf == MAP_FAILED)
+        throw_system_failure("failed allocating pipe buffer");
+    buffers_.push_back(static_cast<char*>(buf));
+    return static_cast<char*>(buf);
+}
+
+// Passes the given characters to the pipe with vmsplice(2); returns false
+// if no characters were passed because vmsplice(2) is unsupported.
+bool pipe_sink_impl::splice(const char* s, std::size_t n)
+{
+    bool started = false;
+    while (n != 0) {
+        struct iovec iov;
+        iov.iov_base = const_cast<char*>(s);
+        iov.iov_len = n;
+        ssize_t amt = ::vmsplice(fd_.handle(), &iov, 1, SPLICE_F_GIFT);
+        if (amt == -1) {
+            if (errno == EINTR)
+                continue;
+            if ((errno == EINVAL || errno == ENOSYS) && !started)
+                return false;
+            throw_system_failure("failed writing to pipe");
+        }
+        s += amt;
+        n -= static_cast<std::size_t>(amt);
+        written_ += static_cast<boost::uintmax_t>(amt);
+        started = true;
+    }
+    return true;
+}
+
+// Passes the whole pages of current_ to the pipe with vmsplice(2) and copies
+// any remaining characters.
+void pipe_sink_impl::submit()
+{
+    std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    std::size_t whole = fill_ / page * page;
+    char*       buf = current_;
+    std::size_t fill = fill_;
+    current_ = 0;
+    fill_ = 0;
+    if (whole != 0 && !splice(buf, whole)) {
+        zero_copy_ = false;
+        whole = 0;
+    }
+    if (whole != 0)
+        pending_.push_back(in_flight(buf, written_));
+    else
+        free_.push_back(buf);
+    write_direct(buf + whole, fill - whole);
+}
+
+#endif // #ifdef __linux__
+
+} // End namespace detail.
+
+//------------------Implementation of pipe_sink-------------------------------//
+
+pipe_sink::pipe_sink
+    (handle_type fd, file_descriptor_flags f, const pipe_params& p)
+    : pimpl_(new detail::pipe_sink_impl(file_descriptor_sink(fd, f), p))
+    { }
+
+pipe_sink::pipe_sink(const file_descriptor_sink& fd, const pipe_params& p)
+    : pimpl_(new detail::pipe_sink_impl(fd, p))
+    { }
+
+std::streamsize pipe_sink::write(const char* s, std::streamsize n)
+{ return pimpl_->write(s, n); }
+
+bool pipe_sink::flush()
+{
+    pimpl_->flush();
+    return true;
+}
+
+void pipe_sink::close() { pimpl_->close(); }
+
+std::size_t pipe_sink::pipe_size() const { return pimpl_->pipe_size(); }
+
+std::size_t pipe_sink::set_pipe_size(std::size_t size)
+{ return pimpl_->set_pipe_size(size); }
+
+bool pipe_sink::zero_copy() const { return pimpl_->zero_copy(); }
+
+} } // End namespaces iostreams, boost.
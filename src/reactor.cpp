@@ -0,0 +1,291 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <cerrno>
+#include <deque>
+#include <map>
+#include <utility>                                // pair.
+#include <vector>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/config/windows_posix.hpp>
+#include <boost/iostreams/detail/ios.hpp>         // failure.
+#include <boost/iostreams/detail/system_failure.hpp>
+#include <boost/iostreams/reactor.hpp>
+#include <boost/throw_exception.hpp>
+
+    // OS-specific headers for readiness notification.
+
+#ifndef BOOST_IOSTREAMS_WINDOWS
+# include <unistd.h>
+# if defined(__linux__) && !defined(BOOST_IOSTREAMS_NO_EPOLL)
+#  define BOOST_IOSTREAMS_HAS_EPOLL
+#  include <sys/epoll.h>
+# else
+#  include <poll.h>
+# endif
+#endif
+
+namespace boost { namespace iostreams {
+
+//------------------Definition of reactor_impl--------------------------------//
+
+namespace detail {
+
+class reactor_impl {
+public:
+    typedef reactor::handle_type                       handle_type;
+    typedef reactor::handler_type                      handler_type;
+    typedef boost::system::error_code                  error_code;
+    reactor_impl();
+    ~reactor_impl();
+    void async_wait( handle_type h, reactor::wait_type type,
+                     const handler_type& handler );
+    void post(const handler_type& handler, const error_code& ec);
+    void cancel(handle_type h);
+    std::size_t run_one();
+    bool stopped_;
+private:
+    struct waiters {
+        waiters() : events(0) { }
+        std::deque<handler_type>  readers;
+        std::deque<handler_type>  writers;
+        int                       events; // As registered with the system.
+    };
+    typedef std::map<handle_type, waiters>             waiter_map;
+    typedef std::pair<handler_type, error_code>        ready_handler;
+    void update(waiter_map::iterator it);
+    void complete( waiter_map::iterator it, bool readable, bool writable,
+                   const error_code& ec = error_code() );
+    void wait();
+    waiter_map                 waiters_;
+    std::deque<ready_handler>  ready_;
+#ifdef BOOST_IOSTREAMS_HAS_EPOLL
+    int                        epoll_;
+#endif
+};
+
+//------------------Implementation of reactor_impl----------------------------//
+
+reactor_impl::reactor_impl() : stopped_(false)
+{
+#if defined(BOOST_IOSTREAMS_WINDOWS)
+    boost::throw_exception(
+        BOOST_IOSTREAMS_FAILURE("reactor is not supported on Windows")
+    );
+#elif defined(BOOST_IOSTREAMS_HAS_EPOLL)
+    if ((epoll_ = ::epoll_create1(EPOLL_CLOEXEC)) == -1)
+        throw_system_failure("failed creating epoll instance");
+#endif
+}
+
+reactor_impl::~reactor_impl()
+{
+#ifdef BOOST_IOSTREAMS_HAS_EPOLL
+    ::close(epoll_);
+#endif
+}
+
+void reactor_impl::async_wait
+    (handle_type h, reactor::wait_type type, const handler_type& handler)
+{
+    waiter_map::iterator it =
+        waiters_.insert(std::make_pair(h, waiters())).first;
+    if (type == reactor::wait_read)
+        it->second.readers.push_back(handler);
+    else
+        it->second.writers.push_back(handler);
+    update(it);
+}
+
+void reactor_impl::post(const handler_type& handler, const error_code& ec)
+{ ready_.push_back(ready_handler(handler, ec)); }
+
+void reactor_impl::cancel(handle_type h)
+{
+    waiter_map::iterator it = waiters_.find(h);
+    if (it != waiters_.end())
+        complete( it, true, true,
+                  make_error_code(boost::system::errc::operation_canceled) );
+}
+
+std::size_t reactor_impl::run_one()
+{
+    while (!stopped_) {
+        if (!ready_.empty()) {
+            ready_handler next = ready_.front();
+            ready_.pop_front();
+            next.first(next.second);
+            return 1;
+        }
+        if (waiters_.empty())
+            return 0;
+        wait();
+    }
+    return 0;
+}
+
+// Brings the events registered with the system for the given descriptor
+// into line with its waiters, erasing the entry if there are none
+void reactor_impl::update(waiter_map::iterator it)
+{
+    waiters&  w = it->second;
+    int       events = 0;
+#ifdef BOOST_IOSTREAMS_HAS_EPOLL
+    if (!w.readers.empty())
+        events |= EPOLLIN;
+    if (!w.writers.empty())
+        events |= EPOLLOUT;
+    if (events != w.events) {
+        epoll_event ev = epoll_event();
+        ev.events = events;
+        ev.data.fd = it->first;
+        int op = w.events == 0 ?
+            EPOLL_CTL_ADD :
+            events == 0 ?
+                EPOLL_CTL_DEL :
+                EPOLL_CTL_MOD;
+        if (::epoll_ctl(epoll_, op, it->first, &ev) == -1) {
+            if (op == EPOLL_CTL_DEL) {
+                // The descriptor has been closed; nothing to do
+            } else if (errno == EPERM) {
+                // Regular files are always ready
+                w.events = events;
+                complete(it, true, true);
+                return;
+            } else {
+                error_code ec(errno, boost::system::system_category());
+                w.events = 0;
+                complete(it, true, true, ec);
+                return;
+            }
+        }
+        w.events = events;
+    }
+#endif
+    if (events == 0 && w.readers.empty() && w.writers.empty())
+        waiters_.erase(it);
+}
+
+// Moves the handlers waiting for the given types of readiness to the queue
+// of handlers ready to run
+void reactor_impl::complete
+    (waiter_map::iterator it, bool readable, bool writable, const error_code& ec)
+{
+    waiters& w = it->second;
+    if (readable) {
+        for (std::size_t z = 0, n = w.readers.size(); z < n; ++z)
+            post(w.readers[z], ec);
+        w.readers.clear();
+    }
+    if (writable) {
+        for (std::size_t z = 0, n = w.writers.size(); z < n; ++z)
+            post(w.writers[z], ec);
+        w.writers.clear();
+    }
+    update(it);
+}
+
+// Blocks until at least one descriptor is ready
+void reactor_impl::wait()
+{
+#if defined(BOOST_IOSTREAMS_HAS_EPOLL)
+    epoll_event  events[64];
+    int          n;
+    if ((n = ::epoll_wait(epoll_, events, 64, -1)) == -1) {
+        if (errno == EINTR)
+            return;
+        throw_system_failure("failed waiting for events");
+    }
+    for (int z = 0; z < n; ++z) {
+        waiter_map::iterator it = waiters_.find(events[z].data.fd);
+        if (it == waiters_.end())
+            continue;
+        unsigned int e = events[z].events;
+        complete( it,
+                  (e & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0,
+                  (e & (EPOLLOUT | EPOLLERR | EPOLLHUP)) != 0 );
+    }
+#elif !defined(BOOST_IOSTREAMS_WINDOWS)
+    std::vector<pollfd> fds;
+    fds.reserve(waiters_.size());
+    for ( waiter_map::iterator first = waiters_.begin(), last = waiters_.end();
+          first != last;
+          ++first )
+    {
+        pollfd fd = pollfd();
+        fd.fd = first->first;
+        fd.events = static_cast<short>(
+            (first->second.readers.empty() ? 0 : POLLIN) |
+            (first->second.writers.empty() ? 0 : POLLOUT)
+        );
+        fds.push_back(fd);
+    }
+    if (::poll(&fds[0], fds.size(), -1) == -1) {
+        if (errno == EINTR)
+            return;
+        throw_system_failure("failed waiting for events");
+    }
+    for (std::size_t z = 0, n = fds.size(); z < n; ++z) {
+        short e = fds[z].revents;
+        if (e == 0)
+            continue;
+        waiter_map::iterator it = waiters_.find(fds[z].fd);
+        if (it == waiters_.end())
+            continue;
+        if (e & POLLNVAL) {
+            complete( it, true, true,
+                      make_error_code(
+                          boost::system::errc::bad_file_descriptor
+                      ) );
+        } else {
+            complete( it,
+                      (e & (POLLIN | POLLERR | POLLHUP)) != 0,
+                      (e & (POLLOUT | POLLERR | POLLHUP)) != 0 );
+        }
+    }
+#endif
+}
+
+} // End namespace detail.
+
+//------------------Implementation of reactor---------------------------------//
+
+reactor::reactor() : pimpl_(new detail::reactor_impl) { }
+
+reactor::~reactor() { }
+
+void reactor::async_wait
+    (handle_type h, wait_type type, const handler_type& handler)
+{ pimpl_->async_wait(h, type, handler); }
+
+void reactor::post(const handler_type& handler)
+{ pimpl_->post(handler, boost::system::error_code()); }
+
+void reactor::cancel(handle_type h) { pimpl_->cancel(h); }
+
+std::size_t reactor::run()
+{
+    std::size_t n = 0;
+    while (pimpl_->run_one())
+        ++n;
+    return n;
+}
+
+std::size_t reactor::run_one() { return pimpl_->run_one(); }
+
+void reactor::stop() { pimpl_->stopped_ = true; }
+
+bool reactor::stopped() const { return pimpl_->stopped_; }
+
+void reactor::restart() { pimpl_->stopped_ = false; }
+
+} } // End namespaces iostreams, boost.
@@ -0,0 +1,96 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Implements write_segments() for file descriptors. On POSIX systems, up to
+// IOV_MAX segments are passed to each call to writev(2); after a short
+// write, the remaining characters of the partially written segment are
+// passed again at the start of the next call.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <cerrno>
+#include <vector>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/config/windows_posix.hpp>
+#include <boost/iostreams/detail/system_failure.hpp>
+#include <boost/iostreams/device/segmented_buffer.hpp>
+
+#ifndef BOOST_IOSTREAMS_WINDOWS
+# include <climits>      // IOV_MAX.
+# include <sys/uio.h>    // writev.
+# ifndef IOV_MAX
+#  define IOV_MAX 16
+# endif
+#endif
+
+namespace boost { namespace iostreams {
+
+#ifdef BOOST_IOSTREAMS_WINDOWS //---------------------------------------------//
+
+std::streamsize
+write_segments(file_descriptor_sink& snk, const segmented_buffer& buf)
+{
+    for ( segmented_buffer::const_iterator it = buf.begin(), end = buf.end();
+          it != end; ++it )
+    {
+        const char*      s = it->data();
+        std::streamsize  n = static_cast<std::streamsize>(it->size());
+        while (n != 0) {
+            std::streamsize amt = snk.write(s, n);
+            s += amt;
+            n -= amt;
+        }
+    }
+    return static_cast<std::streamsize>(buf.size());
+}
+
+#else // #ifdef BOOST_IOSTREAMS_WINDOWS //------------------------------------//
+
+std::streamsize
+write_segments(file_descriptor_sink& snk, const segmented_buffer& buf)
+{
+    std::vector<struct iovec>         iov;
+    segmented_buffer::const_iterator  it = buf.begin(), end = buf.end();
+    std::size_t                       offset = 0; // Written from *it.
+    while (it != end) {
+        iov.clear();
+        segmented_buffer::const_iterator next = it;
+        for ( std::size_t off = offset;
+              next != end && iov.size() < std::size_t(IOV_MAX);
+              ++next, off = 0 )
+        {
+            struct iovec v;
+            v.iov_base = const_cast<char*>(next->data() + off);
+            v.iov_len = next->size() - off;
+            iov.push_back(v);
+        }
+        ssize_t amt = ::writev( snk.handle(), &iov[0],
+                                static_cast<int>(iov.size()) );
+        if (amt == -1) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+                continue;
+            detail::throw_system_failure("failed writing");
+        }
+
+        // Advance past the characters written
+        std::size_t left = static_cast<std::size_t>(amt);
+        while (it != end && left >= it->size() - offset) {
+            left -= it->size() - offset;
+            offset = 0;
+            ++it;
+        }
+        offset += left;
+    }
+    return static_cast<std::streamsize>(buf.size());
+}
+
+#endif // #ifdef BOOST_IOSTREAMS_WINDOWS //-----------------------------------//
+
+} } // End namespaces iostreams, boost.
@@ -0,0 +1,286 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Implements the transpositions used by shuffle_filter and
+// bitshuffle_filter. Elements whose size is a power of two no greater than
+// 16 are transposed sixteen at a time using SSE2, when it is available;
+// other elements, and those left over, are transposed one byte at a time,
+// or eight elements at a time for bit transpositions.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <boost/cstdint.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/config/simd.hpp>
+#include <boost/iostreams/filter/shuffle.hpp>
+#ifdef BOOST_IOSTREAMS_HAS_SSE2
+# include <emmintrin.h>
+#endif
+
+namespace boost { namespace iostreams { namespace detail {
+
+namespace {
+
+// Transposes the 8x8 matrix of bits whose rows are the bytes of x, taken
+// from the least significant byte; see Hacker's Delight, section 7-3.
+boost::uint64_t transpose8(boost::uint64_t x)
+{
+    boost::uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000cccc0000ccccULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ULL;
+    x = x ^ t ^ (t << 28);
+    return x;
+}
+
+// Transposes the bits of the elements first, ..., count - 1, in groups of
+// eight
+void shuffle_bits_scalar( const char* src, char* dest, std::size_t first,
+                          std::size_t count, std::size_t size )
+{
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(src);
+    unsigned char* out = reinterpret_cast<unsigned char*>(dest);
+    std::size_t row = count / 8;
+    for (std::size_t g = first / 8; g < row; ++g) {
+        for (std::size_t j = 0; j < size; ++j) {
+            boost::uint64_t x = 0;
+            for (int t = 0; t < 8; ++t)
+                x |= static_cast<boost::uint64_t>(in[(8 * g + t) * size + j])
+                         << (8 * t);
+            x = transpose8(x);
+            for (int b = 0; b < 8; ++b)
+                out[(8 * j + b) * row + g] =
+                    static_cast<unsigned char>(x >> (8 * b));
+        }
+    }
+}
+
+void unshuffle_bits_scalar( const char* src, char* dest, std::size_t first,
+                            std::size_t count, std::size_t size )
+{
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(src);
+    unsigned char* out = reinterpret_cast<unsigned char*>(dest);
+    std::size_t row = count / 8;
+    for (std::size_t g = first / 8; g < row; ++g) {
+        for (std::size_t j = 0; j < size; ++j) {
+            boost::uint64_t x = 0;
+            for (int b = 0; b < 8; ++b)
+                x |= static_cast<boost::uint64_t>(in[(8 * j + b) * row + g])
+                         << (8 * b);
+            x = transpose8(x);
+            for (int t = 0; t < 8; ++t)
+                out[(8 * g + t) * size + j] =
+                    static_cast<unsigned char>(x >> (8 * t));
+        }
+    }
+}
+
+#ifdef BOOST_IOSTREAMS_HAS_SSE2
+
+// Transposes the bytes of the first n elements, where n is a multiple of
+// 16, by repeatedly separating the even and odd bytes of pairs of vectors;
+// after log2(K) rounds, vector j holds byte j of sixteen elements.
+template<int K>
+void shuffle_sse2( const char* src, char* dest, std::size_t count,
+                   std::size_t n )
+{
+    const __m128i low = _mm_set1_epi16(0x00ff);
+    __m128i v[K], w[K];
+    for (std::size_t i = 0; i < n; i += 16) {
+        for (int k = 0; k < K; ++k)
+            v[k] = _mm_loadu_si128(
+                       reinterpret_cast<const __m128i*>(src + i * K + 16 * k)
+                   );
+        for (int r = 1; r < K; r *= 2) {
+            for (int k = 0; k < K / 2; ++k) {
+                __m128i a = v[2 * k], b = v[2 * k + 1];
+                w[k] = _mm_packus_epi16( _mm_and_si128(a, low),
+                                         _mm_and_si128(b, low) );
+                w[k + K / 2] = _mm_packus_epi16( _mm_srli_epi16(a, 8),
+                                                 _mm_srli_epi16(b, 8) );
+            }
+            for (int k = 0; k < K; ++k)
+                v[k] = w[k];
+        }
+        for (int k = 0; k < K; ++k)
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(dest + k * count + i), v[k]
+            );
+    }
+}
+
+// Inverse of shuffle_sse2, interleaving pairs of vectors.
+template<int K>
+void unshuffle_sse2( const char* src, char* dest, std::size_t count,
+                     std::size_t n )
+{
+    __m128i v[K], w[K];
+    for (std::size_t i = 0; i < n; i += 16) {
+        for (int k = 0; k < K; ++k)
+            v[k] = _mm_loadu_si128(
+                       reinterpret_cast<const __m128i*>(src + k * count + i)
+                   );
+        for (int r = 1; r < K; r *= 2) {
+            for (int k = 0; k < K / 2; ++k) {
+                w[2 * k] = _mm_unpacklo_epi8(v[k], v[k + K / 2]);
+                w[2 * k + 1] = _mm_unpackhi_epi8(v[k], v[k + K / 2]);
+            }
+            for (int k = 0; k < K; ++k)
+                v[k] = w[k];
+        }
+        for (int k = 0; k < K; ++k)
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(dest + i * K + 16 * k), v[k]
+            );
+    }
+}
+
+// Transposes the bits of the first n elements, where n is a multiple of
+// 16, by gathering bit b of sixteen bytes with movemask and shifting.
+template<int K>
+void shuffle_bits_sse2( const char* src, char* dest, std::size_t count,
+                        std::size_t n )
+{
+    std::size_t  row = count / 8;
+    char         planes[16 * K];
+    for (std::size_t i = 0; i < n; i += 16) {
+        const char* p = src + i;
+        if (K != 1) {
+            shuffle_sse2<K>(src + i * K, planes, 16, 16);
+            p = planes;
+        }
+        for (int j = 0; j < K; ++j) {
+            __m128i x =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * j));
+            for (int b = 7; b >= 0; --b) {
+                int   m = _mm_movemask_epi8(x);
+                char* q = dest + (8 * j + b) * row + i / 8;
+                q[0] = static_cast<char>(m & 0xff);
+                q[1] = static_cast<char>(m >> 8);
+                x = _mm_slli_epi16(x, 1);
+            }
+        }
+    }
+}
+
+// Inverse of shuffle_bits_sse2, expanding each bit to a byte mask.
+template<int K>
+void unshuffle_bits_sse2( const char* src, char* dest, std::size_t count,
+                          std::size_t n )
+{
+    const __m128i  select =
+        _mm_setr_epi8( 1, 2, 4, 8, 16, 32, 64, -128,
+                       1, 2, 4, 8, 16, 32, 64, -128 );
+    std::size_t    row = count / 8;
+    char           planes[16 * K];
+    for (std::size_t i = 0; i < n; i += 16) {
+        char* p = K == 1 ? dest + i : planes;
+        for (int j = 0; j < K; ++j) {
+            __m128i acc = _mm_setzero_si128();
+            for (int b = 0; b < 8; ++b) {
+                const char* q = src + (8 * j + b) * row + i / 8;
+                __m128i v = _mm_unpacklo_epi64( _mm_set1_epi8(q[0]),
+                                                _mm_set1_epi8(q[1]) );
+                v = _mm_cmpeq_epi8(_mm_and_si128(v, select), select);
+                acc = _mm_or_si128(
+                          acc,
+                          _mm_and_si128(
+                              v, _mm_set1_epi8(static_cast<char>(1 << b))
+                          )
+                      );
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p + 16 * j), acc);
+        }
+        if (K != 1)
+            unshuffle_sse2<K>(planes, dest + i * K, 16, 16);
+    }
+}
+
+#endif // #ifdef BOOST_IOSTREAMS_HAS_SSE2
+
+} // End unnamed namespace.
+
+void shuffle_bytes( const char* src, char* dest, std::size_t count,
+                    std::size_t size )
+{
+    std::size_t done = 0;
+#ifdef BOOST_IOSTREAMS_HAS_SSE2
+    std::size_t n = count - count % 16;
+    switch (size) {
+    case 2:  shuffle_sse2<2>(src, dest, count, n); done = n; break;
+    case 4:  shuffle_sse2<4>(src, dest, count, n); done = n; break;
+    case 8:  shuffle_sse2<8>(src, dest, count, n); done = n; break;
+    case 16: shuffle_sse2<16>(src, dest, count, n); done = n; break;
+    default: break;
+    }
+#endif
+    for (std::size_t j = 0; j < size; ++j)
+        for (std::size_t i = done; i < count; ++i)
+            dest[j * count + i] = src[i * size + j];
+}
+
+void unshuffle_bytes( const char* src, char* dest, std::size_t count,
+                      std::size_t size )
+{
+    std::size_t done = 0;
+#ifdef BOOST_IOSTREAMS_HAS_SSE2
+    std::size_t n = count - count % 16;
+    switch (size) {
+    case 2:  unshuffle_sse2<2>(src, dest, count, n); done = n; break;
+    case 4:  unshuffle_sse2<4>(src, dest, count, n); done = n; break;
+    case 8:  unshuffle_sse2<8>(src, dest, count, n); done = n; break;
+    case 16: unshuffle_sse2<16>(src, dest, count, n); done = n; break;
+    default: break;
+    }
+#endif
+    for (std::size_t i = done; i < count; ++i)
+        for (std::size_t j = 0; j < size; ++j)
+            dest[i * size + j] = src[j * count + i];
+}
+
+void shuffle_bits( const char* src, char* dest, std::size_t count,
+                   std::size_t size )
+{
+    std::size_t done = 0;
+#ifdef BOOST_IOSTREAMS_HAS_SSE2
+    std::size_t n = count - count % 16;
+    switch (size) {
+    case 1:  shuffle_bits_sse2<1>(src, dest, count, n); done = n; break;
+    case 2:  shuffle_bits_sse2<2>(src, dest, count, n); done = n; break;
+    case 4:  shuffle_bits_sse2<4>(src, dest, count, n); done = n; break;
+    case 8:  shuffle_bits_sse2<8>(src, dest, count, n); done = n; break;
+    case 16: shuffle_bits_sse2<16>(src, dest, count, n); done = n; break;
+    default: break;
+    }
+#endif
+    shuffle_bits_scalar(src, dest, done, count, size);
+}
+
+void unshuffle_bits( const char* src, char* dest, std::size_t count,
+                     std::size_t size )
+{
+    std::size_t done = 0;
+#ifdef BOOST_IOSTREAMS_HAS_SSE2
+    std::size_t n = count - count % 16;
+    switch (size) {
+    case 1:  unshuffle_bits_sse2<1>(src, dest, count, n); done = n; break;
+    case 2:  unshuffle_bits_sse2<2>(src, dest, count, n); done = n; break;
+    case 4:  unshuffle_bits_sse2<4>(src, dest, count, n); done = n; break;
+    case 8:  unshuffle_bits_sse2<8>(src, dest, count, n); done = n; break;
+    case 16: unshuffle_bits_sse2<16>(src, dest, count, n); done = n; break;
+    default: break;
+    }
+#endif
+    unshuffle_bits_scalar(src, dest, done, count, size);
+}
+
+} } } // End namespaces detail, iostreams, boost.
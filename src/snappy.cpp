@@ -0,0 +1,457 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Implements the Snappy block format and the framing format described at
+// https://github.com/google/snappy/blob/main/format_description.txt and
+// https://github.com/google/snappy/blob/main/framing_format.txt.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <cstring>  // memcmp, memcpy, memset.
+#include <boost/throw_exception.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/filter/snappy.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace snappy {
+
+                    // Chunk types
+
+const int compressed_data        = 0x00;
+const int uncompressed_data      = 0x01;
+const int padding                = 0xfe;
+const int stream_identifier      = 0xff;
+
+                    // Status codes
+
+const int okay                   = 0;
+const int bad_stream_identifier  = 1;
+const int bad_chunk_length       = 2;
+const int unskippable_chunk      = 3;
+const int checksum_error         = 4;
+const int data_error             = 5;
+const int unexpected_eof         = 6;
+
+} // End namespace snappy.
+
+//------------------Implementation of snappy_error----------------------------//
+
+snappy_error::snappy_error(int error)
+    : BOOST_IOSTREAMS_FAILURE("snappy error"), error_(error)
+    { }
+
+void snappy_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(int error)
+{
+    if (error != snappy::okay)
+        boost::throw_exception(snappy_error(error));
+}
+
+bool snappy_error::check BOOST_PREVENT_MACRO_SUBSTITUTION
+    (int error, boost::system::error_code& ec)
+{
+    if (error == snappy::okay)
+        return true;
+    ec.assign(error, snappy_category());
+    return false;
+}
+
+//------------------Implementation of snappy_category-------------------------//
+
+namespace detail {
+
+class snappy_category_impl : public boost::system::error_category {
+public:
+    const char* name() const BOOST_SYSTEM_NOEXCEPT { return "snappy"; }
+    std::string message(int ev) const
+    {
+        switch (ev) {
+        case snappy::bad_stream_identifier:
+            return "snappy missing or invalid stream identifier";
+        case snappy::bad_chunk_length:
+            return "snappy invalid chunk length";
+        case snappy::unskippable_chunk:
+            return "snappy reserved unskippable chunk";
+        case snappy::checksum_error:
+            return "snappy checksum mismatch";
+        case snappy::data_error:
+            return "snappy corrupt compressed data";
+        case snappy::unexpected_eof:
+            return "snappy unexpected end of data";
+        default:
+            return "snappy error";
+        }
+    }
+};
+
+} // End namespace detail.
+
+const boost::system::error_category& snappy_category()
+{
+    static const detail::snappy_category_impl instance;
+    return instance;
+}
+
+//------------------Implementation of snappy_base-----------------------------//
+
+namespace detail {
+
+namespace {
+
+                    // CRC-32C (Castagnoli), computed eight bytes at a time
+
+class crc32c_table {
+public:
+    crc32c_table()
+    {
+        for (boost::uint32_t z = 0; z < 256; ++z) {
+            boost::uint32_t crc = z;
+            for (int j = 0; j < 8; ++j)
+                crc = (crc >> 1) ^ (0x82f63b78 & (0 - (crc & 1)));
+            table_[0][z] = crc;
+        }
+        for (int k = 1; k < 8; ++k)
+            for (int z = 0; z < 256; ++z)
+                table_[k][z] = (table_[k - 1][z] >> 8) ^
+                               table_[0][table_[k - 1][z] & 0xff];
+    }
+    boost::uint32_t operator()(const char* s, std::size_t n) const
+    {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(s);
+        boost::uint32_t      crc = 0xffffffff;
+        for (; n >= 8; n -= 8, p += 8) {
+            crc ^= p[0] | (p[1] << 8) | (p[2] << 16) |
+                   (static_cast<boost::uint32_t>(p[3]) << 24);
+            crc = table_[7][crc & 0xff] ^ table_[6][(crc >> 8) & 0xff] ^
+                  table_[5][(crc >> 16) & 0xff] ^ table_[4][crc >> 24] ^
+                  table_[3][p[4]] ^ table_[2][p[5]] ^
+                  table_[1][p[6]] ^ table_[0][p[7]];
+        }
+        for (; n != 0; --n, ++p)
+            crc = (crc >> 8) ^ table_[0][(crc ^ *p) & 0xff];
+        return crc ^ 0xffffffff;
+    }
+private:
+    boost::uint32_t table_[8][256];
+};
+
+const crc32c_table crc32c = crc32c_table();
+
+boost::uint32_t masked_crc32c(const char* s, std::size_t n)
+{
+    boost::uint32_t crc = crc32c(s, n);
+    return ((crc >> 15) | (crc << 17)) + 0xa282ead8;
+}
+
+inline boost::uint32_t load32(const char* p)
+{
+    boost::uint32_t result;
+    std::memcpy(&result, p, 4);
+    return result;
+}
+
+inline boost::uint32_t load_le(const char* p, int n)
+{
+    const unsigned char* q = reinterpret_cast<const unsigned char*>(p);
+    boost::uint32_t      result = 0;
+    for (int z = n - 1; z >= 0; --z)
+        result = (result << 8) | q[z];
+    return result;
+}
+
+inline void store_le(char* p, boost::uint32_t value, int n)
+{
+    for (int z = 0; z < n; ++z, value >>= 8)
+        p[z] = static_cast<char>(value & 0xff);
+}
+
+                    // The Snappy block format
+
+// Blocks shorter than this are stored as a single literal; longer blocks
+// are searched for matches up to this distance from their end, so that
+// four-byte loads never overrun the input.
+const std::size_t input_margin = 15;
+
+// The hash table has 2^max_hash_bits entries, each the offset of a
+// position within the block.
+const int max_hash_bits = 14;
+
+std::size_t max_compressed_length(std::size_t n)
+{ return 32 + n + n / 6; }
+
+char* emit_literal(char* op, const char* literal, std::size_t len)
+{
+    std::size_t n = len - 1;
+    if (n < 60) {
+        *op++ = static_cast<char>(n << 2);
+    } else {
+        int count = n < 0x100 ? 1 : n < 0x10000 ? 2 : n < 0x1000000 ? 3 : 4;
+        *op++ = static_cast<char>((59 + count) << 2);
+        store_le(op, static_cast<boost::uint32_t>(n), count);
+        op += count;
+    }
+    std::memcpy(op, literal, len);
+    return op + len;
+}
+
+// Emits a copy of 4 <= len <= 64 characters.
+char* emit_copy_upto64(char* op, std::size_t offset, std::size_t len)
+{
+    if (len < 12 && offset < 2048) {
+        *op++ = static_cast<char>(1 + ((len - 4) << 2) + ((offset >> 8) << 5));
+        *op++ = static_cast<char>(offset & 0xff);
+    } else {
+        *op++ = static_cast<char>(2 + ((len - 1) << 2));
+        store_le(op, static_cast<boost::uint32_t>(offset), 2);
+        op += 2;
+    }
+    return op;
+}
+
+char* emit_copy(char* op, std::size_t offset, std::size_t len)
+{
+    while (len >= 68) {
+        op = emit_copy_upto64(op, offset, 64);
+        len -= 64;
+    }
+    if (len > 64) {
+        op = emit_copy_upto64(op, offset, 60);
+        len -= 60;
+    }
+    return emit_copy_upto64(op, offset, len);
+}
+
+// Compresses the n <= snappy::chunk_size characters at src, writing at most
+// max_compressed_length(n) characters to dest; returns the number written.
+std::size_t compress(const char* src, std::size_t n, char* dest)
+{
+    char* op = dest;
+
+    // Preamble: the uncompressed length as a varint
+    for (std::size_t len = n; ; len >>= 7) {
+        if (len < 0x80) {
+            *op++ = static_cast<char>(len);
+            break;
+        }
+        *op++ = static_cast<char>((len & 0x7f) | 0x80);
+    }
+
+    const char* next_emit = src;
+    const char* end = src + n;
+    if (n >= input_margin) {
+        int hash_bits = 8;
+        while (hash_bits < max_hash_bits && (std::size_t(1) << hash_bits) < n)
+            ++hash_bits;
+        boost::uint16_t table[1 << max_hash_bits];
+        std::memset(table, 0, sizeof(boost::uint16_t) << hash_bits);
+        const int    shift = 32 - hash_bits;
+        const char*  limit = end - input_margin;
+        const char*  ip = src + 1;
+        std::size_t  skip = 32;
+        while (ip <= limit) {
+            boost::uint32_t  value = load32(ip);
+            boost::uint32_t  h = (value * 0x1e35a7bd) >> shift;
+            const char*      candidate = src + table[h];
+            table[h] = static_cast<boost::uint16_t>(ip - src);
+            if (load32(candidate) != value) {
+
+                // Skip ahead more quickly the longer no match is found
+                ip += skip++ >> 5;
+                continue;
+            }
+            skip = 32;
+            if (ip != next_emit)
+                op = emit_literal(op, next_emit, ip - next_emit);
+            const char* p = ip + 4;
+            const char* q = candidate + 4;
+            while (p != end && *p == *q) {
+                ++p;
+                ++q;
+            }
+            op = emit_copy(op, ip - candidate, p - ip);
+            ip = next_emit = p;
+            if (ip <= limit)
+                table[(load32(ip - 1) * 0x1e35a7bd) >> shift] =
+                    static_cast<boost::uint16_t>(ip - 1 - src);
+        }
+    }
+    if (next_emit != end)
+        op = emit_literal(op, next_emit, end - next_emit);
+    return static_cast<std::size_t>(op - dest);
+}
+
+// Parses the varint at the beginning of the given block; returns the number
+// of characters occupied, or 0 if the varint is malformed.
+std::size_t uncompressed_length
+    (const char* src, std::size_t n, std::size_t& result)
+{
+    result = 0;
+    for (std::size_t z = 0; z < n && z < 5; ++z) {
+        unsigned char c = static_cast<unsigned char>(src[z]);
+        result |= static_cast<std::size_t>(c & 0x7f) << (7 * z);
+        if ((c & 0x80) == 0)
+            return z + 1;
+    }
+    return 0;
+}
+
+// Decompresses the n characters at src into the len characters at dest;
+// returns snappy::okay or snappy::data_error.
+int uncompress(const char* src, std::size_t n, char* dest, std::size_t len)
+{
+    const char*  ip = src;
+    const char*  ip_end = src + n;
+    char*        op = dest;
+    char*        op_end = dest + len;
+    while (ip != ip_end) {
+        unsigned char  tag = static_cast<unsigned char>(*ip++);
+        std::size_t    length, offset;
+        if ((tag & 3) == 0) {
+            length = tag >> 2;
+            if (length >= 60) {
+                int count = static_cast<int>(length) - 59;
+                if (ip_end - ip < count)
+                    return snappy::data_error;
+                length = load_le(ip, count);
+                ip += count;
+            }
+            ++length;
+            if ( static_cast<std::size_t>(ip_end - ip) < length ||
+                 static_cast<std::size_t>(op_end - op) < length )
+            {
+                return snappy::data_error;
+            }
+            std::memcpy(op, ip, length);
+            ip += length;
+            op += length;
+            continue;
+        }
+        int count = (tag & 3) == 1 ? 1 : (tag & 3) == 2 ? 2 : 4;
+        if (ip_end - ip < count)
+            return snappy::data_error;
+        if (count == 1) {
+            length = 4 + ((tag >> 2) & 7);
+            offset = ((tag >> 5) << 8) | static_cast<unsigned char>(*ip);
+        } else {
+            length = 1 + (tag >> 2);
+            offset = load_le(ip, count);
+        }
+        ip += count;
+        if ( offset == 0 || offset > static_cast<std::size_t>(op - dest) ||
+             static_cast<std::size_t>(op_end - op) < length )
+        {
+            return snappy::data_error;
+        }
+
+        // The source and destination may overlap
+        const char* from = op - offset;
+        if (offset >= length) {
+            std::memcpy(op, from, length);
+            op += length;
+        } else {
+            for (char* last = op + length; op != last; )
+                *op++ = *from++;
+        }
+    }
+    return op == op_end ? snappy::okay : snappy::data_error;
+}
+
+const char identifier[] = "\xff\x06\x00\x00sNaPpY";
+const std::size_t identifier_size = sizeof(identifier) - 1;
+const std::size_t checksum_size = 4;
+
+} // End unnamed namespace.
+
+std::size_t snappy_base::max_encoded_size()
+{
+    return header_size + checksum_size +
+           max_compressed_length(snappy::chunk_size);
+}
+
+std::size_t snappy_base::max_body_size()
+{ return max_encoded_size() - header_size; }
+
+std::size_t snappy_base::encode_identifier(char* dest)
+{
+    std::memcpy(dest, identifier, identifier_size);
+    return identifier_size;
+}
+
+std::size_t snappy_base::encode_chunk
+    (const char* src, std::size_t n, char* dest)
+{
+    char*        body = dest + header_size + checksum_size;
+    std::size_t  len = compress(src, n, body);
+    int          type = snappy::compressed_data;
+
+    // Store the data uncompressed if compression saves less than 12.5%
+    if (len >= n - n / 8) {
+        std::memcpy(body, src, n);
+        len = n;
+        type = snappy::uncompressed_data;
+    }
+    dest[0] = static_cast<char>(type);
+    store_le(dest + 1, static_cast<boost::uint32_t>(len + checksum_size), 3);
+    store_le(dest + header_size, masked_crc32c(src, n), 4);
+    return header_size + checksum_size + len;
+}
+
+int snappy_base::decoded_size
+    (int type, const char* body, std::size_t len, std::size_t& size)
+{
+    if (type == snappy::stream_identifier) {
+        size = 0;
+        return len == identifier_size - header_size &&
+               std::memcmp( body, identifier + header_size,
+                            identifier_size - header_size ) == 0 ?
+            snappy::okay :
+            snappy::bad_stream_identifier;
+    }
+    if (len < checksum_size)
+        return snappy::bad_chunk_length;
+    if (type == snappy::uncompressed_data) {
+        size = len - checksum_size;
+    } else if (!uncompressed_length(body + checksum_size,
+                                    len - checksum_size, size))
+    {
+        return snappy::data_error;
+    }
+    return size <= snappy::chunk_size ?
+        snappy::okay :
+        snappy::bad_chunk_length;
+}
+
+int snappy_base::decode_chunk
+    (int type, const char* body, std::size_t len, char* dest, bool verify)
+{
+    std::size_t size;
+    if (int result = decoded_size(type, body, len, size))
+        return result;
+    if (type == snappy::stream_identifier)
+        return snappy::okay;
+    const char*  data = body + checksum_size;
+    std::size_t  data_len = len - checksum_size;
+    if (type == snappy::uncompressed_data) {
+        std::memcpy(dest, data, size);
+    } else {
+        std::size_t skip = uncompressed_length(data, data_len, size);
+        if (int result = uncompress(data + skip, data_len - skip, dest, size))
+            return result;
+    }
+    if (verify && masked_crc32c(dest, size) != load_le(body, 4))
+        return snappy::checksum_error;
+    return snappy::okay;
+}
+
+} // End namespace detail.
+
+//----------------------------------------------------------------------------//
+
+} } // End namespaces iostreams, boost.
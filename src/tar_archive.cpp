@@ -0,0 +1,487 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Implements tar_error and tar_index. A saved index consists of the
+// following, where all integers are unsigned and stored in little-endian
+// order:
+//
+//     The characters "BIOTIX01".
+//     The number of entries and the number of checkpoints, as 64-bit
+//         integers.
+//     For each entry, its header offset, data offset, size and modification
+//         time as 64-bit integers, its mode as a 32-bit integer, its type,
+//         and its name and link name, each as a 32-bit length followed by
+//         the characters.
+//     For each checkpoint, its compressed and uncompressed offsets as
+//         64-bit integers, its crc, size, bits and byte as 32-bit integers,
+//         and its window as a 32-bit length followed by the characters.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <algorithm>  // lower_bound, stable_sort, upper_bound.
+#include <cstring>    // memcmp, memchr.
+#include <limits>     // numeric_limits.
+#include <boost/cstdint.hpp>
+#include <boost/throw_exception.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/device/tar_archive.hpp>
+
+namespace boost { namespace iostreams {
+
+namespace tar {
+
+                    // Status codes
+
+const int okay              = 0;
+const int bad_header        = 1;
+const int bad_checksum      = 2;
+const int unexpected_eof    = 3;
+const int member_not_found  = 4;
+const int bad_index         = 5;
+
+} // End namespace tar.
+
+//------------------Implementation of tar_error-------------------------------//
+
+tar_error::tar_error(int error)
+    : BOOST_IOSTREAMS_FAILURE("tar error"), error_(error)
+    { }
+
+void tar_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(int error)
+{
+    if (error != tar::okay)
+        boost::throw_exception(tar_error(error));
+}
+
+namespace detail {
+
+tar_reader::~tar_reader() { }
+
+namespace {
+
+const std::size_t    block_size = 512;
+
+// The maximum size of a long name or pax header.
+const stream_offset  max_extended_size = 1024 * 1024;
+const char           index_magic[] = "BIOTIX01";
+
+// Returns the characters of a header field, which ends at the first null
+// character if there is one
+std::string field(const char* p, std::size_t n)
+{
+    const char* end = static_cast<const char*>(std::memchr(p, 0, n));
+    return std::string(p, end ? end : p + n);
+}
+
+// Parses a numeric header field, which is either octal, terminated by a
+// space or a null character, or, if its first bit is set, base-256
+bool parse_number(const char* p, std::size_t n, boost::uint64_t& value)
+{
+    const unsigned char* q = reinterpret_cast<const unsigned char*>(p);
+    value = 0;
+    if (q[0] & 0x80) {
+
+        // Negative values and values which don't fit are rejected
+        if (q[0] != 0x80)
+            return false;
+        for (std::size_t z = 1; z < n; ++z) {
+            if (z + 8 < n && q[z] != 0)
+                return false;
+            value = (value << 8) | q[z];
+        }
+        return true;
+    }
+    std::size_t z = 0;
+    while (z < n && q[z] == ' ')
+        ++z;
+    for (; z < n && q[z] >= '0' && q[z] <= '7'; ++z) {
+        if (value >> 61)
+            return false;
+        value = (value << 3) | (q[z] - '0');
+    }
+    for (; z < n; ++z)
+        if (q[z] != ' ' && q[z] != 0)
+            return false;
+    return true;
+}
+
+boost::uint64_t number(const char* p, std::size_t n)
+{
+    boost::uint64_t value;
+    if (!parse_number(p, n, value))
+        boost::throw_exception(tar_error(tar::bad_header));
+    return value;
+}
+
+// Checks the checksum of a header, which may have been computed by summing
+// either unsigned or signed characters
+void check_checksum(const char* block)
+{
+    boost::uint64_t stored = number(block + 148, 8);
+    long            unsigned_sum = 0, signed_sum = 0;
+    for (std::size_t z = 0; z < block_size; ++z) {
+        char c = z >= 148 && z < 156 ? ' ' : block[z];
+        unsigned_sum += static_cast<unsigned char>(c);
+        signed_sum += static_cast<signed char>(c);
+    }
+    if ( stored != static_cast<boost::uint64_t>(unsigned_sum) &&
+         stored != static_cast<boost::uint64_t>(signed_sum) )
+    {
+        boost::throw_exception(tar_error(tar::bad_checksum));
+    }
+}
+
+bool is_zero(const char* block)
+{
+    for (std::size_t z = 0; z < block_size; ++z)
+        if (block[z] != 0)
+            return false;
+    return true;
+}
+
+// Values of a member's header which may be replaced by those of a
+// preceding pax header or GNU long name header
+struct overrides {
+    overrides() : has_size(false), has_mtime(false), size(0), mtime(0) { }
+    std::string      path, link_path;
+    bool             has_size, has_mtime;
+    boost::uint64_t  size;
+    std::time_t      mtime;
+};
+
+// Parses the records of a pax header, each of the form
+// "<length> <keyword>=<value>\n"
+void parse_pax(const std::string& data, overrides& o)
+{
+    std::size_t pos = 0;
+    while (pos < data.size() && data[pos] != 0) {
+        std::size_t len = 0, z = pos;
+        for (; z < data.size() && data[z] >= '0' && data[z] <= '9'; ++z)
+            len = len * 10 + (data[z] - '0');
+        if ( z == pos || z == data.size() || data[z] != ' ' ||
+             len < z - pos + 2 || len > data.size() - pos ||
+             data[pos + len - 1] != '\n' )
+        {
+            boost::throw_exception(tar_error(tar::bad_header));
+        }
+        std::string record(data, z + 1, pos + len - 1 - (z + 1));
+        std::string::size_type eq = record.find('=');
+        if (eq == std::string::npos)
+            boost::throw_exception(tar_error(tar::bad_header));
+        std::string key(record, 0, eq), value(record, eq + 1);
+        if (key == "path") {
+            o.path = value;
+        } else if (key == "linkpath") {
+            o.link_path = value;
+        } else if (key == "size" || key == "mtime") {
+            boost::uint64_t n = 0;
+            std::size_t     y = 0;
+            for (; y < value.size() && value[y] >= '0' && value[y] <= '9'; ++y)
+                n = n * 10 + (value[y] - '0');
+            if (y == 0)
+                boost::throw_exception(tar_error(tar::bad_header));
+            if (key == "size") {
+                o.size = n;
+                o.has_size = true;
+            } else {
+                o.mtime = static_cast<std::time_t>(n);
+                o.has_mtime = true;
+            }
+        }
+        pos += len;
+    }
+}
+
+void store(std::string& s, boost::uint64_t value, int size)
+{
+    for (int z = 0; z < size; ++z, value >>= 8)
+        s += static_cast<char>(value & 0xff);
+}
+
+void store(std::string& s, const std::string& value)
+{
+    store(s, value.size(), 4);
+    s += value;
+}
+
+// Reads values from a saved index, throwing if it is too short
+class index_parser {
+public:
+    explicit index_parser(const std::string& data) : data_(data), pos_(0) { }
+    boost::uint64_t load(int size)
+    {
+        check(static_cast<std::size_t>(size));
+        boost::uint64_t result = 0;
+        for (int z = size; z-- > 0; )
+            result = (result << 8) |
+                     static_cast<unsigned char>(data_[pos_ + z]);
+        pos_ += size;
+        return result;
+    }
+    std::string load_string()
+    {
+        std::size_t n = static_cast<std::size_t>(load(4));
+        check(n);
+        std::string result(data_, pos_, n);
+        pos_ += n;
+        return result;
+    }
+    bool done() const { return pos_ == data_.size(); }
+private:
+    void check(std::size_t n)
+    {
+        if (n > data_.size() - pos_)
+            boost::throw_exception(tar_error(tar::bad_index));
+    }
+    const std::string&  data_;
+    std::size_t         pos_;
+};
+
+} // End unnamed namespace.
+
+} // End namespace detail.
+
+//------------------Implementation of tar_index-------------------------------//
+
+namespace {
+
+struct name_less {
+    explicit name_less(const std::vector<tar_entry>& entries)
+        : entries(&entries)
+        { }
+    bool operator()(std::size_t lhs, std::size_t rhs) const
+    { return (*entries)[lhs].name < (*entries)[rhs].name; }
+    bool operator()(const std::string& lhs, std::size_t rhs) const
+    { return lhs < (*entries)[rhs].name; }
+    const std::vector<tar_entry>* entries;
+};
+
+struct offset_less {
+    bool operator()(stream_offset lhs, const zlib_checkpoint& rhs) const
+    { return lhs < rhs.uncompressed_offset; }
+};
+
+} // End unnamed namespace.
+
+const tar_entry* tar_index::find(const std::string& name) const
+{
+    std::vector<std::size_t>::const_iterator it =
+        std::upper_bound( sorted_.begin(), sorted_.end(),
+                          name, name_less(entries_) );
+    if (it == sorted_.begin() || entries_[*--it].name != name)
+        return 0;
+    return &entries_[*it];
+}
+
+const zlib_checkpoint* tar_index::checkpoint(stream_offset off) const
+{
+    std::vector<zlib_checkpoint>::const_iterator it =
+        std::upper_bound( checkpoints_.begin(), checkpoints_.end(),
+                          off, offset_less() );
+    return it == checkpoints_.begin() ? 0 : &*--it;
+}
+
+void tar_index::add_checkpoint(const zlib_checkpoint& cp)
+{
+    if ( checkpoints_.empty() ||
+         cp.uncompressed_offset > checkpoints_.back().uncompressed_offset )
+    {
+        checkpoints_.push_back(cp);
+    }
+}
+
+void tar_index::build(detail::tar_reader& in)
+{
+    using namespace detail;
+    entries_.clear();
+    checkpoints_.clear();
+    stream_offset  pos = 0;
+    stream_offset  start = -1;  // Offset of first header of next member.
+    overrides      o;
+    char           block[block_size];
+    for (;;) {
+
+        // The archive ends with blocks of null characters, but may be
+        // truncated after the last member
+        std::size_t amt = in.read(block, block_size);
+        if (amt == 0 || (amt == block_size && is_zero(block)))
+            break;
+        if (amt != block_size)
+            boost::throw_exception(tar_error(tar::unexpected_eof));
+        check_checksum(block);
+        stream_offset header = pos;
+        if (start == -1)
+            start = header;
+        pos += block_size;
+        char             type = block[156];
+        boost::uint64_t  size = number(block + 124, 12);
+        if (o.has_size)
+            size = o.size;
+        if (size > static_cast<boost::uint64_t>(
+                       std::numeric_limits<stream_offset>::max() / 2 ) )
+        {
+            boost::throw_exception(tar_error(tar::bad_header));
+        }
+        stream_offset  data = static_cast<stream_offset>(size);
+        stream_offset  padding =
+            -data & static_cast<stream_offset>(block_size - 1);
+
+        // Long names and pax headers apply to the next member; global pax
+        // headers are ignored
+        if (type == 'L' || type == 'K' || type == 'x' || type == 'g') {
+            if (data > max_extended_size)
+                boost::throw_exception(tar_error(tar::bad_header));
+            std::string value(static_cast<std::size_t>(data), '\0');
+            if ( !value.empty() &&
+                 in.read(&value[0], value.size()) != value.size() )
+            {
+                boost::throw_exception(tar_error(tar::unexpected_eof));
+            }
+            in.skip(padding);
+            pos += data + padding;
+            if (type == 'L')
+                o.path = field(value.data(), value.size());
+            else if (type == 'K')
+                o.link_path = field(value.data(), value.size());
+            else if (type == 'x')
+                parse_pax(value, o);
+            else if (start == header)
+                start = -1;
+            continue;
+        }
+
+        // Links, directories and special files have no contents
+        if (type >= tar::hard_link && type <= tar::fifo)
+            data = padding = 0;
+        tar_entry e;
+        e.type = type;
+        e.mode = static_cast<unsigned>(number(block + 100, 8));
+        e.mtime = o.has_mtime ?
+            o.mtime :
+            static_cast<std::time_t>(number(block + 136, 12));
+        if (!o.path.empty()) {
+            e.name = o.path;
+        } else {
+            e.name = field(block, 100);
+            if (std::memcmp(block + 257, "ustar", 6) == 0) {
+                std::string prefix = field(block + 345, 155);
+                if (!prefix.empty())
+                    e.name = prefix + '/' + e.name;
+            }
+        }
+        e.link_name = !o.link_path.empty() ?
+            o.link_path :
+            field(block + 157, 100);
+        e.header_offset = start;
+        e.data_offset = pos;
+        e.size = data;
+        if (!in.skip(data))
+            boost::throw_exception(tar_error(tar::unexpected_eof));
+        in.skip(padding);
+        pos += data + padding;
+        entries_.push_back(e);
+        start = -1;
+        o = overrides();
+    }
+    sort();
+}
+
+std::string tar_index::serialize() const
+{
+    using namespace detail;
+    std::string result(index_magic, 8);
+    store(result, entries_.size(), 8);
+    store(result, checkpoints_.size(), 8);
+    for (std::size_t z = 0; z < entries_.size(); ++z) {
+        const tar_entry& e = entries_[z];
+        store(result, e.header_offset, 8);
+        store(result, e.data_offset, 8);
+        store(result, e.size, 8);
+        store(result, static_cast<boost::uint64_t>(e.mtime), 8);
+        store(result, e.mode, 4);
+        store(result, static_cast<unsigned char>(e.type), 1);
+        store(result, e.name);
+        store(result, e.link_name);
+    }
+    for (std::size_t z = 0; z < checkpoints_.size(); ++z) {
+        const zlib_checkpoint& cp = checkpoints_[z];
+        store(result, cp.compressed_offset, 8);
+        store(result, cp.uncompressed_offset, 8);
+        store(result, cp.crc, 4);
+        store(result, cp.size, 4);
+        store(result, cp.bits, 4);
+        store(result, cp.byte, 4);
+        store(result, cp.window);
+    }
+    return result;
+}
+
+void tar_index::deserialize(const std::string& data)
+{
+    using namespace detail;
+    if (data.size() < 8 || data.compare(0, 8, index_magic) != 0)
+        boost::throw_exception(tar_error(tar::bad_index));
+    index_parser                  p(data);
+    std::vector<tar_entry>        entries;
+    std::vector<zlib_checkpoint>  checkpoints;
+    p.load(8);
+    boost::uint64_t  entry_count = p.load(8),
+                     checkpoint_count = p.load(8);
+    if ( entry_count > data.size() / 45 ||
+         checkpoint_count > data.size() / 36 )
+    {
+        boost::throw_exception(tar_error(tar::bad_index));
+    }
+    entries.resize(static_cast<std::size_t>(entry_count));
+    for (std::size_t z = 0; z < entries.size(); ++z) {
+        tar_entry& e = entries[z];
+        e.header_offset = static_cast<stream_offset>(p.load(8));
+        e.data_offset = static_cast<stream_offset>(p.load(8));
+        e.size = static_cast<stream_offset>(p.load(8));
+        e.mtime = static_cast<std::time_t>(p.load(8));
+        e.mode = static_cast<unsigned>(p.load(4));
+        e.type = static_cast<char>(p.load(1));
+        e.name = p.load_string();
+        e.link_name = p.load_string();
+        if (e.header_offset < 0 || e.data_offset < 0 || e.size < 0)
+            boost::throw_exception(tar_error(tar::bad_index));
+    }
+    checkpoints.resize(static_cast<std::size_t>(checkpoint_count));
+    for (std::size_t z = 0; z < checkpoints.size(); ++z) {
+        zlib_checkpoint& cp = checkpoints[z];
+        cp.compressed_offset = static_cast<std::streamoff>(p.load(8));
+        cp.uncompressed_offset = static_cast<std::streamoff>(p.load(8));
+        cp.crc = static_cast<zlib::ulong>(p.load(4));
+        cp.size = static_cast<zlib::ulong>(p.load(4));
+        cp.bits = static_cast<int>(p.load(4));
+        cp.byte = static_cast<int>(p.load(4));
+        cp.window = p.load_string();
+        if ( z != 0 &&
+             cp.uncompressed_offset <= checkpoints[z - 1].uncompressed_offset )
+        {
+            boost::throw_exception(tar_error(tar::bad_index));
+        }
+    }
+    if (!p.done())
+        boost::throw_exception(tar_error(tar::bad_index));
+    entries_.swap(entries);
+    checkpoints_.swap(checkpoints);
+    sort();
+}
+
+void tar_index::sort()
+{
+    sorted_.resize(entries_.size());
+    for (std::size_t z = 0, n = entries_.size(); z < n; ++z)
+        sorted_[z] = z;
+    std::stable_sort(sorted_.begin(), sorted_.end(), name_less(entries_));
+}
+
+} } // End namespaces iostreams, boost.
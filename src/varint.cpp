@@ -0,0 +1,451 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Implements the block encoding used by delta_varint_encoder and
+// delta_varint_decoder. Blocks are decoded in two passes over batches of
+// integers: the variable-length values are first parsed into an array and
+// then undergo the zigzag and delta transforms. When SSE2 is available,
+// LEB128 values are parsed sixteen bytes at a time: the high bits of the
+// bytes, gathered with movemask, locate the last byte of each value, and
+// sixteen single-byte values are widened in a single step.
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <climits>  // INT_MAX.
+#include <cstring>  // memcpy, memmove.
+#include <boost/throw_exception.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/config/simd.hpp>
+#include <boost/iostreams/filter/varint.hpp>
+#ifdef BOOST_IOSTREAMS_HAS_SSE2
+# include <emmintrin.h>
+# ifdef BOOST_MSVC
+#  include <intrin.h>
+# endif
+#endif
+
+namespace boost { namespace iostreams {
+
+namespace varint {
+
+                    // Formats
+
+const int leb128            = 0;
+const int group_varint      = 1;
+
+                    // Byte orders
+
+const int little_endian     = 0;
+const int big_endian        = 1;
+
+                    // Status codes
+
+const int okay              = 0;
+const int bad_params        = 1;
+const int partial_integer   = 2;
+const int bad_block_header  = 3;
+const int data_error        = 4;
+const int unexpected_eof    = 5;
+
+} // End namespace varint.
+
+//------------------Implementation of varint_error----------------------------//
+
+varint_error::varint_error(int error)
+    : BOOST_IOSTREAMS_FAILURE("varint error"), error_(error)
+    { }
+
+void varint_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(int error)
+{
+    if (error != varint::okay)
+        boost::throw_exception(varint_error(error));
+}
+
+bool varint_error::check BOOST_PREVENT_MACRO_SUBSTITUTION
+    (int error, boost::system::error_code& ec)
+{
+    if (error == varint::okay)
+        return true;
+    ec.assign(error, varint_category());
+    return false;
+}
+
+//------------------Implementation of varint_category-------------------------//
+
+namespace detail {
+
+class varint_category_impl : public boost::system::error_category {
+public:
+    const char* name() const BOOST_SYSTEM_NOEXCEPT { return "varint"; }
+    std::string message(int ev) const
+    {
+        switch (ev) {
+        case varint::bad_params:
+            return "varint invalid parameters";
+        case varint::partial_integer:
+            return "varint input ends with a partial integer";
+        case varint::bad_block_header:
+            return "varint invalid block header";
+        case varint::data_error:
+            return "varint corrupt encoded data";
+        case varint::unexpected_eof:
+            return "varint unexpected end of data";
+        default:
+            return "varint error";
+        }
+    }
+};
+
+} // End namespace detail.
+
+const boost::system::error_category& varint_category()
+{
+    static const detail::varint_category_impl instance;
+    return instance;
+}
+
+//------------------Implementation of varint_base-----------------------------//
+
+namespace detail {
+
+namespace {
+
+typedef boost::uint64_t  uint64;
+typedef unsigned char    byte;
+
+// The number of integers parsed before they are transformed.
+const std::size_t batch_size = 256;
+
+// Describes the encoded form of integers of a given width.
+struct layout {
+    explicit layout(std::size_t width)
+        : mask(width == 8 ? ~uint64(0) : (uint64(1) << (8 * width)) - 1),
+          max_len((8 * width + 6) / 7),
+          tail_mask(static_cast<byte>(
+              (1u << (8 * width - 7 * (max_len - 1))) - 1
+          ))
+    {
+        if (width <= 4) {
+            for (int c = 0; c < 4; ++c)
+                lengths[c] = static_cast<std::size_t>(c + 1);
+        } else {
+            lengths[0] = 1;
+            lengths[1] = 2;
+            lengths[2] = 4;
+            lengths[3] = width;
+        }
+    }
+    uint64       mask;        // The integers which fit in width characters.
+    std::size_t  max_len;     // The longest LEB128 value.
+    byte         tail_mask;   // The bits allowed in byte max_len - 1.
+    std::size_t  lengths[4];  // The group varint lengths.
+};
+
+uint64 load(const byte* p, std::size_t width, bool big)
+{
+    uint64 v = 0;
+    if (big) {
+        for (std::size_t k = 0; k < width; ++k)
+            v = (v << 8) | p[k];
+    } else {
+        for (std::size_t k = width; k-- != 0; )
+            v = (v << 8) | p[k];
+    }
+    return v;
+}
+
+void store(uint64 v, byte* p, std::size_t width, bool big)
+{
+    if (big) {
+        for (std::size_t k = width; k-- != 0; v >>= 8)
+            p[k] = static_cast<byte>(v);
+    } else {
+        for (std::size_t k = 0; k < width; ++k, v >>= 8)
+            p[k] = static_cast<byte>(v);
+    }
+}
+
+byte* put_leb128(uint64 v, byte* p)
+{
+    while (v >= 0x80) {
+        *p++ = static_cast<byte>(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = static_cast<byte>(v);
+    return p;
+}
+
+// Reads a LEB128 value of at most max_len bytes whose last byte, if it has
+// the maximum length, contains no bits other than those in tail_mask.
+bool get_leb128( const byte*& p, const byte* end, std::size_t max_len,
+                 byte tail_mask, uint64& value )
+{
+    uint64 v = 0;
+    for (std::size_t k = 0; k < max_len && p != end; ++k) {
+        byte b = *p++;
+        if (k == max_len - 1 && (b & ~tail_mask) != 0)
+            return false;
+        v |= static_cast<uint64>(b & 0x7f) << (7 * k);
+        if ((b & 0x80) == 0) {
+            value = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef BOOST_IOSTREAMS_HAS_SSE2
+
+// Returns the index of the lowest set bit of x, which must be non-zero.
+inline int lowest_bit(unsigned x)
+{
+# if defined(__GNUC__)
+    return __builtin_ctz(x);
+# elif defined(BOOST_MSVC)
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return static_cast<int>(index);
+# else
+    int index = 0;
+    for (; (x & 1) == 0; x >>= 1)
+        ++index;
+    return index;
+# endif
+}
+
+// Parses LEB128 values sixteen bytes at a time while at least sixteen
+// bytes and sixteen values remain; returns the number of values parsed, or
+// -1 if a value is too long.
+std::ptrdiff_t parse_leb128_sse2( const byte*& p, const byte* end,
+                                  uint64* values, std::size_t n,
+                                  const layout& l )
+{
+    const __m128i  zero = _mm_setzero_si128();
+    std::size_t    done = 0;
+    while (n - done >= 16 && end - p >= 16) {
+        __m128i   x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned  more = static_cast<unsigned>(_mm_movemask_epi8(x));
+        if (more == 0) {
+
+            // Sixteen single-byte values
+            __m128i  half[2] = { _mm_unpacklo_epi8(x, zero),
+                                 _mm_unpackhi_epi8(x, zero) };
+            __m128i* out = reinterpret_cast<__m128i*>(values + done);
+            for (int h = 0; h < 2; ++h) {
+                __m128i quarter[2] = { _mm_unpacklo_epi16(half[h], zero),
+                                       _mm_unpackhi_epi16(half[h], zero) };
+                for (int q = 0; q < 2; ++q) {
+                    _mm_storeu_si128(
+                        out++, _mm_unpacklo_epi32(quarter[q], zero)
+                    );
+                    _mm_storeu_si128(
+                        out++, _mm_unpackhi_epi32(quarter[q], zero)
+                    );
+                }
+            }
+            p += 16;
+            done += 16;
+            continue;
+        }
+
+        // Parse the values which end within the window
+        unsigned ends = ~more & 0xffff;
+        if (ends == 0)
+            return -1;
+        const byte* window = p;
+        do {
+            const byte*  last = window + lowest_bit(ends);
+            std::size_t  len = static_cast<std::size_t>(last - p) + 1;
+            if ( len > l.max_len ||
+                 (len == l.max_len && (*last & ~l.tail_mask) != 0) )
+            {
+                return -1;
+            }
+            uint64 v = 0;
+            for (std::size_t k = 0; k < len; ++k)
+                v |= static_cast<uint64>(p[k] & 0x7f) << (7 * k);
+            values[done++] = v;
+            p = last + 1;
+            ends &= ends - 1;
+        } while (ends != 0);
+    }
+    return static_cast<std::ptrdiff_t>(done);
+}
+
+#endif // #ifdef BOOST_IOSTREAMS_HAS_SSE2
+
+// Parses n LEB128 values; returns false if the data is malformed.
+bool parse_leb128( const byte*& p, const byte* end, uint64* values,
+                   std::size_t n, const layout& l )
+{
+    std::size_t done = 0;
+#ifdef BOOST_IOSTREAMS_HAS_SSE2
+    std::ptrdiff_t parsed = parse_leb128_sse2(p, end, values, n, l);
+    if (parsed < 0)
+        return false;
+    done = static_cast<std::size_t>(parsed);
+#endif
+    for (; done < n; ++done)
+        if (!get_leb128(p, end, l.max_len, l.tail_mask, values[done]))
+            return false;
+    return true;
+}
+
+// Parses n group varint values, where n is a multiple of four unless the
+// values end the block; returns false if the data is malformed.
+bool parse_group_varint( const byte*& p, const byte* end, uint64* values,
+                         std::size_t n, const layout& l, std::size_t width )
+{
+    for (std::size_t i = 0; i < n; i += 4) {
+        if (p == end)
+            return false;
+        unsigned     control = *p++;
+        std::size_t  k = (std::min)(n - i, std::size_t(4));
+        if (k < 4 && (control >> (2 * k)) != 0)
+            return false;
+        for (std::size_t j = 0; j < k; ++j, control >>= 2) {
+            std::size_t len = l.lengths[control & 3];
+            if (len > width || static_cast<std::size_t>(end - p) < len)
+                return false;
+            uint64 v;
+#ifdef BOOST_IOSTREAMS_HAS_SSE2
+
+            // The target is little-endian and allows unaligned access
+            if (end - p >= 8) {
+                std::memcpy(&v, p, 8);
+                if (len < 8)
+                    v &= (uint64(1) << (8 * len)) - 1;
+            } else
+#endif
+            v = load(p, len, false);
+            values[i + j] = v;
+            p += len;
+        }
+    }
+    return true;
+}
+
+} // End unnamed namespace.
+
+varint_base::varint_base(const varint_params& p)
+    : width_(static_cast<std::size_t>(p.width)), format_(p.format),
+      byte_order_(p.byte_order), block_size_(p.block_size), last_(0)
+{
+    // The buffers used by the filters must have sizes representable as int
+    if ( p.width < 1 || p.width > 8 ||
+         (format_ != varint::leb128 && format_ != varint::group_varint) ||
+         ( byte_order_ != varint::little_endian &&
+           byte_order_ != varint::big_endian ) ||
+         block_size_ == 0 || block_size_ > INT_MAX / 16 )
+    {
+        boost::throw_exception(varint_error(varint::bad_params));
+    }
+}
+
+std::size_t varint_base::max_encoded_size() const
+{
+    return header_size + block_size_ * layout(width_).max_len +
+           (block_size_ + 3) / 4;
+}
+
+std::size_t varint_base::encode_block
+    (const char* src, std::size_t count, char* dest)
+{
+    // Encode the body after the largest possible header, then move it
+    // into place once its size is known
+    layout       l(width_);
+    bool         big = byte_order_ == varint::big_endian;
+    const byte*  in = reinterpret_cast<const byte*>(src);
+    byte*        body = reinterpret_cast<byte*>(dest) + header_size;
+    byte*        out = body;
+    byte*        control = 0;
+    for (std::size_t i = 0; i < count; ++i, in += width_) {
+        uint64 value = load(in, width_, big),
+               delta = (value - last_) & l.mask,
+               sign = (delta >> (8 * width_ - 1)) != 0 ? l.mask : 0,
+               zigzag = ((delta << 1) ^ sign) & l.mask;
+        last_ = value;
+        if (format_ == varint::leb128) {
+            out = put_leb128(zigzag, out);
+            continue;
+        }
+        if (i % 4 == 0) {
+            control = out++;
+            *control = 0;
+        }
+        std::size_t needed = 1;
+        while (needed < 8 && (zigzag >> (8 * needed)) != 0)
+            ++needed;
+        unsigned c = 0;
+        while (l.lengths[c] < needed)
+            ++c;
+        *control |= static_cast<byte>(c << (2 * (i % 4)));
+        store(zigzag, out, l.lengths[c], false);
+        out += l.lengths[c];
+    }
+    std::size_t  len = static_cast<std::size_t>(out - body);
+    byte         header[header_size];
+    byte*        end = put_leb128(len, put_leb128(count, header));
+    std::size_t  header_len = static_cast<std::size_t>(end - header);
+    std::memmove(dest + header_len, body, len);
+    std::memcpy(dest, header, header_len);
+    return header_len + len;
+}
+
+int varint_base::decode_header
+    ( const char* header, std::size_t len, std::size_t& count,
+      std::size_t& body_len ) const
+{
+    const byte*  p = reinterpret_cast<const byte*>(header);
+    const byte*  end = p + len;
+    uint64       c, b;
+    if ( !get_leb128(p, end, 10, 1, c) || !get_leb128(p, end, 10, 1, b) ||
+         p != end || c == 0 || c > block_size_ || b < c ||
+         b > max_encoded_size() - header_size )
+    {
+        return varint::bad_block_header;
+    }
+    count = static_cast<std::size_t>(c);
+    body_len = static_cast<std::size_t>(b);
+    return varint::okay;
+}
+
+int varint_base::decode_block
+    (const char* body, std::size_t len, std::size_t count, char* dest)
+{
+    layout       l(width_);
+    bool         big = byte_order_ == varint::big_endian;
+    const byte*  p = reinterpret_cast<const byte*>(body);
+    const byte*  end = p + len;
+    byte*        out = reinterpret_cast<byte*>(dest);
+    uint64       values[batch_size];
+    uint64       last = last_;
+    for (std::size_t i = 0; i < count; i += batch_size) {
+        std::size_t n = (std::min)(count - i, batch_size);
+        bool ok = format_ == varint::leb128 ?
+            parse_leb128(p, end, values, n, l) :
+            parse_group_varint(p, end, values, n, l, width_);
+        if (!ok)
+            return varint::data_error;
+        for (std::size_t j = 0; j < n; ++j, out += width_) {
+            uint64 z = values[j];
+            last = (last + ((z >> 1) ^ (0 - (z & 1)))) & l.mask;
+            store(last, out, width_, big);
+        }
+    }
+    if (p != end)
+        return varint::data_error;
+    last_ = last;
+    return varint::okay;
+}
+
+} // End namespace detail.
+
+} } // End namespaces iostreams, boost.
@@ -0,0 +1,741 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// To configure Boost to work with zlib, see the
+// installation instructions here:
+// http://boost.org/libs/iostreams/doc/index.html?path=7
+
+// Define BOOST_IOSTREAMS_SOURCE so that <boost/iostreams/detail/config.hpp>
+// knows that we are building the library (possibly exporting code), rather
+// than using it (possibly importing code).
+#define BOOST_IOSTREAMS_SOURCE
+
+#include <algorithm>  // lower_bound, min, stable_sort.
+#include <climits>    // UINT_MAX.
+#include <cstring>    // memset.
+#include <limits>     // numeric_limits.
+#include <new>        // bad_alloc.
+#include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/throw_exception.hpp>
+#include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/iostreams/device/zip_archive.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include "zlib_backend.hpp"
+
+namespace boost { namespace iostreams {
+
+namespace zip {
+
+                    // Status codes
+
+const int okay                = 0;
+const int bad_archive         = 1;
+const int bad_local_header    = 2;
+const int multiple_disks      = 3;
+const int unsupported_method  = 4;
+const int encrypted           = 5;
+const int data_error          = 6;
+const int crc_error           = 7;
+const int unexpected_eof      = 8;
+const int member_not_found    = 9;
+
+} // End namespace zip.
+
+//------------------Implementation of zip_error-------------------------------//
+
+zip_error::zip_error(int error)
+    : BOOST_IOSTREAMS_FAILURE("zip error"), error_(error)
+    { }
+
+void zip_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(int error)
+{
+    if (error != zip::okay)
+        boost::throw_exception(zip_error(error));
+}
+
+//------------------Implementation of zip_category----------------------------//
+
+namespace detail {
+
+class zip_category_impl : public boost::system::error_category {
+public:
+    const char* name() const BOOST_SYSTEM_NOEXCEPT { return "zip"; }
+    std::string message(int ev) const
+    {
+        switch (ev) {
+        case zip::bad_archive:
+            return "zip invalid central directory";
+        case zip::bad_local_header:
+            return "zip invalid local header";
+        case zip::multiple_disks:
+            return "zip archives spanning several disks are not supported";
+        case zip::unsupported_method:
+            return "zip unsupported compression method";
+        case zip::encrypted:
+            return "zip encrypted members are not supported";
+        case zip::data_error:
+            return "zip invalid compressed data";
+        case zip::crc_error:
+            return "zip member does not match its crc or size";
+        case zip::unexpected_eof:
+            return "zip unexpected end of data";
+        case zip::member_not_found:
+            return "zip no such member";
+        default:
+            return "zip error";
+        }
+    }
+};
+
+} // End namespace detail.
+
+const boost::system::error_category& zip_category()
+{
+    static const detail::zip_category_impl instance;
+    return instance;
+}
+
+//------------------Implementation of zip_archive_impl------------------------//
+
+namespace detail {
+
+namespace {
+
+const boost::uint32_t local_header_signature    = 0x04034b50;
+const boost::uint32_t central_header_signature  = 0x02014b50;
+const boost::uint32_t end_signature             = 0x06054b50;
+const boost::uint32_t zip64_end_signature       = 0x06064b50;
+const boost::uint32_t zip64_locator_signature   = 0x07064b50;
+const std::size_t     local_header_size         = 30;
+const std::size_t     central_header_size       = 46;
+const std::size_t     end_size                  = 22;
+const std::size_t     zip64_end_size            = 56;
+const std::size_t     zip64_locator_size        = 20;
+const std::size_t     max_comment_size          = 0xffff;
+const boost::uint16_t zip64_extra_id            = 0x0001;
+
+boost::uint16_t load16(const char* p)
+{
+    const unsigned char* q = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<boost::uint16_t>(q[0] | (q[1] << 8));
+}
+
+boost::uint32_t load32(const char* p)
+{
+    return load16(p) | (static_cast<boost::uint32_t>(load16(p + 2)) << 16);
+}
+
+boost::uint64_t load64(const char* p)
+{
+    return load32(p) | (static_cast<boost::uint64_t>(load32(p + 4)) << 32);
+}
+
+// Returns the address of the first element of v, which may be empty
+char* address(std::vector<char>& v) { return v.empty() ? 0 : &v[0]; }
+
+} // End unnamed namespace.
+
+class zip_archive_impl {
+public:
+    explicit zip_archive_impl(const shared_ptr<zip_device>& dev);
+    const zip_entry* find(const std::string& name) const;
+
+    // Returns the position of the contents of the given member, after
+    // checking that they can be read.
+    stream_offset data_offset(const zip_entry& e) const;
+
+    // Fills buf with n characters starting at the given offset.
+    void read(stream_offset off, std::vector<char>& buf, std::size_t n) const;
+
+    shared_ptr<zip_device>    dev;
+    std::vector<zip_entry>    entries;
+    std::vector<std::size_t>  sorted;  // Indices of entries, sorted by name.
+private:
+    struct name_less {
+        explicit name_less(const std::vector<zip_entry>& entries)
+            : entries(&entries)
+            { }
+        bool operator()(std::size_t lhs, std::size_t rhs) const
+        { return (*entries)[lhs].name < (*entries)[rhs].name; }
+        bool operator()(std::size_t lhs, const std::string& rhs) const
+        { return (*entries)[lhs].name < rhs; }
+        const std::vector<zip_entry>* entries;
+    };
+    void read_directory(stream_offset off, stream_offset size,
+                        boost::uint64_t count);
+};
+
+zip_archive_impl::zip_archive_impl(const shared_ptr<zip_device>& d)
+    : dev(d)
+{
+    // Locate the end of central directory record, which is followed only
+    // by the archive comment
+    stream_offset size = dev->size();
+    std::size_t tail = static_cast<std::size_t>(
+        (std::min)(size, static_cast<stream_offset>(end_size +
+                                                     max_comment_size))
+    );
+    if (tail < end_size)
+        boost::throw_exception(zip_error(zip::bad_archive));
+    std::vector<char> buf;
+    read(size - tail, buf, tail);
+    std::size_t pos = tail - end_size + 1;
+    while (pos-- > 0)
+        if ( load32(&buf[pos]) == end_signature &&
+             pos + end_size + load16(&buf[pos + 20]) <= tail )
+        {
+            break;
+        }
+    if (pos == static_cast<std::size_t>(-1))
+        boost::throw_exception(zip_error(zip::bad_archive));
+    const char*      end = &buf[pos];
+    stream_offset    end_offset = size - tail + pos;
+    boost::uint64_t  count = load16(end + 10);
+    boost::uint64_t  dir_size = load32(end + 12);
+    boost::uint64_t  dir_offset = load32(end + 16);
+    if ( load16(end + 4) != 0 || load16(end + 6) != 0 ||
+         load16(end + 8) != count )
+    {
+        boost::throw_exception(zip_error(zip::multiple_disks));
+    }
+
+    // Use the ZIP64 end of central directory record, if present
+    if ( end_offset >= static_cast<stream_offset>(zip64_locator_size) &&
+         ( count == 0xffff || dir_size == 0xffffffff ||
+           dir_offset == 0xffffffff ||
+           ( pos >= zip64_locator_size &&
+             load32(end - zip64_locator_size) == zip64_locator_signature ) ) )
+    {
+        std::vector<char> locator;
+        read(end_offset - zip64_locator_size, locator, zip64_locator_size);
+        if (load32(&locator[0]) == zip64_locator_signature) {
+            if (load32(&locator[4]) != 0 || load32(&locator[16]) > 1)
+                boost::throw_exception(zip_error(zip::multiple_disks));
+            boost::uint64_t off = load64(&locator[8]);
+            if (off > static_cast<boost::uint64_t>(size - zip64_end_size))
+                boost::throw_exception(zip_error(zip::bad_archive));
+            std::vector<char> end64;
+            read(static_cast<stream_offset>(off), end64, zip64_end_size);
+            const char* p = &end64[0];
+            if (load32(p) != zip64_end_signature)
+                boost::throw_exception(zip_error(zip::bad_archive));
+            if ( load32(p + 16) != 0 || load32(p + 20) != 0 ||
+                 load64(p + 24) != load64(p + 32) )
+            {
+                boost::throw_exception(zip_error(zip::multiple_disks));
+            }
+            count = load64(p + 32);
+            dir_size = load64(p + 40);
+            dir_offset = load64(p + 48);
+        }
+    }
+    if ( dir_offset > static_cast<boost::uint64_t>(size) ||
+         dir_size > static_cast<boost::uint64_t>(size) - dir_offset ||
+         count > dir_size / central_header_size )
+    {
+        boost::throw_exception(zip_error(zip::bad_archive));
+    }
+    read_directory( static_cast<stream_offset>(dir_offset),
+                    static_cast<stream_offset>(dir_size), count );
+}
+
+void zip_archive_impl::read_directory
+    (stream_offset off, stream_offset size, boost::uint64_t count)
+{
+    std::vector<char> buf;
+    read(off, buf, static_cast<std::size_t>(size));
+    entries.reserve(static_cast<std::size_t>(count));
+    stream_offset  archive_size = dev->size();
+    const char*    p = address(buf);
+    const char*    end = p + buf.size();
+    for (boost::uint64_t z = 0; z < count; ++z) {
+        if ( static_cast<std::size_t>(end - p) < central_header_size ||
+             load32(p) != central_header_signature )
+        {
+            boost::throw_exception(zip_error(zip::bad_archive));
+        }
+        std::size_t name_size = load16(p + 28);
+        std::size_t extra_size = load16(p + 30);
+        std::size_t comment_size = load16(p + 32);
+        std::size_t record_size =
+            central_header_size + name_size + extra_size + comment_size;
+        if (static_cast<std::size_t>(end - p) < record_size)
+            boost::throw_exception(zip_error(zip::bad_archive));
+        zip_entry e;
+        e.flags = load16(p + 8);
+        e.method = load16(p + 10);
+        e.crc = load32(p + 16);
+        boost::uint64_t  compressed_size = load32(p + 20);
+        boost::uint64_t  size = load32(p + 24);
+        boost::uint64_t  header_offset = load32(p + 42);
+        boost::uint32_t  disk = load16(p + 34);
+        e.name.assign(p + central_header_size, name_size);
+
+        // Fields which don't fit are stored in the ZIP64 extra field, in
+        // the order below
+        const char* extra = p + central_header_size + name_size;
+        const char* extra_end = extra + extra_size;
+        while (extra_end - extra >= 4) {
+            std::size_t id = load16(extra), len = load16(extra + 2);
+            const char* q = extra + 4;
+            if (len > static_cast<std::size_t>(extra_end - q))
+                break;
+            if (id == zip64_extra_id) {
+                const char* q_end = q + len;
+                if (size == 0xffffffff && q_end - q >= 8)
+                    size = load64(q), q += 8;
+                if (compressed_size == 0xffffffff && q_end - q >= 8)
+                    compressed_size = load64(q), q += 8;
+                if (header_offset == 0xffffffff && q_end - q >= 8)
+                    header_offset = load64(q), q += 8;
+                if (disk == 0xffff && q_end - q >= 4)
+                    disk = load32(q);
+            }
+            extra += 4 + len;
+        }
+        if (disk != 0)
+            boost::throw_exception(zip_error(zip::multiple_disks));
+        if ( header_offset > static_cast<boost::uint64_t>(archive_size) ||
+             compressed_size > static_cast<boost::uint64_t>(archive_size) ||
+             size > static_cast<boost::uint64_t>(
+                        std::numeric_limits<stream_offset>::max() ) )
+        {
+            boost::throw_exception(zip_error(zip::bad_archive));
+        }
+        e.compressed_size = static_cast<stream_offset>(compressed_size);
+        e.size = static_cast<stream_offset>(size);
+        e.header_offset = static_cast<stream_offset>(header_offset);
+        entries.push_back(e);
+        p += record_size;
+    }
+
+    // Index the entries by name; the first of several entries with the same
+    // name is found
+    sorted.resize(entries.size());
+    for (std::size_t z = 0, n = entries.size(); z < n; ++z)
+        sorted[z] = z;
+    std::stable_sort(sorted.begin(), sorted.end(), name_less(entries));
+}
+
+const zip_entry* zip_archive_impl::find(const std::string& name) const
+{
+    std::vector<std::size_t>::const_iterator it =
+        std::lower_bound( sorted.begin(), sorted.end(),
+                          name, name_less(entries) );
+    return it != sorted.end() && entries[*it].name == name ?
+        &entries[*it] :
+        0;
+}
+
+stream_offset zip_archive_impl::data_offset(const zip_entry& e) const
+{
+    if ((e.flags & 1) != 0)
+        boost::throw_exception(zip_error(zip::encrypted));
+    if ( e.method != zip::deflated &&
+         (e.method != zip::stored || e.compressed_size != e.size) )
+    {
+        boost::throw_exception(zip_error(
+            e.method == zip::stored ? zip::bad_archive : zip::unsupported_method
+        ));
+    }
+    std::vector<char> header;
+    read(e.header_offset, header, local_header_size);
+    if (load32(&header[0]) != local_header_signature)
+        boost::throw_exception(zip_error(zip::bad_local_header));
+    stream_offset result = e.header_offset + local_header_size +
+                           load16(&header[26]) + load16(&header[28]);
+    if (result > dev->size() - e.compressed_size)
+        boost::throw_exception(zip_error(zip::unexpected_eof));
+    return result;
+}
+
+void zip_archive_impl::read
+    (stream_offset off, std::vector<char>& buf, std::size_t n) const
+{
+    buf.resize(n);
+    std::size_t result = 0;
+    while (result < n) {
+        std::streamsize amt =
+            dev->read_at( off + result, &buf[result],
+                          static_cast<std::streamsize>(
+                              (std::min)(n - result, std::size_t(INT_MAX))
+                          ) );
+        if (amt <= 0)
+            boost::throw_exception(zip_error(zip::unexpected_eof));
+        result += static_cast<std::size_t>(amt);
+    }
+}
+
+zip_device::~zip_device() { }
+
+//------------------Implementation of zip_extractor---------------------------//
+
+// Decompresses a sequence of archive members on a group of threads, each of
+// which takes the next member from the sequence when it is ready.
+class zip_extractor {
+public:
+    zip_extractor( const zip_archive_impl& archive,
+                   const std::vector<std::size_t>& members,
+                   const zip_archive::extract_handler& handler )
+        : archive_(archive), members_(members), handler_(handler), next_(0)
+        { }
+    void run(unsigned threads);
+private:
+    // Decompresses whole members, using libdeflate if it is available,
+    // since the compressed and uncompressed sizes are known in advance.
+    struct inflater {
+        inflater();
+        ~inflater();
+        void run( const char* src, std::size_t compressed_size,
+                  char* dest, std::size_t size );
+    #ifdef BOOST_IOSTREAMS_LIBDEFLATE
+        libdeflate_decompressor*  decompressor;
+    #else
+        zlib_backend::stream      stream;
+    #endif
+    };
+    void work();
+    void extract( const zip_entry& e, inflater& inf,
+                  std::vector<char>& in, std::vector<char>& out );
+    const zip_archive_impl&               archive_;
+    const std::vector<std::size_t>&       members_;
+    const zip_archive::extract_handler&   handler_;
+    boost::mutex                          mtx_;
+    std::size_t                           next_;
+    boost::exception_ptr                  error_;
+};
+
+#ifdef BOOST_IOSTREAMS_LIBDEFLATE
+
+zip_extractor::inflater::inflater()
+    : decompressor(libdeflate_alloc_decompressor())
+{
+    if (!decompressor)
+        boost::throw_exception(std::bad_alloc());
+}
+
+zip_extractor::inflater::~inflater()
+{ libdeflate_free_decompressor(decompressor); }
+
+// libdeflate does not distinguish truncated data from invalid data.
+void zip_extractor::inflater::run
+    (const char* src, std::size_t compressed_size, char* dest, std::size_t size)
+{
+    std::size_t       actual = 0;
+    libdeflate_result status =
+        libdeflate_deflate_decompress( decompressor, src, compressed_size,
+                                       dest, size, &actual );
+    if (status == LIBDEFLATE_BAD_DATA)
+        boost::throw_exception(zip_error(zip::data_error));
+    if (status != LIBDEFLATE_SUCCESS || actual != size)
+        boost::throw_exception(zip_error(zip::crc_error));
+}
+
+#else // #ifdef BOOST_IOSTREAMS_LIBDEFLATE
+
+zip_extractor::inflater::inflater()
+{
+    std::memset(&stream, 0, sizeof(stream));
+    if (zlib_backend::inflate_init(&stream, -MAX_WBITS) != Z_OK)
+        boost::throw_exception(std::bad_alloc());
+}
+
+zip_extractor::inflater::~inflater() { zlib_backend::inflate_end(&stream); }
+
+void zip_extractor::inflater::run
+    (const char* src, std::size_t compressed_size, char* dest, std::size_t size)
+{
+    zlib_backend::stream& s = stream;
+    zlib_backend::inflate_reset(&s);
+    s.next_in = reinterpret_cast<zlib::byte*>(const_cast<char*>(src));
+    s.next_out = reinterpret_cast<zlib::byte*>(dest);
+    std::size_t  in_left = compressed_size, out_left = size;
+    int          status;
+    do {
+        if (s.avail_in == 0 && in_left != 0) {
+            s.avail_in = static_cast<zlib::uint>((std::min)(in_left,
+                                                 std::size_t(UINT_MAX)));
+            in_left -= s.avail_in;
+        }
+        if (s.avail_out == 0 && out_left != 0) {
+            s.avail_out = static_cast<zlib::uint>((std::min)(out_left,
+                                                  std::size_t(UINT_MAX)));
+            out_left -= s.avail_out;
+        }
+        status = zlib_backend::inflate(&s, Z_NO_FLUSH);
+    } while (status == Z_OK);
+    if (status == Z_MEM_ERROR)
+        boost::throw_exception(std::bad_alloc());
+    if (status == Z_BUF_ERROR && s.avail_in == 0 && in_left == 0)
+        boost::throw_exception(zip_error(zip::unexpected_eof));
+    if (status != Z_STREAM_END && status != Z_BUF_ERROR)
+        boost::throw_exception(zip_error(zip::data_error));
+    if (status != Z_STREAM_END || s.avail_out != 0 || out_left != 0)
+        boost::throw_exception(zip_error(zip::crc_error));
+}
+
+#endif // #ifdef BOOST_IOSTREAMS_LIBDEFLATE
+
+void zip_extractor::run(unsigned threads)
+{
+    if (threads == 0)
+        threads = (std::max)(boost::thread::hardware_concurrency(), 1u);
+    if (threads > members_.size())
+        threads = static_cast<unsigned>(members_.size());
+    boost::thread_group group;
+    try {
+        for (unsigned z = 1; z < threads; ++z)
+            group.create_thread(boost::bind(&zip_extractor::work, this));
+    } catch (...) {
+        boost::mutex::scoped_lock lock(mtx_);
+        error_ = boost::current_exception();
+    }
+    work();
+    group.join_all();
+    if (error_)
+        boost::rethrow_exception(error_);
+}
+
+void zip_extractor::work()
+{
+    try {
+        inflater           inf;
+        std::vector<char>  in, out;
+        while (true) {
+            std::size_t n;
+            {
+                boost::mutex::scoped_lock lock(mtx_);
+                if (error_ || next_ == members_.size())
+                    return;
+                n = members_[next_++];
+            }
+            extract(archive_.entries.at(n), inf, in, out);
+        }
+    } catch (...) {
+        boost::mutex::scoped_lock lock(mtx_);
+        if (!error_)
+            error_ = boost::current_exception();
+    }
+}
+
+void zip_extractor::extract
+    ( const zip_entry& e, inflater& inf,
+      std::vector<char>& in, std::vector<char>& out )
+{
+    stream_offset  off = archive_.data_offset(e);
+    const char*    mem = archive_.dev->data();
+    std::size_t    compressed_size =
+        static_cast<std::size_t>(e.compressed_size);
+    std::size_t    size = static_cast<std::size_t>(e.size);
+    const char*    src;
+    if (mem) {
+        src = mem + off;
+    } else {
+        archive_.read(off, in, compressed_size);
+        src = address(in);
+    }
+
+    // Stored members are passed to the handler where they lie
+    const char* result = src;
+    if (e.method == zip::deflated) {
+        out.resize(size);
+        inf.run(src, compressed_size, address(out), size);
+        result = address(out);
+    }
+    if (zlib_backend::crc32(0, result, size) != e.crc)
+        boost::throw_exception(zip_error(zip::crc_error));
+    handler_(e, result, size);
+}
+
+} // End namespace detail.
+
+//------------------Implementation of zip_member_source-----------------------//
+
+class zip_member_source::impl {
+public:
+    impl(const shared_ptr<detail::zip_archive_impl>& archive,
+         const zip_entry& e);
+    std::streamsize read(char* s, std::streamsize n);
+    const zip_entry& entry() const { return entry_; }
+private:
+    struct raw_source {
+        typedef char        char_type;
+        typedef source_tag  category;
+        explicit raw_source(impl& self) : self(&self) { }
+        std::streamsize read(char* s, std::streamsize n)
+        { return self->read_raw(s, n); }
+        impl* self;
+    };
+    std::streamsize read_raw(char* s, std::streamsize n);
+    void finish();
+    shared_ptr<detail::zip_archive_impl>  archive_;
+    zip_entry                             entry_;
+    stream_offset                         offset_;
+    stream_offset                         end_;
+    stream_offset                         size_;
+    zlib::ulong                           crc_;
+    scoped_ptr<zlib_decompressor>         inflater_;
+    bool                                  eof_;
+};
+
+zip_member_source::impl::impl
+    ( const shared_ptr<detail::zip_archive_impl>& archive,
+      const zip_entry& e )
+    : archive_(archive), entry_(e), offset_(archive->data_offset(e)),
+      end_(offset_ + e.compressed_size), size_(0),
+      crc_(0), eof_(false)
+{
+    if (e.method == zip::deflated) {
+        zlib_params p;
+        p.noheader = true;
+        p.calculate_crc = true;
+        inflater_.reset(new zlib_decompressor(p));
+    }
+}
+
+std::streamsize zip_member_source::impl::read(char* s, std::streamsize n)
+{
+    if (eof_)
+        return -1;
+    std::streamsize result;
+    if (inflater_) {
+        try {
+            raw_source src(*this);
+            result = inflater_->read(src, s, n);
+        } catch (const zlib_error&) {
+            boost::throw_exception(zip_error(
+                offset_ == end_ ? zip::unexpected_eof : zip::data_error
+            ));
+        }
+    } else {
+        result = read_raw(s, n);
+        if (result > 0)
+            crc_ = detail::zlib_backend::crc32(
+                       crc_, s, static_cast<std::size_t>(result)
+                   );
+    }
+    if (result == -1) {
+        finish();
+        return -1;
+    }
+    size_ += result;
+    return result;
+}
+
+std::streamsize zip_member_source::impl::read_raw(char* s, std::streamsize n)
+{
+    if (offset_ == end_)
+        return -1;
+    if (n > end_ - offset_)
+        n = static_cast<std::streamsize>(end_ - offset_);
+    std::streamsize result = archive_->dev->read_at(offset_, s, n);
+    if (result <= 0)
+        boost::throw_exception(zip_error(zip::unexpected_eof));
+    offset_ += result;
+    return result;
+}
+
+void zip_member_source::impl::finish()
+{
+    eof_ = true;
+    if (inflater_ && !inflater_->eof())
+        boost::throw_exception(zip_error(zip::unexpected_eof));
+    zlib::ulong crc = inflater_ ? inflater_->crc() : crc_;
+    if (size_ != entry_.size || crc != entry_.crc)
+        boost::throw_exception(zip_error(zip::crc_error));
+}
+
+zip_member_source::zip_member_source(impl* pimpl) : pimpl_(pimpl) { }
+
+std::streamsize zip_member_source::read(char* s, std::streamsize n)
+{ return pimpl_->read(s, n); }
+
+const zip_entry& zip_member_source::entry() const { return pimpl_->entry(); }
+
+//------------------Implementation of zip_archive-----------------------------//
+
+zip_archive::zip_archive(const std::string& path)
+{
+    init(new detail::zip_direct_device<mapped_file_source>(
+             mapped_file_source(path)
+         ));
+}
+
+zip_archive::zip_archive(const char* path)
+{
+    init(new detail::zip_direct_device<mapped_file_source>(
+             mapped_file_source(path)
+         ));
+}
+
+zip_archive::size_type zip_archive::size() const
+{ return pimpl_->entries.size(); }
+
+zip_archive::const_iterator zip_archive::begin() const
+{ return pimpl_->entries.begin(); }
+
+zip_archive::const_iterator zip_archive::end() const
+{ return pimpl_->entries.end(); }
+
+const zip_entry& zip_archive::operator[](size_type n) const
+{ return pimpl_->entries[n]; }
+
+const zip_entry* zip_archive::find(const std::string& name) const
+{ return pimpl_->find(name); }
+
+zip_member_source zip_archive::open(const zip_entry& e) const
+{ return zip_member_source(new zip_member_source::impl(pimpl_, e)); }
+
+zip_member_source zip_archive::open(const std::string& name) const
+{
+    const zip_entry* e = find(name);
+    if (!e)
+        boost::throw_exception(zip_error(zip::member_not_found));
+    return open(*e);
+}
+
+std::pair<const char*, const char*>
+zip_archive::data(const zip_entry& e) const
+{
+    const char* mem = pimpl_->dev->data();
+    if (!mem || e.method != zip::stored)
+        return std::pair<const char*, const char*>(0, 0);
+    const char* begin = mem + pimpl_->data_offset(e);
+    return std::make_pair(begin, begin + e.size);
+}
+
+void zip_archive::extract
+    (const extract_handler& handler, unsigned threads) const
+{
+    std::vector<size_type> members;
+    for (size_type z = 0, n = size(); z < n; ++z)
+        if (!pimpl_->entries[z].is_directory())
+            members.push_back(z);
+    extract(members, handler, threads);
+}
+
+void zip_archive::extract
+    ( const std::vector<size_type>& members,
+      const extract_handler& handler,
+      unsigned threads ) const
+{
+    detail::zip_extractor(*pimpl_, members, handler).run(threads);
+}
+
+void zip_archive::init(detail::zip_device* dev)
+{
+    shared_ptr<detail::zip_device> p(dev);
+    pimpl_.reset(new detail::zip_archive_impl(p));
+}
+
+//----------------------------------------------------------------------------//
+
+} } // End namespaces iostreams, boost.
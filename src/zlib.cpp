@@ -16,11 +16,9 @@
 
 #include <boost/throw_exception.hpp>
 #include <boost/iostreams/detail/config/dyn_link.hpp>
+#include <boost/iostreams/detail/probe.hpp>
 #include <boost/iostreams/filter/zlib.hpp> 
-#include "zlib.h"   // Jean-loup Gailly's and Mark Adler's "zlib.h" header.
-                    // To configure Boost to work with zlib, see the 
-                    // installation instructions here:
-                    // http://boost.org/libs/iostreams/doc/index.html?path=7
+#include "zlib_backend.hpp"
 
 namespace boost { namespace iostreams {
 
@@ -58,6 +56,7 @@ const int buf_error            = Z_BUF_ERROR;
 const int finish               = Z_FINISH;
 const int no_flush             = Z_NO_FLUSH;
 const int sync_flush           = Z_SYNC_FLUSH;
+const int full_flush           = Z_FULL_FLUSH;
 
                     // Code for current OS
 
@@ -86,20 +85,73 @@ void zlib_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(int error)
     }
 }
 
+bool zlib_error::check BOOST_PREVENT_MACRO_SUBSTITUTION
+    (int error, boost::system::error_code& ec)
+{
+    switch (error) {
+    case Z_OK: 
+    case Z_STREAM_END: 
+        return true;
+    case Z_MEM_ERROR: 
+        ec = boost::system::errc::make_error_code(
+                 boost::system::errc::not_enough_memory
+             );
+        return false;
+    default:
+        ec.assign(error, zlib_category());
+        return false;
+    }
+}
+
+//------------------Implementation of zlib_category---------------------------//
+
+namespace detail {
+
+class zlib_category_impl : public boost::system::error_category {
+public:
+    const char* name() const BOOST_SYSTEM_NOEXCEPT { return "zlib"; }
+    std::string message(int ev) const
+    {
+        switch (ev) {
+        case Z_STREAM_ERROR:  return "zlib stream error";
+        case Z_DATA_ERROR:    return "zlib data error";
+        case Z_MEM_ERROR:     return "zlib out of memory";
+        case Z_BUF_ERROR:     return "zlib buffer error";
+        case Z_VERSION_ERROR: return "zlib version error";
+        case Z_NEED_DICT:     return "zlib dictionary needed";
+        case Z_ERRNO:         return "zlib file error";
+        default:              return "zlib error";
+        }
+    }
+};
+
+} // End namespace detail.
+
+const boost::system::error_category& zlib_category()
+{
+    static const detail::zlib_category_impl instance;
+    return instance;
+}
+
 //------------------Implementation of zlib_base-------------------------------//
 
 namespace detail {
 
+namespace zb = zlib_backend;
+
 zlib_base::zlib_base()
-    : stream_(new z_stream), calculate_crc_(false), crc_(0), crc_imp_(0)
+    : stream_(new zb::stream), calculate_crc_(false), compress_(false),
+      window_bits_(0), crc_(0), crc_imp_(0), total_in_(0), total_out_(0),
+      compressed_base_(0), uncompressed_base_(0), spacing_(0),
+      has_checkpoint_(false), last_byte_(0)
     { }
 
-zlib_base::~zlib_base() { delete static_cast<z_stream*>(stream_); }
+zlib_base::~zlib_base() { delete static_cast<zb::stream*>(stream_); }
 
 void zlib_base::before( const char*& src_begin, const char* src_end,
                         char*& dest_begin, char* dest_end )
 {
-    z_stream* s = static_cast<z_stream*>(stream_);
+    zb::stream* s = static_cast<zb::stream*>(stream_);
     s->next_in = reinterpret_cast<zlib::byte*>(const_cast<char*>(src_begin));
     s->avail_in = static_cast<zlib::uint>(src_end - src_begin);
     s->next_out = reinterpret_cast<zlib::byte*>(dest_begin);
@@ -108,8 +160,8 @@ void zlib_base::before( const char*& src_begin, const char* src_end,
 
 void zlib_base::after(const char*& src_begin, char*& dest_begin, bool compress)
 {
-    z_stream* s = static_cast<z_stream*>(stream_);
-    char* next_in = reinterpret_cast<char*>(s->next_in);
+    zb::stream* s = static_cast<zb::stream*>(stream_);
+    const char* next_in = reinterpret_cast<const char*>(s->next_in);
     char* next_out = reinterpret_cast<char*>(s->next_out);
     if (calculate_crc_) {
         const zlib::byte* buf = compress ?
@@ -121,68 +173,204 @@ void zlib_base::after(const char*& src_begin, char*& dest_begin, bool compress)
             static_cast<zlib::uint>(next_in - src_begin) :
             static_cast<zlib::uint>(next_out - dest_begin);
         if (length > 0)
-            crc_ = crc_imp_ = crc32(crc_imp_, buf, length);
+            crc_ = crc_imp_ = zb::crc32(crc_imp_, buf, length);
     }
     total_in_ = s->total_in;
     total_out_ = s->total_out;
-    src_begin = const_cast<const char*>(next_in);
+    src_begin = next_in;
     dest_begin = next_out;
 }
 
 int zlib_base::xdeflate(int flush)
 { 
-    return ::deflate(static_cast<z_stream*>(stream_), flush);
+    zb::stream* s = static_cast<zb::stream*>(stream_);
+    BOOST_IOSTREAMS_PROBE4(
+        zlib_deflate_start, this, s->avail_in, s->avail_out, flush
+    );
+    int result = zb::deflate(s, flush);
+    BOOST_IOSTREAMS_PROBE4(
+        zlib_deflate_done, this, s->avail_in, s->avail_out, result
+    );
+    return result;
 }
 
 int zlib_base::xinflate(int flush)
 { 
-    return ::inflate(static_cast<z_stream*>(stream_), flush);
+    zb::stream* s = static_cast<zb::stream*>(stream_);
+    if (spacing_ != 0 && flush == Z_SYNC_FLUSH)
+        return xinflate_blocks();
+    BOOST_IOSTREAMS_PROBE4(
+        zlib_inflate_start, this, s->avail_in, s->avail_out, flush
+    );
+    int result = zb::inflate(s, flush);
+    BOOST_IOSTREAMS_PROBE4(
+        zlib_inflate_done, this, s->avail_in, s->avail_out, result
+    );
+    return result;
 }
 
 void zlib_base::reset(bool compress, bool realloc)
 {
-    z_stream* s = static_cast<z_stream*>(stream_);
+    zb::stream* s = static_cast<zb::stream*>(stream_);
     // Undiagnosed bug:
     // deflateReset(), etc., return Z_DATA_ERROR
+    // inflateReset2() undoes the switch to raw inflate made by restore().
     //zlib_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(
         realloc ?
-            (compress ? deflateReset(s) : inflateReset(s)) :
-            (compress ? deflateEnd(s) : inflateEnd(s))
+            (compress ?
+                zb::deflate_reset(s) :
+                zb::inflate_reset(s, window_bits_)) :
+            (compress ? zb::deflate_end(s) : zb::inflate_end(s))
                 ;
     //);
     crc_imp_ = 0;
+    compressed_base_ = uncompressed_base_ = 0;
+}
+
+void zlib_base::restore(const zlib_checkpoint& cp)
+{
+    zb::stream* s = static_cast<zb::stream*>(stream_);
+    if (compress_) {
+
+        // A raw deflate stream can be continued by a new one after a sync
+        // point; a zlib header and checksum cannot.
+        if (window_bits_ > 0)
+            boost::throw_exception(zlib_error(Z_STREAM_ERROR));
+        zlib_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(
+            zb::deflate_reset(s)
+        );
+        s->total_in = cp.size;
+    } else {
+
+        // Resume with a raw inflate primed with the partially consumed byte
+        // and the preceding output, as in zlib's example zran.c.
+        int window_bits = window_bits_ < 0 ? -window_bits_ : window_bits_;
+        zlib_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(
+            zb::inflate_reset(s, -window_bits)
+        );
+        if (cp.bits != 0)
+            zlib_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(
+                zb::inflate_prime(s, cp.bits, cp.byte >> (8 - cp.bits))
+            );
+        if (!cp.window.empty())
+            zlib_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(
+                zb::inflate_set_dictionary(
+                    s, 
+                    reinterpret_cast<const zlib::byte*>(cp.window.data()), 
+                    static_cast<zlib::uint>(cp.window.size())
+                )
+            );
+        s->total_out = cp.size;
+    }
+    crc_ = crc_imp_ = cp.crc;
+    total_in_ = s->total_in;
+    total_out_ = s->total_out;
+    compressed_base_ = cp.compressed_offset;
+    uncompressed_base_ = cp.uncompressed_offset - cp.size;
+}
+
+std::streamoff zlib_base::compressed_offset() const
+{
+    zb::stream* s = static_cast<zb::stream*>(stream_);
+    return compressed_base_ + 
+           static_cast<std::streamoff>(compress_ ? s->total_out : s->total_in);
+}
+
+std::streamoff zlib_base::uncompressed_offset() const
+{
+    zb::stream* s = static_cast<zb::stream*>(stream_);
+    return uncompressed_base_ + 
+           static_cast<std::streamoff>(compress_ ? s->total_in : s->total_out);
+}
+
+void zlib_base::set_offsets
+    (std::streamoff compressed, std::streamoff uncompressed)
+{
+    compressed_base_ += compressed - compressed_offset();
+    uncompressed_base_ += uncompressed - uncompressed_offset();
+}
+
+// Inflates as much as possible, stopping at each deflate block boundary to
+// record a checkpoint if one is due.
+int zlib_base::xinflate_blocks()
+{
+    zb::stream*        s = static_cast<zb::stream*>(stream_);
+    const zlib::byte*  begin_in = s->next_in;
+    const zlib::byte*  begin_out = s->next_out;
+    int                result;
+    while (true) {
+        result = xinflate(Z_BLOCK);
+        if (s->next_in != begin_in)
+            last_byte_ = s->next_in[-1];
+        if (result != Z_OK || (s->data_type & 128) == 0)
+            break;
+        if ((s->data_type & 64) == 0) // Not after the last block.
+            save_checkpoint(begin_out);
+        if (s->avail_in == 0 || s->avail_out == 0)
+            break;
+    }
+    return result;
+}
+
+void zlib_base::save_checkpoint(const zlib::byte* begin_out)
+{
+    zb::stream* s = static_cast<zb::stream*>(stream_);
+    if ( has_checkpoint_ && 
+         uncompressed_offset() - checkpoint_.uncompressed_offset < spacing_ )
+    {
+        return;
+    }
+    zlib_checkpoint& cp = checkpoint_;
+    cp.compressed_offset = compressed_offset();
+    cp.uncompressed_offset = uncompressed_offset();
+    cp.crc = calculate_crc_ ?
+        zb::crc32( crc_imp_, begin_out, 
+                   static_cast<zlib::uint>(s->next_out - begin_out) ) :
+        0;
+    cp.size = static_cast<zlib::ulong>(s->total_out);
+    cp.bits = s->data_type & 7;
+    cp.byte = cp.bits != 0 ? last_byte_ : 0;
+    zlib::uint length = 0;
+    cp.window.resize(32768);
+    zb::inflate_get_dictionary(
+        s, reinterpret_cast<zlib::byte*>(&cp.window[0]), &length
+    );
+    cp.window.resize(length);
+    has_checkpoint_ = true;
 }
 
 void zlib_base::do_init
     ( const zlib_params& p, bool compress, 
       #if !BOOST_WORKAROUND(BOOST_MSVC, < 1300)
-          zlib::xalloc_func /* alloc */, zlib::xfree_func /* free*/, 
+          zlib::xalloc_func alloc, zlib::xfree_func free, 
       #endif
       void* derived )
 {
     calculate_crc_ = p.calculate_crc;
-    z_stream* s = static_cast<z_stream*>(stream_);
-
-    // Current interface for customizing memory management 
-    // is non-conforming and has been disabled:
-    //#if !BOOST_WORKAROUND(BOOST_MSVC, < 1300)
-    //    s->zalloc = alloc;
-    //    s->zfree = free;
-    //#else
+    compress_ = compress;
+    zb::stream* s = static_cast<zb::stream*>(stream_);
+
+    // Null pointers select zlib's own memory management; the functions
+    // supplied for custom allocators report failure to zlib by returning a
+    // null pointer rather than by throwing.
+    #if !BOOST_WORKAROUND(BOOST_MSVC, < 1300)
+        s->zalloc = alloc;
+        s->zfree = free;
+    #else
         s->zalloc = 0;
         s->zfree = 0;
-    //#endif
+    #endif
     s->opaque = derived;
-    int window_bits = p.noheader? -p.window_bits : p.window_bits;
+    int window_bits = window_bits_ = p.noheader? -p.window_bits : p.window_bits;
     zlib_error::check BOOST_PREVENT_MACRO_SUBSTITUTION(
         compress ?
-            deflateInit2( s, 
-                          p.level,
-                          p.method,
-                          window_bits,
-                          p.mem_level,
-                          p.strategy ) :
-            inflateInit2(s, window_bits)
+            zb::deflate_init( s, 
+                              p.level,
+                              p.method,
+                              window_bits,
+                              p.mem_level,
+                              p.strategy ) :
+            zb::inflate_init(s, window_bits)
     );
 }
 
@@ -0,0 +1,130 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2003-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Selects the implementation of the deflate format used by zlib.cpp and
+// zip_archive.cpp. By default this is zlib; if BOOST_IOSTREAMS_ZLIB_NG is
+// defined, it is zlib-ng, using its native API, so that it may be linked
+// alongside zlib. Both produce the same byte format and accept the same
+// parameters. If BOOST_IOSTREAMS_LIBDEFLATE is defined, libdeflate is
+// additionally used to decompress members of zip archives which lie
+// entirely in memory, and to compute their checksums.
+//
+// Private to the library; not installed.
+
+#ifndef BOOST_IOSTREAMS_SRC_ZLIB_BACKEND_HPP_INCLUDED
+#define BOOST_IOSTREAMS_SRC_ZLIB_BACKEND_HPP_INCLUDED
+
+#include <cstddef>    // size_t.
+#include <boost/cstdint.hpp>
+
+#ifdef BOOST_IOSTREAMS_ZLIB_NG
+# include <zlib-ng.h>
+#else
+# include "zlib.h"  // Jean-loup Gailly's and Mark Adler's "zlib.h" header.
+                    // To configure Boost to work with zlib, see the
+                    // installation instructions here:
+                    // http://boost.org/libs/iostreams/doc/index.html?path=7
+#endif
+#ifdef BOOST_IOSTREAMS_LIBDEFLATE
+# include <libdeflate.h>
+#endif
+
+namespace boost { namespace iostreams { namespace detail {
+
+namespace zlib_backend {
+
+#ifdef BOOST_IOSTREAMS_ZLIB_NG
+
+typedef zng_stream stream;
+
+inline int deflate_init( stream* s, int level, int method, int window_bits,
+                         int mem_level, int strategy )
+{ return zng_deflateInit2(s, level, method, window_bits, mem_level, strategy); }
+inline int inflate_init(stream* s, int window_bits)
+{ return zng_inflateInit2(s, window_bits); }
+inline int deflate(stream* s, int flush) { return zng_deflate(s, flush); }
+inline int inflate(stream* s, int flush) { return zng_inflate(s, flush); }
+inline int deflate_reset(stream* s) { return zng_deflateReset(s); }
+inline int inflate_reset(stream* s) { return zng_inflateReset(s); }
+inline int inflate_reset(stream* s, int window_bits)
+{ return zng_inflateReset2(s, window_bits); }
+inline int deflate_end(stream* s) { return zng_deflateEnd(s); }
+inline int inflate_end(stream* s) { return zng_inflateEnd(s); }
+inline int inflate_prime(stream* s, int bits, int value)
+{ return zng_inflatePrime(s, bits, value); }
+inline int inflate_set_dictionary
+    (stream* s, const boost::uint8_t* dict, boost::uint32_t length)
+{ return zng_inflateSetDictionary(s, dict, length); }
+inline int inflate_get_dictionary
+    (stream* s, boost::uint8_t* dict, boost::uint32_t* length)
+{ return zng_inflateGetDictionary(s, dict, length); }
+inline boost::uint32_t crc32
+    (boost::uint32_t crc, const boost::uint8_t* buf, boost::uint32_t length)
+{ return zng_crc32(crc, buf, length); }
+
+#else // #ifdef BOOST_IOSTREAMS_ZLIB_NG
+
+typedef z_stream stream;
+
+inline int deflate_init( stream* s, int level, int method, int window_bits,
+                         int mem_level, int strategy )
+{ return deflateInit2(s, level, method, window_bits, mem_level, strategy); }
+inline int inflate_init(stream* s, int window_bits)
+{ return inflateInit2(s, window_bits); }
+inline int deflate(stream* s, int flush) { return ::deflate(s, flush); }
+inline int inflate(stream* s, int flush) { return ::inflate(s, flush); }
+inline int deflate_reset(stream* s) { return deflateReset(s); }
+inline int inflate_reset(stream* s) { return inflateReset(s); }
+inline int inflate_reset(stream* s, int window_bits)
+{ return inflateReset2(s, window_bits); }
+inline int deflate_end(stream* s) { return deflateEnd(s); }
+inline int inflate_end(stream* s) { return inflateEnd(s); }
+inline int inflate_prime(stream* s, int bits, int value)
+{ return inflatePrime(s, bits, value); }
+inline int inflate_set_dictionary
+    (stream* s, const boost::uint8_t* dict, boost::uint32_t length)
+{ return inflateSetDictionary(s, dict, length); }
+inline int inflate_get_dictionary
+    (stream* s, boost::uint8_t* dict, boost::uint32_t* length)
+{
+    uInt n = 0;
+    int result = inflateGetDictionary(s, dict, &n);
+    *length = n;
+    return result;
+}
+inline boost::uint32_t crc32
+    (boost::uint32_t crc, const boost::uint8_t* buf, boost::uint32_t length)
+{ return static_cast<boost::uint32_t>(::crc32(crc, buf, length)); }
+
+#endif // #ifdef BOOST_IOSTREAMS_ZLIB_NG
+
+// Returns the CRC-32 of the given buffer, which may be of any length,
+// continuing from crc.
+inline boost::uint32_t crc32
+    (boost::uint32_t crc, const char* buf, std::size_t length)
+{
+    const boost::uint8_t* p = reinterpret_cast<const boost::uint8_t*>(buf);
+#ifdef BOOST_IOSTREAMS_LIBDEFLATE
+    return libdeflate_crc32(crc, p, length);
+#else
+    while (length != 0) {
+        boost::uint32_t amt = length > 0x40000000 ?
+            0x40000000 :
+            static_cast<boost::uint32_t>(length);
+        crc = crc32(crc, p, amt);
+        p += amt;
+        length -= amt;
+    }
+    return crc;
+#endif
+}
+
+} // End namespace zlib_backend.
+
+} } } // End namespaces detail, iostreams, boost.
+
+#endif // #ifndef BOOST_IOSTREAMS_SRC_ZLIB_BACKEND_HPP_INCLUDED
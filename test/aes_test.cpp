@@ -0,0 +1,194 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <cstdlib>  // strtol.
+#include <string>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/aes.hpp>
+#include <boost/iostreams/filter/test.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include "detail/sequence.hpp"
+
+using namespace std;
+using namespace boost;
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+const std::string key("0123456789abcdef0123456789abcdef");
+
+// Converts a string of hexadecimal digits to binary
+std::string unhex(const std::string& hex)
+{
+    std::string result;
+    for (std::string::size_type z = 0; z < hex.size(); z += 2)
+        result += static_cast<char>(
+                      std::strtol(hex.substr(z, 2).c_str(), 0, 16)
+                  );
+    return result;
+}
+
+template<typename Filter>
+std::string filter_string(const std::string& data, Filter f)
+{
+    std::string result;
+    io::copy(
+        io::compose(f, array_source(data.data(), data.size())),
+        io::back_inserter(result)
+    );
+    return result;
+}
+
+// Returns the size of a GCM stream containing n characters; the last chunk
+// may be full, but only an empty stream has an empty chunk
+std::size_t sealed_size(std::size_t n, std::size_t chunk)
+{ return 20 + (n != 0 ? (n + chunk - 1) / chunk : 1) * 20 + n; }
+
+void ctr_test()
+{
+    // Test vector from NIST SP 800-38A, F.5.1
+    aes_params   p( unhex("2b7e151628aed2a6abf7158809cf4f3c"),
+                    unhex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff") );
+    std::string  plain = unhex("6bc1bee22e409f96e93d7e117393172a"),
+                 cipher = unhex("874d6191b620e3261bef6864990db6ce");
+    BOOST_CHECK(filter_string(plain, aes_ctr_encryptor(p)) == cipher);
+    BOOST_CHECK(filter_string(cipher, aes_ctr_decryptor(p)) == plain);
+
+    text_sequence  data;
+    std::string    str(data.begin(), data.end());
+    p.key = key;
+    BOOST_CHECK(test_filter_pair(aes_ctr_filter(p), aes_ctr_filter(p), str));
+
+    BOOST_CHECK_THROW((aes_ctr_filter(aes_params(key))), aes_error);
+    BOOST_CHECK_THROW(
+        (aes_ctr_filter(aes_params("short", p.iv))),
+        aes_error
+    );
+}
+
+void gcm_test()
+{
+    text_sequence  data;
+    std::string    str(data.begin(), data.end());
+    aes_params     p(key, std::string(12, 'n'));
+    BOOST_CHECK(
+        test_filter_pair(aes_gcm_encryptor(p), aes_gcm_decryptor(p), str)
+    );
+    BOOST_CHECK(
+        test_filter_pair( aes_gcm_encryptor(p), aes_gcm_decryptor(p),
+                          std::string() )
+    );
+
+    // Many chunks, including streams which end at a chunk boundary
+    for (std::size_t chunk = 1; chunk <= 1000; chunk *= 10) {
+        aes_params   q(key.substr(0, 16), std::string(), chunk);
+        std::string  prefix = str.substr(0, chunk * 3);
+        BOOST_CHECK(
+            test_filter_pair(aes_gcm_encryptor(q), aes_gcm_decryptor(q), str)
+        );
+        std::string  cipher = filter_string(prefix, aes_gcm_encryptor(q));
+        BOOST_CHECK_EQUAL(cipher.size(), sealed_size(prefix.size(), chunk));
+        BOOST_CHECK(filter_string(cipher, aes_gcm_decryptor(q)) == prefix);
+    }
+
+    // Random nonces differ from stream to stream
+    aes_params   q(key);
+    std::string  first = filter_string(str, aes_gcm_encryptor(q)),
+                 second = filter_string(str, aes_gcm_encryptor(q));
+    BOOST_CHECK(first != second);
+    BOOST_CHECK(filter_string(second, aes_gcm_decryptor(q)) == str);
+
+    BOOST_CHECK_THROW(
+        (aes_gcm_encryptor(aes_params(key, "short"))),
+        aes_error
+    );
+    BOOST_CHECK_THROW(
+        (aes_gcm_encryptor(aes_params(key, std::string(), 0))),
+        aes_error
+    );
+}
+
+// Checks that decrypting data fails with the given error
+void check_rejected(const std::string& data, int error, const aes_params& p)
+{
+    try {
+        filter_string(data, aes_gcm_decryptor(p));
+        BOOST_ERROR("invalid ciphertext accepted");
+    } catch (const aes_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), error);
+    }
+}
+
+void tamper_test()
+{
+    text_sequence  data;
+    std::string    str(data.begin(), data.end());
+    std::size_t    chunk = 1000, sealed = chunk + 20;
+    aes_params     p(key, std::string(), chunk);
+    std::string    cipher = filter_string(str.substr(0, 3 * chunk + 10),
+                                  aes_gcm_encryptor(p)),
+                   modified;
+
+    // Modified ciphertext
+    modified = cipher;
+    modified[20 + sealed + 100] ^= 1;
+    check_rejected(modified, aes::authentication_failed, p);
+
+    // Modified header
+    modified = cipher;
+    modified[10] ^= 1;
+    check_rejected(modified, aes::authentication_failed, p);
+
+    // Dropped chunk
+    modified = cipher.substr(0, 20 + sealed) + cipher.substr(20 + 2 * sealed);
+    check_rejected(modified, aes::authentication_failed, p);
+
+    // Truncation at a chunk boundary and within a chunk
+    check_rejected( cipher.substr(0, 20 + 3 * sealed),
+                    aes::unexpected_eof, p );
+    check_rejected( cipher.substr(0, cipher.size() - 1),
+                    aes::unexpected_eof, p );
+
+    // Data following the last chunk
+    check_rejected(cipher + "x", aes::trailing_data, p);
+
+    // Wrong key
+    check_rejected( cipher, aes::authentication_failed,
+                    aes_params(std::string(32, 'k')) );
+
+    // Not an encrypted stream
+    check_rejected(str, aes::bad_header, p);
+
+    // Errors are reported through error_code overloads
+    modified = cipher;
+    modified[modified.size() - 1] ^= 1;
+    std::string                      dest;
+    back_insert_device<std::string>  snk(dest);
+    aes_gcm_decryptor                dec(p);
+    boost::system::error_code        ec;
+    dec.write(snk, modified.data(), (std::streamsize) modified.size(), ec);
+    if (!ec)
+        dec.close(snk, BOOST_IOS::out, ec);
+    BOOST_CHECK(ec == boost::system::error_code( aes::authentication_failed,
+                                                 aes_category() ));
+    BOOST_CHECK(dest.size() <= 3 * chunk);
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("aes test");
+    test->add(BOOST_TEST_CASE(&ctr_test));
+    test->add(BOOST_TEST_CASE(&gcm_test));
+    test->add(BOOST_TEST_CASE(&tamper_test));
+    return test;
+}
@@ -0,0 +1,236 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+// Measures the memory allocations made by filters and devices once a stream
+// has been warmed up, by replacing the global operator new; allocations
+// made directly with malloc, e.g., by a codec library which is not passed an
+// allocator, are not counted. The results are reported per megabyte and per
+// call to read() or write(), which are visible with --log_level=message;
+// paths which are expected to make no allocations are checked.
+
+#include <cstdlib>                         // malloc, free.
+#include <new>
+#include <string>
+#include <vector>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/null.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#include <boost/iostreams/filter/counter.hpp>
+#include <boost/iostreams/filter/grep.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/newline.hpp>
+#include <boost/iostreams/filter/snappy.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/shared_array.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::iostreams;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+//------------------Replacement of operator new-------------------------------//
+
+std::size_t allocations = 0;
+
+void* operator new(std::size_t n)
+{
+    ++allocations;
+    void* result = std::malloc(n != 0 ? n : 1);
+    if (!result)
+        throw std::bad_alloc();
+    return result;
+}
+
+void* operator new[](std::size_t n) { return operator new(n); }
+void operator delete(void* p) throw() { std::free(p); }
+void operator delete[](void* p) throw() { std::free(p); }
+
+//------------------Definition of measure-------------------------------------//
+
+const std::size_t chunk_size = 8192;
+const int         warm_up = 16;
+const int         measured = 256;
+
+// Calls the given operation, which processes chunk_size characters, until
+// the stream is warmed up and then a fixed number of times, reporting the
+// number of allocations made; if allocation_free is true, checks that there
+// were none
+template<typename Op>
+void measure(const char* name, Op op, bool allocation_free)
+{
+    for (int z = 0; z < warm_up; ++z)
+        op();
+    std::size_t before = allocations;
+    for (int z = 0; z < measured; ++z)
+        op();
+    std::size_t  count = allocations - before;
+    double       mb = double(measured) * chunk_size / (1024 * 1024);
+    BOOST_TEST_MESSAGE(
+        name << ": " << count / mb << " allocations per MB, " <<
+        double(count) / measured << " per operation"
+    );
+    if (allocation_free)
+        BOOST_CHECK_MESSAGE(
+            count == 0,
+            name << " made " << count << " allocations in steady state"
+        );
+}
+
+// Returns text of the given size consisting of short lines
+std::string contents(std::size_t size)
+{
+    static const char* const words[] =
+        { "alpha ", "beta ", "gamma ", "delta ", "epsilon ", "zeta\n" };
+    std::string result;
+    unsigned value = 12345;
+    while (result.size() < size) {
+        value = value * 1103515245u + 12345u;
+        result += words[(value >> 16) % 6];
+    }
+    result.resize(size);
+    return result;
+}
+
+template<typename Compressor>
+std::string compress(const std::string& data, const Compressor& c)
+{
+    std::string result;
+    io::copy( array_source(data.data(), data.size()),
+              io::compose(c, io::back_inserter(result)) );
+    return result;
+}
+
+//------------------Definition of operations----------------------------------//
+
+// Writes a chunk to an output stream
+template<typename Stream>
+struct write_op {
+    write_op(Stream& out, const std::string& data)
+        : out(&out), data(&data)
+        { }
+    void operator()() const
+    {
+        out->write(data->data(), static_cast<std::streamsize>(chunk_size));
+    }
+    Stream*             out;
+    const std::string*  data;
+};
+
+// Reads a chunk from an input stream
+template<typename Stream>
+struct read_op {
+    explicit read_op(Stream& in) : in(&in), buf(new char[chunk_size]) { }
+    void operator()() const
+    {
+        in->read(buf.get(), static_cast<std::streamsize>(chunk_size));
+    }
+    Stream*                      in;
+    boost::shared_array<char>    buf;
+};
+
+// Copies a chunk from an array to an array
+struct copy_op {
+    copy_op(const std::string& data, std::vector<char>& dest)
+        : data(&data), dest(&dest)
+        { }
+    void operator()() const
+    {
+        io::copy( array_source(data->data(), chunk_size),
+                  array_sink(&(*dest)[0], chunk_size) );
+    }
+    const std::string*  data;
+    std::vector<char>*  dest;
+};
+
+//------------------Definition of tests---------------------------------------//
+
+// Measures a filter used for output to a null_sink
+template<typename Filter>
+void measure_output(const char* name, const Filter& f, bool allocation_free)
+{
+    std::string        data = contents(chunk_size);
+    filtering_ostream  out;
+    out.push(f);
+    out.push(null_sink());
+    measure(name, write_op<filtering_ostream>(out, data), allocation_free);
+}
+
+// Measures a filter used for input from an array_source containing the
+// given data
+template<typename Filter>
+void measure_input( const char* name, const Filter& f,
+                    const std::string& data, bool allocation_free )
+{
+    filtering_istream in;
+    in.push(f);
+    in.push(array_source(data.data(), data.size()));
+    measure(name, read_op<filtering_istream>(in), allocation_free);
+}
+
+void filter_test()
+{
+    std::size_t  size = chunk_size * (warm_up + measured + 1);
+    std::string  data = contents(size);
+
+    measure_output("zlib_compressor", zlib_compressor(), true);
+    measure_output("gzip_compressor", gzip_compressor(), true);
+    measure_output("bzip2_compressor", bzip2_compressor(), true);
+    measure_output("snappy_compressor", snappy_compressor(), true);
+    measure_output("counter (output)", counter(), true);
+    measure_output("newline_filter (output)", newline_filter(newline::dos),
+                   true);
+    measure_output( "grep_filter (output)",
+                    grep_filter(boost::regex("gamma")), false );
+
+    measure_input( "zlib_decompressor",
+                   zlib_decompressor(), compress(data, zlib_compressor()),
+                   true );
+    measure_input( "gzip_decompressor",
+                   gzip_decompressor(), compress(data, gzip_compressor()),
+                   true );
+    measure_input( "bzip2_decompressor",
+                   bzip2_decompressor(), compress(data, bzip2_compressor()),
+                   true );
+    measure_input( "snappy_decompressor",
+                   snappy_decompressor(),
+                   compress(data, snappy_compressor()), true );
+    measure_input("counter (input)", counter(), data, true);
+    measure_input( "newline_filter (input)", newline_filter(newline::dos),
+                   data, true );
+    measure_input( "grep_filter (input)",
+                   grep_filter(boost::regex("gamma")), data, false );
+}
+
+void device_test()
+{
+    std::size_t  size = chunk_size * (warm_up + measured + 1);
+    std::string  data = contents(size);
+
+    stream<array_source> in(data.data(), data.size());
+    measure("stream<array_source>", read_op< stream<array_source> >(in), true);
+
+    std::vector<char> dest(chunk_size);
+    measure("copy(array_source, array_sink)", copy_op(data, dest), true);
+
+    stream<null_sink> out((null_sink()));
+    measure( "stream<null_sink>",
+             write_op< stream<null_sink> >(out, data), true );
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("allocation test");
+    test->add(BOOST_TEST_CASE(&filter_test));
+    test->add(BOOST_TEST_CASE(&device_test));
+    return test;
+}
@@ -0,0 +1,364 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <exception>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/iostreams/async.hpp>
+#include <boost/iostreams/close.hpp>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_streambuf.hpp>
+#include <boost/iostreams/reactor.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+using namespace boost;
+using namespace boost::iostreams;
+namespace io = boost::iostreams;
+using boost::system::error_code;
+using boost::unit_test::test_suite;
+
+// Larger than the capacity of a pipe, so that writes block
+const std::streamsize data_size = 200000;
+
+// Returns data_size characters which compress poorly
+std::string random_data()
+{
+    std::string   result;
+    unsigned int  state = 12345;
+    for (std::streamsize z = 0; z < data_size; ++z) {
+        state = state * 1103515245 + 12345;
+        result += static_cast<char>(state >> 16);
+    }
+    return result;
+}
+
+std::string zlib_compress(const std::string& data)
+{
+    std::string result;
+    io::copy(
+        array_source(data.data(), data.size()),
+        io::compose(zlib_compressor(), io::back_inserter(result))
+    );
+    return result;
+}
+
+std::string zlib_decompress(const std::string& data)
+{
+    std::string result;
+    io::copy(
+        io::compose(
+            zlib_decompressor(),
+            array_source(data.data(), data.size())
+        ),
+        io::back_inserter(result)
+    );
+    return result;
+}
+
+// A pipe whose ends are in non-blocking mode
+struct nonblocking_pipe {
+    nonblocking_pipe()
+    {
+        BOOST_REQUIRE(::pipe(fd) == 0);
+        ::fcntl(fd[0], F_SETFL, ::fcntl(fd[0], F_GETFL) | O_NONBLOCK);
+        ::fcntl(fd[1], F_SETFL, ::fcntl(fd[1], F_GETFL) | O_NONBLOCK);
+    }
+    ~nonblocking_pipe()
+    {
+        close_write();
+        ::close(fd[0]);
+    }
+    void close_write()
+    {
+        if (fd[1] != -1) {
+            ::close(fd[1]);
+            fd[1] = -1;
+        }
+    }
+
+    // Reads whatever is available from the read end
+    void drain(std::string& dest)
+    {
+        char             buf[1000];
+        std::streamsize  amt;
+        while ((amt = ::read(fd[0], buf, sizeof(buf))) > 0)
+            dest.append(buf, amt);
+    }
+    int fd[2];
+};
+
+// The result of an asynchronous operation
+struct result {
+    result() : done(false), n(0) { }
+    bool             done;
+    error_code       ec;
+    std::streamsize  n;
+};
+
+// Completion handler which records its arguments and then optionally
+// closes the write end of a pipe or stops a reactor
+struct record {
+    record(result& res, nonblocking_pipe* p = 0, reactor* r = 0)
+        : res_(&res), pipe_(p), reactor_(r)
+        { }
+    void operator()(const error_code& ec, std::streamsize n) const
+    {
+        res_->done = true;
+        res_->ec = ec;
+        res_->n = n;
+        if (pipe_)
+            pipe_->close_write();
+        if (reactor_)
+            reactor_->stop();
+    }
+    result*            res_;
+    nonblocking_pipe*  pipe_;
+    reactor*           reactor_;
+};
+
+// Reads from a source until end-of-stream
+template<typename Source>
+class reader {
+public:
+    struct state {
+        state() : eof(false), reads(0) { }
+        char         buf[1000];
+        std::string  data;
+        error_code   ec;
+        bool         eof;
+        int          reads;
+    };
+    reader(reactor& r, Source& src, state& st)
+        : reactor_(&r), src_(&src), state_(&st)
+        { }
+    void start()
+    {
+        io::async_read(
+            *reactor_, *src_, state_->buf, sizeof(state_->buf), *this
+        );
+    }
+    void operator()(const error_code& ec, std::streamsize n)
+    {
+        ++state_->reads;
+        if (ec) {
+            state_->ec = ec;
+        } else if (n == -1) {
+            state_->eof = true;
+        } else {
+            state_->data.append(state_->buf, n);
+            start();
+        }
+    }
+private:
+    reactor*  reactor_;
+    Source*   src_;
+    state*    state_;
+};
+
+void device_test()
+{
+    std::string                                 data = random_data();
+    nonblocking_pipe                            p;
+    file_descriptor_source                      src(p.fd[0], never_close_handle);
+    file_descriptor_sink                        snk(p.fd[1], never_close_handle);
+    reactor                                     r;
+    reader<file_descriptor_source>::state       st;
+    result                                      w;
+
+    // Nothing happens until the reactor is run
+    reader<file_descriptor_source>(r, src, st).start();
+    io::async_write(r, snk, data.data(), data.size(), record(w, &p));
+    BOOST_CHECK(!w.done);
+    BOOST_CHECK_EQUAL(st.reads, 0);
+
+    BOOST_CHECK(r.run() > 0);
+    BOOST_CHECK(w.done);
+    BOOST_CHECK(!w.ec);
+    BOOST_CHECK_EQUAL(w.n, data_size);
+    BOOST_CHECK(!st.ec);
+    BOOST_CHECK(st.eof);
+    BOOST_CHECK(st.data == data);
+    BOOST_CHECK(st.reads > 2); // The reader had to wait
+}
+
+void input_chain_test()
+{
+    std::string                           data = random_data(),
+                                          compressed = zlib_compress(data);
+    nonblocking_pipe                      p;
+    file_descriptor_sink                  snk(p.fd[1], never_close_handle);
+    filtering_istreambuf                  in;
+    in.push(zlib_decompressor());
+    in.push(file_descriptor_source(p.fd[0], never_close_handle));
+    reactor                               r;
+    reader<filtering_istreambuf>::state   st;
+    result                                w;
+
+    reader<filtering_istreambuf>(r, in, st).start();
+    io::async_write( r, snk, compressed.data(), compressed.size(),
+                     record(w, &p) );
+    r.run();
+    BOOST_CHECK(w.done && !w.ec);
+    BOOST_CHECK(!st.ec);
+    BOOST_CHECK(st.eof);
+    BOOST_CHECK(st.data == data);
+}
+
+void output_chain_test()
+{
+    std::string                             data = random_data(), compressed;
+    nonblocking_pipe                        p;
+    file_descriptor_source                  src(p.fd[0], never_close_handle);
+    filtering_ostreambuf                    out;
+    out.push(zlib_compressor());
+    out.push(file_descriptor_sink(p.fd[1], never_close_handle));
+    reactor                                 r;
+    reader<file_descriptor_source>::state   st;
+    result                                  w, f;
+
+    // Write and flush while reading the other end of the pipe, then close
+    // the chain once the pipe has been drained
+    reader<file_descriptor_source>(r, src, st).start();
+    io::async_write(r, out, data.data(), data.size(), record(w));
+    while (!w.done)
+        r.run_one();
+    BOOST_CHECK(!w.ec);
+    BOOST_CHECK_EQUAL(w.n, data_size);
+    io::async_flush(r, out, record(f, 0, &r));
+    r.run();
+    BOOST_CHECK(f.done && !f.ec);
+    BOOST_CHECK(!out.output_pending());
+    compressed = st.data;
+    p.drain(compressed);
+    io::close(out);
+    p.drain(compressed);
+    BOOST_CHECK(zlib_decompress(compressed) == data);
+}
+
+void error_test()
+{
+    // Invalid handle
+    {
+        file_descriptor_source  src;
+        reactor                 r;
+        result                  res;
+        char                    buf[10];
+        io::async_read(r, src, buf, 10, record(res));
+        r.run();
+        BOOST_CHECK(res.done);
+        BOOST_CHECK(res.ec == boost::system::errc::bad_file_descriptor);
+    }
+
+    // Cancellation
+    {
+        nonblocking_pipe        p;
+        file_descriptor_source  src(p.fd[0], never_close_handle);
+        reactor                 r;
+        result                  res;
+        char                    buf[10];
+        io::async_read(r, src, buf, 10, record(res));
+        r.run_one();
+        BOOST_CHECK(!res.done);
+        r.cancel(p.fd[0]);
+        r.run();
+        BOOST_CHECK(res.done);
+        BOOST_CHECK(res.ec == boost::system::errc::operation_canceled);
+    }
+
+    // Exceptions thrown by the filters of a chain are reported to the
+    // handler
+    {
+        nonblocking_pipe                      p;
+        std::string                           garbage(100, 'x');
+        filtering_istreambuf                  in;
+        in.push(zlib_decompressor());
+        in.push(file_descriptor_source(p.fd[0], never_close_handle));
+        reactor                               r;
+        reader<filtering_istreambuf>::state   st;
+        BOOST_REQUIRE_EQUAL(
+            ::write(p.fd[1], garbage.data(), garbage.size()), 100
+        );
+        reader<filtering_istreambuf>(r, in, st).start();
+        r.run();
+        BOOST_CHECK(st.ec == errors::failure);
+    }
+}
+
+#ifdef BOOST_IOSTREAMS_HAS_COROUTINES
+
+// Coroutine which runs until its first suspension point on creation and
+// destroys itself on completion
+struct detached_task {
+    struct promise_type {
+        detached_task get_return_object() { return detached_task(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() { }
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+detached_task read_coroutine
+    (reactor& r, filtering_istreambuf& in, std::string& dest, bool& done)
+{
+    char             buf[1000];
+    std::streamsize  amt;
+    while ((amt = co_await io::async_read(r, in, buf, sizeof(buf))) != -1)
+        dest.append(buf, amt);
+    done = true;
+}
+
+detached_task write_coroutine
+    (reactor& r, file_descriptor_sink& snk, const std::string& data,
+     nonblocking_pipe& p)
+{
+    co_await io::async_write(r, snk, data.data(), data.size());
+    p.close_write();
+}
+
+void coroutine_test()
+{
+    std::string           data = random_data(),
+                          compressed = zlib_compress(data),
+                          dest;
+    nonblocking_pipe      p;
+    file_descriptor_sink  snk(p.fd[1], never_close_handle);
+    filtering_istreambuf  in;
+    in.push(zlib_decompressor());
+    in.push(file_descriptor_source(p.fd[0], never_close_handle));
+    reactor               r;
+    bool                  done = false;
+
+    read_coroutine(r, in, dest, done);
+    write_coroutine(r, snk, compressed, p);
+    r.run();
+    BOOST_CHECK(done);
+    BOOST_CHECK(dest == data);
+}
+
+#endif // #ifdef BOOST_IOSTREAMS_HAS_COROUTINES
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("async test");
+    test->add(BOOST_TEST_CASE(&device_test));
+    test->add(BOOST_TEST_CASE(&input_chain_test));
+    test->add(BOOST_TEST_CASE(&output_chain_test));
+    test->add(BOOST_TEST_CASE(&error_test));
+#ifdef BOOST_IOSTREAMS_HAS_COROUTINES
+    test->add(BOOST_TEST_CASE(&coroutine_test));
+#endif
+    return test;
+}
@@ -0,0 +1,196 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <string>
+#include <vector>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/blocked.hpp>
+#include <boost/iostreams/filter/snappy.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace boost::iostreams;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+typedef blocked_compressor<zlib_compressor>                 zlib_blocked;
+typedef blocked_decompressor<zlib_decompressor>             zlib_unblocked;
+typedef blocked_source<zlib_decompressor, array_source>     zlib_source;
+
+// Returns compressible contents of the given size
+std::string contents(std::size_t size)
+{
+    std::string result;
+    unsigned value = 12345;
+    for (std::size_t z = 0; z < size; ++z) {
+        value = value * 1103515245u + 12345u;
+        result += static_cast<char>('a' + (value >> 16) % 8);
+    }
+    return result;
+}
+
+template<typename Compressor>
+std::string compress(const std::string& data, const Compressor& c)
+{
+    std::string result;
+    io::copy( array_source(data.data(), data.size()),
+              io::compose(c, io::back_inserter(result)) );
+    return result;
+}
+
+template<typename Decompressor>
+std::string decompress(const std::string& data, const Decompressor& d)
+{
+    std::string result;
+    io::copy( io::compose(d, array_source(data.data(), data.size())),
+              io::back_inserter(result) );
+    return result;
+}
+
+zlib_compressor fast_zlib() { return zlib_compressor(zlib::best_speed); }
+
+int decompressors = 0;
+
+zlib_decompressor counting_zlib()
+{
+    ++decompressors;
+    return zlib_decompressor();
+}
+
+void round_trip_test()
+{
+    const std::size_t sizes[] = { 0, 1, 999, 1000, 1001, 25000, 100500 };
+    for (std::size_t z = 0; z < sizeof(sizes) / sizeof(sizes[0]); ++z) {
+        std::string data = contents(sizes[z]);
+        for (unsigned threads = 1; threads <= 4; threads += 3) {
+            blocked_params p(1000, threads);
+            std::string zl = compress(data, zlib_blocked(p, &fast_zlib));
+            BOOST_CHECK(decompress(zl, zlib_unblocked(p)) == data);
+            BOOST_CHECK(
+                decompress(zl, zlib_unblocked(blocked_params(1, 3))) == data
+            );
+            zlib_source src(array_source(zl.data(), zl.size()), p);
+            BOOST_CHECK_EQUAL(src.size(), static_cast<int>(data.size()));
+            BOOST_CHECK_EQUAL(src.blocks(), (data.size() + 999) / 1000);
+
+            std::string sn = compress(
+                data, blocked_compressor<snappy_compressor>(p)
+            );
+            BOOST_CHECK(
+                decompress(sn, blocked_decompressor<snappy_decompressor>(p)) ==
+                data
+            );
+        }
+    }
+
+    // A filter may be reused after it is closed
+    std::string       data = contents(5000);
+    zlib_blocked      c(blocked_params(700, 2));
+    zlib_unblocked    d(blocked_params(0, 2));
+    for (int z = 0; z < 2; ++z)
+        BOOST_CHECK(decompress(compress(data, c), d) == data);
+}
+
+void random_access_test()
+{
+    std::string  data = contents(50000);
+    std::string  zl = compress(data, zlib_blocked(1000));
+    zlib_source  src( array_source(zl.data(), zl.size()),
+                      blocked_params(0, 1), &counting_zlib );
+
+    // Only the blocks containing the characters read are decompressed
+    char buf[5000];
+    decompressors = 0;
+    src.seek(5100, BOOST_IOS::beg);
+    BOOST_CHECK_EQUAL(src.read(buf, 10), 10);
+    BOOST_CHECK(std::string(buf, 10) == data.substr(5100, 10));
+    BOOST_CHECK_EQUAL(decompressors, 1);
+    BOOST_CHECK_EQUAL(src.read(buf, 10), 10);
+    BOOST_CHECK(std::string(buf, 10) == data.substr(5110, 10));
+    BOOST_CHECK_EQUAL(decompressors, 1);
+    src.seek(20990, BOOST_IOS::beg);
+    BOOST_CHECK_EQUAL(src.read(buf, 2020), 2020);
+    BOOST_CHECK(std::string(buf, 2020) == data.substr(20990, 2020));
+    BOOST_CHECK_EQUAL(decompressors, 5);
+    src.seek(-10, BOOST_IOS::end);
+    BOOST_CHECK_EQUAL(src.read(buf, 100), 10);
+    BOOST_CHECK(std::string(buf, 10) == data.substr(49990));
+    BOOST_CHECK_EQUAL(src.read(buf, 100), -1);
+
+    // Reads spanning many blocks, decompressed concurrently
+    stream<zlib_source> in(
+        zlib_source(array_source(zl.data(), zl.size()), blocked_params(0, 4))
+    );
+    for (std::size_t off = 0; off < data.size(); off += 7919) {
+        in.seekg(static_cast<std::streamoff>(off));
+        std::size_t amt =
+            std::min<std::size_t>(sizeof(buf), data.size() - off);
+        BOOST_CHECK(in.read(buf, static_cast<std::streamsize>(amt)));
+        BOOST_CHECK(std::string(buf, amt) == data.substr(off, amt));
+    }
+}
+
+void error_test()
+{
+    std::string  data = contents(20000);
+    std::string  zl = compress(data, zlib_blocked(1000));
+
+    // Bad magic number
+    std::string bad = zl;
+    bad[0] = 'X';
+    try {
+        decompress(bad, zlib_unblocked());
+        BOOST_ERROR("expected blocked_error");
+    } catch (const blocked_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), blocked::bad_header);
+    }
+
+    // Truncated container
+    try {
+        decompress(zl.substr(0, zl.size() / 2), zlib_unblocked());
+        BOOST_ERROR("expected blocked_error");
+    } catch (const blocked_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), blocked::unexpected_eof);
+    }
+    try {
+        zlib_source src(array_source(zl.data(), zl.size() - 1));
+        BOOST_ERROR("expected blocked_error");
+    } catch (const blocked_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), blocked::bad_index);
+    }
+
+    // Corrupt compressed data is reported by the codec, on any thread
+    bad = zl;
+    bad[26] ^= 0x55;
+    bad[27] ^= 0x55;
+    BOOST_CHECK_THROW(
+        decompress(bad, zlib_unblocked(blocked_params(0, 4))),
+        zlib_error
+    );
+    zlib_source src( array_source(bad.data(), bad.size()),
+                     blocked_params(0, 4) );
+    std::vector<char> buf(data.size());
+    BOOST_CHECK_THROW(
+        src.read(&buf[0], static_cast<std::streamsize>(buf.size())),
+        zlib_error
+    );
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("blocked test");
+    test->add(BOOST_TEST_CASE(&round_trip_test));
+    test->add(BOOST_TEST_CASE(&random_access_test));
+    test->add(BOOST_TEST_CASE(&error_test));
+    return test;
+}
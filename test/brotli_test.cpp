@@ -0,0 +1,207 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <string>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/brotli.hpp>
+#include <boost/iostreams/filter/test.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include "detail/sequence.hpp"
+
+using namespace std;
+using namespace boost;
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+struct brotli_alloc : std::allocator<char> { };
+
+std::string decompress( const std::string& compressed,
+                        const brotli_params& p = brotli_params() )
+{
+    std::string result;
+    io::copy(
+        io::compose( brotli_decompressor(p),
+                     array_source(compressed.data(), compressed.size()) ),
+        io::back_inserter(result)
+    );
+    return result;
+}
+
+void brotli_test()
+{
+    text_sequence  data;
+    std::string    str(data.begin(), data.end());
+    BOOST_CHECK(
+        test_filter_pair(brotli_compressor(), brotli_decompressor(), str)
+    );
+    BOOST_CHECK(
+        test_filter_pair( basic_brotli_compressor<brotli_alloc>(),
+                          basic_brotli_decompressor<brotli_alloc>(),
+                          str )
+    );
+    BOOST_CHECK(
+        test_filter_pair( brotli_compressor(),
+                          brotli_decompressor(),
+                          std::string() )
+    );
+
+    // Quality, window size, mode and size hint
+    for (int quality = brotli::min_quality; quality <= brotli::max_quality;
+         quality += 5)
+    {
+        BOOST_CHECK(
+            test_filter_pair( brotli_compressor(brotli_params(quality, 10)),
+                              brotli_decompressor(),
+                              str )
+        );
+    }
+    BOOST_CHECK(
+        test_filter_pair(
+            brotli_compressor(
+                brotli_params(5, brotli::max_window_bits, brotli::text,
+                              str.size())
+            ),
+            brotli_decompressor(),
+            str
+        )
+    );
+    {
+        brotli_params p(5, 26);
+        p.large_window = true;
+        BOOST_CHECK(
+            test_filter_pair(brotli_compressor(p), brotli_decompressor(p), str)
+        );
+    }
+    {
+        filtering_istream strm;
+        strm.push( brotli_compressor() );
+        strm.push( null_source() );
+    }
+    {
+        filtering_istream strm;
+        strm.push( brotli_decompressor() );
+        strm.push( null_source() );
+    }
+}
+
+void flush_test()
+{
+    text_sequence      data;
+    std::string        str(data.begin(), data.end()), dest;
+    filtering_ostream  out;
+    out.push(brotli_compressor());
+    out.push(io::back_inserter(dest));
+
+    // After each flush, the data written so far can be decompressed,
+    // although the stream is incomplete
+    for (int z = 0; z < 3; ++z) {
+        out.write(str.data(), static_cast<std::streamsize>(str.size()));
+        out.flush();
+        std::string                      partial;
+        back_insert_device<std::string>  snk(partial);
+        brotli_decompressor              dec;
+        dec.write(snk, dest.data(), static_cast<std::streamsize>(dest.size()));
+        dec.drain(snk);
+        BOOST_REQUIRE_EQUAL(partial.size(), str.size() * (z + 1));
+        BOOST_CHECK(partial.substr(z * str.size()) == str);
+    }
+    out.pop();
+    BOOST_CHECK(decompress(dest) == str + str + str);
+
+    // Flushing an input filter has no effect
+    filtering_istream in;
+    in.push(brotli_compressor());
+    in.push(array_source(str.data(), str.size()));
+    in.sync();
+    std::string compressed;
+    io::copy(in, io::back_inserter(compressed));
+    BOOST_CHECK(decompress(compressed) == str);
+}
+
+void error_test()
+{
+    text_sequence  data;
+    std::string    str(data.begin(), data.end()), compressed;
+    io::copy(
+        array_source(str.data(), str.size()),
+        io::compose(brotli_compressor(), io::back_inserter(compressed))
+    );
+
+    // Truncated input
+    std::string truncated = compressed.substr(0, compressed.size() / 2);
+    try {
+        decompress(truncated);
+        BOOST_ERROR("truncated input not detected");
+    } catch (const brotli_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), brotli::unexpected_eof);
+    }
+
+    // Corrupt input
+    try {
+        decompress(std::string(100, 'x'));
+        BOOST_ERROR("corrupt input not detected");
+    } catch (const brotli_error& e) {
+        BOOST_CHECK(e.error() < 0);
+        boost::system::error_code ec(e.error(), brotli_category());
+        BOOST_CHECK(!ec.message().empty());
+    }
+
+    // Invalid parameters
+    BOOST_CHECK_THROW(
+        decompress( std::string(),
+                    brotli_params(brotli::max_quality + 1) ),
+        brotli_error
+    );
+    {
+        std::string dest;
+        BOOST_CHECK_THROW(
+            io::copy(
+                array_source(str.data(), str.size()),
+                io::compose( brotli_compressor(brotli_params(5, 40)),
+                             io::back_inserter(dest) )
+            ),
+            brotli_error
+        );
+    }
+}
+
+void dictionary_test()
+{
+    text_sequence  data;
+    std::string    str(data.begin(), data.end()), compressed;
+    brotli_params  p;
+    p.dictionary = str.substr(0, 1000);
+    try {
+        io::copy(
+            array_source(str.data(), str.size()),
+            io::compose(brotli_compressor(p), io::back_inserter(compressed))
+        );
+    } catch (const brotli_error& e) {
+        // Custom dictionaries require Brotli 1.1
+        BOOST_CHECK_EQUAL(e.error(), brotli::dictionary_unsupported);
+        return;
+    }
+    BOOST_CHECK(decompress(compressed, p) == str);
+    BOOST_CHECK_THROW(decompress(compressed), brotli_error);
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("brotli test");
+    test->add(BOOST_TEST_CASE(&brotli_test));
+    test->add(BOOST_TEST_CASE(&flush_test));
+    test->add(BOOST_TEST_CASE(&error_test));
+    test->add(BOOST_TEST_CASE(&dictionary_test));
+    return test;
+}
@@ -0,0 +1,140 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <string>
+#include <boost/iostreams/chain_prototype.hpp>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/counter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include "detail/filters.hpp"
+
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+typedef chain_prototype<filtering_istream>  istream_prototype;
+typedef chain_prototype<filtering_ostream>  ostream_prototype;
+
+int decompressors = 0;
+
+gzip_decompressor make_decompressor()
+{
+    ++decompressors;
+    return gzip_decompressor();
+}
+
+gzip_compressor make_compressor() { return gzip_compressor(); }
+
+std::string compress(const std::string& data)
+{
+    std::string result;
+    io::copy( array_source(data.data(), data.size()),
+              io::compose(gzip_compressor(), io::back_inserter(result)) );
+    return result;
+}
+
+std::string read_all(std::istream& in)
+{
+    std::string result;
+    io::copy(in, io::back_inserter(result));
+    return result;
+}
+
+void input_test()
+{
+    std::string        first = "first message\n", second = "second message\n";
+    std::string        gz1 = compress(first), gz2 = compress(second);
+    istream_prototype  proto;
+    proto.push(toupper_filter());
+    proto.push_factory(&make_decompressor);
+    BOOST_CHECK_EQUAL(proto.size(), 2u);
+
+    // Instances in use at the same time have their own filters
+    decompressors = 0;
+    istream_prototype::stream_ptr
+        in1 = proto.open(array_source(gz1.data(), gz1.size())),
+        in2 = proto.open(array_source(gz2.data(), gz2.size()));
+    BOOST_CHECK_EQUAL(decompressors, 2);
+    BOOST_CHECK_EQUAL(in1->size(), 3u);
+    char c;
+    BOOST_CHECK(in1->get(c) && c == 'F');
+    BOOST_CHECK_EQUAL(read_all(*in2), "SECOND MESSAGE\n");
+    BOOST_CHECK_EQUAL(read_all(*in1), "IRST MESSAGE\n");
+    BOOST_CHECK_EQUAL(proto.idle(), 0u);
+
+    // Released instances are reused, with their filters reset
+    filtering_istream* last = in2.get();
+    in1.reset();
+    in2.reset();
+    BOOST_CHECK_EQUAL(proto.idle(), 2u);
+    for (int z = 0; z < 3; ++z) {
+        istream_prototype::stream_ptr
+            in = proto.open(array_source(gz2.data(), gz2.size()));
+        BOOST_CHECK_EQUAL(proto.idle(), 1u);
+        BOOST_CHECK(in.get() == last);
+        BOOST_CHECK(in->good());
+        BOOST_CHECK_EQUAL(read_all(*in), "SECOND MESSAGE\n");
+    }
+    BOOST_CHECK_EQUAL(decompressors, 2);
+
+    // Instances whose links have changed are not reused
+    {
+        istream_prototype::stream_ptr
+            in = proto.open(array_source(gz1.data(), gz1.size()));
+        in->pop();
+    }
+    BOOST_CHECK_EQUAL(proto.idle(), 1u);
+
+    // Adding a filter discards idle instances
+    proto.push(counter());
+    BOOST_CHECK_EQUAL(proto.idle(), 0u);
+    istream_prototype::stream_ptr
+        in = proto.open(array_source(gz1.data(), gz1.size()));
+    BOOST_CHECK_EQUAL(read_all(*in), "FIRST MESSAGE\n");
+    BOOST_CHECK_EQUAL(
+        in->component<counter>(2)->characters(),
+        static_cast<int>(gz1.size())
+    );
+}
+
+void output_test()
+{
+    ostream_prototype  proto;
+    proto.push(tolower_filter());
+    proto.push_factory(&make_compressor);
+    for (int z = 0; z < 3; ++z) {
+        std::string gz;
+        {
+            ostream_prototype::stream_ptr
+                out = proto.open(io::back_inserter(gz));
+            *out << "Message " << z;
+        }
+        BOOST_CHECK_EQUAL(proto.idle(), 1u);
+
+        // The compressor was closed when the instance was released
+        std::string result;
+        io::copy( io::compose( gzip_decompressor(),
+                               array_source(gz.data(), gz.size()) ),
+                  io::back_inserter(result) );
+        BOOST_CHECK_EQUAL(result, "message " + std::string(1, '0' + z));
+    }
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("chain_prototype test");
+    test->add(BOOST_TEST_CASE(&input_test));
+    test->add(BOOST_TEST_CASE(&output_test));
+    return test;
+}
@@ -0,0 +1,254 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <algorithm>                      // min.
+#include <string>
+#include <vector>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/concepts.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+using namespace boost;
+using namespace boost::iostreams;
+namespace io = boost::iostreams;
+using boost::unit_test::test_suite;
+
+const std::streamsize data_size = 500000;
+const std::streamsize spacing = 50000;
+
+// Returns data_size characters which compress moderately well, so that the
+// compressed data consists of many deflate blocks
+std::string make_data(unsigned int seed)
+{
+    std::string   result;
+    unsigned int  state = seed;
+    while (static_cast<std::streamsize>(result.size()) < data_size) {
+        state = state * 1103515245 + 12345;
+        result += static_cast<char>('a' + (state >> 16) % 16);
+        if ((state >> 8) % 7 == 0)
+            result += ' ';
+    }
+    result.resize(data_size);
+    return result;
+}
+
+// Source which reads from a string; unlike array_source, it can be passed
+// directly to a filter's read() member
+class string_source : public source {
+public:
+    explicit string_source(const std::string& str) : str_(str), pos_(0) { }
+    std::streamsize read(char* s, std::streamsize n)
+    {
+        std::streamsize amt = 
+            (std::min)(n, static_cast<std::streamsize>(str_.size() - pos_));
+        str_.copy(s, static_cast<std::string::size_type>(amt), pos_);
+        pos_ += static_cast<std::string::size_type>(amt);
+        return amt != 0 ? amt : -1;
+    }
+private:
+    const std::string&      str_;
+    std::string::size_type  pos_;
+};
+
+template<typename Compressor>
+std::string compress(const std::string& data, Compressor comp)
+{
+    std::string result;
+    io::copy(
+        array_source(data.data(), data.size()),
+        io::compose(comp, io::back_inserter(result))
+    );
+    return result;
+}
+
+// Decompresses all of the given data, reading in small pieces, and returns
+// each distinct checkpoint recorded along the way
+template<typename Decompressor>
+std::vector<zlib_checkpoint>
+collect_checkpoints(const std::string& compressed, Decompressor dec)
+{
+    std::vector<zlib_checkpoint>  result;
+    string_source                 src(compressed);
+    char                          buf[1000];
+    dec.enable_checkpoints(spacing);
+    while (dec.read(src, buf, sizeof(buf)) != -1) {
+        if ( dec.has_checkpoint() &&
+             ( result.empty() ||
+               result.back().uncompressed_offset !=
+                   dec.checkpoint().uncompressed_offset ) )
+        {
+            result.push_back(dec.checkpoint());
+        }
+    }
+    return result;
+}
+
+// Checks that a decompressor restored from each of the given checkpoints
+// produces the remainder of data
+template<typename Decompressor>
+void check_restore( const std::string& data, const std::string& compressed,
+                    const std::vector<zlib_checkpoint>& checkpoints,
+                    Decompressor proto )
+{
+    for (std::size_t z = 0, n = checkpoints.size(); z < n; ++z) {
+        const zlib_checkpoint&  cp = checkpoints[z];
+        std::string             dest;
+        Decompressor            dec(proto);
+        BOOST_REQUIRE( cp.compressed_offset < 
+                       static_cast<std::streamoff>(compressed.size()) );
+        BOOST_REQUIRE( cp.uncompressed_offset <= 
+                       static_cast<std::streamoff>(data.size()) );
+        dec.restore(cp);
+        io::copy(
+            io::compose(
+                dec,
+                array_source( compressed.data() + cp.compressed_offset,
+                              compressed.data() + compressed.size() )
+            ),
+            io::back_inserter(dest)
+        );
+        BOOST_CHECK(dest == data.substr(cp.uncompressed_offset));
+    }
+}
+
+void zlib_decompressor_test()
+{
+    std::string data = make_data(1);
+
+    // zlib format
+    {
+        std::string                   compressed =
+                                          compress(data, zlib_compressor());
+        std::vector<zlib_checkpoint>  checkpoints =
+            collect_checkpoints(compressed, zlib_decompressor());
+        BOOST_CHECK(checkpoints.size() > 2);
+        check_restore(data, compressed, checkpoints, zlib_decompressor());
+    }
+
+    // Raw deflate
+    {
+        zlib_params                   p;
+        p.noheader = true;
+        std::string                   compressed =
+                                          compress(data, zlib_compressor(p));
+        std::vector<zlib_checkpoint>  checkpoints =
+            collect_checkpoints(compressed, zlib_decompressor(p));
+        BOOST_CHECK(checkpoints.size() > 2);
+        check_restore(data, compressed, checkpoints, zlib_decompressor(p));
+    }
+}
+
+void gzip_decompressor_test()
+{
+    // Two members, so that checkpoints must account for headers and footers
+    gzip_params                   p(gzip::default_compression);
+    p.file_name = "checkpoint_test";
+    std::string                   first = make_data(1),
+                                  second = make_data(2),
+                                  data = first + second,
+                                  compressed =
+                                      compress(first, gzip_compressor(p)) +
+                                      compress(second, gzip_compressor());
+    std::vector<zlib_checkpoint>  checkpoints =
+        collect_checkpoints(compressed, gzip_decompressor());
+    BOOST_CHECK(checkpoints.size() > 4);
+    BOOST_CHECK( checkpoints.back().uncompressed_offset >
+                 (std::streamoff) first.size() );
+    check_restore(data, compressed, checkpoints, gzip_decompressor());
+
+    // Corruption following a checkpoint is detected by the footer
+    zlib_checkpoint cp = checkpoints.back();
+    cp.crc ^= 1;
+    gzip_decompressor  dec;
+    std::string        dest;
+    dec.restore(cp);
+    BOOST_CHECK_THROW(
+        io::copy(
+            io::compose(
+                dec,
+                array_source( compressed.data() + cp.compressed_offset,
+                              compressed.data() + compressed.size() )
+            ),
+            io::back_inserter(dest)
+        ),
+        gzip_error
+    );
+}
+
+// Compresses the first half of data, takes a checkpoint, writes more data
+// and then discards it, and completes the stream with a restored compressor
+template<typename Compressor>
+std::string compress_with_restart(const std::string& data, Compressor proto)
+{
+    std::streamsize                    half = data_size / 2;
+    std::string                        result;
+    back_insert_device<std::string>    snk(result);
+    Compressor                         comp(proto);
+    comp.write(snk, data.data(), half);
+    zlib_checkpoint cp = comp.checkpoint(snk);
+    BOOST_CHECK_EQUAL(cp.compressed_offset, (std::streamoff) result.size());
+    BOOST_CHECK_EQUAL(cp.uncompressed_offset, half);
+    comp.write(snk, data.data() + half, 1000);
+    result.resize(static_cast<std::string::size_type>(cp.compressed_offset));
+
+    Compressor                         restarted(proto);
+    restarted.restore(cp);
+    restarted.write(snk, data.data() + half, data_size - half);
+    restarted.close(snk, BOOST_IOS::out);
+    return result;
+}
+
+template<typename Decompressor>
+std::string decompress(const std::string& compressed, Decompressor dec)
+{
+    std::string result;
+    io::copy(
+        io::compose(dec, array_source(compressed.data(), compressed.size())),
+        io::back_inserter(result)
+    );
+    return result;
+}
+
+void compressor_test()
+{
+    std::string data = make_data(3);
+
+    // gzip
+    {
+        std::string compressed =
+            compress_with_restart(data, gzip_compressor());
+        BOOST_CHECK(decompress(compressed, gzip_decompressor()) == data);
+    }
+
+    // Raw deflate
+    {
+        zlib_params  p;
+        p.noheader = true;
+        std::string  compressed =
+            compress_with_restart(data, zlib_compressor(p));
+        BOOST_CHECK(decompress(compressed, zlib_decompressor(p)) == data);
+    }
+
+    // The zlib format cannot be continued
+    zlib_compressor comp;
+    BOOST_CHECK_THROW(comp.restore(zlib_checkpoint()), zlib_error);
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("checkpoint test");
+    test->add(BOOST_TEST_CASE(&zlib_decompressor_test));
+    test->add(BOOST_TEST_CASE(&gzip_decompressor_test));
+    test->add(BOOST_TEST_CASE(&compressor_test));
+    return test;
+}
@@ -0,0 +1,271 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/iostreams/device/compressed_block.hpp>
+#include <boost/iostreams/filter/snappy.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include "detail/temp_file.hpp"
+
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+using boost::unit_test::test_suite;
+
+typedef basic_compressed_block_device<
+            snappy_compressor,
+            snappy_decompressor
+        >                                      snappy_block_device;
+
+const BOOST_IOS::openmode create =
+    BOOST_IOS::in | BOOST_IOS::out | BOOST_IOS::trunc | BOOST_IOS::binary;
+const BOOST_IOS::openmode update =
+    BOOST_IOS::in | BOOST_IOS::out | BOOST_IOS::binary;
+
+// Returns compressible contents of the given size
+std::string contents(std::size_t size, unsigned seed)
+{
+    std::string result;
+    unsigned value = seed;
+    for (std::size_t z = 0; z < size; ++z) {
+        value = value * 1103515245u + 12345u;
+        result += static_cast<char>('a' + (value >> 16) % 8);
+    }
+    return result;
+}
+
+// Returns the contents of the given device
+template<typename Device>
+std::string read_all(Device& dev)
+{
+    std::string result(static_cast<std::size_t>(dev.size()), '\0');
+    dev.seek(0, BOOST_IOS::beg);
+    if (!result.empty())
+        BOOST_CHECK_EQUAL( dev.read(&result[0], result.size()),
+                           static_cast<std::streamsize>(result.size()) );
+    return result;
+}
+
+zlib_compressor make_zlib() { return zlib_compressor(); }
+
+int decompressors = 0;
+
+zlib_decompressor counting_zlib()
+{
+    ++decompressors;
+    return zlib_decompressor();
+}
+
+void read_write_test()
+{
+    temp_file    temp;
+    std::string  expected;
+
+    // Write to random offsets through a stream, and past the end
+    {
+        compressed_block_device dev( file_descriptor(temp.name(), create),
+                                     compressed_block_params(1000, 4) );
+        stream<compressed_block_device> io(dev);
+        unsigned value = 1;
+        for (int z = 0; z < 200; ++z) {
+            value = value * 1103515245u + 12345u;
+            std::size_t  off = (value >> 8) % 30000;
+            std::string  s = contents(1 + (value >> 4) % 2500, value);
+            if (expected.size() < off + s.size())
+                expected.resize(off + s.size());
+            expected.replace(off, s.size(), s);
+            io.seekp(static_cast<std::streamoff>(off));
+            io.write(s.data(), static_cast<std::streamsize>(s.size()));
+        }
+        io.seekp(40000);
+        io.write("end", 3);
+        expected.resize(40000);
+        expected += "end";
+        BOOST_CHECK(io.good());
+
+        // Reading through the stream sees the characters written
+        std::vector<char> buf(expected.size());
+        io.seekg(0);
+        io.read(&buf[0], static_cast<std::streamsize>(buf.size()));
+        BOOST_CHECK(std::string(buf.begin(), buf.end()) == expected);
+        io.seekg(39990);
+        BOOST_CHECK_EQUAL(io.get(), 0);
+        io.seekg(0, BOOST_IOS::end);
+        BOOST_CHECK_EQUAL(io.tellg(), std::streampos(40003));
+        BOOST_CHECK_EQUAL(io.get(), EOF);
+    }
+
+    // The contents survive reopening the container
+    {
+        compressed_block_device dev(file_descriptor(temp.name(), update));
+        BOOST_CHECK_EQUAL(dev.block_size(), 1000u);
+        BOOST_CHECK_EQUAL(dev.size(), 40003);
+        BOOST_CHECK(read_all(dev) == expected);
+        BOOST_CHECK(
+            dev.used() < static_cast<stream_offset>(expected.size())
+        );
+    }
+
+    // Blocks are decompressed only when missing from the cache
+    {
+        typedef basic_compressed_block_device<
+                    zlib_compressor, zlib_decompressor
+                > device_type;
+        device_type dev( file_descriptor(temp.name(), update),
+                         compressed_block_params(0, 2),
+                         &make_zlib,
+                         &counting_zlib );
+        char buf[100];
+        decompressors = 0;
+        dev.seek(5100, BOOST_IOS::beg);
+        BOOST_CHECK_EQUAL(dev.read(buf, 100), 100);
+        BOOST_CHECK(std::string(buf, 100) == expected.substr(5100, 100));
+        dev.seek(5050, BOOST_IOS::beg);
+        BOOST_CHECK_EQUAL(dev.read(buf, 100), 100);
+        BOOST_CHECK(std::string(buf, 100) == expected.substr(5050, 100));
+        BOOST_CHECK_EQUAL(decompressors, 1);
+        dev.seek(6950, BOOST_IOS::beg);
+        BOOST_CHECK_EQUAL(dev.read(buf, 100), 100);
+        BOOST_CHECK(std::string(buf, 100) == expected.substr(6950, 100));
+        BOOST_CHECK_EQUAL(decompressors, 3);
+
+        // Blocks of null characters are not stored
+        dev.seek(35000, BOOST_IOS::beg);
+        BOOST_CHECK_EQUAL(dev.read(buf, 100), 100);
+        BOOST_CHECK(std::string(buf, 100) == std::string(100, '\0'));
+        BOOST_CHECK_EQUAL(decompressors, 3);
+    }
+}
+
+void compaction_test()
+{
+    temp_file    temp;
+    std::string  expected = contents(20000, 7);
+    {
+        snappy_block_device dev( file_descriptor(temp.name(), create),
+                                 compressed_block_params(1000, 8, 0.5) );
+        dev.write(expected.data(), static_cast<std::streamsize>(20000));
+        dev.flush();
+        BOOST_CHECK_EQUAL(dev.garbage(), 0);
+        stream_offset initial = dev.used();
+
+        // Rewriting the same blocks creates garbage, which is removed when
+        // it exceeds half of the container
+        for (int z = 0; z < 20; ++z) {
+            std::string s = contents(3000, z);
+            expected.replace(2000, s.size(), s);
+            dev.seek(2000, BOOST_IOS::beg);
+            dev.write(s.data(), static_cast<std::streamsize>(s.size()));
+            dev.flush();
+            BOOST_CHECK(dev.garbage() <= (dev.used() - 48) / 2);
+            BOOST_CHECK(dev.used() < 3 * initial);
+        }
+        BOOST_CHECK(read_all(dev) == expected);
+        dev.compact();
+        BOOST_CHECK_EQUAL(dev.garbage(), 0);
+        BOOST_CHECK(read_all(dev) == expected);
+
+        // Dirty blocks are written when evicted from the cache
+        std::string s = contents(15000, 99);
+        expected.replace(4000, s.size(), s);
+        dev.seek(4000, BOOST_IOS::beg);
+        dev.write(s.data(), static_cast<std::streamsize>(s.size()));
+        BOOST_CHECK(dev.garbage() > 0);
+    }
+    snappy_block_device dev(file_descriptor(temp.name(), update));
+    BOOST_CHECK(read_all(dev) == expected);
+}
+
+// Reads random ranges of the given device, recording any mismatch
+void read_ranges( snappy_block_device dev, const std::string* expected,
+                  unsigned seed, boost::mutex* mtx, int* failures )
+{
+    std::vector<char> buf(3000);
+    for (int z = 0; z < 300; ++z) {
+        seed = seed * 1103515245u + 12345u;
+        std::size_t off = (seed >> 8) % (expected->size() - buf.size());
+        dev.seek(static_cast<stream_offset>(off), BOOST_IOS::beg);
+        std::streamsize amt =
+            dev.read(&buf[0], static_cast<std::streamsize>(buf.size()));
+        if ( amt != static_cast<std::streamsize>(buf.size()) ||
+             expected->compare(off, buf.size(), &buf[0], buf.size()) != 0 )
+        {
+            boost::mutex::scoped_lock lock(*mtx);
+            ++*failures;
+        }
+    }
+}
+
+void concurrent_test()
+{
+    temp_file            temp;
+    std::string          expected = contents(100000, 3);
+    snappy_block_device  dev( file_descriptor(temp.name(), create),
+                              compressed_block_params(1000, 8) );
+    dev.write(expected.data(), static_cast<std::streamsize>(expected.size()));
+    dev.flush();
+
+    // Copies have their own positions and share the cache
+    boost::mutex         mtx;
+    int                  failures = 0;
+    boost::thread_group  group;
+    for (unsigned z = 0; z < 4; ++z)
+        group.create_thread(boost::bind( &read_ranges, dev, &expected,
+                                         z + 1, &mtx, &failures ));
+    group.join_all();
+    BOOST_CHECK_EQUAL(failures, 0);
+}
+
+void error_test()
+{
+    temp_file temp;
+    {
+        std::ofstream out(temp.name().c_str(), BOOST_IOS::binary);
+        out << "BIOCBD02" << std::string(100, '\0');
+    }
+    try {
+        compressed_block_device dev(file_descriptor(temp.name(), update));
+        BOOST_ERROR("expected compressed_block_error");
+    } catch (const compressed_block_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), compressed_block::bad_header);
+    }
+
+    // Table referring to characters beyond those in use
+    {
+        compressed_block_device dev( file_descriptor(temp.name(), create),
+                                     compressed_block_params(100) );
+        std::string s = contents(1000, 5);
+        dev.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+    {
+        std::fstream io(temp.name().c_str(), update);
+        io.seekp(32);
+        io.write("\x40\0\0\0", 4);
+    }
+    try {
+        compressed_block_device dev(file_descriptor(temp.name(), update));
+        BOOST_ERROR("expected compressed_block_error");
+    } catch (const compressed_block_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), compressed_block::bad_table);
+    }
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("compressed_block test");
+    test->add(BOOST_TEST_CASE(&read_write_test));
+    test->add(BOOST_TEST_CASE(&compaction_test));
+    test->add(BOOST_TEST_CASE(&concurrent_test));
+    test->add(BOOST_TEST_CASE(&error_test));
+    return test;
+}
@@ -0,0 +1,209 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/concat.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include "detail/temp_file.hpp"
+
+using namespace std;
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+// Returns distinct, poorly compressible contents for the n-th part
+std::string contents(int n, std::size_t size = 5000)
+{
+    std::string result;
+    unsigned value = 12345 + n;
+    for (std::size_t z = 0; z < size; ++z) {
+        value = value * 1103515245u + 12345u;
+        result += static_cast<char>('a' + (value >> 16) % 26);
+    }
+    return result;
+}
+
+template<typename Compressor>
+std::string compress(const std::string& data, const Compressor& c)
+{
+    std::string result;
+    io::copy( array_source(data.data(), data.size()),
+              io::compose(c, io::back_inserter(result)) );
+    return result;
+}
+
+// Temporary files holding the given characters
+class part_files {
+public:
+    void add(const std::string& data)
+    {
+        files_.push_back(boost::shared_ptr<temp_file>(new temp_file));
+        std::ofstream out( files_.back()->name().c_str(),
+                           BOOST_IOS::out | BOOST_IOS::binary );
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+    std::vector<std::string> paths() const
+    {
+        std::vector<std::string> result;
+        for (std::size_t z = 0; z < files_.size(); ++z)
+            result.push_back(files_[z]->name());
+        return result;
+    }
+private:
+    std::vector< boost::shared_ptr<temp_file> > files_;
+};
+
+std::string read_all(concat_source src, std::streamsize chunk = 1000)
+{
+    std::string        result;
+    std::vector<char>  buf(static_cast<std::size_t>(chunk));
+    std::streamsize    amt;
+    while ((amt = src.read(&buf[0], chunk)) != -1)
+        result.append(&buf[0], static_cast<std::size_t>(amt));
+    return result;
+}
+
+// Returns the parts in a vector of strings, naming them by index
+struct string_generator {
+    explicit string_generator(const std::vector<std::string>& parts)
+        : parts(new std::vector<std::string>(parts)), next(0)
+        { }
+    bool operator()(concat_part& p)
+    {
+        if (next == parts->size())
+            return false;
+        const std::string& s = (*parts)[next];
+        p.open(array_source(s.data(), s.size()), std::string(1, '0' + next));
+        ++next;
+        return true;
+    }
+    boost::shared_ptr< std::vector<std::string> >  parts;
+    std::size_t                                    next;
+};
+
+void files_test()
+{
+    part_files   files;
+    std::string  expected;
+    for (int z = 0; z < 20; ++z) {
+        std::string data = contents(z, 100 * z);
+        files.add(data);
+        expected += data;
+    }
+
+    // Small chunks and a small read-ahead make the background thread wait
+    BOOST_CHECK(read_all(concat_source(files.paths())) == expected);
+    BOOST_CHECK(
+        read_all(concat_source(files.paths(), concat_params(
+            concat::none, 64, 256
+        )), 7) == expected
+    );
+    BOOST_CHECK(
+        read_all(concat_source(std::vector<std::string>())).empty()
+    );
+}
+
+void compression_test()
+{
+    part_files                files;
+    std::string               expected;
+    std::vector<std::string>  raw;
+    for (int z = 0; z < 6; ++z) {
+        std::string data = contents(z, 20000);
+        expected += data;
+        if (z % 3 == 0)
+            files.add(compress(data, gzip_compressor()));
+        else if (z % 3 == 1)
+            files.add(data);
+        else
+            files.add(compress(data, zlib_compressor()));
+        raw.push_back(compress(data, zlib_compressor()));
+    }
+
+    // Automatic detection recognizes only gzip
+    std::string automatic =
+        read_all(concat_source(files.paths(), concat::automatic));
+    BOOST_CHECK(automatic.substr(0, 40000) == expected.substr(0, 40000));
+    BOOST_CHECK(automatic.size() < expected.size());
+
+    BOOST_CHECK(
+        read_all(concat_source(string_generator(raw), concat::zlib)) ==
+        expected
+    );
+}
+
+void separator_test()
+{
+    std::vector<std::string> parts;
+    parts.push_back("alpha\n");
+    parts.push_back("");
+    parts.push_back("gamma\n");
+    concat_params p;
+    p.separator = "--\n";
+    concat_source src(string_generator(parts), p);
+    BOOST_CHECK_EQUAL(src.part(), 0u);
+    char buf[4];
+    BOOST_CHECK_EQUAL(src.read(buf, 4), 4);
+    BOOST_CHECK_EQUAL(src.part(), 0u);
+    BOOST_CHECK_EQUAL(src.part_name(), "0");
+    BOOST_CHECK_EQUAL(read_all(src), "a\n--\n--\ngamma\n");
+    BOOST_CHECK_EQUAL(src.part(), 2u);
+    BOOST_CHECK_EQUAL(src.part_name(), "2");
+}
+
+void error_test()
+{
+    part_files files;
+    files.add("first");
+    std::vector<std::string> paths = files.paths();
+    paths.push_back(paths[0] + ".missing");
+
+    // The characters preceding the failure are read first
+    concat_source  src(paths);
+    char           buf[100];
+    BOOST_CHECK_EQUAL(src.read(buf, 100), 5);
+    BOOST_CHECK_THROW(src.read(buf, 100), BOOST_IOSTREAMS_FAILURE);
+    BOOST_CHECK_EQUAL(src.read(buf, 100), -1);
+
+    // Corrupt compressed data
+    std::string gz = compress(contents(0), gzip_compressor());
+    gz[gz.size() / 2] ^= 0x55;
+    gz[gz.size() / 2 + 1] ^= 0x55;
+    std::vector<std::string> parts(1, gz);
+    BOOST_CHECK_THROW(
+        read_all(concat_source(string_generator(parts), concat::automatic)),
+        BOOST_IOSTREAMS_FAILURE
+    );
+
+    // Closing stops a thread which is waiting for the reader
+    std::vector<std::string> many(1000, contents(0, 1000));
+    concat_source stopped(string_generator(many), concat_params(0, 100, 100));
+    BOOST_CHECK_EQUAL(stopped.read(buf, 10), 10);
+    stopped.close();
+    BOOST_CHECK_EQUAL(stopped.read(buf, 10), -1);
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("concat test");
+    test->add(BOOST_TEST_CASE(&files_test));
+    test->add(BOOST_TEST_CASE(&compression_test));
+    test->add(BOOST_TEST_CASE(&separator_test));
+    test->add(BOOST_TEST_CASE(&error_test));
+    return test;
+}
@@ -13,10 +13,13 @@
 #include <boost/iostreams/copy.hpp>
 #include <boost/iostreams/device/array.hpp>
 #include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/error_code.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/stream.hpp>
 #include <boost/test/test_tools.hpp>
 #include <boost/test/unit_test.hpp>
 #include "../example/container_device.hpp"
+#include "detail/filters.hpp"
 #include "detail/sequence.hpp"
 
 using namespace std;
@@ -48,6 +51,37 @@ private:
     size_type      pos_;
 };*/
 
+//------------------Definition of recording_source----------------------------//
+
+// Source which records the range of the buffers passed to read()
+class recording_source : public source {
+public:
+    recording_source(const vector<char>& data, std::streamsize max)
+        : data_(data), pos_(0), max_(max), first_(0), last_(0)
+        { }
+    std::streamsize read(char_type* s, std::streamsize n)
+    {
+        if (pos_ == data_.size())
+            return -1;
+        std::streamsize amt =
+            (std::min)( (std::min)(n, max_),
+                        static_cast<std::streamsize>(data_.size() - pos_) );
+        std::copy(&data_[pos_], &data_[pos_] + amt, s);
+        pos_ += static_cast<std::size_t>(amt);
+        if (!first_)
+            first_ = s;
+        last_ = s + amt;
+        return amt;
+    }
+    const char* first() const { return first_; }
+    const char* last() const { return last_; }
+private:
+    const vector<char>&  data_;
+    std::size_t          pos_;
+    std::streamsize      max_;
+    const char          *first_, *last_;
+};
+
 //------------------Definition of stream types--------------------------------//
 
 typedef container_source< vector<char> >  vector_source;
@@ -164,9 +198,98 @@ void copy_test()
     }
 }
 
+//------------------Definition of direct_copy_test----------------------------//
+
+void direct_copy_test()
+{
+    // An indirect source is read directly into a direct sink, a block at
+    // a time
+    {
+        test_sequence<>   src;
+        vector<char>      dest(src.size(), '?');
+        recording_source  in(src, 100);
+        array_sink        out(&dest[0], &dest[0] + dest.size());
+        BOOST_CHECK_EQUAL(
+            boost::iostreams::copy(boost::ref(in), out, 300),
+            static_cast<streamsize>(src.size())
+        );
+        BOOST_CHECK(src == dest);
+        BOOST_CHECK(in.first() == &dest[0]);
+        BOOST_CHECK(in.last() == &dest[0] + dest.size());
+    }
+
+    // A direct sink may be larger than the contents copied to it
+    {
+        test_sequence<>   src;
+        vector<char>      dest(src.size() + 10, '?');
+        array_source      in(&src[0], &src[0] + src.size());
+        array_sink        out(&dest[0], &dest[0] + dest.size());
+        BOOST_CHECK_EQUAL(
+            boost::iostreams::copy(in, out, 7),
+            static_cast<streamsize>(src.size())
+        );
+        BOOST_CHECK(std::equal(src.begin(), src.end(), dest.begin()));
+        BOOST_CHECK(dest.back() == '?');
+    }
+
+    // Copying more characters than a direct sink can hold is an error
+    {
+        test_sequence<>   src;
+        vector<char>      dest(src.size() - 1);
+        array_source      in(&src[0], &src[0] + src.size());
+        array_sink        out(&dest[0], &dest[0] + dest.size());
+        BOOST_CHECK_THROW(
+            boost::iostreams::copy(in, out),
+            BOOST_IOSTREAMS_FAILURE
+        );
+        BOOST_CHECK_THROW(
+            boost::iostreams::copy(recording_source(src, 5), out),
+            BOOST_IOSTREAMS_FAILURE
+        );
+        boost::system::error_code ec;
+        BOOST_CHECK_EQUAL(boost::iostreams::copy(in, out, ec), 0);
+        BOOST_CHECK(ec == errors::bad_write);
+        ec.clear();
+        BOOST_CHECK_EQUAL(
+            boost::iostreams::copy(recording_source(src, 5), out, ec),
+            static_cast<streamsize>(dest.size())
+        );
+        BOOST_CHECK(ec == errors::bad_write);
+    }
+
+    // Filtering streams read from and write to direct devices
+    {
+        test_sequence<>     src;
+        vector<char>        dest(src.size(), '?');
+        filtering_istream   in;
+        in.push(identity_seekable_filter());
+        in.push(array_source(&src[0], &src[0] + src.size()));
+        BOOST_CHECK_EQUAL(
+            boost::iostreams::copy(
+                in, array_sink(&dest[0], &dest[0] + dest.size())
+            ),
+            static_cast<streamsize>(src.size())
+        );
+        BOOST_CHECK(src == dest);
+
+        vector<char>        dest2(src.size(), '?');
+        filtering_ostream   out;
+        out.push(identity_seekable_filter());
+        out.push(array_sink(&dest2[0], &dest2[0] + dest2.size()));
+        BOOST_CHECK_EQUAL(
+            boost::iostreams::copy(
+                array_source(&src[0], &src[0] + src.size()), out
+            ),
+            static_cast<streamsize>(src.size())
+        );
+        BOOST_CHECK(src == dest2);
+    }
+}
+
 test_suite* init_unit_test_suite(int, char* []) 
 {
     test_suite* test = BOOST_TEST_SUITE("copy test");
     test->add(BOOST_TEST_CASE(&copy_test));
+    test->add(BOOST_TEST_CASE(&direct_copy_test));
     return test;
 }
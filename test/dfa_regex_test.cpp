@@ -0,0 +1,232 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <cstdlib>                     // rand.
+#include <string>
+#include <vector>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/dfa_regex.hpp>
+#include <boost/iostreams/filter/grep.hpp>
+#include <boost/iostreams/filter/regex.hpp>
+#include <boost/iostreams/filter/test.hpp>
+#include <boost/ref.hpp>
+#include <boost/regex.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+using namespace boost;
+using namespace boost::iostreams;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+typedef basic_grep_filter<char, dfa_regex_engine>   dfa_grep_filter;
+typedef basic_regex_filter<char, dfa_regex_engine>  dfa_regex_filter;
+
+bool search(const char* pattern, const std::string& text, int options = 0)
+{
+    return dfa_regex(pattern, options).search( text.data(),
+                                               text.data() + text.size() );
+}
+
+bool match(const char* pattern, const std::string& text, int options = 0)
+{
+    return dfa_regex(pattern, options).match( text.data(),
+                                              text.data() + text.size() );
+}
+
+// Returns the matches of the given pattern, separated by "|"
+std::string find_all( const char* pattern, const std::string& text,
+                      int flags = dfa::match_default )
+{
+    std::vector<dfa_match> matches;
+    dfa_regex(pattern).find_all( text.data(), text.data() + text.size(),
+                                 matches, flags );
+    std::string result;
+    for (std::size_t z = 0; z < matches.size(); ++z) {
+        if (z != 0)
+            result += '|';
+        result += matches[z].str();
+    }
+    return result;
+}
+
+bool is_invalid(const char* pattern, std::size_t max_states = 10000)
+{
+    try {
+        dfa_regex re(pattern, dfa::normal, max_states);
+    } catch (const dfa_regex_error&) {
+        return true;
+    }
+    return false;
+}
+
+void syntax_test()
+{
+    BOOST_CHECK(search("abc", "xxabcxx"));
+    BOOST_CHECK(!search("abc", "xxabxcx"));
+    BOOST_CHECK(search("a.c", "abc"));
+    BOOST_CHECK(!search("a.c", "ac"));
+    BOOST_CHECK(search("colou?r", "color"));
+    BOOST_CHECK(search("colou?r", "colour"));
+    BOOST_CHECK(match("ab*c", "ac"));
+    BOOST_CHECK(match("ab*c", "abbbc"));
+    BOOST_CHECK(!match("ab+c", "ac"));
+    BOOST_CHECK(match("(ab|cd)+", "abcdab"));
+    BOOST_CHECK(!match("(ab|cd)+", "abcda"));
+    BOOST_CHECK(match("(?:ab){2,3}", "ababab"));
+    BOOST_CHECK(!match("(?:ab){2,3}", "ab"));
+    BOOST_CHECK(!match("(?:ab){2,3}", "abababab"));
+    BOOST_CHECK(match("a{3}", "aaa"));
+    BOOST_CHECK(match("a{2,}", "aaaaa"));
+    BOOST_CHECK(match("\\d+-\\d+", "123-45"));
+    BOOST_CHECK(!match("\\d+", "12a"));
+    BOOST_CHECK(match("\\w+\\s\\W", "ab_1 !"));
+    BOOST_CHECK(match("\\x41\\t\\n", "A\t\n"));
+    BOOST_CHECK(match("[a-c]+", "abcba"));
+    BOOST_CHECK(!match("[^a-c]", "b"));
+    BOOST_CHECK(match("[[:digit:]x]+", "1x2"));
+    BOOST_CHECK(match("[]a]+", "]a]"));
+    BOOST_CHECK(match("[a-]+", "-a"));
+    BOOST_CHECK(match("a\\.b\\*", "a.b*"));
+    BOOST_CHECK(match("", ""));
+    BOOST_CHECK(match("HeLLo", "hello", dfa::icase));
+    BOOST_CHECK(match("[^A-Z]", "1", dfa::icase));
+    BOOST_CHECK(!match("[^A-Z]", "q", dfa::icase));
+
+    BOOST_CHECK(is_invalid("(ab"));
+    BOOST_CHECK(is_invalid("ab)"));
+    BOOST_CHECK(is_invalid("[ab"));
+    BOOST_CHECK(is_invalid("*a"));
+    BOOST_CHECK(is_invalid("a*?"));
+    BOOST_CHECK(is_invalid("a++"));
+    BOOST_CHECK(is_invalid("(a)\\1"));
+    BOOST_CHECK(is_invalid("\\bword"));
+    BOOST_CHECK(is_invalid("a{3,2}"));
+    BOOST_CHECK(is_invalid("^a|b"));
+    BOOST_CHECK(is_invalid("a^b"));
+    BOOST_CHECK(is_invalid("(a|b)*a(a|b){12}", 100));
+    BOOST_CHECK(!is_invalid("(a|b)*a(a|b){3}", 100));
+}
+
+void anchor_test()
+{
+    BOOST_CHECK(search("^abc", "abcd"));
+    BOOST_CHECK(!search("^abc", "xabc"));
+    BOOST_CHECK(search("abc$", "xabc"));
+    BOOST_CHECK(!search("abc$", "abcx"));
+    BOOST_CHECK(search("^abc$", "abc"));
+    BOOST_CHECK(!search("^abc$", "abcabc"));
+    BOOST_CHECK(search("abc\\$", "abc$x"));
+    BOOST_CHECK(search("^(a|b)$", "b"));
+
+    dfa_regex    re("^ab");
+    std::string  text = "abab";
+    BOOST_CHECK(
+        !re.search(text.data(), text.data() + 4, dfa::match_not_bol)
+    );
+    BOOST_CHECK_EQUAL(find_all("^ab", text), "ab");
+    BOOST_CHECK_EQUAL(find_all("ab$", text), "ab");
+    BOOST_CHECK_EQUAL(find_all("^ab", text, dfa::match_not_bol), "");
+    BOOST_CHECK_EQUAL(find_all("ab$", text, dfa::match_not_eol), "");
+}
+
+void find_all_test()
+{
+    // Leftmost longest, rather than leftmost first
+    BOOST_CHECK_EQUAL(find_all("a|ab", "abab"), "ab|ab");
+    BOOST_CHECK_EQUAL(find_all("x*", "axxb"), "|xx||");
+    BOOST_CHECK_EQUAL(find_all("[0-9]+", "a12b345c6"), "12|345|6");
+    BOOST_CHECK_EQUAL(find_all("aa", "aaaaa"), "aa|aa");
+    BOOST_CHECK_EQUAL(find_all("q", "abc"), "");
+
+    // Compare with Boost.Regex, which uses the POSIX rules for extended
+    // expressions
+    const char* patterns[] = {
+        "a|ab", "(a|ab)(c|bcd)", "[ab]+c?", "x+y|xy+", "(ab|a)*b",
+        "a[^a]a", "(a|b|c)(b|c|d){1,3}", "d+|c.d"
+    };
+    std::srand(1);
+    for (std::size_t z = 0; z < sizeof(patterns) / sizeof(char*); ++z) {
+        boost::regex  posix(patterns[z], boost::regex::extended);
+        for (int k = 0; k < 100; ++k) {
+            std::string text;
+            for (int n = std::rand() % 20; n != 0; --n)
+                text += "abcdxy"[std::rand() % 6];
+            std::string expected;
+            sregex_iterator first(text.begin(), text.end(), posix), last;
+            for (; first != last; ++first) {
+                if (!expected.empty())
+                    expected += '|';
+                expected += first->str();
+            }
+            BOOST_CHECK_MESSAGE(
+                find_all(patterns[z], text) == expected,
+                std::string("failed finding ") + patterns[z] +
+                " in \"" + text + "\""
+            );
+            BOOST_CHECK_EQUAL(
+                search(patterns[z], text),
+                regex_search(text, posix)
+            );
+        }
+    }
+}
+
+void filter_test()
+{
+    std::string  text =
+        "error: disk full\n"
+        "warning: low memory\n"
+        "errors: 2\n";
+
+    {
+        dfa_grep_filter  grep(dfa_regex("^errors?:"));
+        std::string      dest;
+        io::copy(
+            io::array_source(text.data(), text.data() + text.size()),
+            io::compose(boost::ref(grep), io::back_inserter(dest))
+        );
+        BOOST_CHECK_EQUAL(dest, "error: disk full\nerrors: 2\n");
+        BOOST_CHECK_EQUAL(grep.count(), 2);
+    }
+
+    {
+        dfa_grep_filter  grep( dfa_regex("error.*"), dfa::match_default,
+                               grep::invert | grep::whole_line );
+        std::string      dest;
+        io::copy(
+            io::array_source(text.data(), text.data() + text.size()),
+            io::compose(grep, io::back_inserter(dest))
+        );
+        BOOST_CHECK_EQUAL(dest, "warning: low memory\n");
+    }
+
+    {
+        dfa_regex_filter filter(dfa_regex("[a-z]+:"), "[$&$$]");
+        BOOST_CHECK(
+            io::test_output_filter(
+                filter, text,
+                "[error:$] disk full\n"
+                "[warning:$] low memory\n"
+                "[errors:$] 2\n"
+            )
+        );
+    }
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("dfa_regex test");
+    test->add(BOOST_TEST_CASE(&syntax_test));
+    test->add(BOOST_TEST_CASE(&anchor_test));
+    test->add(BOOST_TEST_CASE(&find_all_test));
+    test->add(BOOST_TEST_CASE(&filter_test));
+    return test;
+}
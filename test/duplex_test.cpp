@@ -0,0 +1,215 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <algorithm>  // min.
+#include <deque>
+#include <string>
+#include <boost/bind.hpp>
+#include <boost/iostreams/duplex.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include "detail/closable.hpp"
+#include "detail/operation_sequence.hpp"
+
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+using boost::unit_test::test_suite;
+
+// Bounded queue of characters, whose reads block until characters are
+// available and whose writes block while it is full
+class channel_buffer {
+public:
+    explicit channel_buffer(std::size_t capacity)
+        : capacity_(capacity), closed_(false)
+        { }
+    std::streamsize read(char* s, std::streamsize n)
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        while (data_.empty() && !closed_)
+            cond_.wait(lock);
+        if (data_.empty())
+            return -1;
+        std::size_t amt =
+            (std::min)(static_cast<std::size_t>(n), data_.size());
+        std::copy(data_.begin(), data_.begin() + amt, s);
+        data_.erase(data_.begin(), data_.begin() + amt);
+        cond_.notify_all();
+        return static_cast<std::streamsize>(amt);
+    }
+    void write(const char* s, std::streamsize n)
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        while (n != 0) {
+            while (data_.size() == capacity_)
+                cond_.wait(lock);
+            std::size_t amt =
+                (std::min)( static_cast<std::size_t>(n),
+                            capacity_ - data_.size() );
+            data_.insert(data_.end(), s, s + amt);
+            s += amt;
+            n -= static_cast<std::streamsize>(amt);
+            cond_.notify_all();
+        }
+    }
+    void close()
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        closed_ = true;
+        cond_.notify_all();
+    }
+private:
+    std::size_t        capacity_;
+    std::deque<char>   data_;
+    bool               closed_;
+    boost::mutex       mtx_;
+    boost::condition   cond_;
+};
+
+typedef boost::shared_ptr<channel_buffer> buffer_ptr;
+
+// Bidirectional device which reads from one channel_buffer and writes to
+// another; closing the output sequence signals end-of-stream to the reader
+// at the other end
+class channel_device {
+public:
+    typedef char char_type;
+    struct category : bidirectional_device_tag, closable_tag { };
+    channel_device(buffer_ptr in, buffer_ptr out) : in_(in), out_(out) { }
+    std::streamsize read(char* s, std::streamsize n)
+    { return in_->read(s, n); }
+    std::streamsize write(const char* s, std::streamsize n)
+    {
+        out_->write(s, n);
+        return n;
+    }
+    void close(BOOST_IOS::openmode which)
+    {
+        if (which == BOOST_IOS::out)
+            out_->close();
+    }
+private:
+    buffer_ptr in_, out_;
+};
+
+// Returns data of the given size which compresses moderately well
+std::string contents(std::size_t size)
+{
+    std::string result;
+    unsigned value = 1;
+    for (std::size_t z = 0; z < size; ++z) {
+        value = value * 1103515245u + 12345u;
+        result += static_cast<char>('a' + (value >> 16) % 16);
+    }
+    return result;
+}
+
+// Reads the given stream to the end, storing its contents
+void receive(std::istream* in, std::string* result)
+{
+    char buf[1000];
+    while (in->read(buf, sizeof(buf)), in->gcount() > 0)
+        result->append(buf, static_cast<std::size_t>(in->gcount()));
+}
+
+// Writes back the characters read until end-of-stream
+void echo(duplex_stream* io)
+{
+    char buf[1000];
+    while (io->in().read(buf, sizeof(buf)), io->in().gcount() > 0)
+        io->out().write(buf, io->in().gcount());
+    io->close();
+}
+
+void echo_test()
+{
+    // The buffers are much smaller than the compressed data, so that each
+    // end blocks writing unless the other end is reading
+    buffer_ptr     to_server(new channel_buffer(1024));
+    buffer_ptr     to_client(new channel_buffer(1024));
+    duplex_stream  server;
+    server.push(zlib_decompressor(), zlib_compressor());
+    server.open(channel_device(to_server, to_client));
+    duplex_stream  client;
+    client.push(zlib_decompressor(), zlib_compressor());
+    client.open(channel_device(to_client, to_server));
+    BOOST_CHECK(client.is_complete());
+
+    std::string    data = contents(1000000), result;
+    boost::thread  echo_thread(boost::bind(&echo, &server));
+    boost::thread  receive_thread(
+        boost::bind(&receive, &client.in(), &result)
+    );
+    client.out().write(data.data(), static_cast<std::streamsize>(data.size()));
+    BOOST_CHECK(client.out().good());
+    client.close_out();
+    receive_thread.join();
+    echo_thread.join();
+    client.close_in();
+    BOOST_CHECK(!client.is_complete());
+    BOOST_CHECK(result == data);
+}
+
+void close_test()
+{
+    // Each direction of a device with two sequences is closed separately,
+    // after the filters of the input chain and before those of the output
+    // chain
+    {
+        operation_sequence  seq;
+        duplex_stream       io;
+        io.push( closable_filter<input>(seq.new_operation(2)),
+                 closable_filter<output>(seq.new_operation(3)) );
+        io.open( closable_device<bidirectional>(
+                     seq.new_operation(1),
+                     seq.new_operation(4)
+                 ) );
+        BOOST_CHECK_NO_THROW(io.close_in());
+        BOOST_CHECK(io.out().good());
+        BOOST_CHECK_NO_THROW(io.close_out());
+        BOOST_CHECK_OPERATION_SEQUENCE(seq);
+    }
+
+    // Other devices are closed with the second direction
+    {
+        operation_sequence  seq;
+        duplex_stream       io;
+        io.push( closable_filter<input>(seq.new_operation(1)),
+                 closable_filter<output>(seq.new_operation(2)) );
+        io.open(closable_device<seekable>(seq.new_operation(3)));
+        BOOST_CHECK_NO_THROW(io.close_in());
+        BOOST_CHECK_NO_THROW(io.close_out());
+        BOOST_CHECK_OPERATION_SEQUENCE(seq);
+    }
+
+    // Destruction closes the output chain first
+    {
+        operation_sequence  seq;
+        {
+            duplex_stream io;
+            io.push( closable_filter<input>(seq.new_operation(4)),
+                     closable_filter<output>(seq.new_operation(1)) );
+            io.open( closable_device<bidirectional>(
+                         seq.new_operation(3),
+                         seq.new_operation(2)
+                     ) );
+        }
+        BOOST_CHECK_OPERATION_SEQUENCE(seq);
+    }
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("duplex test");
+    test->add(BOOST_TEST_CASE(&echo_test));
+    test->add(BOOST_TEST_CASE(&close_test));
+    return test;
+}
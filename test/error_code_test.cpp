@@ -0,0 +1,172 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <stdexcept>
+#include <string>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/error_code.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include "detail/sequence.hpp"
+
+using namespace boost;
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+namespace io = boost::iostreams;
+using boost::system::error_code;
+using boost::unit_test::test_suite;
+
+// Source which throws on every read
+struct throwing_source : source {
+    std::streamsize read(char*, std::streamsize)
+    { throw std::runtime_error("throwing_source"); }
+};
+
+std::string gzip_data()
+{
+    text_sequence  data;
+    std::string    result;
+    io::copy(
+        make_iterator_range(data),
+        io::compose(gzip_compressor(), io::back_inserter(result))
+    );
+    return result;
+}
+
+void file_descriptor_test()
+{
+    BOOST_CHECK(reports_error_codes<file_descriptor>::value);
+    BOOST_CHECK(reports_error_codes<file_descriptor_source>::value);
+
+    file_descriptor_source  src;
+    error_code              ec;
+    char                    c;
+    BOOST_CHECK_EQUAL(io::read(src, &c, 1, ec), -1);
+    BOOST_CHECK(ec == boost::system::errc::bad_file_descriptor);
+
+    file_descriptor_sink    snk;
+    BOOST_CHECK_EQUAL(io::write(snk, &c, 1, ec), 0);
+    BOOST_CHECK(ec == boost::system::errc::bad_file_descriptor);
+
+    file_descriptor         fd;
+    io::seek(fd, 0, BOOST_IOS::beg, ec);
+    BOOST_CHECK(ec == boost::system::errc::bad_file_descriptor);
+}
+
+void round_trip_test()
+{
+    text_sequence  data;
+    std::string    compressed = gzip_data(), dest;
+    error_code     ec;
+    std::streamsize amt =
+        io::copy(
+            io::compose(
+                gzip_decompressor(),
+                array_source(compressed.data(), compressed.size())
+            ),
+            io::back_inserter(dest),
+            ec
+        );
+    BOOST_CHECK(!ec);
+    BOOST_CHECK_EQUAL(amt, static_cast<std::streamsize>(data.size()));
+    BOOST_CHECK(dest == std::string(data.begin(), data.end()));
+}
+
+void corrupt_input_test()
+{
+    std::string  compressed = gzip_data(), dest;
+    error_code   ec;
+
+    // Bad header
+    std::string  bad_header(compressed);
+    bad_header[0] = 0;
+    io::copy(
+        io::compose(
+            gzip_decompressor(),
+            array_source(bad_header.data(), bad_header.size())
+        ),
+        io::back_inserter(dest),
+        ec
+    );
+    BOOST_CHECK(ec == error_code(gzip::bad_header, gzip_category()));
+
+    // Corrupt body
+    std::string  bad_body(compressed);
+    for (std::string::size_type z = 20; z < 40; ++z)
+        bad_body[z] = static_cast<char>(~bad_body[z]);
+    io::copy(
+        io::compose(
+            gzip_decompressor(),
+            array_source(bad_body.data(), bad_body.size())
+        ),
+        io::back_inserter(dest),
+        ec
+    );
+    BOOST_CHECK(ec);
+    BOOST_CHECK( ec.category() == zlib_category() ||
+                 ec.category() == gzip_category() );
+
+    // Truncated footer
+    io::copy(
+        io::compose(
+            gzip_decompressor(),
+            array_source(compressed.data(), compressed.size() - 4)
+        ),
+        io::back_inserter(dest),
+        ec
+    );
+    BOOST_CHECK(ec == error_code(gzip::bad_footer, gzip_category()));
+
+    // Raw zlib
+    std::string  garbage(100, 'x');
+    io::copy(
+        io::compose(
+            zlib_decompressor(),
+            array_source(garbage.data(), garbage.size())
+        ),
+        io::back_inserter(dest),
+        ec
+    );
+    BOOST_CHECK(ec.category() == zlib_category());
+}
+
+void exception_translation_test()
+{
+    error_code  ec;
+    char        buf[10];
+    throwing_source src;
+    BOOST_CHECK(!reports_error_codes<throwing_source>::value);
+    BOOST_CHECK_EQUAL(io::read(src, buf, 10, ec), -1);
+    BOOST_CHECK(ec == errors::failure);
+
+    // Errors from a component which throws propagate through one which
+    // doesn't
+    std::string  dest;
+    io::copy(
+        io::compose(gzip_decompressor(), throwing_source()),
+        io::back_inserter(dest),
+        ec
+    );
+    BOOST_CHECK(ec == errors::failure);
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("error_code test");
+    test->add(BOOST_TEST_CASE(&file_descriptor_test));
+    test->add(BOOST_TEST_CASE(&round_trip_test));
+    test->add(BOOST_TEST_CASE(&corrupt_input_test));
+    test->add(BOOST_TEST_CASE(&exception_translation_test));
+    return test;
+}
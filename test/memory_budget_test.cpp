@@ -0,0 +1,144 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <string>
+#include <vector>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/counter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/memory_budget.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include "detail/sequence.hpp"
+
+using namespace std;
+using namespace boost;
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+namespace io = boost::iostreams;
+using boost::unit_test::test_suite;
+
+typedef budget_allocator<char>                           alloc_type;
+typedef basic_zlib_compressor<alloc_type>                compressor;
+typedef filtering_stream<
+            output, char, std::char_traits<char>, alloc_type
+        >                                                budget_ostream;
+typedef filtering_stream<
+            input, char, std::char_traits<char>, alloc_type
+        >                                                budget_istream;
+
+const char null_data[] = "";
+
+void accounting_test()
+{
+    memory_budget budget;
+    {
+        budget_ostream out;
+        out.set_budget(&budget);
+        {
+            memory_budget::scope scope(budget);
+            out.push(compressor());
+        }
+        BOOST_CHECK(budget.used() > 0);
+        std::size_t used = budget.used();
+        std::string dest;
+        out.push(io::back_inserter(dest));
+        BOOST_CHECK(budget.used() > used);
+        text_sequence data;
+        io::copy(make_iterator_range(data), out);
+        BOOST_CHECK(budget.peak() >= budget.used());
+    }
+    BOOST_CHECK_EQUAL(budget.used(), 0u);
+    BOOST_CHECK(budget.peak() > 0);
+
+    // Allocations outside a scope are not charged
+    {
+        compressor c;
+        BOOST_CHECK_EQUAL(budget.used(), 0u);
+    }
+}
+
+void throw_exception_test()
+{
+    memory_budget budget(1000, memory_budget::throw_exception);
+    budget_istream in;
+    in.set_budget(&budget);
+    {
+        memory_budget::scope scope(budget);
+        // zlib reports the failure as Z_MEM_ERROR
+        BOOST_CHECK_THROW(compressor(), std::bad_alloc);
+    }
+    BOOST_CHECK_EQUAL(budget.used(), 0u);
+    BOOST_CHECK_THROW(
+        in.push(counter(), 4096),
+        memory_budget_exceeded
+    );
+    BOOST_CHECK(in.empty());
+    BOOST_CHECK_EQUAL(budget.used(), 0u);
+    in.push(counter(), 512);
+    in.push(array_source(null_data, null_data));
+    BOOST_CHECK(in.is_complete());
+    BOOST_CHECK(budget.used() > 0);
+}
+
+void fail_push_test()
+{
+    memory_budget budget(1000, memory_budget::fail_push);
+    budget_istream in;
+    in.set_budget(&budget);
+    BOOST_CHECK_THROW(
+        in.push(counter(), 4096),
+        memory_budget_exceeded
+    );
+    BOOST_CHECK(in.empty());
+    BOOST_CHECK_EQUAL(budget.used(), 0u);
+    in.push(counter(), 512);
+    in.push(array_source(null_data, null_data));
+    BOOST_CHECK(in.is_complete());
+}
+
+void shrink_buffers_test()
+{
+    text_sequence      data;
+    std::vector<char>  dest;
+    memory_budget      budget(200, memory_budget::shrink_buffers);
+    {
+        budget_istream in;
+        in.set_budget(&budget);
+        in.push(counter(), 4096);
+        in.push(array_source(&data[0], data.size()));
+        BOOST_CHECK(budget.used() > 0);
+        BOOST_CHECK(budget.used() <= budget.limit());
+        io::copy(in, io::back_inserter(dest));
+        BOOST_CHECK_EQUAL(
+            in.component<counter>(0)->characters(), 
+            static_cast<int>(data.size())
+        );
+    }
+    BOOST_CHECK_EQUAL(budget.used(), 0u);
+    BOOST_REQUIRE_EQUAL(data.size(), dest.size());
+    BOOST_CHECK(std::equal(data.begin(), data.end(), dest.begin()));
+
+    // Buffers can't shrink below one character
+    budget.set_limit(0);
+    budget_istream in;
+    in.set_budget(&budget);
+    BOOST_CHECK_THROW(in.push(counter(), 4096), memory_budget_exceeded);
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("memory_budget test");
+    test->add(BOOST_TEST_CASE(&accounting_test));
+    test->add(BOOST_TEST_CASE(&throw_exception_test));
+    test->add(BOOST_TEST_CASE(&fail_push_test));
+    test->add(BOOST_TEST_CASE(&shrink_buffers_test));
+    return test;
+}
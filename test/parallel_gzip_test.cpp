@@ -0,0 +1,173 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <string>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/parallel_gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace boost::iostreams;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+// Returns contents of the given size consisting of words chosen at random,
+// so that back-references of all distances occur
+std::string contents(std::size_t size)
+{
+    static const char* const words[] =
+        { "alpha ", "beta ", "gamma ", "delta ", "epsilon ", "zeta ", "eta ",
+          "theta ", "iota ", "kappa ", "lambda ", "mu ", "nu ", "xi ", "\n" };
+    std::string result;
+    unsigned value = 12345;
+    while (result.size() < size) {
+        value = value * 1103515245u + 12345u;
+        if ((value >> 16) % 5 == 0)
+            result += static_cast<char>(value >> 8);
+        else
+            result += words[(value >> 16) % 15];
+    }
+    result.resize(size);
+    return result;
+}
+
+std::string compress( const std::string& data,
+                      int level = zlib::default_compression )
+{
+    std::string result;
+    io::copy( array_source(data.data(), data.size()),
+              io::compose(gzip_compressor(level), io::back_inserter(result)) );
+    return result;
+}
+
+std::string decompress( const std::string& data,
+                        const parallel_gzip_params& p )
+{
+    std::string result;
+    io::copy( io::compose( parallel_gzip_decompressor(p),
+                           array_source(data.data(), data.size()) ),
+              io::back_inserter(result) );
+    return result;
+}
+
+void round_trip_test()
+{
+    const std::size_t sizes[] = { 1, 1000, 100000, 1500000 };
+    const int levels[] =
+        { zlib::no_compression, zlib::best_speed, zlib::best_compression };
+    const std::size_t chunks[] = { 3000, 16384, 0 };
+    for (std::size_t z = 0; z < sizeof(sizes) / sizeof(sizes[0]); ++z) {
+        std::string data = contents(sizes[z]);
+        for (std::size_t l = 0; l < 3; ++l) {
+            std::string gz = compress(data, levels[l]);
+            for (std::size_t c = 0; c < 3; ++c) {
+                for (unsigned threads = 1; threads <= 4; threads += 3) {
+                    parallel_gzip_params p(chunks[c], threads);
+                    BOOST_CHECK(decompress(gz, p) == data);
+                }
+            }
+        }
+    }
+}
+
+void multiple_member_test()
+{
+    std::string  first = contents(300000), second = contents(5000);
+    std::string  gz = compress(first) + compress(second, 1);
+    BOOST_CHECK(decompress(gz, parallel_gzip_params(4096, 4)) ==
+                first + second);
+
+    // Use with a filtering_istream; the filter may be reused after it is
+    // closed
+    parallel_gzip_decompressor d(parallel_gzip_params(10000, 3));
+    for (int z = 0; z < 2; ++z) {
+        filtering_istream in;
+        in.push(d);
+        in.push(array_source(gz.data(), gz.size()));
+        std::string result;
+        io::copy(in, io::back_inserter(result));
+        BOOST_CHECK(result == first + second);
+    }
+}
+
+void error_test()
+{
+    std::string  data = contents(200000);
+    std::string  gz = compress(data);
+    parallel_gzip_params p(5000, 4);
+
+    // Checksum and length
+    std::string bad = gz;
+    bad[bad.size() - 6] ^= 1;
+    try {
+        decompress(bad, p);
+        BOOST_ERROR("expected gzip_error");
+    } catch (const gzip_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), gzip::bad_crc);
+    }
+    bad = gz;
+    bad[bad.size() - 2] ^= 1;
+    try {
+        decompress(bad, p);
+        BOOST_ERROR("expected gzip_error");
+    } catch (const gzip_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), gzip::bad_length);
+    }
+
+    // Header and footer
+    bad = gz;
+    bad[2] = 7;
+    try {
+        decompress(bad, p);
+        BOOST_ERROR("expected gzip_error");
+    } catch (const gzip_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), gzip::bad_method);
+    }
+    try {
+        decompress(gz + "garbage", p);
+        BOOST_ERROR("expected gzip_error");
+    } catch (const gzip_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), gzip::bad_header);
+    }
+    try {
+        decompress(gz.substr(0, gz.size() - 3), p);
+        BOOST_ERROR("expected gzip_error");
+    } catch (const gzip_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), gzip::bad_footer);
+    }
+
+    // Compressed data
+    const std::size_t sizes[] = { 20, gz.size() / 2 };
+    for (std::size_t z = 0; z < 2; ++z) {
+        try {
+            decompress(gz.substr(0, sizes[z]), p);
+            BOOST_ERROR("expected gzip_error");
+        } catch (const gzip_error& e) {
+            BOOST_CHECK_EQUAL(e.error(), gzip::zlib_error);
+            BOOST_CHECK_EQUAL(e.zlib_error_code(), zlib::data_error);
+        }
+    }
+    bad = gz;
+    for (std::size_t z = 0; z < 16; ++z)
+        bad[gz.size() / 2 + z] = static_cast<char>(0xFF);
+    BOOST_CHECK_THROW(decompress(bad, p), gzip_error);
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("parallel_gzip test");
+    test->add(BOOST_TEST_CASE(&round_trip_test));
+    test->add(BOOST_TEST_CASE(&multiple_member_test));
+    test->add(BOOST_TEST_CASE(&error_test));
+    return test;
+}
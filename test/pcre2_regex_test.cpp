@@ -0,0 +1,173 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <string>
+#include <vector>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/grep.hpp>
+#include <boost/iostreams/filter/pcre2_regex.hpp>
+#include <boost/iostreams/filter/regex.hpp>
+#include <boost/iostreams/filter/test.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+using namespace boost;
+using namespace boost::iostreams;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+typedef basic_grep_filter<char, pcre2_regex_engine>   pcre2_grep_filter;
+typedef basic_regex_filter<char, pcre2_regex_engine>  pcre2_regex_filter;
+
+bool search( const char* pattern, const std::string& text,
+             int options = pcre2::normal, int flags = pcre2::match_default )
+{
+    return pcre2_regex(pattern, options).search( text.data(),
+                                                 text.data() + text.size(),
+                                                 flags );
+}
+
+bool match(const char* pattern, const std::string& text)
+{
+    return pcre2_regex(pattern).match(text.data(), text.data() + text.size());
+}
+
+// Returns the matches of the given pattern, separated by "|"
+std::string find_all( const char* pattern, const std::string& text,
+                      int options = pcre2::normal )
+{
+    std::vector<pcre2_match_results> matches;
+    pcre2_regex(pattern, options).find_all( text.data(),
+                                            text.data() + text.size(),
+                                            matches );
+    std::string result;
+    for (std::size_t z = 0; z < matches.size(); ++z) {
+        if (z != 0)
+            result += '|';
+        result += matches[z].str();
+    }
+    return result;
+}
+
+void match_test()
+{
+    BOOST_CHECK(search("b+", "abbbc"));
+    BOOST_CHECK(!search("d", "abc"));
+    BOOST_CHECK(search("ABC", "xabcx", pcre2::icase));
+    BOOST_CHECK(search("^b", "a\nb", pcre2::multiline));
+    BOOST_CHECK(!search("^b", "a\nb"));
+    BOOST_CHECK(search("a.b", "a\nb", pcre2::dotall));
+    BOOST_CHECK(!search("a.b", "a\nb"));
+    BOOST_CHECK(search("a b # comment", "ab", pcre2::extended));
+    BOOST_CHECK(!search("^a", "ab", pcre2::normal, pcre2::match_not_bol));
+    BOOST_CHECK(!search("b$", "ab", pcre2::normal, pcre2::match_not_eol));
+    BOOST_CHECK(!search("x*", "ab", pcre2::normal, pcre2::match_not_empty));
+
+    // Backreferences and lookaround
+    BOOST_CHECK(match("(\\w+) \\1", "hello hello"));
+    BOOST_CHECK(!match("(\\w+) \\1", "hello world"));
+    BOOST_CHECK(search("foo(?=bar)", "foobar"));
+    BOOST_CHECK(!search("foo(?=bar)", "foobaz"));
+
+    // Whole matches
+    BOOST_CHECK(match("a|ab", "ab"));
+    BOOST_CHECK(!match("ab", "abc"));
+    BOOST_CHECK(!match("bc", "abc"));
+
+    BOOST_CHECK_EQUAL(pcre2_regex("(a)(b(c))?").mark_count(), 3u);
+
+    bool thrown = false;
+    try {
+        pcre2_regex re("(ab");
+    } catch (const pcre2_error& e) {
+        thrown = true;
+        BOOST_CHECK(e.error() != 0);
+    }
+    BOOST_CHECK(thrown);
+}
+
+void find_all_test()
+{
+    BOOST_CHECK_EQUAL(find_all("\\d+", "a12b345c6"), "12|345|6");
+    BOOST_CHECK_EQUAL(find_all("a|ab", "abab"), "a|a");
+    BOOST_CHECK_EQUAL(find_all("x*", "axxb"), "|xx||");
+    BOOST_CHECK_EQUAL(find_all("q", "abc"), "");
+
+    // Empty matches between the characters of a multibyte sequence
+    BOOST_CHECK_EQUAL(find_all("", "\xc3\xa9", pcre2::utf), "|");
+
+    std::vector<pcre2_match_results>  matches;
+    std::string                       text = "k1=v1, k2=, k3=v3";
+    pcre2_regex("(\\w+)=(\\w+)?").find_all( text.data(),
+                                            text.data() + text.size(),
+                                            matches );
+    BOOST_REQUIRE_EQUAL(matches.size(), 3u);
+    BOOST_CHECK_EQUAL(matches[0].size(), 3u);
+    BOOST_CHECK_EQUAL(matches[0].str(1), "k1");
+    BOOST_CHECK_EQUAL(matches[0].str(2), "v1");
+    BOOST_CHECK_EQUAL(matches[1].position(), 7u);
+    BOOST_CHECK(!matches[1].matched(2));
+    BOOST_CHECK_EQUAL(matches[1].length(2), 0u);
+    BOOST_CHECK_EQUAL(matches[2].length(), 5u);
+}
+
+void filter_test()
+{
+    std::string  text =
+        "error: disk full\n"
+        "warning: low memory\n"
+        "errors: 2\n";
+
+    {
+        pcre2_grep_filter  grep(pcre2_regex("^errors?:"));
+        std::string        dest;
+        io::copy(
+            io::array_source(text.data(), text.data() + text.size()),
+            io::compose(boost::ref(grep), io::back_inserter(dest))
+        );
+        BOOST_CHECK_EQUAL(dest, "error: disk full\nerrors: 2\n");
+        BOOST_CHECK_EQUAL(grep.count(), 2);
+    }
+
+    {
+        pcre2_grep_filter  grep( pcre2_regex("error.*"),
+                                 pcre2::match_default,
+                                 grep::invert | grep::whole_line );
+        std::string        dest;
+        io::copy(
+            io::array_source(text.data(), text.data() + text.size()),
+            io::compose(grep, io::back_inserter(dest))
+        );
+        BOOST_CHECK_EQUAL(dest, "warning: low memory\n");
+    }
+
+    {
+        pcre2_regex_filter filter( pcre2_regex("(\\w+): (\\w+)"),
+                                   "$2 <${1}> $$$& ${x}" );
+        BOOST_CHECK(
+            io::test_output_filter(
+                filter, text,
+                "disk <error> $error: disk ${x} full\n"
+                "low <warning> $warning: low ${x} memory\n"
+                "2 <errors> $errors: 2 ${x}\n"
+            )
+        );
+    }
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("pcre2_regex test");
+    test->add(BOOST_TEST_CASE(&match_test));
+    test->add(BOOST_TEST_CASE(&find_all_test));
+    test->add(BOOST_TEST_CASE(&filter_test));
+    return test;
+}
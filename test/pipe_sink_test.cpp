@@ -0,0 +1,151 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+#include <boost/bind.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/device/pipe_sink.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+#include "detail/temp_file.hpp"
+
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+using boost::unit_test::test_suite;
+
+// Returns poorly compressible contents of the given size
+std::string contents(std::size_t size)
+{
+    std::string result;
+    unsigned value = 12345;
+    for (std::size_t z = 0; z < size; ++z) {
+        value = value * 1103515245u + 12345u;
+        result += static_cast<char>(value >> 16);
+    }
+    return result;
+}
+
+// Reads from the given descriptor until end-of-file, pausing occasionally
+// so that the pipe fills up
+void read_all(int fd, std::string* result)
+{
+    char buf[5000];
+    for (int count = 0; ; ++count) {
+        ssize_t amt = ::read(fd, buf, sizeof(buf));
+        if (amt <= 0)
+            break;
+        result->append(buf, static_cast<std::size_t>(amt));
+        if (count % 64 == 0)
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+    ::close(fd);
+}
+
+// Writes data to a pipe_sink with the given parameters, in pieces of
+// varying size, and returns the characters read from the pipe
+std::string write_to_pipe( const std::string& data, const pipe_params& p,
+                           bool* zero_copy )
+{
+    int fds[2];
+    BOOST_REQUIRE(::pipe(fds) == 0);
+    std::string    result;
+    boost::thread  reader(boost::bind(&read_all, fds[0], &result));
+    {
+        stream<pipe_sink> out(pipe_sink(fds[1], close_handle, p), 1000);
+        std::size_t pos = 0;
+        for (std::size_t amt = 1; pos < data.size(); amt = amt * 7 % 10007) {
+            if (amt > data.size() - pos)
+                amt = data.size() - pos;
+            out.write(data.data() + pos, static_cast<std::streamsize>(amt));
+            pos += amt;
+        }
+        out.flush();
+        *zero_copy = out->zero_copy();
+    }
+    reader.join();
+    return result;
+}
+
+void zero_copy_test()
+{
+    std::string  data = contents(3000000);
+    bool         zero_copy = false;
+
+    // Small buffers are reused many times
+    BOOST_CHECK(write_to_pipe(data, pipe_params(), &zero_copy) == data);
+    BOOST_CHECK(zero_copy);
+    BOOST_CHECK(
+        write_to_pipe(data, pipe_params(0, true, 1), &zero_copy) == data
+    );
+    BOOST_CHECK(zero_copy);
+    BOOST_CHECK(
+        write_to_pipe(data, pipe_params(256 * 1024, true), &zero_copy) ==
+        data
+    );
+    BOOST_CHECK(zero_copy);
+
+    // Copying
+    BOOST_CHECK(
+        write_to_pipe(data, pipe_params(0, false), &zero_copy) == data
+    );
+    BOOST_CHECK(!zero_copy);
+}
+
+void pipe_size_test()
+{
+    int fds[2];
+    BOOST_REQUIRE(::pipe(fds) == 0);
+    file_descriptor_source  in(fds[0], close_handle);
+    pipe_sink               out(fds[1], close_handle, 128 * 1024);
+    BOOST_CHECK(out.pipe_size() >= 128 * 1024u);
+    std::size_t size = out.set_pipe_size(256 * 1024);
+    BOOST_CHECK(size >= 256 * 1024u);
+    BOOST_CHECK_EQUAL(out.pipe_size(), size);
+
+    // Flushing makes buffered characters available to the reader
+    char buf[6];
+    BOOST_CHECK_EQUAL(out.write("hello", 5), 5);
+    out.flush();
+    BOOST_CHECK_EQUAL(in.read(buf, 6), 5);
+    BOOST_CHECK_EQUAL(std::string(buf, 5), "hello");
+    BOOST_CHECK_EQUAL(out.write("world", 5), 5);
+    out.close();
+    BOOST_CHECK_EQUAL(in.read(buf, 6), 5);
+    BOOST_CHECK_EQUAL(std::string(buf, 5), "world");
+    BOOST_CHECK_EQUAL(in.read(buf, 6), -1);
+}
+
+void file_test()
+{
+    temp_file    temp;
+    std::string  data = contents(100000);
+    {
+        file_descriptor_sink  file(temp.name(), BOOST_IOS::out);
+        stream<pipe_sink>     out(pipe_sink(file, 1024 * 1024));
+        BOOST_CHECK(!out->zero_copy());
+        BOOST_CHECK_EQUAL(out->pipe_size(), 0u);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+    std::ifstream in(temp.name().c_str(), BOOST_IOS::in | BOOST_IOS::binary);
+    std::string result( (std::istreambuf_iterator<char>(in)),
+                        std::istreambuf_iterator<char>() );
+    BOOST_CHECK(result == data);
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("pipe_sink test");
+    test->add(BOOST_TEST_CASE(&zero_copy_test));
+    test->add(BOOST_TEST_CASE(&pipe_size_test));
+    test->add(BOOST_TEST_CASE(&file_test));
+    return test;
+}
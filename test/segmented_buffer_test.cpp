@@ -0,0 +1,185 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <cctype>    // toupper.
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/device/segmented_buffer.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include "detail/filters.hpp"
+#include "detail/temp_file.hpp"
+
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+// Returns the contents of the given buffer
+std::string contents(const segmented_buffer& buf)
+{
+    std::string result;
+    for ( segmented_buffer::const_iterator it = buf.begin();
+          it != buf.end(); ++it )
+    {
+        result.append(it->data(), it->size());
+    }
+    return result;
+}
+
+void append_test()
+{
+    // Copied characters share storage until it is full
+    segmented_buffer buf(16);
+    buf.append("hello ", 6);
+    buf.append("world", 5);
+    BOOST_CHECK_EQUAL(buf.size(), 11u);
+    BOOST_CHECK_EQUAL(buf.segment_count(), 1u);
+    buf.append("0123456789", 10);
+    BOOST_CHECK_EQUAL(buf.segment_count(), 2u);
+    BOOST_CHECK_EQUAL(contents(buf), "hello world0123456789");
+
+    // Borrowed and owned characters are not copied
+    static const char borrowed[] = "borrowed";
+    boost::shared_ptr<std::string> owned(new std::string("owned"));
+    buf.append_borrowed(borrowed, 8);
+    buf.append(owned->data(), owned->size(), owned);
+    BOOST_CHECK_EQUAL(buf.segment_count(), 4u);
+    segmented_buffer::const_iterator it = buf.begin();
+    std::advance(it, 2);
+    BOOST_CHECK(it->data() == borrowed);
+    BOOST_CHECK((++it)->data() == owned->data());
+    BOOST_CHECK_EQUAL(owned.use_count(), 2);
+    BOOST_CHECK_EQUAL(contents(buf), "hello world0123456789borrowedowned");
+
+    // Appending a buffer shares its segments
+    segmented_buffer other;
+    other.append(buf);
+    other.append(buf);
+    BOOST_CHECK_EQUAL(other.segment_count(), 8u);
+    BOOST_CHECK(other.begin()->data() == buf.begin()->data());
+    BOOST_CHECK_EQUAL(owned.use_count(), 4);
+    other.clear();
+    buf.clear();
+    BOOST_CHECK(buf.empty());
+    BOOST_CHECK_EQUAL(owned.use_count(), 1);
+}
+
+void split_test()
+{
+    segmented_buffer buf(8);
+    buf.append("abcdefgh", 8);
+    buf.append("ijklmnop", 8);
+    buf.append("qrstuvwx", 8);
+    const char* second = (++buf.begin())->data();
+
+    segmented_buffer first = buf.split(11);
+    BOOST_CHECK_EQUAL(contents(first), "abcdefghijk");
+    BOOST_CHECK_EQUAL(contents(buf), "lmnopqrstuvwx");
+    BOOST_CHECK_EQUAL(first.segment_count(), 2u);
+    BOOST_CHECK((++first.begin())->data() == second);
+    BOOST_CHECK(buf.begin()->data() == second + 3);
+
+    buf.consume(6);
+    BOOST_CHECK_EQUAL(contents(buf), "rstuvwx");
+    BOOST_CHECK_EQUAL(contents(buf.split(100)), "rstuvwx");
+    BOOST_CHECK(buf.empty());
+
+    // A copy shares segments; characters appended to either are not seen
+    // by the other, even if both could use the same storage
+    segmented_buffer a(64);
+    a.append("shared", 6);
+    segmented_buffer b = a;
+    BOOST_CHECK(a.begin()->data() == b.begin()->data());
+    a.append("-a", 2);
+    b.append("-b", 2);
+    BOOST_CHECK_EQUAL(contents(a), "shared-a");
+    BOOST_CHECK_EQUAL(contents(b), "shared-b");
+    BOOST_CHECK_EQUAL(a.segment_count(), 1u);
+    BOOST_CHECK_EQUAL(b.segment_count(), 2u);
+}
+
+void device_test()
+{
+    segmented_buffer buf(100);
+    std::string      data;
+    for (int z = 0; z < 2000; ++z) {
+        std::string s(1 + z % 7, static_cast<char>('a' + z % 26));
+        data += s;
+        if (z % 3 == 0) {
+            buf.append(s.data(), s.size());
+        } else {
+            boost::shared_ptr<std::string> owned(new std::string(s));
+            buf.append(owned->data(), owned->size(), owned);
+        }
+    }
+    BOOST_CHECK(buf.segment_count() > 1000u);
+
+    // Reading
+    {
+        segmented_source  src(buf);
+        char              chunk[10];
+        std::string       result;
+        std::streamsize   amt;
+        while ((amt = src.read(chunk, sizeof(chunk))) != -1)
+            result.append(chunk, static_cast<std::size_t>(amt));
+        BOOST_CHECK(result == data);
+        BOOST_CHECK_EQUAL(buf.size(), data.size());
+    }
+
+    // Copying to an ordinary sink, to a segmented_sink and through a chain
+    {
+        std::string result;
+        BOOST_CHECK_EQUAL(
+            io::copy(segmented_source(buf), io::back_inserter(result)),
+            static_cast<std::streamsize>(data.size())
+        );
+        BOOST_CHECK(result == data);
+
+        segmented_buffer dest;
+        io::copy(segmented_source(buf), segmented_sink(dest));
+        BOOST_CHECK_EQUAL(dest.segment_count(), buf.segment_count());
+        BOOST_CHECK(dest.begin()->data() == buf.begin()->data());
+
+        filtering_istream in;
+        in.push(toupper_filter());
+        in.push(segmented_source(buf));
+        segmented_buffer upper;
+        io::copy(in, segmented_sink(upper));
+        std::string expected = data;
+        for (std::size_t z = 0; z < expected.size(); ++z)
+            expected[z] = static_cast<char>(std::toupper(expected[z]));
+        BOOST_CHECK(contents(upper) == expected);
+    }
+
+    // Copying to a file descriptor
+    {
+        temp_file temp;
+        io::copy( segmented_source(buf),
+                  file_descriptor_sink(temp.name(), BOOST_IOS::out) );
+        std::ifstream in( temp.name().c_str(),
+                          BOOST_IOS::in | BOOST_IOS::binary );
+        std::string result( (std::istreambuf_iterator<char>(in)),
+                            std::istreambuf_iterator<char>() );
+        BOOST_CHECK(result == data);
+    }
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("segmented_buffer test");
+    test->add(BOOST_TEST_CASE(&append_test));
+    test->add(BOOST_TEST_CASE(&split_test));
+    test->add(BOOST_TEST_CASE(&device_test));
+    return test;
+}
@@ -0,0 +1,179 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <string>
+#include <boost/cstdint.hpp>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/shuffle.hpp>
+#include <boost/iostreams/filter/test.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include "detail/sequence.hpp"
+
+using namespace std;
+using namespace boost;
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+// Returns n little-endian 64-bit integers which increase slowly, like
+// timestamps
+std::string timestamps(int n)
+{
+    std::string      result;
+    boost::uint64_t  value = 1200000000000ULL;
+    for (int z = 0; z < n; ++z) {
+        value += 1000 + (z * 7919) % 50;
+        for (int k = 0; k < 8; ++k)
+            result += static_cast<char>((value >> (8 * k)) & 0xff);
+    }
+    return result;
+}
+
+template<typename Filter>
+std::string write_through(const std::string& data, Filter f)
+{
+    std::string result;
+    io::copy(
+        array_source(data.data(), data.size()),
+        io::compose(f, io::back_inserter(result))
+    );
+    return result;
+}
+
+template<typename Filter>
+std::string read_through(const std::string& data, Filter f)
+{
+    std::string result;
+    io::copy(
+        io::compose(f, array_source(data.data(), data.size())),
+        io::back_inserter(result)
+    );
+    return result;
+}
+
+void shuffle_test()
+{
+    // Bytes are grouped by position; the partial element is unchanged
+    BOOST_CHECK_EQUAL(
+        write_through(std::string("a1b2c3d4e"), shuffle_filter<2>()),
+        "abcd1234e"
+    );
+    BOOST_CHECK_EQUAL(
+        read_through(std::string("abcd1234e"), shuffle_filter<2>()),
+        "a1b2c3d4e"
+    );
+
+    // Blocks of 6 characters, the last of which is partial
+    BOOST_CHECK_EQUAL(
+        write_through(std::string("a1b2c3d4e5f"), shuffle_filter<2>(6)),
+        "abc123de45f"
+    );
+
+    text_sequence  data;
+    std::string    str(data.begin(), data.end());
+    BOOST_CHECK(
+        test_filter_pair(shuffle_filter<2>(), shuffle_filter<2>(), str)
+    );
+    BOOST_CHECK(
+        test_filter_pair(shuffle_filter<3>(100), shuffle_filter<3>(100), str)
+    );
+    BOOST_CHECK(
+        test_filter_pair( shuffle_filter<4>(1000),
+                          shuffle_filter<4>(1000), str )
+    );
+    BOOST_CHECK(
+        test_filter_pair(shuffle_filter<8>(), shuffle_filter<8>(), str)
+    );
+    BOOST_CHECK(
+        test_filter_pair( shuffle_filter<16>(160),
+                          shuffle_filter<16>(160), str )
+    );
+    BOOST_CHECK(
+        test_filter_pair( shuffle_filter<8>(), shuffle_filter<8>(),
+                          std::string() )
+    );
+}
+
+void bitshuffle_test()
+{
+    // Bit b of byte j of eight elements forms row 8 * j + b
+    std::string elements("\x01\x80\x00\x80\x03\x80\x00\x80"
+                         "\x01\x80\x00\x80\x00\x80\x00\x81", 16);
+    std::string rows(16, '\0');
+    rows[0] = '\x15';
+    rows[1] = '\x04';
+    rows[8 + 0] = '\x80';
+    rows[8 + 7] = '\xff';
+    BOOST_CHECK(write_through(elements, bitshuffle_filter(2)) == rows);
+    BOOST_CHECK(read_through(rows, bitshuffle_filter(2)) == elements);
+
+    text_sequence  data;
+    std::string    str(data.begin(), data.end());
+    for (std::size_t size = 1; size <= 16; size *= 2)
+        BOOST_CHECK(
+            test_filter_pair( bitshuffle_filter(size, 4096),
+                              bitshuffle_filter(size, 4096), str )
+        );
+    BOOST_CHECK(
+        test_filter_pair(bitshuffle_filter(3), bitshuffle_filter(3), str)
+    );
+    BOOST_CHECK(
+        test_filter_pair( bitshuffle_filter(8, 100),
+                          bitshuffle_filter(8, 100), str.substr(0, 1234) )
+    );
+}
+
+void compression_test()
+{
+    std::string  data = timestamps(100000);
+    std::string  plain = write_through(data, zlib_compressor());
+    std::string  shuffled, bitshuffled;
+    {
+        filtering_ostream out( shuffle_filter<8>() | zlib_compressor() |
+                               io::back_inserter(shuffled) );
+        out.write(data.data(), data.size());
+    }
+    {
+        filtering_ostream out( bitshuffle_filter(8) | zlib_compressor() |
+                               io::back_inserter(bitshuffled) );
+        out.write(data.data(), data.size());
+    }
+    BOOST_CHECK(shuffled.size() < plain.size());
+    BOOST_CHECK(bitshuffled.size() < plain.size());
+
+    filtering_istream in;
+    in.push(shuffle_filter<8>());
+    in.push(zlib_decompressor());
+    in.push(array_source(shuffled.data(), shuffled.size()));
+    std::string result;
+    io::copy(in, io::back_inserter(result));
+    BOOST_CHECK(result == data);
+
+    in.reset();
+    in.push(bitshuffle_filter(8));
+    in.push(zlib_decompressor());
+    in.push(array_source(bitshuffled.data(), bitshuffled.size()));
+    result.clear();
+    io::copy(in, io::back_inserter(result));
+    BOOST_CHECK(result == data);
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("shuffle test");
+    test->add(BOOST_TEST_CASE(&shuffle_test));
+    test->add(BOOST_TEST_CASE(&bitshuffle_test));
+    test->add(BOOST_TEST_CASE(&compression_test));
+    return test;
+}
@@ -0,0 +1,187 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <string>
+#include <boost/cstdint.hpp>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/snappy.hpp>
+#include <boost/iostreams/filter/test.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include "detail/sequence.hpp"
+
+using namespace std;
+using namespace boost;
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+struct snappy_alloc : std::allocator<char> { };
+
+const std::string identifier("\xff\x06\x00\x00sNaPpY", 10);
+
+// Returns n characters, alternating between runs which compress well and
+// runs which do not
+std::string make_data(std::size_t n)
+{
+    std::string   result;
+    unsigned int  state = 1;
+    while (result.size() < n) {
+        state = state * 1103515245 + 12345;
+        if ((result.size() / 100000) % 2 == 0)
+            result += static_cast<char>('a' + (state >> 16) % 4);
+        else
+            result += static_cast<char>(state >> 16);
+    }
+    return result;
+}
+
+std::string compress(const std::string& data)
+{
+    std::string result;
+    io::copy(
+        array_source(data.data(), data.size()),
+        io::compose(snappy_compressor(), io::back_inserter(result))
+    );
+    return result;
+}
+
+std::string decompress( const std::string& data,
+                        const snappy_params& p = snappy_params() )
+{
+    std::string result;
+    io::copy(
+        io::compose( snappy_decompressor(p),
+                     array_source(data.data(), data.size()) ),
+        io::back_inserter(result)
+    );
+    return result;
+}
+
+// Returns a chunk header
+std::string header(int type, std::size_t length)
+{
+    std::string result(4, '\0');
+    result[0] = static_cast<char>(type);
+    result[1] = static_cast<char>(length & 0xff);
+    result[2] = static_cast<char>((length >> 8) & 0xff);
+    result[3] = static_cast<char>((length >> 16) & 0xff);
+    return result;
+}
+
+// Returns an uncompressed data chunk containing the string "123456789",
+// whose CRC-32C is 0xe3069283
+std::string check_chunk()
+{
+    boost::uint32_t  crc = 0xe3069283;
+    boost::uint32_t  masked = ((crc >> 15) | (crc << 17)) + 0xa282ead8;
+    std::string      result = header(snappy::uncompressed_data, 13);
+    for (int z = 0; z < 4; ++z, masked >>= 8)
+        result += static_cast<char>(masked & 0xff);
+    return result + "123456789";
+}
+
+void snappy_test()
+{
+    text_sequence  data;
+    std::string    str(data.begin(), data.end());
+    BOOST_CHECK(
+        test_filter_pair(snappy_compressor(), snappy_decompressor(), str)
+    );
+    BOOST_CHECK(
+        test_filter_pair( basic_snappy_compressor<snappy_alloc>(),
+                          basic_snappy_decompressor<snappy_alloc>(),
+                          str )
+    );
+    BOOST_CHECK(
+        test_filter_pair( snappy_compressor(),
+                          snappy_decompressor(),
+                          std::string() )
+    );
+    BOOST_CHECK(compress(std::string()) == identifier);
+
+    // Many chunks, both compressed and stored
+    std::string large = make_data(1000000), compressed = compress(large);
+    BOOST_CHECK(compressed.size() < large.size());
+    BOOST_CHECK(decompress(compressed) == large);
+    BOOST_CHECK(
+        test_filter_pair(snappy_compressor(), snappy_decompressor(), large)
+    );
+}
+
+void framing_test()
+{
+    // Hand-built stream containing padding, a reserved skippable chunk, a
+    // repeated stream identifier and a chunk with a known checksum
+    std::string stream =
+        identifier +
+        header(snappy::padding, 3) + "xyz" +
+        header(0x80, 0) +
+        header(0x9a, 2) + "ab" +
+        check_chunk() +
+        identifier +
+        check_chunk();
+    BOOST_CHECK_EQUAL(decompress(stream), "123456789123456789");
+
+    // Missing stream identifier
+    try {
+        decompress(check_chunk());
+        BOOST_ERROR("missing stream identifier not detected");
+    } catch (const snappy_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), snappy::bad_stream_identifier);
+    }
+
+    // Reserved unskippable chunk
+    try {
+        decompress(identifier + header(0x02, 1) + "a");
+        BOOST_ERROR("unskippable chunk not detected");
+    } catch (const snappy_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), snappy::unskippable_chunk);
+    }
+
+    // Checksum mismatch, unless checksums are not verified
+    std::string corrupt = identifier + check_chunk();
+    corrupt[corrupt.size() - 1] = 'x';
+    try {
+        decompress(corrupt);
+        BOOST_ERROR("checksum mismatch not detected");
+    } catch (const snappy_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), snappy::checksum_error);
+    }
+    BOOST_CHECK_EQUAL(decompress(corrupt, false), "12345678x");
+
+    // Truncated stream
+    std::string compressed = compress(make_data(100000));
+    try {
+        decompress(compressed.substr(0, compressed.size() - 1));
+        BOOST_ERROR("truncated stream not detected");
+    } catch (const snappy_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), snappy::unexpected_eof);
+    }
+
+    // Corrupt compressed data is reported through error_code overloads
+    compressed[identifier.size() + 10] ^= 0x55;
+    std::string                      dest;
+    back_insert_device<std::string>  snk(dest);
+    snappy_decompressor              dec;
+    boost::system::error_code        ec;
+    dec.write(snk, compressed.data(), (std::streamsize) compressed.size(), ec);
+    BOOST_CHECK(ec.category() == snappy_category());
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("snappy test");
+    test->add(BOOST_TEST_CASE(&snappy_test));
+    test->add(BOOST_TEST_CASE(&framing_test));
+    return test;
+}
@@ -0,0 +1,342 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <cstdio>     // sprintf.
+#include <cstring>    // memcpy.
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/device/tar_archive.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include "detail/temp_file.hpp"
+
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+typedef basic_tar_archive<array_source>     array_tar;
+typedef basic_tar_gz_archive<array_source>  array_tar_gz;
+
+// Assembles an archive in memory
+class tar_builder {
+public:
+    void add( const std::string& name, const std::string& data,
+              char type = tar::regular, const std::string& link = "",
+              const std::string& prefix = "" )
+    {
+        header(name, data.size(), type, link, prefix);
+        append(data);
+    }
+
+    // Adds a member whose name is stored in a GNU long name header
+    void add_long(const std::string& name, const std::string& data)
+    {
+        header("././@LongLink", name.size() + 1, 'L', "", "");
+        append(name + '\0');
+        add(name.substr(0, 99), data);
+    }
+
+    // Adds a member whose name is stored in a pax header
+    void add_pax(const std::string& name, const std::string& data)
+    {
+        std::string  body = " path=" + name + "\n";
+        std::size_t  len = body.size() + 1;
+        while (len != body.size() + digits(len))
+            len = body.size() + digits(len);
+        std::ostringstream record;
+        record << len << body;
+        header("PaxHeader", record.str().size(), 'x', "", "");
+        append(record.str());
+        add(name.substr(0, 99), data);
+    }
+    std::string str() const { return archive_ + std::string(1024, '\0'); }
+    std::size_t size() const { return archive_.size(); }
+private:
+    static std::size_t digits(std::size_t n)
+    {
+        std::ostringstream out;
+        out << n;
+        return out.str().size();
+    }
+    void header( const std::string& name, std::size_t size, char type,
+                 const std::string& link, const std::string& prefix )
+    {
+        char h[512] = { 0 };
+        std::memcpy(h, name.data(), name.size());
+        std::sprintf(h + 100, "%07o", 0644);
+        std::sprintf(h + 108, "%07o", 0);
+        std::sprintf(h + 116, "%07o", 0);
+        std::sprintf(h + 124, "%011lo", static_cast<unsigned long>(size));
+        std::sprintf(h + 136, "%011lo", 1200000000ul);
+        std::memset(h + 148, ' ', 8);
+        h[156] = type;
+        std::memcpy(h + 157, link.data(), link.size());
+        std::memcpy(h + 257, "ustar\0" "00", 8);
+        std::memcpy(h + 345, prefix.data(), prefix.size());
+        unsigned long sum = 0;
+        for (int z = 0; z < 512; ++z)
+            sum += static_cast<unsigned char>(h[z]);
+        std::sprintf(h + 148, "%06lo", sum);
+        archive_.append(h, 512);
+    }
+    void append(const std::string& data)
+    {
+        archive_ += data;
+        archive_.append((512 - data.size() % 512) % 512, '\0');
+    }
+    std::string archive_;
+};
+
+// Returns data of the given size which compresses moderately well
+std::string contents(std::size_t size, unsigned seed)
+{
+    std::string result;
+    unsigned value = seed;
+    for (std::size_t z = 0; z < size; ++z) {
+        value = value * 1103515245u + 12345u;
+        result += static_cast<char>('a' + (value >> 16) % 16);
+    }
+    return result;
+}
+
+std::string gzipped(const std::string& data)
+{
+    std::string result;
+    io::copy( array_source(data.data(), data.size()),
+              io::compose(gzip_compressor(), io::back_inserter(result)) );
+    return result;
+}
+
+// Returns the contents of the given member
+template<typename Archive>
+std::string read_member(const Archive& a, const std::string& name)
+{
+    std::string result;
+    io::copy(a.open(name), io::back_inserter(result));
+    return result;
+}
+
+// Returns a copy of the given index made by saving and loading it
+tar_index copy_index(const tar_index& index)
+{
+    std::string saved;
+    back_insert_device<std::string> snk(saved);
+    index.save(snk);
+    tar_index result;
+    array_source src(saved.data(), saved.size());
+    result.load(src);
+    return result;
+}
+
+std::string long_name()
+{
+    return "long/" + std::string(120, 'x') + "/member.txt";
+}
+
+// Returns an archive containing members of each kind
+std::string sample_archive()
+{
+    tar_builder b;
+    b.add("a.txt", "alpha");
+    b.add("dir/", "", tar::directory);
+    b.add("dir/empty", "");
+    b.add("dir/link", "", tar::symbolic_link, "../a.txt");
+    b.add_long(long_name(), contents(1000, 1));
+    b.add_pax("pax/" + std::string(110, 'y'), contents(700, 2));
+    b.add("b.txt", "in prefix", tar::regular, "", "some/prefix");
+    b.add("a.txt", "alpha again");
+    return b.str();
+}
+
+void index_test()
+{
+    std::string  tar = sample_archive();
+    array_tar    a(array_source(tar.data(), tar.size()));
+    BOOST_REQUIRE_EQUAL(a.size(), 8u);
+    BOOST_CHECK_EQUAL(a[0].name, "a.txt");
+    BOOST_CHECK_EQUAL(a[0].header_offset, 0);
+    BOOST_CHECK_EQUAL(a[0].data_offset, 512);
+    BOOST_CHECK_EQUAL(a[0].size, 5);
+    BOOST_CHECK_EQUAL(a[0].mode, 0644u);
+    BOOST_CHECK_EQUAL(a[0].mtime, 1200000000);
+    BOOST_CHECK(a[1].is_directory());
+    BOOST_CHECK(a[2].is_regular());
+    BOOST_CHECK_EQUAL(a[3].type, tar::symbolic_link);
+    BOOST_CHECK_EQUAL(a[3].link_name, "../a.txt");
+
+    // Long names; header_offset is that of the first header
+    BOOST_CHECK_EQUAL(a[4].name, long_name());
+    BOOST_CHECK_EQUAL(a[4].header_offset, 5 * 512);
+    BOOST_CHECK_EQUAL(a[4].data_offset, 8 * 512);
+    BOOST_CHECK_EQUAL(a[5].name, "pax/" + std::string(110, 'y'));
+    BOOST_CHECK_EQUAL(a[6].name, "some/prefix/b.txt");
+
+    // Lookup by name finds the last member with a name
+    BOOST_CHECK(a.find("a.txt") == &a[7]);
+    BOOST_CHECK(a.find("dir/link") == &a[3]);
+    BOOST_CHECK(a.find("missing") == 0);
+    BOOST_CHECK(read_member(a, "a.txt") == "alpha again");
+    BOOST_CHECK(read_member(a, long_name()) == contents(1000, 1));
+    BOOST_CHECK(read_member(a, a[5].name) == contents(700, 2));
+    BOOST_CHECK(read_member(a, "dir/empty").empty());
+    try {
+        a.open("missing");
+        BOOST_ERROR("expected tar_error");
+    } catch (const tar_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), tar::member_not_found);
+    }
+
+    // Members of an archive in memory are views of its characters
+    array_tar::member_source m = a.open(a[4]);
+    std::pair<char*, char*> seq = m.input_sequence();
+    BOOST_CHECK(seq.first == tar.data() + a[4].data_offset);
+    BOOST_CHECK_EQUAL(seq.second - seq.first, 1000);
+
+    // A saved index can be loaded and used with the same archive
+    array_tar b(array_source(tar.data(), tar.size()), copy_index(a.index()));
+    BOOST_REQUIRE_EQUAL(b.size(), a.size());
+    for (std::size_t z = 0; z < a.size(); ++z) {
+        BOOST_CHECK_EQUAL(b[z].name, a[z].name);
+        BOOST_CHECK_EQUAL(b[z].link_name, a[z].link_name);
+        BOOST_CHECK_EQUAL(b[z].data_offset, a[z].data_offset);
+        BOOST_CHECK_EQUAL(b[z].mtime, a[z].mtime);
+    }
+    BOOST_CHECK(read_member(b, long_name()) == contents(1000, 1));
+}
+
+void file_test()
+{
+    std::string  tar = sample_archive();
+    temp_file    temp;
+    {
+        std::ofstream out(temp.name().c_str(), BOOST_IOS::binary);
+        out.write(tar.data(), static_cast<std::streamsize>(tar.size()));
+    }
+
+    // Memory-mapped file
+    {
+        tar_archive a((mapped_file_source(temp.name())));
+        BOOST_REQUIRE_EQUAL(a.size(), 8u);
+
+        // Closing a member leaves the file mapped
+        BOOST_CHECK(read_member(a, a[5].name) == contents(700, 2));
+        tar_archive::member_source m = a.open(long_name());
+        std::pair<char*, char*> seq = m.input_sequence();
+        BOOST_CHECK( std::string(seq.first, seq.second) ==
+                     contents(1000, 1) );
+    }
+
+    // Seekable file
+    {
+        basic_tar_archive<file_source> a((file_source(temp.name())));
+        BOOST_REQUIRE_EQUAL(a.size(), 8u);
+        BOOST_CHECK(read_member(a, a[5].name) == contents(700, 2));
+        stream<basic_tar_archive<file_source>::member_source>
+            in(a.open("some/prefix/b.txt"));
+        std::string line;
+        BOOST_CHECK(std::getline(in, line));
+        BOOST_CHECK_EQUAL(line, "in prefix");
+    }
+}
+
+void gz_test()
+{
+    tar_builder b;
+    for (int z = 0; z < 40; ++z) {
+        std::ostringstream name;
+        name << "member" << z;
+        b.add(name.str(), contents(5000 + z * 3000, z));
+    }
+    std::string tar = b.str(), gz = gzipped(tar);
+
+    // Checkpoints are recorded while the index is built
+    array_tar_gz a(array_source(gz.data(), gz.size()), 64 * 1024);
+    BOOST_REQUIRE_EQUAL(a.size(), 40u);
+    BOOST_CHECK(a.index().checkpoints().size() > 10);
+    array_tar plain(array_source(tar.data(), tar.size()));
+    for (std::size_t z = 0; z < a.size(); z += 3) {
+        BOOST_CHECK_EQUAL(a[z].data_offset, plain[z].data_offset);
+        BOOST_CHECK(read_member(a, a[z].name) == contents(a[z].size, z));
+    }
+
+    // Members may be read in any order, with a saved index
+    array_tar_gz c(array_source(gz.data(), gz.size()), copy_index(a.index()));
+    BOOST_CHECK_EQUAL( c.index().checkpoints().size(),
+                       a.index().checkpoints().size() );
+    for (std::size_t z = a.size(); z-- > 0; )
+        BOOST_CHECK(read_member(c, c[z].name) == contents(c[z].size, z));
+
+    // Reading in small pieces
+    array_tar_gz::member_source m = c.open("member33");
+    std::string result;
+    char buf[7];
+    std::streamsize amt;
+    while ((amt = m.read(buf, sizeof(buf))) != -1)
+        result.append(buf, static_cast<std::size_t>(amt));
+    BOOST_CHECK(result == contents(5000 + 33 * 3000, 33));
+}
+
+void error_test()
+{
+    std::string tar = sample_archive();
+
+    // Bad checksum
+    std::string bad = tar;
+    bad[1024] ^= 1;
+    try {
+        array_tar a(array_source(bad.data(), bad.size()));
+        BOOST_ERROR("expected tar_error");
+    } catch (const tar_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), tar::bad_checksum);
+    }
+
+    // Truncated member, and archive truncated after a member
+    tar_builder b;
+    b.add("a", contents(2000, 1));
+    std::string truncated = b.str().substr(0, 1500);
+    try {
+        array_tar a(array_source(truncated.data(), truncated.size()));
+        BOOST_ERROR("expected tar_error");
+    } catch (const tar_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), tar::unexpected_eof);
+    }
+    array_tar a(array_source(tar.data(), 1024));
+    BOOST_CHECK_EQUAL(a.size(), 1u);
+
+    // Malformed index
+    std::string saved;
+    back_insert_device<std::string> snk(saved);
+    a.index().save(snk);
+    saved.resize(saved.size() - 1);
+    tar_index index;
+    array_source src(saved.data(), saved.size());
+    try {
+        index.load(src);
+        BOOST_ERROR("expected tar_error");
+    } catch (const tar_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), tar::bad_index);
+    }
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("tar_archive test");
+    test->add(BOOST_TEST_CASE(&index_test));
+    test->add(BOOST_TEST_CASE(&file_test));
+    test->add(BOOST_TEST_CASE(&gz_test));
+    test->add(BOOST_TEST_CASE(&error_test));
+    return test;
+}
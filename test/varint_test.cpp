@@ -0,0 +1,232 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/test.hpp>
+#include <boost/iostreams/filter/varint.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include "detail/sequence.hpp"
+
+using namespace std;
+using namespace boost;
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+// Returns the given integers, with the given width and byte order
+std::string integers( const std::vector<boost::uint64_t>& values, int width,
+                      bool big = false )
+{
+    std::string result;
+    for (std::size_t z = 0; z < values.size(); ++z)
+        for (int k = 0; k < width; ++k) {
+            int shift = 8 * (big ? width - 1 - k : k);
+            result += static_cast<char>((values[z] >> shift) & 0xff);
+        }
+    return result;
+}
+
+// Returns n integers which mostly increase slowly, like timestamps, with
+// occasional jumps in either direction
+std::vector<boost::uint64_t> timestamps(int n)
+{
+    std::vector<boost::uint64_t>  result;
+    boost::uint64_t               value = 1200000000000ULL, seed = 1;
+    for (int z = 0; z < n; ++z) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        if (z % 97 == 0)
+            value += seed;
+        else if (z % 5 == 0)
+            value += 1000 + (z * 7919) % 50;
+        else
+            value -= (seed >> 60) - 8;
+        result.push_back(value);
+    }
+    return result;
+}
+
+std::string encode(const std::string& data, const varint_params& p)
+{
+    std::string result;
+    io::copy(
+        array_source(data.data(), data.size()),
+        io::compose(delta_varint_encoder(p), io::back_inserter(result))
+    );
+    return result;
+}
+
+std::string decode(const std::string& data, const varint_params& p)
+{
+    std::string result;
+    io::copy(
+        io::compose( delta_varint_decoder(p),
+                     array_source(data.data(), data.size()) ),
+        io::back_inserter(result)
+    );
+    return result;
+}
+
+void format_test()
+{
+    // Differences 1, 2, -1 and 298 become 2, 4, 1 and 596
+    std::vector<boost::uint64_t> values;
+    values.push_back(1);
+    values.push_back(3);
+    values.push_back(2);
+    values.push_back(300);
+    std::string data = integers(values, 4);
+    BOOST_CHECK(encode(data, 4) == std::string("\4\5\2\4\1\xd4\4", 7));
+    BOOST_CHECK(
+        encode(data, varint_params(4, varint::group_varint)) ==
+        std::string("\4\6\x40\2\4\1\x54\2", 8)
+    );
+    BOOST_CHECK(
+        encode( integers(values, 4, true),
+                varint_params(4, varint::leb128, varint::big_endian) ) ==
+        encode(data, 4)
+    );
+
+    // Blocks of three integers; differences wrap around
+    values[1] = 0xffffffff;
+    BOOST_CHECK(
+        encode(integers(values, 4), varint_params(4, varint::leb128,
+                                                  varint::little_endian, 3)) ==
+        std::string("\3\3\2\3\6\1\2\xd4\4", 9)
+    );
+
+    // Empty streams
+    BOOST_CHECK(encode(std::string(), 4).empty());
+    BOOST_CHECK(decode(std::string(), 4).empty());
+}
+
+void round_trip_test()
+{
+    std::vector<boost::uint64_t>  values = timestamps(20000);
+    text_sequence                 text;
+    std::string                   str(text.begin(), text.end());
+    for (int width = 1; width <= 8; ++width) {
+        for (int format = 0; format < 2; ++format) {
+            for (int big = 0; big < 2; ++big) {
+                varint_params p( width,
+                                 format ?
+                                     varint::group_varint :
+                                     varint::leb128,
+                                 big ?
+                                     varint::big_endian :
+                                     varint::little_endian );
+                std::string data = integers(values, width, big != 0);
+                BOOST_CHECK(
+                    test_filter_pair( delta_varint_encoder(p),
+                                      delta_varint_decoder(p), data )
+                );
+                BOOST_CHECK(
+                    test_filter_pair( delta_varint_encoder(p),
+                                      delta_varint_decoder(p),
+                                      str.substr(0, str.size() -
+                                                        str.size() % width) )
+                );
+                p.block_size = 7;
+                BOOST_CHECK(
+                    test_filter_pair( delta_varint_encoder(p),
+                                      delta_varint_decoder(p),
+                                      data.substr(0, 1000 * width) )
+                );
+            }
+        }
+    }
+
+    // Slowly increasing integers take about a byte each
+    std::vector<boost::uint64_t> counter;
+    for (int z = 0; z < 10000; ++z)
+        counter.push_back(1000000 + 3 * z + z % 7);
+    std::string data = integers(counter, 8);
+    BOOST_CHECK(encode(data, 8).size() < data.size() / 7);
+    BOOST_CHECK(decode(encode(data, 8), 8) == data);
+}
+
+void error_test()
+{
+    try {
+        delta_varint_encoder enc(varint_params(9));
+        BOOST_ERROR("invalid width accepted");
+    } catch (const varint_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), varint::bad_params);
+    }
+
+    // Input which doesn't consist of whole integers
+    try {
+        encode("1234567", 4);
+        BOOST_ERROR("partial integer not detected");
+    } catch (const varint_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), varint::partial_integer);
+    }
+
+    // Truncated stream
+    std::string encoded = encode(integers(timestamps(10000), 8), 8);
+    try {
+        decode(encoded.substr(0, encoded.size() - 1), 8);
+        BOOST_ERROR("truncated stream not detected");
+    } catch (const varint_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), varint::unexpected_eof);
+    }
+
+    // Block larger than the block size
+    try {
+        decode(encoded, varint_params(8, varint::leb128,
+                                      varint::little_endian, 100));
+        BOOST_ERROR("invalid block header not detected");
+    } catch (const varint_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), varint::bad_block_header);
+    }
+
+    // Values exceeding the width, and bodies of the wrong size
+    try {
+        decode(std::string("\1\2\x80\4", 4), 1);
+        BOOST_ERROR("overlong value not detected");
+    } catch (const varint_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), varint::data_error);
+    }
+    try {
+        decode(std::string("\1\2\1\1", 4), 2);
+        BOOST_ERROR("bad body size not detected");
+    } catch (const varint_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), varint::data_error);
+    }
+    try {
+        decode( std::string("\1\2\1\1", 4),
+                varint_params(2, varint::group_varint) );
+        BOOST_ERROR("bad control byte not detected");
+    } catch (const varint_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), varint::data_error);
+    }
+
+    // Errors are reported through error_code overloads
+    encoded[encoded.size() / 2] ^= 0x80;
+    std::string                      dest;
+    back_insert_device<std::string>  snk(dest);
+    delta_varint_decoder             dec(8);
+    boost::system::error_code        ec;
+    dec.write(snk, encoded.data(), (std::streamsize) encoded.size(), ec);
+    BOOST_CHECK(ec.category() == varint_category());
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("varint test");
+    test->add(BOOST_TEST_CASE(&format_test));
+    test->add(BOOST_TEST_CASE(&round_trip_test));
+    test->add(BOOST_TEST_CASE(&error_test));
+    return test;
+}
@@ -0,0 +1,294 @@
+// (C) Copyright 2008 CodeRage, LLC (turkanis at coderage dot com)
+// (C) Copyright 2004-2007 Jonathan Turkanis
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt.)
+
+// See http://www.boost.org/libs/iostreams for documentation.
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/device/zip_archive.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/mutex.hpp>
+#include "detail/sequence.hpp"
+#include "detail/temp_file.hpp"
+
+using namespace std;
+using namespace boost::iostreams;
+using namespace boost::iostreams::test;
+using boost::unit_test::test_suite;
+namespace io = boost::iostreams;
+
+std::string le(boost::uint64_t value, int size)
+{
+    std::string result;
+    for (int z = 0; z < size; ++z, value >>= 8)
+        result += static_cast<char>(value & 0xff);
+    return result;
+}
+
+// Assembles an archive in memory
+class zip_builder {
+public:
+    void add( const std::string& name, const std::string& data,
+              int method = zip::deflated )
+    {
+        std::string compressed = data;
+        if (method == zip::deflated) {
+            compressed.clear();
+            zlib_params p;
+            p.noheader = true;
+            io::copy(
+                array_source(data.data(), data.size()),
+                io::compose( zlib_compressor(p),
+                             io::back_inserter(compressed) )
+            );
+        }
+        boost::uint32_t crc = crc32(data);
+        std::string common =
+            le(20, 2) + le(0, 2) + le(method, 2) + le(0, 4) + le(crc, 4) +
+            le(compressed.size(), 4) + le(data.size(), 4) +
+            le(name.size(), 2) + le(0, 2);
+        directory_ +=
+            le(0x02014b50, 4) + le(20, 2) + common + le(0, 2) + le(0, 2) +
+            le(0, 2) + le(0, 4) + le(archive_.size(), 4) + name;
+        archive_ += le(0x04034b50, 4) + common + name + compressed;
+        ++count_;
+    }
+
+    // Returns the archive, using ZIP64 end records if requested
+    std::string finish(bool zip64 = false)
+    {
+        std::string result = archive_ + directory_;
+        if (zip64) {
+            std::size_t end64 = result.size();
+            result +=
+                le(0x06064b50, 4) + le(44, 8) + le(45, 2) + le(45, 2) +
+                le(0, 4) + le(0, 4) + le(count_, 8) + le(count_, 8) +
+                le(directory_.size(), 8) + le(archive_.size(), 8) +
+                le(0x07064b50, 4) + le(0, 4) + le(end64, 8) + le(1, 4) +
+                le(0x06054b50, 4) + le(0, 4) + le(0xffff, 2) +
+                le(0xffff, 2) + le(0xffffffff, 4) + le(0xffffffff, 4) +
+                le(0, 2);
+        } else {
+            result +=
+                le(0x06054b50, 4) + le(0, 4) + le(count_, 2) + le(count_, 2) +
+                le(directory_.size(), 4) + le(archive_.size(), 4) +
+                le(7, 2) + "comment";
+        }
+        return result;
+    }
+    zip_builder() : count_(0) { }
+private:
+    static boost::uint32_t crc32(const std::string& data)
+    {
+        boost::uint32_t crc = 0xffffffff;
+        for (std::string::size_type z = 0; z < data.size(); ++z) {
+            crc ^= static_cast<unsigned char>(data[z]);
+            for (int k = 0; k < 8; ++k)
+                crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+        }
+        return ~crc;
+    }
+    std::string  archive_, directory_;
+    std::size_t  count_;
+};
+
+std::string contents(int n)
+{
+    text_sequence  data;
+    std::string    str(data.begin(), data.end());
+    return str.substr(0, (n * 977) % str.size());
+}
+
+std::string read_member(const zip_archive& a, const std::string& name)
+{
+    std::string result;
+    zip_member_source src = a.open(name);
+    io::copy(src, io::back_inserter(result));
+    return result;
+}
+
+// Records the contents passed by zip_archive::extract
+struct collector {
+    void operator()(const zip_entry& e, const char* s, std::size_t n)
+    {
+        boost::mutex::scoped_lock lock(*mtx);
+        (*members)[e.name] = std::string(s, n);
+    }
+    boost::mutex*                         mtx;
+    std::map<std::string, std::string>*   members;
+};
+
+void check_archive(const zip_archive& a, bool in_memory)
+{
+    BOOST_REQUIRE_EQUAL(a.size(), 5u);
+    BOOST_CHECK_EQUAL(a[0].name, "dir/");
+    BOOST_CHECK(a[0].is_directory());
+    BOOST_CHECK(a.find("missing") == 0);
+    BOOST_REQUIRE(a.find("dir/stored") != 0);
+    BOOST_CHECK_EQUAL(a.find("dir/stored")->method, zip::stored);
+    BOOST_CHECK_EQUAL(read_member(a, "dir/stored"), contents(1));
+    BOOST_CHECK_EQUAL(read_member(a, "dir/deflated"), contents(2));
+    BOOST_CHECK_EQUAL(read_member(a, "empty"), std::string());
+    BOOST_CHECK_EQUAL(read_member(a, "empty-stored"), std::string());
+
+    std::pair<const char*, const char*> data =
+        a.data(*a.find("dir/stored"));
+    if (in_memory) {
+        BOOST_REQUIRE(data.first != 0);
+        BOOST_CHECK_EQUAL(std::string(data.first, data.second), contents(1));
+    } else {
+        BOOST_CHECK(data.first == 0);
+    }
+    BOOST_CHECK(a.data(*a.find("dir/deflated")).first == 0);
+    try {
+        a.open("missing");
+        BOOST_ERROR("missing member not detected");
+    } catch (const zip_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), zip::member_not_found);
+    }
+}
+
+void archive_test()
+{
+    zip_builder b;
+    b.add("dir/", "", zip::stored);
+    b.add("dir/stored", contents(1), zip::stored);
+    b.add("dir/deflated", contents(2));
+    b.add("empty", "");
+    b.add("empty-stored", "", zip::stored);
+    for (int zip64 = 0; zip64 < 2; ++zip64) {
+        std::string archive = b.finish(zip64 != 0);
+        check_archive(
+            zip_archive(array_source(archive.data(), archive.size())),
+            true
+        );
+
+        temp_file      f;
+        std::ofstream  out(f.name().c_str(), BOOST_IOS::binary);
+        out.write(archive.data(), archive.size());
+        out.close();
+        check_archive(zip_archive(f.name()), true);
+        check_archive(zip_archive(file_source(f.name())), false);
+    }
+}
+
+void extract_test()
+{
+    zip_builder b;
+    for (int z = 0; z < 200; ++z)
+        b.add( "member" + le('a' + z % 26, 1) + le('a' + z / 26, 1),
+               contents(z), z % 3 == 0 ? zip::stored : zip::deflated );
+    b.add("dir/", "", zip::stored);
+    std::string archive = b.finish();
+    std::map<std::string, std::string>  members;
+    boost::mutex                        mtx;
+    collector                           c = { &mtx, &members };
+    for (int indirect = 0; indirect < 2; ++indirect) {
+        temp_file      f;
+        std::ofstream  out(f.name().c_str(), BOOST_IOS::binary);
+        out.write(archive.data(), archive.size());
+        out.close();
+        zip_archive a = indirect ?
+            zip_archive(file_source(f.name())) :
+            zip_archive(f.name());
+        for (unsigned threads = 1; threads <= 4; threads *= 2) {
+            members.clear();
+            a.extract(c, threads);
+            BOOST_REQUIRE_EQUAL(members.size(), 200u);
+            for (zip_archive::size_type z = 0; z < 200; ++z)
+                BOOST_CHECK(members[a[z].name] == contents(z));
+        }
+
+        std::vector<zip_archive::size_type> some;
+        some.push_back(5);
+        some.push_back(150);
+        members.clear();
+        a.extract(some, c);
+        BOOST_CHECK_EQUAL(members.size(), 2u);
+        BOOST_CHECK(members[a[150].name] == contents(150));
+    }
+
+    // Failures are reported once all threads have finished
+    std::string corrupt = archive;
+    corrupt[corrupt.find("memberad") + 8] ^= 1;
+    zip_archive a(array_source(corrupt.data(), corrupt.size()));
+    try {
+        a.extract(c, 4);
+        BOOST_ERROR("corrupt member not detected");
+    } catch (const zip_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), zip::crc_error);
+    }
+}
+
+void error_test()
+{
+    zip_builder b;
+    b.add("stored", contents(1), zip::stored);
+    b.add("deflated", contents(2));
+    std::string archive = b.finish();
+
+    // Not an archive
+    std::string str = contents(3);
+    try {
+        zip_archive a(array_source(str.data(), str.size()));
+        BOOST_ERROR("invalid archive accepted");
+    } catch (const zip_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), zip::bad_archive);
+    }
+
+    // Modified contents
+    std::string corrupt = archive;
+    corrupt[100] ^= 1;
+    zip_archive ca(array_source(corrupt.data(), corrupt.size()));
+    try {
+        read_member(ca, "stored");
+        BOOST_ERROR("crc mismatch not detected");
+    } catch (const zip_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), zip::crc_error);
+    }
+
+    // Compressed data ending before the end of the deflate stream
+    std::string truncated = archive;
+    zip_archive a(array_source(archive.data(), archive.size()));
+    truncated.replace( truncated.rfind("PK\1\2") + 20, 4,
+                       le(a.find("deflated")->compressed_size - 10, 4) );
+    zip_archive ta(array_source(truncated.data(), truncated.size()));
+    try {
+        read_member(ta, "deflated");
+        BOOST_ERROR("truncated member not detected");
+    } catch (const zip_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), zip::unexpected_eof);
+    }
+
+    // Unsupported compression method
+    std::string bzip2 = archive;
+    bzip2[bzip2.find("PK\1\2") + 10] = 12;
+    zip_archive ua(array_source(bzip2.data(), bzip2.size()));
+    try {
+        read_member(ua, "stored");
+        BOOST_ERROR("unsupported method not detected");
+    } catch (const zip_error& e) {
+        BOOST_CHECK_EQUAL(e.error(), zip::unsupported_method);
+    }
+}
+
+test_suite* init_unit_test_suite(int, char* [])
+{
+    test_suite* test = BOOST_TEST_SUITE("zip_archive test");
+    test->add(BOOST_TEST_CASE(&archive_test));
+    test->add(BOOST_TEST_CASE(&extract_test));
+    test->add(BOOST_TEST_CASE(&error_test));
+    return test;
+}
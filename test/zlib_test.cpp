@@ -6,6 +6,11 @@
 // See http://www.boost.org/libs/iostreams for documentation.
 
 #include <string>
+#include <boost/iostreams/compose.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/filter/test.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
@@ -52,9 +57,79 @@ void zlib_test()
     }
 }
 
+// Returns text of the given size consisting of words chosen at random
+std::string words(std::size_t size)
+{
+    static const char* const vocabulary[] =
+        { "alpha ", "beta ", "gamma ", "delta ", "epsilon ", "zeta ", "eta ",
+          "theta ", "iota ", "kappa ", "lambda ", "mu ", "nu ", "xi ", "\n" };
+    std::string result;
+    unsigned value = 12345;
+    while (result.size() < size) {
+        value = value * 1103515245u + 12345u;
+        result += vocabulary[(value >> 16) % 15];
+        if ((value >> 8) % 7 == 0)
+            result += static_cast<char>('0' + (value >> 20) % 10);
+    }
+    result.resize(size);
+    return result;
+}
+
+std::string compress(const std::string& data, const zlib_params& p)
+{
+    std::string result;
+    boost::iostreams::copy(
+        array_source(data.data(), data.size()),
+        compose(zlib_compressor(p), boost::iostreams::back_inserter(result))
+    );
+    return result;
+}
+
+// Returns the length of the longest common suffix of the given compressed
+// data, excluding the trailing checksum
+std::size_t common_suffix(const std::string& s1, const std::string& s2)
+{
+    std::size_t n = 0;
+    while ( n + 4 < s1.size() && n + 4 < s2.size() &&
+            s1[s1.size() - 5 - n] == s2[s2.size() - 5 - n] )
+    {
+        ++n;
+    }
+    return n;
+}
+
+void rsyncable_test()
+{
+    std::string  small = words(80000);
+    zlib_params  p;
+    p.rsyncable = true;
+    BOOST_CHECK(
+        test_filter_pair(zlib_compressor(p), zlib_decompressor(), small)
+    );
+    gzip_params gp;
+    gp.rsyncable = true;
+    BOOST_CHECK(
+        test_filter_pair(gzip_compressor(gp), gzip_decompressor(), small)
+    );
+
+    // The output resynchronizes shortly after a change, at a small cost
+    std::string data = words(1000000), changed = data;
+    changed.insert(1000, "inserted");
+    changed[500000] = '!';
+    std::string plain = compress(data, zlib_params());
+    std::string before = compress(data, p), after = compress(changed, p);
+    BOOST_CHECK(common_suffix(before, after) > before.size() / 3);
+    BOOST_CHECK(
+        common_suffix(plain, compress(changed, zlib_params())) <
+        plain.size() / 10
+    );
+    BOOST_CHECK(before.size() < plain.size() + plain.size() / 50);
+}
+
 test_suite* init_unit_test_suite(int, char* []) 
 {
     test_suite* test = BOOST_TEST_SUITE("zlib test");
     test->add(BOOST_TEST_CASE(&zlib_test));
+    test->add(BOOST_TEST_CASE(&rsyncable_test));
     return test;
 }